@@ -28,15 +28,13 @@ UI_DIR = build/ui
 # In order to do so uncomment the following line.
 #DEFINES += QT_DISABLE_DEPRECATED_BEFORE=0x060000    # disables all the APIs deprecated before Qt 6.0.0
 
+# Noyau C de génération (sources, en-têtes et bibliothèques externes)
+include(spectral_core.pri)
+
 # Fichiers source
 SOURCES += \
     src/main.cpp \
     src/spectrogramgenerator.cpp \
-    src/spectral_generator.c \
-    src/spectral_wav_processing.c \
-    src/spectral_fft.c \
-    src/spectral_raster.c \
-    src/spectral_vector.c \
     src/previewimageprovider.cpp \
     src/waveformprovider.cpp \
     src/vectorprintprovider.cpp \
@@ -51,15 +49,16 @@ SOURCES += \
     src/VisualizationStrategy.cpp \
     src/QmlConstants.cpp \
     src/PathManager.cpp \
-    src/MacOSBridge.cpp
+    src/MacOSBridge.cpp \
+    src/AudioAnalysisCache.cpp \
+    src/WaveformPyramid.cpp \
+    src/WaveformItem.cpp \
+    src/JobScheduler.cpp \
+    src/PreviewController.cpp
 
 # Fichiers d'en-tête
 HEADERS += \
     include/spectrogramgenerator.h \
-    include/spectral_generator.h \
-    src/spectral_common.h \
-    src/spectral_wav_processing.h \
-    src/spectral_fft.h \
     include/previewimageprovider.h \
     include/waveformprovider.h \
     include/vectorprintprovider.h \
@@ -76,7 +75,12 @@ HEADERS += \
     include/TaskManager.h \
     include/QmlConstants.h \
     include/PathManager.h \
-    include/MacOSBridge.h
+    include/MacOSBridge.h \
+    include/AudioAnalysisCache.h \
+    include/WaveformPyramid.h \
+    include/WaveformItem.h \
+    include/JobScheduler.h \
+    include/PreviewController.h
 
 # Chemins d'inclusion
 INCLUDEPATH += $$PWD/include
@@ -94,15 +98,8 @@ else: unix:!android: target.path = /opt/$${TARGET}/bin
 !isEmpty(target.path): INSTALLS += target
 
 # Configuration des bibliothèques externes
-unix:!macx {
-    # Configuration Linux
-    LIBS += -lfftw3 -lcairo -lsndfile
-}
+# (fftw3, cairo et sndfile sont ajoutées par spectral_core.pri)
 macx {
-    # Configuration macOS
-    LIBS += -L/opt/homebrew/lib -lfftw3 -lcairo -lsndfile
-    INCLUDEPATH += /opt/homebrew/include
-    
     # Objectif-C++ pour la prise en charge spécifique à macOS
     OBJECTIVE_SOURCES += src/macos_utils.mm
     LIBS += -framework Cocoa
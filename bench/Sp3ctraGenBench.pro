@@ -0,0 +1,23 @@
+###############################################################################
+# sp3ctragen-bench - Mesure des étapes du pipeline sur des signaux synthétiques
+#
+# Usage: sp3ctragen-bench --durations 10,3600 --rates 44100,384000 --output bench.json
+###############################################################################
+
+TEMPLATE = app
+CONFIG -= qt app_bundle
+CONFIG += console release
+
+# Nom et cible du projet
+TARGET = sp3ctragen-bench
+
+# Répertoires pour les fichiers générés
+OBJECTS_DIR = build/obj
+
+# Noyau C de génération (sources, en-têtes et bibliothèques externes)
+include(../spectral_core.pri)
+
+# Fichiers source
+SOURCES += \
+    ../src/spectral_bench.c \
+    ../src/spectral_synth.c
@@ -0,0 +1,44 @@
+###############################################################################
+# sp3ctragen-cli - Génération de spectrogrammes par lots, sans interface
+###############################################################################
+
+# Configuration Qt (pas de dépendance à Qt Quick ni à Qt GUI)
+QT = core
+
+# Configuration du projet
+CONFIG += c++17 console
+CONFIG -= app_bundle
+CONFIG += sdk_no_version_check
+
+# Nom et cible du projet
+TARGET = sp3ctragen-cli
+
+# Répertoires pour les fichiers générés
+OBJECTS_DIR = build/obj
+MOC_DIR = build/moc
+
+# Noyau C de génération (sources, en-têtes et bibliothèques externes)
+include(../spectral_core.pri)
+
+# Fichiers source
+SOURCES += \
+    ../src/cli_main.cpp \
+    ../src/BatchRunner.cpp \
+    ../src/SpectrogramSettingsCpp.cpp \
+    ../src/TaskManager.cpp \
+    ../src/JobScheduler.cpp \
+    ../src/PathManager.cpp
+
+# Fichiers d'en-tête
+HEADERS += \
+    ../include/BatchRunner.h \
+    ../include/SpectrogramSettingsCpp.h \
+    ../include/TaskManager.h \
+    ../include/JobScheduler.h \
+    ../include/PathManager.h \
+    ../include/Constants.h \
+    ../include/SharedConstants.h
+
+# Règles de déploiement
+unix:!android: target.path = /opt/Sp3ctraGen/bin
+!isEmpty(target.path): INSTALLS += target
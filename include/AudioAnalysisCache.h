@@ -0,0 +1,137 @@
+/*
+ * Copyright (C) 2025 - present Ondulab
+ * All rights reserved.
+ *
+ * This software is licensed under terms that can be found in the LICENSE file
+ * in the root directory of this software component.
+ */
+
+#ifndef AUDIOANALYSISCACHE_H
+#define AUDIOANALYSISCACHE_H
+
+#include <QObject>
+#include <QHash>
+#include <QSet>
+#include <QMutex>
+#include <QString>
+#include <memory>
+#include "../src/spectral_audio_analysis.h"
+
+/**
+ * @brief Persistent cache of per-file peak/RMS analyses
+ *
+ * Each audio file is decoded once, in a single background pass, to
+ * produce file-wide and per-block peak/RMS summaries. Results are kept
+ * in memory and written to a sidecar file in the application cache
+ * directory, keyed by path, size and modification time, so that
+ * normalization factors are available instantly on later requests.
+ */
+class AudioAnalysisCache : public QObject
+{
+    Q_OBJECT
+
+public:
+    /**
+     * @brief Shared, immutable analysis result
+     */
+    using AnalysisPtr = std::shared_ptr<const AudioAnalysis>;
+
+    /**
+     * @brief Gets the unique instance of the cache (Singleton)
+     *
+     * @return Cache instance
+     */
+    static AudioAnalysisCache* getInstance();
+
+    /**
+     * @brief Starts a background analysis of a file if it is not cached yet
+     *
+     * @param audioPath Path to the audio file
+     */
+    void requestAnalysis(const QString& audioPath);
+
+    /**
+     * @brief Returns the cached analysis of a file without computing it
+     *
+     * Looks in memory first, then in the sidecar directory.
+     *
+     * @param audioPath Path to the audio file
+     * @return Analysis, or nullptr if none is available yet
+     */
+    AnalysisPtr cachedAnalysis(const QString& audioPath);
+
+    /**
+     * @brief Returns the analysis of a file, computing it synchronously if needed
+     *
+     * @param audioPath Path to the audio file
+     * @return Analysis, or nullptr if the file cannot be read
+     */
+    AnalysisPtr analysis(const QString& audioPath);
+
+    /**
+     * @brief Computes the gain bringing the file peak to a target level
+     *
+     * @param audioPath Path to the audio file
+     * @param targetPeak Target peak amplitude (default 0.95 to avoid clipping)
+     * @return Normalization factor (1.0 if the file cannot be analyzed)
+     */
+    double normalizationFactor(const QString& audioPath, double targetPeak = 0.95);
+
+    /**
+     * @brief Returns the normalization factor without decoding the file
+     *
+     * Safe on the GUI thread: when the analysis is not cached yet, it is
+     * requested in background and analysisReady() follows.
+     *
+     * @param audioPath Path to the audio file
+     * @param targetPeak Target peak amplitude
+     * @return Normalization factor, or 0.0 while the analysis is pending
+     */
+    double cachedNormalizationFactor(const QString& audioPath, double targetPeak = 0.95);
+
+signals:
+    /**
+     * @brief Signal emitted when a background analysis is finished
+     *
+     * @param audioPath Path to the analyzed file
+     * @param success Whether the analysis succeeded
+     */
+    void analysisReady(const QString& audioPath, bool success);
+
+private:
+    /**
+     * @brief Private constructor (Singleton)
+     *
+     * @param parent Parent object
+     */
+    explicit AudioAnalysisCache(QObject *parent = nullptr);
+
+    /**
+     * @brief Builds the cache key of a file (path, size and modification time)
+     *
+     * @param audioPath Path to the audio file
+     * @return Cache key, or empty string if the file does not exist
+     */
+    static QString cacheKey(const QString& audioPath);
+
+    /**
+     * @brief Gain bringing the peak of an analysis to a target level
+     */
+    static double factorOf(const AudioAnalysis& analysis, double targetPeak);
+
+    /**
+     * @brief Decodes a file, stores the result in memory and on disk
+     *
+     * @param audioPath Path to the audio file
+     * @param key Cache key of the file
+     * @return Analysis, or nullptr on error
+     */
+    AnalysisPtr computeAndStore(const QString& audioPath, const QString& key);
+
+    static AudioAnalysisCache* s_instance; // Unique instance (Singleton)
+    QMutex m_mutex;                        // Protects m_entries and m_pending
+    QHash<QString, AnalysisPtr> m_entries; // Analyses by cache key
+    QSet<QString> m_pending;               // Keys being analyzed in background
+};
+
+#endif // AUDIOANALYSISCACHE_H
@@ -0,0 +1,141 @@
+/*
+ * Copyright (C) 2025 - present Ondulab
+ * All rights reserved.
+ *
+ * This software is licensed under terms that can be found in the LICENSE file
+ * in the root directory of this software component.
+ */
+
+#ifndef BATCHRUNNER_H
+#define BATCHRUNNER_H
+
+#include <QJsonObject>
+#include <QMutex>
+#include <QString>
+#include <QStringList>
+#include <QTextStream>
+#include <QVector>
+#include "SpectrogramSettingsCpp.h"
+
+/**
+ * @brief Headless batch generation of spectrograms
+ *
+ * Collects jobs from a directory of audio files or from a JSON/CSV
+ * manifest and runs them as export jobs of the JobScheduler, at most
+ * a given number at a time. The jobs share the FFT plan cache and the
+ * parallel stages through TaskManager::prepareJob(). The length of a
+ * file is read from its header and the analysis normalizes the signal
+ * itself, so nothing is decoded twice. Every job analyzes its file once
+ * and renders all the requested formats from that analysis.
+ *
+ * Manifest entries use the keys "file", "output", "format" (png, pdf
+ * or both) and "dpi", plus any settings key accepted by applySetting().
+ * A JSON manifest is either an array of entries or an object with
+ * optional "defaults" and an array of "jobs"; a CSV manifest has one
+ * header row naming its columns. Relative paths are resolved against
+ * the manifest directory (inputs) and the output directory (outputs).
+ */
+class BatchRunner
+{
+public:
+    /**
+     * @brief One file to render
+     */
+    struct Job {
+        QString inputFile;
+        QString outputBase;                 // Output path without extension
+        bool png;
+        bool pdf;
+        int dpi;                            // Resolution of the PDF
+        SpectrogramSettingsCpp settings;
+    };
+
+    /**
+     * @brief Outcome and timing of a job
+     */
+    struct Result {
+        bool success;
+        QString message;
+        double audioSeconds;                // Length of the recording
+        double analyzeMs;                   // Decoding, filtering and FFT
+        double renderMs;                    // Every requested format
+        double totalMs;                     // Wall time of the job
+    };
+
+    BatchRunner();
+
+    /**
+     * @brief Settings of the jobs that do not override them
+     */
+    void setDefaults(const SpectrogramSettingsCpp& settings) { m_defaults = settings; }
+
+    /**
+     * @brief Directory receiving the outputs (created if needed)
+     */
+    void setOutputDirectory(const QString& path) { m_outputDirectory = path; }
+
+    /**
+     * @brief Default output formats and PDF resolution
+     */
+    void setFormats(bool png, bool pdf) { m_png = png; m_pdf = pdf; }
+    void setDpi(int dpi) { m_dpi = dpi; }
+
+    /**
+     * @brief Adds a job for every audio file of a directory (not recursive)
+     *
+     * @return false if the directory cannot be read
+     */
+    bool addDirectory(const QString& path, QString* error);
+
+    /**
+     * @brief Adds the jobs of a JSON or CSV manifest (chosen by extension)
+     *
+     * @return false if the manifest cannot be read or has an invalid entry
+     */
+    bool addManifest(const QString& path, QString* error);
+
+    /**
+     * @brief Sets one setting from its textual value
+     *
+     * The keys are the names of the SpectrogramSettings fields
+     * (minFreq, writingSpeed, enableNormalization, paginate...).
+     *
+     * @return false if the key is unknown or the value invalid
+     */
+    static bool applySetting(SpectrogramSettingsCpp& settings, const QString& key,
+                             const QString& value, QString* error);
+
+    int jobCount() const { return m_jobs.size(); }
+
+    /**
+     * @brief Runs every job and prints one line per job and a summary
+     *
+     * Batch mode has no previews, so the scheduler's interactive worker is
+     * released to the exports; the concurrency actually used (capped by the
+     * workers) is printed first.
+     *
+     * @param concurrency Maximum number of jobs running at the same time (0 = default)
+     * @param reportFile Optional CSV file receiving the timing of every job
+     * @return Number of failed jobs
+     */
+    int run(int concurrency, const QString& reportFile = QString());
+
+private:
+    bool addEntry(const QJsonObject& defaults, const QJsonObject& entry,
+                  const QString& baseDirectory, QString* error);
+    Result runJob(const Job& job) const;
+    void printResult(int index, const Job& job, const Result& result);
+
+    SpectrogramSettingsCpp m_defaults;
+    QString m_outputDirectory;
+    bool m_png;
+    bool m_pdf;
+    int m_dpi;
+    QVector<Job> m_jobs;
+
+    QMutex m_outputMutex;                   // Serializes the job lines
+    QTextStream m_out;
+    int m_finished;
+};
+
+#endif // BATCHRUNNER_H
@@ -51,6 +51,10 @@ namespace Constants {
     constexpr double BOTTOM_MARGIN = DEFAULT_BOTTOM_MARGIN_MM;
     constexpr double SPECTRO_HEIGHT = DEFAULT_SPECTRO_HEIGHT_MM;
     
+    // Generation budgets: larger plans are refused (0 = no limit)
+    constexpr qint64 MEMORY_BUDGET = 8LL * 1024 * 1024 * 1024;
+    constexpr double TIME_BUDGET = 0.0;
+    
     // User interface colors
     const QString PRIMARY_COLOR = "#D4AF37";  // Or
     const QString BACKGROUND_COLOR = "#222222";
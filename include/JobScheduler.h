@@ -0,0 +1,193 @@
+/*
+ * Copyright (C) 2025 - present Ondulab
+ * All rights reserved.
+ *
+ * This software is licensed under terms that can be found in the LICENSE file
+ * in the root directory of this software component.
+ */
+
+#ifndef JOBSCHEDULER_H
+#define JOBSCHEDULER_H
+
+#include <QObject>
+#include <QFuture>
+#include <QFutureInterface>
+#include <QList>
+#include <QMutex>
+#include <QWaitCondition>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <vector>
+
+class QThread;
+
+/**
+ * @brief Bounded, priority-aware scheduler for the generation jobs
+ *
+ * Jobs belong to a priority class (interactive preview, export, background
+ * warm-up). A free worker always takes the ready job of the highest class
+ * whose concurrency limit is not reached, and one worker is kept out of
+ * reach of the export and background classes, so a large export never
+ * starves the previews (unless the reservation is turned off, as in the
+ * command-line batch mode, which has no previews). A job may depend on the futures of other jobs
+ * (decode → analyze → render → encode): it only becomes ready once they
+ * are finished. A job whose future was cancelled before it started, or
+ * one of whose dependencies was cancelled, never runs: its future is
+ * reported cancelled, which cancels its own dependents in turn.
+ *
+ * Running jobs can split their work with parallelFor(). The sub-tasks go
+ * to the calling worker's own deque; idle workers steal them from the
+ * other end, and the caller runs sub-tasks itself while some are queued,
+ * so nested loops cannot deadlock the pool. It then sleeps until the
+ * last sub-task of its loop finishes.
+ */
+class JobScheduler : public QObject
+{
+    Q_OBJECT
+
+public:
+    /**
+     * @brief Priority classes, from the most to the least urgent
+     */
+    enum Priority {
+        Interactive = 0, // Previews the user is waiting for
+        Export,          // Full-resolution PNG/PDF generation
+        Background       // Cache warm-up (analyses, pyramids)
+    };
+    static const int PriorityCount = 3;
+
+    using Job = std::function<void()>;
+
+    /**
+     * @brief Gets the unique instance of the scheduler (Singleton)
+     *
+     * @return Scheduler instance
+     */
+    static JobScheduler* getInstance();
+
+    /**
+     * @brief Queues a job
+     *
+     * @param priority Priority class of the job
+     * @param job Function to execute on a worker
+     * @param dependencies Futures of scheduler jobs that must be finished first
+     *        (the job is cancelled if one of them is)
+     * @return Future finished when the job has run, or cancelled
+     */
+    QFuture<void> schedule(Priority priority, Job job,
+                           const QList<QFuture<void>>& dependencies = QList<QFuture<void>>());
+
+    /**
+     * @brief Runs body(i) for every i in [0, count) and waits for all of them
+     *
+     * @param count Number of sub-tasks
+     * @param body Sub-task function, called concurrently
+     */
+    void parallelFor(int count, const std::function<void(int)>& body);
+
+    /**
+     * @brief Parallel loop with the C signature expected by SpectralJob
+     *
+     * @param userData Scheduler instance
+     */
+    static void runParallelFor(void *userData, int count,
+                               void (*body)(void *arg, int index), void *arg);
+
+    /**
+     * @brief Sets the maximum number of jobs of a class running at once
+     *
+     * @param priority Priority class
+     * @param limit Maximum number of running jobs (at least 1)
+     */
+    void setConcurrencyLimit(Priority priority, int limit);
+
+    /**
+     * @brief Gets the maximum number of jobs of a class running at once
+     */
+    int concurrencyLimit(Priority priority) const;
+
+    /**
+     * @brief Keeps one worker for interactive jobs (the default) or not
+     *
+     * @param reserved false lets export and background jobs use every worker
+     */
+    void setInteractiveReserve(bool reserved);
+
+    /**
+     * @brief Gets the number of jobs of a class that can actually run at once
+     *
+     * The concurrency limit, capped by the workers available to the class.
+     */
+    int effectiveConcurrency(Priority priority) const;
+
+    /**
+     * @brief Gets the number of worker threads
+     */
+    int workerCount() const { return static_cast<int>(m_workers.size()); }
+
+    /**
+     * @brief Blocks until no job is queued or running
+     */
+    void waitForDone();
+
+private:
+    /**
+     * @brief Private constructor (Singleton)
+     *
+     * @param parent Parent object
+     */
+    explicit JobScheduler(QObject *parent = nullptr);
+
+    /**
+     * @brief Destructor: drops the queued jobs and joins the workers
+     */
+    ~JobScheduler();
+
+    /**
+     * @brief Structure of a queued job
+     */
+    struct PendingJob {
+        Job job;
+        QFutureInterface<void> promise;
+        QList<QFuture<void>> dependencies;
+    };
+
+    /**
+     * @brief Worker thread and its deque of sub-tasks
+     */
+    struct Worker {
+        QThread* thread = nullptr;
+        QMutex mutex;                             // Protects subtasks
+        std::deque<std::function<void()>> subtasks;
+    };
+
+    void workerLoop(int index);
+
+    /**
+     * @brief Takes the most urgent ready job allowed by the limits (m_mutex held)
+     */
+    bool takeJob(PendingJob& job, Priority& priority);
+
+    /**
+     * @brief Runs one sub-task: the newest of a deque, else the oldest of another
+     *
+     * @param index Deque to look at first
+     * @return false if every deque was empty
+     */
+    bool runSubtask(int index);
+
+    static JobScheduler* s_instance;              // Unique instance (Singleton)
+    std::vector<std::unique_ptr<Worker>> m_workers;
+    mutable QMutex m_mutex;                       // Protects everything below
+    QWaitCondition m_wakeup;                      // New job, sub-task or completion
+    std::deque<PendingJob> m_queues[PriorityCount];
+    int m_running[PriorityCount];                 // Running jobs per class
+    int m_limits[PriorityCount];                  // Concurrency limit per class
+    quint64 m_subtaskEpoch;                       // Incremented when sub-tasks are pushed
+    int m_nextWorker;                             // Round robin for external callers
+    bool m_reserveInteractive;                    // One worker kept for interactive jobs
+    bool m_stopping;
+};
+
+#endif // JOBSCHEDULER_H
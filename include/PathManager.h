@@ -70,6 +70,27 @@ public:
      * @return Resources directory
      */
     static QString getResourcesDir();
+    
+    /**
+     * @brief Gets the application cache directory, creating it if needed
+     *
+     * @param subFolder Optional sub-folder inside the cache directory
+     * @return Cache directory
+     */
+    static QString getCacheDir(const QString& subFolder = QString());
+    
+    /**
+     * @brief Gets the cache file associated with a source file
+     *
+     * The name is derived from the source path, size and modification
+     * time, so a modified source file never matches a stale cache file.
+     *
+     * @param sourcePath Path of the source file
+     * @param subFolder Sub-folder inside the cache directory
+     * @param extension Extension of the cache file
+     * @return Cache file path, or empty string if the source does not exist
+     */
+    static QString getCacheFilePath(const QString& sourcePath, const QString& subFolder, const QString& extension);
 };
 
 #endif // PATHMANAGER_H
\ No newline at end of file
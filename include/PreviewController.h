@@ -0,0 +1,171 @@
+/*
+ * Copyright (C) 2025 - present Ondulab
+ * All rights reserved.
+ *
+ * This software is licensed under terms that can be found in the LICENSE file
+ * in the root directory of this software component.
+ */
+
+#ifndef PREVIEWCONTROLLER_H
+#define PREVIEWCONTROLLER_H
+
+#include <QObject>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QQmlEngine>
+#include <QSize>
+#include <QTimer>
+#include <functional>
+
+/**
+ * @brief Latest-wins coalescing of live preview requests
+ *
+ * Dragging a slider produces a burst of preview requests. The controller
+ * keeps only the newest one and launches it once the burst has been quiet
+ * for the debounce interval. Every launch gets an increasing serial
+ * number: the launcher cancels the in-flight previews it makes obsolete,
+ * and a result is only displayed if it is newer than the one on screen,
+ * so a late stale render can never replace a fresher one.
+ *
+ * The controller lives on the GUI thread; workers hand their results back
+ * through a queued call before asking accept().
+ *
+ * Latency is measured from the last request of a burst to the moment its
+ * image is handed to the display (request → pixels), debounce included.
+ *
+ * When the viewport size is known, previews are progressive: a draft at
+ * screen resolution is displayed first, then replaced by the refined print
+ * resolution image of the same serial. The draft size follows the latency
+ * budget: it shrinks while drafts take longer than the budget and grows
+ * back to the viewport size when they are well within it.
+ */
+class PreviewController : public QObject
+{
+    Q_OBJECT
+    QML_ELEMENT
+    QML_UNCREATABLE("PreviewController is owned by SpectrogramGenerator")
+    Q_PROPERTY(int debounceInterval READ debounceInterval WRITE setDebounceInterval NOTIFY debounceIntervalChanged)
+    Q_PROPERTY(double lastLatencyMs READ lastLatencyMs NOTIFY metricsChanged)
+    Q_PROPERTY(double averageLatencyMs READ averageLatencyMs NOTIFY metricsChanged)
+    Q_PROPERTY(double maxLatencyMs READ maxLatencyMs NOTIFY metricsChanged)
+    Q_PROPERTY(int completedCount READ completedCount NOTIFY metricsChanged)
+    Q_PROPERTY(int coalescedCount READ coalescedCount NOTIFY metricsChanged)
+    Q_PROPERTY(int droppedCount READ droppedCount NOTIFY metricsChanged)
+    Q_PROPERTY(double lastRefineLatencyMs READ lastRefineLatencyMs NOTIFY metricsChanged)
+    Q_PROPERTY(QSize viewportSize READ viewportSize WRITE setViewportSize NOTIFY viewportSizeChanged)
+    Q_PROPERTY(int draftBudget READ draftBudget WRITE setDraftBudget NOTIFY draftBudgetChanged)
+    Q_PROPERTY(double draftScale READ draftScale NOTIFY metricsChanged)
+
+public:
+    /**
+     * @brief Function launching a preview for a serial number
+     */
+    using Launch = std::function<void(quint64 serial)>;
+
+    static const int DEFAULT_DEBOUNCE_MS = 120;
+    static const int DEFAULT_DRAFT_BUDGET_MS = 150;
+
+    explicit PreviewController(QObject *parent = nullptr);
+
+    /**
+     * @brief Requests a preview; replaces any request not launched yet
+     *
+     * @param launch Function starting the generation for the given serial
+     */
+    void request(Launch launch);
+
+    /**
+     * @brief Launches the pending request now, without waiting for the debounce
+     */
+    Q_INVOKABLE void flush();
+
+    /**
+     * @brief Decides whether a finished preview may be displayed (GUI thread)
+     *
+     * Records the latency of the accepted result. The refined image of the
+     * displayed draft is accepted; a draft never replaces a refined image.
+     *
+     * @param serial Serial number given to the launch function
+     * @param draft true for the screen-resolution draft of a progressive preview
+     * @return false if a newer or finer result is already displayed
+     */
+    bool accept(quint64 serial, bool draft = false);
+
+    /**
+     * @brief Indicates whether a newer preview has been launched since serial
+     *
+     * Failures and cancellations of obsolete previews are not reported.
+     */
+    bool isObsolete(quint64 serial) const { return serial < m_latestSerial; }
+
+    int debounceInterval() const { return m_debounce.interval(); }
+    void setDebounceInterval(int milliseconds);
+
+    /**
+     * @brief Size of the preview viewport in device pixels (empty = no draft)
+     */
+    QSize viewportSize() const { return m_viewportSize; }
+    void setViewportSize(const QSize &size);
+
+    /**
+     * @brief Latency budget of the drafts in milliseconds
+     */
+    int draftBudget() const { return m_draftBudget; }
+    void setDraftBudget(int milliseconds);
+
+    /**
+     * @brief Fraction of the viewport size given to the next draft
+     */
+    double draftScale() const { return m_draftScale; }
+
+    /**
+     * @brief Maximum size of the next draft (empty if drafts are disabled)
+     */
+    QSize draftSize() const;
+
+    double lastLatencyMs() const { return m_lastLatencyMs; }
+    double averageLatencyMs() const;
+    double maxLatencyMs() const { return m_maxLatencyMs; }
+    int completedCount() const { return m_completedCount; }
+    int coalescedCount() const { return m_coalescedCount; }
+    int droppedCount() const { return m_droppedCount; }
+    double lastRefineLatencyMs() const { return m_lastRefineLatencyMs; }
+
+    /**
+     * @brief Clears the latency metrics
+     */
+    Q_INVOKABLE void resetMetrics();
+
+signals:
+    void debounceIntervalChanged();
+    void viewportSizeChanged();
+    void draftBudgetChanged();
+    void metricsChanged();
+
+private slots:
+    void launchPending();
+
+private:
+    QTimer m_debounce;                      // Single shot, restarted by each request
+    QElapsedTimer m_clock;                  // Time base of the latency measurements
+    Launch m_pending;                       // Newest request not launched yet
+    qint64 m_pendingRequestTime;            // Time of the newest request (ms)
+    QHash<quint64, qint64> m_requestTimes;  // Request time of each launched serial
+    quint64 m_latestSerial;                 // Last launched serial
+    quint64 m_displayedSerial;              // Serial of the result on screen
+    bool m_displayedDraft;                  // The result on screen is a draft
+    QSize m_viewportSize;
+    int m_draftBudget;
+    double m_draftScale;
+
+    // Metrics
+    double m_lastLatencyMs;
+    double m_totalLatencyMs;
+    double m_maxLatencyMs;
+    double m_lastRefineLatencyMs;
+    int m_completedCount;
+    int m_coalescedCount;
+    int m_droppedCount;
+};
+
+#endif // PREVIEWCONTROLLER_H
@@ -11,6 +11,7 @@
 
 #include <QObject>
 #include <QQmlEngine>
+#include <QVariantMap>
 #include "spectral_generator.h"
 
 /**
@@ -64,6 +65,9 @@ class SpectrogramParametersModel : public QObject
     Q_PROPERTY(double effectiveOverlap READ effectiveOverlap NOTIFY effectiveOverlapChanged)
     Q_PROPERTY(int overlapPreset READ overlapPreset WRITE setOverlapPreset NOTIFY overlapPresetChanged)
     
+    // Sizes and estimated time of a generation with these parameters (see TaskManager::planMap)
+    Q_PROPERTY(QVariantMap generationPlan READ generationPlan NOTIFY generationPlanChanged)
+    
 public:
     explicit SpectrogramParametersModel(QObject *parent = nullptr);
     ~SpectrogramParametersModel();
@@ -79,6 +83,10 @@ public:
     Q_INVOKABLE double calculateAudioDuration();
     Q_INVOKABLE double calculateMaxBps(double writingSpeed);
     
+    // Dry run: sizes, peak memory and estimated time, without decoding the audio
+    QVariantMap generationPlan() { return planForFile(QString()); }
+    Q_INVOKABLE QVariantMap planForFile(const QString &inputFile);
+    
     // Conversion to C structure
     SpectrogramSettings toCStruct() const;
     
@@ -182,6 +190,7 @@ signals:
     void binsPerSecondChanged();
     void fftSizeChanged();
     void effectiveOverlapChanged();
+    void generationPlanChanged();
     
     // Batch update signal
     void parametersChanged();
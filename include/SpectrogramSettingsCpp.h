@@ -97,6 +97,10 @@ public:
     bool getEnableNormalization() const { return m_enableNormalization; }
     void setEnableNormalization(bool value) { m_enableNormalization = value; }
     
+    // Gain virtuel appliqué au chargement (remplace un fichier normalisé temporaire)
+    double getInputGain() const { return m_inputGain; }
+    void setInputGain(double value) { m_inputGain = value; }
+    
     // Output Format options
     bool getEnableVerticalScale() const { return m_enableVerticalScale; }
     void setEnableVerticalScale(bool value) { m_enableVerticalScale = value; }
@@ -122,6 +126,18 @@ public:
     double getLineThicknessFactor() const { return m_lineThicknessFactor; }
     void setLineThicknessFactor(double value) { m_lineThicknessFactor = value; }
     
+    // PDF : spectrogramme intégré comme image en niveaux de gris au DPI demandé
+    bool getPdfEmbedImage() const { return m_pdfEmbedImage; }
+    void setPdfEmbedImage(bool value) { m_pdfEmbedImage = value; }
+    
+    // Pagination : l'enregistrement entier sur des pages successives
+    bool getPaginate() const { return m_paginate; }
+    void setPaginate(bool value) { m_paginate = value; }
+    
+    // Moteur d'analyse : FFT (SPECTRAL_ENGINE_FFT) ou constant-Q, un bin par ligne de pixels
+    int getAnalysisEngine() const { return m_analysisEngine; }
+    void setAnalysisEngine(int value) { m_analysisEngine = value; }
+    
     // Méthodes pour bins/s
     double getBinsPerSecond() const { return m_binsPerSecond; }
     void setBinsPerSecond(double value) { m_binsPerSecond = value; }
@@ -210,6 +226,10 @@ private:
     double m_resolutionSliderValue;  // Position du curseur resolution (0=Temporal, 0.5=Balanced, 1=Spectral)
     mutable bool m_isResolutionLimited; // Indique si la limitation de résolution est atteinte
     int m_fftSize;                   // Taille FFT calculée par le curseur de résolution (0=auto)
+    double m_inputGain;              // Gain virtuel appliqué au signal chargé (1.0 = inchangé)
+    bool m_pdfEmbedImage;            // PDF : image au DPI demandé au lieu des cellules vectorielles
+    bool m_paginate;                 // Pages successives (PDF multipage ou PNG numérotés)
+    int m_analysisEngine;            // Moteur d'analyse (0=FFT, 1=constant-Q)
 };
 
 #endif // SPECTROGRAMSETTINGSCPP_H
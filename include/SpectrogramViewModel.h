@@ -13,6 +13,7 @@
 #include <QQmlEngine>
 #include <QByteArray>
 #include <QString>
+#include <QVariantMap>
 #include "SpectrogramParametersModel.h"
 #include "spectrogramgenerator.h"
 
@@ -38,6 +39,9 @@ class SpectrogramViewModel : public QObject
     // Durée audio calculée à partir du format papier et de la vitesse d'écriture
     Q_PROPERTY(double audioDuration READ audioDuration NOTIFY audioDurationChanged)
     
+    // Compteurs de la dernière génération (voir TaskManager::jobStatsMap)
+    Q_PROPERTY(QVariantMap generationStats READ generationStats NOTIFY generationStatsChanged)
+    
 public:
     explicit SpectrogramViewModel(QObject *parent = nullptr);
     ~SpectrogramViewModel();
@@ -53,6 +57,7 @@ public:
     QString statusMessage() const { return m_statusMessage; }
     bool hasPreview() const { return m_hasPreview; }
     double audioDuration() const;
+    QVariantMap generationStats() const { return m_generationStats; }
     
     // Main functions exposed to QML
     Q_INVOKABLE void generateSpectrogram(const QString &inputFile, const QString &outputFolder);
@@ -76,6 +81,7 @@ signals:
     void statusMessageChanged();
     void hasPreviewChanged();
     void audioDurationChanged();
+    void generationStatsChanged();
     
     // Result signals
     void spectrogramGenerated(bool success, const QString &outputPath, const QString &errorMessage = "");
@@ -95,8 +101,9 @@ private slots:
     void onPreviewGenerated(bool success, const QImage &previewImage, const QString &errorMessage);
     void onSegmentPreviewGenerated(bool success, const QImage &previewImage, const QString &errorMessage);
     void onPreviewSaved(bool success, const QString &outputPath, const QString &format, const QString &errorMessage);
-    void onTaskProgressUpdated(const QUuid &taskId, int progress, const QString &message);
+    void onTaskProgressUpdated(const QUuid &taskId, int progress, const QString &message, double etaSeconds);
     void onFftParametersCalculated(int calculatedFftSize, double effectiveOverlap, double binsPerSecond);
+    void onJobStatsCollected(const QVariantMap &stats);
     
 private:
     // Models
@@ -107,6 +114,7 @@ private:
     bool m_isGenerating;
     QString m_statusMessage;
     bool m_hasPreview;
+    QVariantMap m_generationStats;
     
     // Ownership flags
     bool m_ownsParametersModel;
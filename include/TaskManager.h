@@ -13,15 +13,22 @@
 #include <QMap>
 #include <QString>
 #include <QUuid>
+#include <QVariantMap>
+#include <QElapsedTimer>
 #include <QFuture>
 #include <QFutureWatcher>
+#include <QMutex>
 #include <functional>
+#include <memory>
+#include "spectral_generator.h"
+#include "JobScheduler.h"
 
 /**
  * @brief Background task manager
  *
  * This class provides a unified interface for executing tasks
- * in the background and tracking their progress.
+ * in the background and tracking their progress. Tasks run on the
+ * JobScheduler with the priority class given at submission.
  */
 class TaskManager : public QObject
 {
@@ -38,6 +45,14 @@ public:
      */
     using ProgressCallback = std::function<void(int progress, const QString& message)>;
     
+    /**
+     * @brief Task function receiving the cancellation context of its run
+     *
+     * The job is meant to be passed to the C generation API, which polls it
+     * and reports its stages through taskProgressUpdated().
+     */
+    using CancellableTask = std::function<void(SpectralJob* job, ProgressCallback progressCallback)>;
+    
     /**
      * @brief Gets the unique instance of the task manager (Singleton)
      *
@@ -50,15 +65,33 @@ public:
      *
      * @param task Function to execute
      * @param callback Callback function to call when the task is completed
-     * @param progressCallback Callback function for progress (optional)
+     * @param priority Priority class of the task
      * @return Unique task identifier
      */
     QUuid runTask(std::function<void(ProgressCallback)> task, 
-                 TaskCallback callback);
+                 TaskCallback callback,
+                 JobScheduler::Priority priority = JobScheduler::Interactive);
+    
+    /**
+     * @brief Runs a task in the background with a cancellation context
+     *
+     * @param task Function to execute; it receives the job to poll
+     * @param callback Callback function to call when the task is completed
+     * @param timeoutSeconds Deadline after which the job stops (0 = none)
+     * @param priority Priority class of the task
+     * @return Unique task identifier
+     */
+    QUuid runCancellableTask(CancellableTask task,
+                             TaskCallback callback,
+                             double timeoutSeconds = 0.0,
+                             JobScheduler::Priority priority = JobScheduler::Interactive);
     
     /**
      * @brief Cancels a running task
      *
+     * Flags the task's job so that the generation stops at its next poll
+     * point, and reports the task as cancelled immediately.
+     *
      * @param taskId Identifier of the task to cancel
      * @return true if the task was cancelled
      */
@@ -84,6 +117,114 @@ public:
      */
     int runningTaskCount() const;
     
+    /**
+     * @brief Sets the minimum interval between two progress reports of a job stage
+     *
+     * Applies to the tasks started afterwards.
+     *
+     * @param seconds Interval in seconds (<= 0 selects the default of 0.1 s)
+     */
+    void setProgressInterval(double seconds);
+    
+    /**
+     * @brief Gets the minimum interval between two progress reports of a job stage
+     *
+     * @return Interval in seconds
+     */
+    double getProgressInterval() const { return m_progressInterval; }
+    
+    /**
+     * @brief Attaches the application-wide resources to a generation context
+     *
+     * Shares the FFT plan cache, lets the parallel stages run on the
+     * JobScheduler and routes the generator messages to the Qt log. Called for every task job; other owners of a SpectralJob (strategies,
+     * print provider) call it after spectral_job_init().
+     *
+     * @param job Job to configure
+     */
+    void prepareJob(SpectralJob* job);
+    
+    /**
+     * @brief Publishes the counters of a finished generation
+     *
+     * Thread-safe; emits jobStatsCollected().
+     *
+     * @param job Finished job
+     */
+    void publishJobStats(const SpectralJob* job);
+    
+    /**
+     * @brief Converts job counters to a map for QML
+     *
+     * Keys: fftCount, bytesDecoded, peakAllocatedBytes, planCacheHits,
+     * planCacheMisses, planCacheHitRate, vectorRects, vectorFills, wallMs,
+     * cpuMs and stages, a list of maps {stage, label, wallMs, cpuMs} for
+     * the stages that ran.
+     *
+     * @param stats Counters
+     * @return Map of the counters
+     */
+    static QVariantMap jobStatsMap(const SpectralJobStats& stats);
+    
+    /**
+     * @brief Sets the budgets of the jobs prepared afterwards
+     *
+     * A generation whose plan needs more memory or time is refused before
+     * decoding (0 = no limit).
+     *
+     * @param memoryBytes Peak memory budget in bytes
+     * @param seconds Estimated time budget in seconds
+     */
+    void setBudgets(qint64 memoryBytes, double seconds);
+    
+    qint64 memoryBudget() const { return m_memoryBudget; }
+    double timeBudget() const { return m_timeBudget; }
+    
+    /**
+     * @brief Gets a copy of the cost model calibrated on this machine
+     */
+    SpectralCostModel costModel() const;
+    
+    /**
+     * @brief Plans a generation with the calibrated cost model
+     *
+     * @param settings Generation settings
+     * @param inputFile Audio file, whose length is read from its header;
+     *        empty to plan the requested duration (or one page)
+     * @param plan Receives the plan
+     * @return true if the plan could be computed
+     */
+    bool planGeneration(const SpectrogramSettings& settings, const QString& inputFile, SpectralPlan* plan) const;
+    
+    /**
+     * @brief Checks a plan against the budgets
+     *
+     * @param plan Plan of the generation
+     * @param reason Receives the refusal message (may be nullptr)
+     * @return true if the generation may run
+     */
+    bool withinBudget(const SpectralPlan& plan, QString* reason = nullptr) const;
+    
+    /**
+     * @brief Calibrates the cost model with a finished generation (thread-safe)
+     *
+     * @param settings Settings of the generation
+     * @param inputFile Audio file it decoded
+     * @param stats Counters of its job
+     */
+    void calibrateCostModel(const SpectrogramSettings& settings, const QString& inputFile,
+                            const SpectralJobStats& stats);
+    
+    /**
+     * @brief Converts a plan to a map for QML
+     *
+     * Keys: valid, sampleCount, windows, windowsPerPage, fftSize,
+     * paddedFftSize, hopSize, binMin, binMax, bins, pages, canvasWidth,
+     * canvasHeight, signalBytes, matrixBytes, kernelBytes, canvasBytes, peakBytes,
+     * estimatedSeconds and withinBudget.
+     */
+    QVariantMap planMap(const SpectralPlan& plan, bool valid) const;
+    
 signals:
     /**
      * @brief Signal emitted when a task is started
@@ -114,8 +255,21 @@ signals:
      * @param taskId Task identifier
      * @param progress Progress (0-100)
      * @param message Progress message
+     * @param etaSeconds Estimated remaining time in seconds (negative if unknown)
+     */
+    void taskProgressUpdated(const QUuid& taskId, int progress, const QString& message, double etaSeconds);
+    
+    /**
+     * @brief Signal emitted when a generation publishes its counters
+     *
+     * @param stats Counters, see jobStatsMap()
+     */
+    void jobStatsCollected(const QVariantMap& stats);
+    
+    /**
+     * @brief Signal emitted when the budgets or the cost model change
      */
-    void taskProgressUpdated(const QUuid& taskId, int progress, const QString& message);
+    void costModelChanged();
     
 private:
     /**
@@ -130,6 +284,21 @@ private:
      */
     ~TaskManager();
     
+    /**
+     * @brief Forwards the progress of a C job to the task's progress callback
+     *
+     * @param userData Progress callback of the task
+     */
+    static void forwardJobProgress(void *userData, SpectralStage stage,
+                                   double stageFraction, double overallFraction);
+    
+    /**
+     * @brief Writes a message of a C job to the Qt log, under the category
+     * "sp3ctragen.<category>" (called from the C logging thread)
+     */
+    static void forwardJobLog(void *userData, SpectralLogLevel level,
+                              const char *category, const char *message);
+    
     /**
      * @brief Structure to store task information
      */
@@ -137,10 +306,17 @@ private:
         QFutureWatcher<void>* watcher;
         TaskCallback callback;
         ProgressCallback progressCallback;
+        std::shared_ptr<SpectralJob> job; // Shared with the running thread
     };
     
     static TaskManager* s_instance; // Unique instance (Singleton)
     QMap<QUuid, TaskInfo> m_tasks; // Running tasks
+    double m_progressInterval;     // Throttling of job progress reports (seconds)
+    SpectralPlanCache* m_planCache; // FFT plans shared by all generations
+    mutable QMutex m_costMutex;     // Guards m_costModel (calibrated from the workers)
+    SpectralCostModel m_costModel;  // Time estimates of the plans
+    qint64 m_memoryBudget;          // Budgets of the jobs (0 = no limit)
+    double m_timeBudget;
 };
 
 #endif // TASKMANAGER_H
\ No newline at end of file
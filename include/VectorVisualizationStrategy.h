@@ -67,11 +67,13 @@ protected:
      * @param settings Spectrogram settings
      * @param inputFile Input audio file
      * @param outputFile Output file
-     * @return Return code (EXIT_SUCCESS or EXIT_FAILURE)
+     * @param job Cancellation context
+     * @return Return code (EXIT_SUCCESS, EXIT_FAILURE or SPECTRAL_CANCELLED)
      */
     int callGeneratorFunction(const SpectrogramSettings& settings,
                              const char* inputFile,
-                             const char* outputFile) override;
+                             const char* outputFile,
+                             SpectralJob* job) override;
                       
     int m_dpi; // Resolution in DPI for PDF generation
 };
@@ -11,6 +11,9 @@
 
 #include <QString>
 #include <QObject>
+#include <QFuture>
+#include <QList>
+#include <memory>
 #include "SpectrogramSettingsCpp.h"
 
 /**
@@ -26,7 +29,11 @@ class VisualizationStrategy : public QObject
     
 public:
     explicit VisualizationStrategy(QObject *parent = nullptr);
-    virtual ~VisualizationStrategy() = default;
+    
+    /**
+     * @brief Destructor; cancels and waits for the running generations
+     */
+    virtual ~VisualizationStrategy();
     
     /**
      * @brief Generates a visualization (Template Method)
@@ -42,6 +49,21 @@ public:
     bool generate(const SpectrogramSettingsCpp& settings,
                  const QString& inputFile,
                  const QString& outputFile);
+    
+    /**
+     * @brief Cancels the running generations of this strategy
+     *
+     * Each generation stops at its next poll point and reports
+     * generationCompleted(false, ...) without leaving an output file.
+     */
+    void cancel();
+    
+    /**
+     * @brief Indicates whether a generation of this strategy is running
+     *
+     * @return true if at least one generation is running
+     */
+    bool isRunning() const;
                          
     /**
      * @brief Gets the strategy name
@@ -74,11 +96,13 @@ protected:
      * @param settings Spectrogram settings
      * @param inputFile Input audio file
      * @param outputFile Output file
-     * @return Return code (EXIT_SUCCESS or EXIT_FAILURE)
+     * @param job Cancellation context to pass to the C API
+     * @return Return code (EXIT_SUCCESS, EXIT_FAILURE or SPECTRAL_CANCELLED)
      */
     virtual int callGeneratorFunction(const SpectrogramSettings& settings,
                                      const char* inputFile,
-                                     const char* outputFile) = 0;
+                                     const char* outputFile,
+                                     SpectralJob* job) = 0;
     
     /**
      * @brief Executes generation in a separate thread
@@ -86,10 +110,20 @@ protected:
      * @param settings Spectrogram settings
      * @param inputFile Input audio file
      * @param outputFile Output file
+     * @param job Cancellation context of this run
      */
     void runGeneration(const SpectrogramSettings& settings,
                       const QString& inputFile,
-                      const QString& outputFile);
+                      const QString& outputFile,
+                      SpectralJob* job);
+    
+    /**
+     * @brief Emits the completion signals for a C result code
+     *
+     * @param result Return code of the C API
+     * @param outputFile Output file
+     */
+    void reportResult(int result, const QString& outputFile);
     
 signals:
     /**
@@ -108,6 +142,22 @@ signals:
      * @param errorMessage Error message in case of failure
      */
     void generationCompleted(bool success, const QString& outputPath, const QString& errorMessage = "");
+    
+private:
+    /**
+     * @brief A generation started by generate()
+     */
+    struct RunningGeneration {
+        QFuture<void> future;
+        std::shared_ptr<SpectralJob> job;
+    };
+    
+    /**
+     * @brief Forgets the finished generations and prepares the job of a new one
+     */
+    RunningGeneration startGeneration();
+    
+    QList<RunningGeneration> m_running; // Generations started from the GUI thread
 };
 
 #endif // VISUALIZATIONSTRATEGY_H
\ No newline at end of file
@@ -0,0 +1,128 @@
+/*
+ * Copyright (C) 2025 - present Ondulab
+ * All rights reserved.
+ *
+ * This software is licensed under terms that can be found in the LICENSE file
+ * in the root directory of this software component.
+ */
+
+#ifndef WAVEFORMITEM_H
+#define WAVEFORMITEM_H
+
+#include <QQuickItem>
+#include <QColor>
+#include <QPointer>
+#include <QQmlEngine>
+#include <vector>
+#include "waveformprovider.h"
+
+class QSGGeometryNode;
+
+/**
+ * @brief Scene graph item drawing the waveform of a WaveformProvider
+ *
+ * The item reads the provider's min/max/RMS summaries directly into its
+ * own buffers and turns them into vertex buffers (filled envelope,
+ * contours and RMS line), so redrawing costs no JavaScript allocation.
+ * Waveform geometry is rebuilt only when the data, the size or the view
+ * window change; moving the cursor rewrites the cursor's two vertices
+ * and reuses the rest. Updates are coalesced to the display refresh by
+ * the scene graph.
+ */
+class WaveformItem : public QQuickItem
+{
+    Q_OBJECT
+    QML_ELEMENT
+    Q_PROPERTY(WaveformProvider* provider READ provider WRITE setProvider NOTIFY providerChanged)
+    Q_PROPERTY(double startRatio READ startRatio WRITE setStartRatio NOTIFY viewWindowChanged)
+    Q_PROPERTY(double endRatio READ endRatio WRITE setEndRatio NOTIFY viewWindowChanged)
+    Q_PROPERTY(QColor color READ color WRITE setColor NOTIFY colorChanged)
+    Q_PROPERTY(double cursorPosition READ cursorPosition WRITE setCursorPosition NOTIFY cursorPositionChanged)
+    Q_PROPERTY(QColor cursorColor READ cursorColor WRITE setCursorColor NOTIFY cursorColorChanged)
+    Q_PROPERTY(bool hasData READ hasData NOTIFY hasDataChanged)
+
+public:
+    explicit WaveformItem(QQuickItem *parent = nullptr);
+
+    WaveformProvider* provider() const { return m_provider; }
+    void setProvider(WaveformProvider *provider);
+
+    /**
+     * @brief View window, as fractions of the file duration
+     */
+    double startRatio() const { return m_startRatio; }
+    void setStartRatio(double ratio);
+    double endRatio() const { return m_endRatio; }
+    void setEndRatio(double ratio);
+
+    QColor color() const { return m_color; }
+    void setColor(const QColor &color);
+
+    /**
+     * @brief Cursor position, as a fraction of the item width (negative = hidden)
+     */
+    double cursorPosition() const { return m_cursorPosition; }
+    void setCursorPosition(double position);
+
+    QColor cursorColor() const { return m_cursorColor; }
+    void setCursorColor(const QColor &color);
+
+    /**
+     * @brief Indicates whether the provider has a file to display
+     */
+    bool hasData() const { return m_hasData; }
+
+signals:
+    void providerChanged();
+    void viewWindowChanged();
+    void colorChanged();
+    void cursorPositionChanged();
+    void cursorColorChanged();
+    void hasDataChanged();
+
+protected:
+    /**
+     * @brief Reads the summaries from the provider (GUI thread, before sync)
+     */
+    void updatePolish() override;
+
+    /**
+     * @brief Builds or updates the scene graph nodes (render thread, GUI blocked)
+     */
+    QSGNode *updatePaintNode(QSGNode *oldNode, UpdatePaintNodeData *data) override;
+
+#if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
+    void geometryChange(const QRectF &newGeometry, const QRectF &oldGeometry) override;
+#else
+    void geometryChanged(const QRectF &newGeometry, const QRectF &oldGeometry) override;
+#endif
+
+private slots:
+    void onWaveformChanged();
+
+private:
+    void updateWaveformGeometry(QSGGeometryNode *fill, QSGGeometryNode *upper,
+                                QSGGeometryNode *lower, QSGGeometryNode *rms);
+    void updateCursorGeometry(QSGGeometryNode *cursor);
+
+    QPointer<WaveformProvider> m_provider;
+    double m_startRatio;
+    double m_endRatio;
+    QColor m_color;
+    double m_cursorPosition;
+    QColor m_cursorColor;
+    bool m_hasData;
+
+    // Summaries of the last polish, one value per column (reused between frames)
+    std::vector<float> m_min;
+    std::vector<float> m_max;
+    std::vector<float> m_rms;
+    int m_columns;
+
+    // What changed since the last updatePaintNode()
+    bool m_waveformDirty;
+    bool m_colorDirty;
+    bool m_cursorDirty;
+};
+
+#endif // WAVEFORMITEM_H
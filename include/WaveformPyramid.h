@@ -0,0 +1,134 @@
+/*
+ * Copyright (C) 2025 - present Ondulab
+ * All rights reserved.
+ *
+ * This software is licensed under terms that can be found in the LICENSE file
+ * in the root directory of this software component.
+ */
+
+#ifndef WAVEFORMPYRAMID_H
+#define WAVEFORMPYRAMID_H
+
+#include <QString>
+#include <QtGlobal>
+#include <vector>
+
+/**
+ * @brief Mip-mapped min/max/RMS summary of an audio file
+ *
+ * Level 0 summarizes blocks of BASE_BLOCK_SIZE frames of the mono mix;
+ * each following level halves the number of blocks. Every level is
+ * stored as a structure of arrays (min, max, sum of squares) so that
+ * any window can be summarized at any width in O(width).
+ *
+ * Frames are appended incrementally, which allows a partially decoded
+ * file to be displayed while it is still loading.
+ */
+class WaveformPyramid
+{
+public:
+    /**
+     * @brief Number of frames summarized by one level 0 block
+     */
+    static constexpr int BASE_BLOCK_SIZE = 256;
+
+    /**
+     * @brief One level of the pyramid (structure of arrays)
+     */
+    struct Level {
+        std::vector<float> min;        // Minimum mono amplitude per block
+        std::vector<float> max;        // Maximum mono amplitude per block
+        std::vector<float> sumSquares; // Sum of squared mono amplitudes per block
+    };
+
+    WaveformPyramid();
+
+    /**
+     * @brief Clears the pyramid and prepares it for a new file
+     *
+     * @param channels Number of interleaved channels of the input
+     */
+    void reset(int channels);
+
+    /**
+     * @brief Appends interleaved frames to the pyramid
+     *
+     * @param interleaved Interleaved samples
+     * @param frames Number of frames
+     */
+    void appendFrames(const float *interleaved, qint64 frames);
+
+    /**
+     * @brief Flushes the trailing partial blocks once the whole file is appended
+     */
+    void finalize();
+
+    /**
+     * @brief Indicates whether the whole file has been summarized
+     */
+    bool isComplete() const { return m_complete; }
+
+    /**
+     * @brief Indicates whether the pyramid contains no block yet
+     */
+    bool isEmpty() const { return m_levels.empty() || m_levels[0].min.empty(); }
+
+    /**
+     * @brief Number of frames covered by complete level 0 blocks
+     */
+    qint64 summarizedFrames() const;
+
+    /**
+     * @brief Number of levels
+     */
+    int levelCount() const { return static_cast<int>(m_levels.size()); }
+
+    /**
+     * @brief Summarizes a frame window into width columns
+     *
+     * Each column reads the coarsest level whose blocks fit in it; while
+     * the file is loading, the frames past the last complete block of that
+     * level come from the finer levels, up to summarizedFrames().
+     *
+     * @param startFrame First frame of the window
+     * @param endFrame Frame after the last frame of the window
+     * @param width Number of columns
+     * @param minOut Output minimum per column (width values)
+     * @param maxOut Output maximum per column (width values)
+     * @param rmsOut Output RMS per column (width values)
+     */
+    void query(qint64 startFrame, qint64 endFrame, int width,
+               float *minOut, float *maxOut, float *rmsOut) const;
+
+    /**
+     * @brief Writes a complete pyramid to a sidecar file
+     *
+     * @param path Sidecar file path
+     * @return true on success
+     */
+    bool save(const QString &path) const;
+
+    /**
+     * @brief Reads a pyramid written by save()
+     *
+     * @param path Sidecar file path
+     * @return true on success
+     */
+    bool load(const QString &path);
+
+private:
+    void pushBlock(float minValue, float maxValue, float sumSquares);
+
+    std::vector<Level> m_levels;
+    int m_channels;
+    qint64 m_totalFrames;  // Frames appended so far
+    bool m_complete;
+
+    // Level 0 block being accumulated
+    float m_pendingMin;
+    float m_pendingMax;
+    float m_pendingSumSquares;
+    int m_pendingCount;
+};
+
+#endif // WAVEFORMPYRAMID_H
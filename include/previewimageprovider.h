@@ -14,6 +14,9 @@
 #include <QDebug>
 #include "SharedConstants.h"
 
+// Environment variable enabling the debug dumps of the served images
+#define PREVIEW_DEBUG_IMAGES_ENV "SP3CTRAGEN_DEBUG_IMAGES"
+
 class PreviewImageProvider : public QQuickImageProvider
 {
 public:
@@ -21,6 +24,14 @@ public:
     QImage requestImage(const QString &id, QSize *size, const QSize &requestedSize) override;
     void updateImage(const QImage &image);
     
+    // Shows a screen-resolution draft until updateImage() brings the print-resolution
+    // image; saving and printing are unavailable meanwhile. The image's dots per meter
+    // give its resolution.
+    void updateDraftImage(const QImage &image);
+    
+    // Indicates whether the displayed image is a draft still being refined
+    bool isDraft() const { return m_originalImage.isNull() && !m_displayImage.isNull(); }
+    
     // Method to retrieve the original high-resolution image
     QImage getOriginalImage() const { return m_originalImage; }
     
@@ -31,16 +42,18 @@ public:
     Q_INVOKABLE bool printImage() const;
     
     // Methods to get image dimensions and resolution information
-    Q_INVOKABLE int getImageWidth() const { return m_originalImage.width(); }
-    Q_INVOKABLE int getImageHeight() const { return m_originalImage.height(); }
-    Q_INVOKABLE double getImageDPI() const { return PRINTER_DPI; }
+    Q_INVOKABLE int getImageWidth() const { return isDraft() ? m_displayImage.width() : m_originalImage.width(); }
+    Q_INVOKABLE int getImageHeight() const { return isDraft() ? m_displayImage.height() : m_originalImage.height(); }
+    Q_INVOKABLE double getImageDPI() const {
+        return isDraft() ? m_displayImage.dotsPerMeterX() * 0.0254 : PRINTER_DPI;
+    }
     
     // Get physical dimensions in millimeters
     Q_INVOKABLE double getImageWidthMM() const { 
-        return m_originalImage.width() / (PRINTER_DPI / 25.4); 
+        return getImageWidth() / (getImageDPI() / 25.4); 
     }
     Q_INVOKABLE double getImageHeightMM() const { 
-        return m_originalImage.height() / (PRINTER_DPI / 25.4); 
+        return getImageHeight() / (getImageDPI() / 25.4); 
     }
     
     // Get physical dimensions in centimeters
@@ -51,6 +64,11 @@ public:
         return getImageHeightMM() / 10.0; 
     }
     
+    // Writes every served image to /tmp (preview_debug.png, preview_scaled_debug.png).
+    // Off unless enabled here or by the PREVIEW_DEBUG_IMAGES_ENV environment variable.
+    static void setDebugImageDumps(bool enabled) { s_debugImageDumps = enabled; }
+    static bool debugImageDumps() { return s_debugImageDumps; }
+    
     // Debug method to check the image state
     void debugImageState() {
         qDebug() << "PreviewImageProvider::debugImageState";
@@ -64,6 +82,8 @@ public:
 private:
     QImage m_displayImage;  // Resized version for display
     QImage m_originalImage; // Original high-resolution image
+    
+    static bool s_debugImageDumps;
 };
 
 #endif // PREVIEWIMAGEPROVIDER_H
@@ -9,6 +9,8 @@
 #ifndef SPECTROGRAM_CONFIG_H
 #define SPECTROGRAM_CONFIG_H
 
+#include <stddef.h>
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -45,18 +47,297 @@ typedef struct SpectrogramSettings
     double  lineThicknessFactor;          // Scale factor for line thickness (default = 1.0)
     double  binsPerSecond;                // Bins per second (default = 150.0)
     int     overlapPreset;                // Overlap preset (0 = Low, 1 = Medium, 2 = High)
+    double  inputGain;                    // Virtual gain applied on load (0 or 1.0 = unchanged)
+    int     pdfEmbedImage;                // PDF: 0 = vector cells, 1 = 8-bit image at the requested DPI
+    int     paginate;                     // 0 = first page only, 1 = whole recording on consecutive pages
+    int     analysisEngine;               // SPECTRAL_ENGINE_FFT or SPECTRAL_ENGINE_CONSTANT_Q
 } SpectrogramSettings;
 
+// Analysis engines of SpectrogramSettings::analysisEngine
+#define SPECTRAL_ENGINE_FFT        0      // Zero-padded, multi-resolution FFT
+#define SPECTRAL_ENGINE_CONSTANT_Q 1      // Constant-Q transform, one bin per pixel row
+
+// Return code of the generation functions when the job was cancelled
+// or its deadline has passed (no output file is left behind)
+#define SPECTRAL_CANCELLED (-1)
+
+// Default minimum delay between two progress reports of a stage (seconds)
+#define SPECTRAL_DEFAULT_PROGRESS_INTERVAL 0.1
+
+// Seed of the dithering noise of a new job
+#define SPECTRAL_DEFAULT_SEED 1ULL
+
+// Stages reported by the progress callback, in execution order
+typedef enum SpectralStage
+{
+    SPECTRAL_STAGE_DECODE = 0,            // Loading and decoding the audio
+    SPECTRAL_STAGE_FILTER,                // High-pass filter and high boost
+    SPECTRAL_STAGE_FFT,                   // Short-time Fourier transform
+    SPECTRAL_STAGE_TONE_MAP,              // Dynamic range, gamma, dithering, contrast
+    SPECTRAL_STAGE_RASTER,                // Drawing the spectrogram columns
+    SPECTRAL_STAGE_ENCODE,                // Writing the PNG or PDF file
+    SPECTRAL_STAGE_COUNT
+} SpectralStage;
+
+// Counters of one generation, updated while it runs; read them once the
+// call that used the job has returned. Stage times add up the successive
+// runs of a stage (one per page for the renders).
+typedef struct SpectralJobStats
+{
+    long long fftCount;                             // FFTs executed
+    long long bytesDecoded;                         // Decoded signal, in bytes
+    long long allocatedBytes;                       // Held through the job's allocator now
+    long long peakAllocatedBytes;                   // High-water mark of allocatedBytes
+    long long planCacheHits;                        // FFT plans found in the plan cache
+    long long planCacheMisses;                      // FFT plans created
+    long long vectorRects;                          // Rectangles of the vector PDF cells
+    long long vectorFills;                          // Fills of the vector PDF cells
+    long long stageWallUs[SPECTRAL_STAGE_COUNT];    // Wall time of each stage (microseconds)
+    long long stageCpuUs[SPECTRAL_STAGE_COUNT];     // CPU time of each stage, all threads
+} SpectralJobStats;
+
+// Cost of the work units of each stage on this machine, in seconds per unit
+// (see SpectralPlan::stageWork), calibrated from finished generations
+typedef struct SpectralCostModel
+{
+    double secondsPerUnit[SPECTRAL_STAGE_COUNT];
+    int    observations;                            // Generations folded into the model
+} SpectralCostModel;
+
+// Sizes of a generation, computed from the settings and the length of the
+// recording without decoding it (spectral_plan()). The page layout comes
+// first: it decides the windows drawn, hence the samples decoded (from the
+// start of the recording) and the bins kept. The canvas is that of the PNG
+// render; the PDF render draws vectors instead.
+typedef struct SpectralPlan
+{
+    double    binsPerSecond;
+    int       sampleRate;                           // Sample rate of the recording
+    int       sampleCount;                          // Decoded samples: those of the drawn windows, then contextSamples
+    int       contextSamples;                       // Read past the last window by the long windows centered on it
+    int       fftSize;                              // Window length, in samples
+    int       paddedFftSize;                        // Transform of the stored bins, after zero padding (constant-Q: run per hop)
+    int       hopSize;                              // Samples between two windows
+    int       windows;                              // Columns of the spectrogram
+    int       windowsPerPage;                       // Columns of a page (0 = no writing speed)
+    int       binMin;                               // Drawn bins [binMin, binMax]
+    int       binMax;
+    int       bins;                                 // Rows of the matrix (binMax + 1)
+    int       pages;                                // Pages of the output
+    int       canvasWidth;                          // Page surface, in pixels
+    int       canvasHeight;
+    long long signalBytes;                          // Decoded signal
+    long long matrixBytes;                          // Spectrogram matrix (one page when paginated)
+    long long kernelBytes;                          // Constant-Q kernels, alive during the analysis (0 = FFT)
+    long long canvasBytes;                          // Page surfaces alive at once
+    long long peakBytes;                            // Estimated high-water mark
+    double    stageWork[SPECTRAL_STAGE_COUNT];      // Work units of each stage
+    double    stageSeconds[SPECTRAL_STAGE_COUNT];   // Estimated time of each stage
+    double    estimatedSeconds;                     // Sum of stageSeconds
+} SpectralPlan;
+
+// Progress callback, called from the generating thread.
+// stageFraction and overallFraction are in [0, 1].
+typedef void (*SpectralProgressCallback)(void *userData, SpectralStage stage,
+                                         double stageFraction, double overallFraction);
+
+// Severity of the messages written by the generator
+typedef enum SpectralLogLevel
+{
+    SPECTRAL_LOG_DEBUG = 0,
+    SPECTRAL_LOG_INFO,
+    SPECTRAL_LOG_WARNING,
+    SPECTRAL_LOG_ERROR
+} SpectralLogLevel;
+
+// Log callback, called from the logging thread with one complete message
+// (without its trailing newline) and the category of the module that wrote it
+// ("audio", "fft", "raster"...)
+typedef void (*SpectralLogCallback)(void *userData, SpectralLogLevel level,
+                                    const char *category, const char *message);
+
+// Allocator of the large per-generation buffers (spectrogram matrix, lookup tables)
+typedef struct SpectralAllocator
+{
+    void *(*allocate)(void *userData, size_t size);
+    void  (*release)(void *userData, void *ptr);
+    void   *userData;
+} SpectralAllocator;
+
+// Cache of FFT plans that concurrent generations can share (opaque, thread-safe)
+typedef struct SpectralPlanCache SpectralPlanCache;
+
+// Parallel loop provided by the caller's scheduler: runs body(arg, i) for
+// every i in [0, count), possibly concurrently, and returns when all are done
+typedef void (*SpectralParallelFor)(void *userData, int count,
+                                    void (*body)(void *arg, int index), void *arg);
+
+// Context of one generation, shared between the caller and the generating
+// thread: cancellation, progress, dithering seed, logger, allocator and plan
+// cache. The generator keeps no other mutable state, so generations with
+// distinct jobs can run concurrently, and the same seed gives the same output.
+// The generator polls the job between blocks of FFT windows and render bands;
+// any thread may cancel it. A NULL job never stops, reports nothing and uses
+// the defaults.
+typedef struct SpectralJob
+{
+    int     cancelRequested;              // Set by spectral_job_cancel() (atomic accesses only)
+    double  deadline;                     // Monotonic time in seconds, 0 = no deadline
+    SpectralProgressCallback progress;    // Optional progress callback
+    void   *progressUserData;             // Passed back to the callback
+    double  progressInterval;             // Minimum seconds between two reports of a stage
+    double  lastProgressTime;             // Time of the last report (generating thread only)
+    int     lastProgressStage;            // Stage of the last report, -1 before the first one
+    double  lastProgressOverall;          // Overall fraction of the last report; later ones never go below
+    int     progressFirstStage;           // Stages [first, last] reported over the overall
+    int     progressLastStage;            //   fractions [progressStart, progressEnd]: the whole
+    double  progressStart;                //   generation, or one pass of a progressive one
+    double  progressEnd;
+    unsigned long long seed;              // Seed of the dithering noise
+    SpectralLogCallback log;              // Optional log callback, NULL = stdout/stderr
+    void   *logUserData;                  // Passed back to the log callback
+    SpectralAllocator allocator;          // malloc/free unless replaced
+    SpectralPlanCache *planCache;         // Optional shared plan cache (not owned)
+    SpectralParallelFor parallelFor;      // Optional parallel loop, NULL = serial
+    void   *parallelUserData;             // Passed back to the parallel loop
+    int     reporting;                    // Serializes reports from parallel stages (atomic accesses only)
+    SpectralJobStats stats;               // Counters, reset by spectral_job_init()
+    long long memoryBudget;               // Refuse plans above this peak (bytes), 0 = none
+    double  timeBudget;                   // Refuse plans above this estimate (seconds), 0 = none
+    SpectralCostModel costModel;          // Estimates of the budget check
+} SpectralJob;
+
+// Initializes a job; timeoutSeconds <= 0 means no deadline
+void spectral_job_init(SpectralJob *job, double timeoutSeconds);
+
+// Installs a progress callback, throttled to one report per intervalSeconds
+// (<= 0 selects the default of 0.1 s); stage changes and completions are
+// always reported
+void spectral_job_set_progress(SpectralJob *job, SpectralProgressCallback callback,
+                               void *userData, double intervalSeconds);
+
+// Reports the progress of a stage (no-op for a NULL job or without callback)
+void spectral_job_report(SpectralJob *job, SpectralStage stage, double stageFraction);
+
+// Returns a short display name for a stage
+const char *spectral_stage_name(SpectralStage stage);
+
+// Sets the seed of the dithering noise
+void spectral_job_set_seed(SpectralJob *job, unsigned long long seed);
+
+// Routes the generator messages to a callback (NULL restores stdout/stderr).
+// Messages are queued and delivered by a background thread: the callback and
+// userData must remain valid until spectral_log_flush() returns.
+void spectral_job_set_logger(SpectralJob *job, SpectralLogCallback callback, void *userData);
+
+// Drops the messages below level at run time (default SPECTRAL_LOG_DEBUG).
+// Levels below SPECTRAL_LOG_MIN_LEVEL are removed at compile time.
+void spectral_log_set_level(SpectralLogLevel level);
+
+// Waits until every queued message has been delivered
+void spectral_log_flush(void);
+
+// Adds the counters of other to stats (e.g. the analysis shared by a render);
+// the peaks add up, both jobs' buffers being alive at the same time
+void spectral_job_stats_add(SpectralJobStats *stats, const SpectralJobStats *other);
+
+// Writes a one-line summary of the counters, as appended to the parameters
+// text. Returns the length snprintf() would have written.
+int spectral_job_stats_format(const SpectralJobStats *stats, char *buffer, size_t size);
+
+// Initializes a cost model with conservative defaults
+void spectral_cost_model_init(SpectralCostModel *model);
+
+// Folds the stage times of a finished generation into the model, as seconds
+// per work unit of its plan
+void spectral_cost_model_update(SpectralCostModel *model, const SpectralPlan *plan,
+                                const SpectralJobStats *stats);
+
+// Computes the sizes and estimated time of a generation without touching
+// the audio. audioSeconds and audioSampleRate describe the recording
+// (<= 0: unknown, the requested duration or one page, and cfg->sampleRate
+// are used);
+// a NULL model leaves the time estimates at 0. Returns EXIT_SUCCESS, or
+// EXIT_FAILURE if the length is unknown or too short for one window.
+int spectral_plan(const SpectrogramSettings *cfg, double audioSeconds, int audioSampleRate,
+                  const SpectralCostModel *model, SpectralPlan *plan);
+
+// Same as spectral_plan() for an audio file, whose length is read from its header
+int spectral_plan_file(const SpectrogramSettings *cfg, const char *inputFile,
+                       const SpectralCostModel *model, SpectralPlan *plan);
+
+// Returns 1 if the plan fits the budgets (0 = no limit)
+int spectral_plan_within_budget(const SpectralPlan *plan, long long memoryBudget, double timeBudget);
+
+// Makes the generations of the job refuse, before decoding, the files whose
+// plan exceeds the budgets (0 = no limit). The model is copied; NULL selects
+// the defaults.
+void spectral_job_set_budget(SpectralJob *job, long long memoryBudget, double timeBudget,
+                             const SpectralCostModel *model);
+
+// Replaces the buffer allocator (NULL restores malloc/free)
+void spectral_job_set_allocator(SpectralJob *job, const SpectralAllocator *allocator);
+
+// Shares a plan cache with the job; the cache must outlive the generation
+void spectral_job_set_plan_cache(SpectralJob *job, SpectralPlanCache *cache);
+
+// Lets the FFT and tone-mapping stages split their blocks over a scheduler
+void spectral_job_set_parallel_for(SpectralJob *job, SpectralParallelFor parallelFor,
+                                   void *userData);
+
+// Creates an empty plan cache
+SpectralPlanCache *spectral_plan_cache_create(void);
+
+// Destroys a plan cache and its plans (no generation may still use it)
+void spectral_plan_cache_destroy(SpectralPlanCache *cache);
+
+// Size of a buffer holding any page file name
+#define SPECTRAL_PATH_MAX 4096
+
+// Writes the path of page `page` (1-based) of a paginated output into buffer:
+// "dir/name.png" becomes "dir/name_001.png". Returns 0, or -1 if it does not fit.
+int spectral_page_file_name(const char *outputFile, int page, char *buffer, size_t size);
+
+// Environment variable naming the trace file written by the applications
+#define SPECTRAL_TRACE_ENV "SP3CTRAGEN_TRACE"
+
+// Timeline tracing. While a trace is recorded, the stages, FFT blocks,
+// decoded ranges and pages of every generation are recorded as events in a
+// per-thread buffer, without locks. Start and stop when no generation runs.
+void spectral_trace_start(void);
+
+// Stops recording and writes the events as a Chrome trace JSON file
+// (chrome://tracing, Perfetto); a NULL path discards them. Returns 0 or -1.
+int spectral_trace_stop(const char *path);
+
+// Timestamp of an event start, 0 when no trace is recorded
+double spectral_trace_begin(void);
+
+// Records an event started at begin (name must be a static string);
+// bytes and count (FFTs, pages...) are left out of the trace when 0
+void spectral_trace_end(const SpectralJob *job, const char *name, double begin,
+                        long long bytes, long long count);
+
+// Requests cancellation (thread-safe)
+void spectral_job_cancel(SpectralJob *job);
+
+// Returns 1 if the job was cancelled or its deadline has passed
+int spectral_job_should_stop(const SpectralJob *job);
+
 // C function we want to call from C++
 int spectral_generator(const SpectrogramSettings *cfg,
                        const char *inputFile,
-                       const char *outputFile);
+                       const char *outputFile,
+                       SpectralJob *job);
 
-// C function for vector PDF generation with custom DPI
+// C function for vector PDF generation with custom DPI. With cfg->pdfEmbedImage
+// the spectrogram area is embedded as a grayscale image at exactly dpi, the
+// axes, labels and reference lines stay vector.
 int spectral_generator_vector_pdf(const SpectrogramSettings *cfg,
                                  const char *inputFile,
                                  const char *outputFile,
-                                 int dpi);
+                                 int dpi,
+                                 SpectralJob *job);
 
 // C function with additional metadata for parameters display
 int spectral_generator_with_metadata(const SpectrogramSettings *cfg,
@@ -64,7 +345,76 @@ int spectral_generator_with_metadata(const SpectrogramSettings *cfg,
                                    const char *outputFile,
                                    const char *audioFileName,
                                    double startTime,
-                                   double segmentDuration);
+                                   double segmentDuration,
+                                   SpectralJob *job);
+
+// Immutable result of decoding, filtering and analyzing an audio file for
+// one page layout (opaque). Renders only read it, so the PNG and the PDF of
+// that layout may share one analysis and run concurrently; another page
+// format or pagination needs its own analysis.
+typedef struct SpectralAnalysis SpectralAnalysis;
+
+// Decodes, filters and analyzes inputFile once with the settings of cfg.
+// Only what the page layout of cfg draws is analyzed (spectral_plan()): the
+// windows of the first page when it follows the writing speed, unless
+// cfg->paginate asks for the whole recording, and the bins up to maxFreq.
+// A paginated analysis keeps the filtered signal and the global maximum
+// only: its renders analyze and tone-map one page at a time.
+// *analysis is set on EXIT_SUCCESS only; the allocator of the job must
+// outlive the analysis.
+int spectral_analyze(const SpectrogramSettings *cfg,
+                     const char *inputFile,
+                     SpectralAnalysis **analysis,
+                     SpectralJob *job);
+
+// Frees an analysis (no render may still use it)
+void spectral_analysis_free(SpectralAnalysis *analysis);
+
+// Renders an analysis as a PNG at print resolution. Only the overlay
+// settings of cfg are used (margins, height, scale, reference lines,
+// parameters text, PDF image mode); a NULL cfg keeps those of the analysis.
+// The page format and the pagination always are those of the analysis,
+// since they decided the windows analyzed: a render asking for others is
+// logged and drawn with those of the analysis. With pagination (and a writing speed), every
+// page width of the recording is written to a numbered PNG, named by
+// spectral_page_file_name(), and outputFile itself is not created.
+int spectral_render_png(const SpectralAnalysis *analysis,
+                        const SpectrogramSettings *cfg,
+                        const char *outputFile,
+                        SpectralJob *job);
+
+// Renders an analysis as a vector PDF (cfg as for spectral_render_png()).
+// When the analysis is paginated the PDF has one page per page width of the
+// recording. Cells of close intensities are merged: an analysis without
+// dithering, whose noise keeps them apart, gives the smallest file.
+int spectral_render_vector_pdf(const SpectralAnalysis *analysis,
+                               const SpectrogramSettings *cfg,
+                               const char *outputFile,
+                               int dpi,
+                               SpectralJob *job);
+
+// Receives the draft of a progressive preview: ARGB32 premultiplied pixels in
+// native byte order (QImage::Format_ARGB32_Premultiplied), valid during the
+// call only; dpi is the print resolution scaled to the draft
+typedef void (*SpectralDraftCallback)(void *userData, const unsigned char *pixels,
+                                      int width, int height, int stride, double dpi);
+
+// Progressive preview: decodes and filters the audio once, hands a draft that
+// fits in draftWidth x draftHeight pixels to draftCallback (shorter zero
+// padding, windows pooled into pixel columns), then refines the same signal at
+// print resolution into outputFile, with the metadata of
+// spectral_generator_with_metadata(). Cancelling the job after the draft stops
+// the refinement. A zero draft size skips the draft.
+int spectral_generator_progressive(const SpectrogramSettings *cfg,
+                                   const char *inputFile,
+                                   const char *outputFile,
+                                   const char *audioFileName,
+                                   double startTime,
+                                   int draftWidth,
+                                   int draftHeight,
+                                   SpectralDraftCallback draftCallback,
+                                   void *draftUserData,
+                                   SpectralJob *job);
 
 #ifdef __cplusplus
 }
@@ -20,6 +20,7 @@
 #include <QDir>
 #include <QFileInfo>
 #include "SpectrogramSettingsCpp.h"
+#include "PreviewController.h"
 
 // Forward declarations
 class PreviewImageProvider;
@@ -36,6 +37,9 @@ class SpectrogramGenerator : public QObject
 {
     Q_OBJECT
     QML_ELEMENT
+    
+    // Coalescing of live previews and its latency metrics
+    Q_PROPERTY(PreviewController* previewController READ previewController CONSTANT)
 
 public:
     explicit SpectrogramGenerator(QObject *parent = nullptr);
@@ -47,6 +51,11 @@ public:
      * @param provider Pointer to the image provider
      */
     static void setPreviewImageProvider(PreviewImageProvider *provider);
+    
+    /**
+     * @brief Gets the controller that coalesces the preview requests
+     */
+    PreviewController* previewController() const { return m_previewController; }
 
     /**
      * @brief Generates a spectrogram
@@ -315,6 +324,9 @@ public:
    /**
     * @brief Normalizes an audio file and saves the result to a temporary file
     *
+    * Kept for compatibility: the interface now uses setInputGain() and
+    * WaveformProvider::setGain() instead of rewriting the file.
+    *
     * @param inputPath Path to the original audio file
     * @param factor Normalization factor to apply (1.0 = no change)
     * @return Path to the normalized temporary file, or empty string if failed
@@ -324,15 +336,55 @@ public:
    /**
     * @brief Calculates the normalization factor for an audio file
     *
+    * Never decodes the file on the calling (GUI) thread: until the
+    * background peak analysis lands, returns 0.0 and
+    * normalizationFactorReady() follows.
+    *
     * @param audioPath Path to the audio file
-    * @return Recommended normalization factor (0.95/maxAmplitude)
+    * @return Recommended normalization factor (0.95/maxAmplitude), 0.0 while pending
     */
    Q_INVOKABLE double calculateNormalizationFactor(const QString &audioPath);
    
+   /**
+    * @brief Writes a gain-adjusted copy of an audio file for playback, in background
+    *
+    * The player cannot amplify (its volume stops at 1.0), so a gain above
+    * 1.0 is heard through this copy. normalizedAudioReady() follows.
+    *
+    * @param inputPath Path to the original audio file
+    * @param factor Gain to apply
+    */
+   Q_INVOKABLE void requestNormalizedAudio(const QString &inputPath, double factor);
+   
+   /**
+    * @brief Sets the virtual gain applied to the audio loaded from a file
+    *
+    * Replaces the normalized temporary copy: the gain is applied by the
+    * generation pipeline while the file is read.
+    *
+    * @param gain Gain to apply (1.0 = no change)
+    */
+   Q_INVOKABLE void setInputGain(double gain);
+   
+   /**
+    * @brief Gets the virtual gain applied to the audio loaded from a file
+    *
+    * @return Current gain (1.0 = no change)
+    */
+   Q_INVOKABLE double getInputGain() const;
+   
     /**
      * @brief Cleans up temporary files created during normalization
      */
    Q_INVOKABLE void cleanup();
+   
+   /**
+    * @brief Cancels the preview generations still running
+    *
+    * The C generation stops at its next poll point; each cancelled task
+    * reports previewGenerated/segmentPreviewGenerated(false, ...).
+    */
+   Q_INVOKABLE void cancelPreviews();
     
     /**
      * @brief Gets the width of the current preview image in pixels
@@ -401,6 +453,15 @@ signals:
      */
     void segmentPreviewGenerated(bool success, const QImage &previewImage, const QString &errorMessage = "");
     
+    /**
+     * @brief Signal emitted when the screen-resolution draft of a preview is displayed
+     *
+     * The refined preview follows with previewGenerated or segmentPreviewGenerated.
+     *
+     * @param segment true for a segment preview, false for a file preview
+     */
+    void previewDraftGenerated(bool segment);
+    
     /**
      * @brief Signal emitted when a preview is saved
      *
@@ -411,14 +472,32 @@ signals:
      */
     void previewSaved(bool success, const QString &outputPath, const QString &format, const QString &errorMessage = "");
     
+    /**
+     * @brief Signal emitted when the normalization factor of a file is known
+     *
+     * @param audioPath Path to the audio file
+     * @param factor Normalization factor (1.0 if the file could not be analyzed)
+     */
+    void normalizationFactorReady(const QString &audioPath, double factor);
+    
+    /**
+     * @brief Signal emitted when the playback copy of requestNormalizedAudio() is written
+     *
+     * @param inputPath Path to the original audio file
+     * @param factor Gain applied
+     * @param outputPath Path to the copy, empty on failure
+     */
+    void normalizedAudioReady(const QString &inputPath, double factor, const QString &outputPath);
+    
     /**
      * @brief Signal emitted when task progress is updated
      *
      * @param taskId Task identifier
      * @param progress Progress (0-100)
      * @param message Progress message
+     * @param etaSeconds Estimated remaining time in seconds (negative if unknown)
      */
-    void taskProgressUpdated(const QUuid &taskId, int progress, const QString &message);
+    void taskProgressUpdated(const QUuid &taskId, int progress, const QString &message, double etaSeconds);
 
 private:
     /**
@@ -497,16 +576,77 @@ private:
      *
      * @param settings Spectrogram settings
      * @param audioSegment Audio segment
+     * @param serial Serial number given by the preview controller
+     * @param draftSize Maximum size of the draft (empty = no draft)
      * @param originalAudioFileName Original audio file name for display (optional)
      * @param startTime Start time in seconds for display (optional)
+     * @param job Cancellation context of the task (optional)
      */
     void runSegmentPreviewGeneration(
         const SpectrogramSettings &settings,
         const QByteArray &audioSegment,
+        quint64 serial,
+        const QSize &draftSize,
         const QString &originalAudioFileName = "",
-        double startTime = 0.0
+        double startTime = 0.0,
+        SpectralJob *job = nullptr
     );
     
+    /**
+     * @brief Renders a preview into imageFile, progressively if a draft size is given
+     *
+     * The draft is published as soon as it is rendered; the refined image is
+     * left in imageFile.
+     *
+     * @param serial Serial number given by the preview controller
+     * @param segment true for a segment preview, false for a file preview
+     * @param draftSize Maximum size of the draft (empty = no draft)
+     * @return Result code of the C generator
+     */
+    int renderPreview(const SpectrogramSettings &settings,
+                      const char *audioFile,
+                      const char *imageFile,
+                      const QString &audioFileName,
+                      double startTime,
+                      quint64 serial,
+                      bool segment,
+                      const QSize &draftSize,
+                      SpectralJob *job);
+    
+    /**
+     * @brief Receives the draft of a progressive preview (SpectralDraftCallback)
+     *
+     * @param userData DraftTarget of the preview
+     */
+    static void forwardDraft(void *userData, const unsigned char *pixels,
+                             int width, int height, int stride, double dpi);
+    
+    /**
+     * @brief Destination of the draft of a progressive preview
+     */
+    struct DraftTarget {
+        SpectrogramGenerator *generator;
+        quint64 serial;
+        bool segment;
+    };
+    
+    /**
+     * @brief Hands a preview result over to the GUI thread
+     *
+     * The image is displayed only if the preview controller accepts it;
+     * failures of obsolete previews are dropped.
+     *
+     * @param serial Serial number given by the preview controller
+     * @param segment true for a segment preview, false for a file preview
+     * @param success Generation success
+     * @param previewImage Preview image
+     * @param errorMessage Error message in case of failure
+     * @param draft true for the screen-resolution draft of a progressive preview
+     */
+    void publishPreview(quint64 serial, bool segment, bool success,
+                        const QImage &previewImage, const QString &errorMessage = "",
+                        bool draft = false);
+    
     // Preview image
     QImage m_previewImage;
     
@@ -518,6 +658,12 @@ private:
     
     // List of temporary files to be cleaned up
     QStringList m_tempFiles;
+    
+    // Virtual gain applied to file inputs (1.0 = no change)
+    double m_inputGain;
+    
+    // Latest-wins coalescing of the preview requests
+    PreviewController *m_previewController;
 };
 
 #endif // SPECTROGRAMGENERATOR_H
@@ -13,6 +13,8 @@
 #include <QString>
 #include <QUrl>
 #include <QQmlEngine>
+#include <QFuture>
+#include <memory>
 #include "spectral_generator.h"
 #include "SharedConstants.h"
 
@@ -67,6 +69,11 @@ public:
      * @param inputFile Input audio file
      * @param outputFolder Output folder
      * @param dpi Resolution in DPI (default 800)
+     * @param embedImage Embeds the spectrogram as an 8-bit grayscale image at
+     *        exactly dpi (axes and labels stay vector); the file size then
+     *        depends on the page and the DPI only, not on the bins/s
+     * @param paginate Lays the whole recording out on consecutive pages at
+     *        the writing speed instead of the first page only
      */
     Q_INVOKABLE void generateVectorPDF(
         double minFreq,
@@ -90,9 +97,19 @@ public:
         int overlapPreset,
         const QString &inputFile,
         const QString &outputFolder,
-        int dpi = PRINTER_DPI
+        int dpi = PRINTER_DPI,
+        bool embedImage = false,
+        bool paginate = false
     );
 
+    /**
+     * @brief Cancels the running PDF generation, if any
+     *
+     * The generation stops at its next poll point, removes the partial
+     * file and emits vectorPDFGenerated(false, ...).
+     */
+    Q_INVOKABLE void cancel();
+
 signals:
     /**
      * @brief Signal emitted when the vector PDF is generated
@@ -111,13 +128,18 @@ private:
      * @param inputFile Input audio file
      * @param outputFile Output PDF file
      * @param dpi Resolution in DPI
+     * @param job Cancellation context of this run
      */
     void runVectorGeneration(
         const SpectrogramSettings &settings,
         const QString &inputFile,
         const QString &outputFile,
-        int dpi
+        int dpi,
+        SpectralJob *job
     );
+
+    QFuture<void> m_future;             // Running generation
+    std::shared_ptr<SpectralJob> m_job; // Cancellation context of the running generation
 };
 
 #endif // VECTORPRINTPROVIDER_H
@@ -15,8 +15,12 @@
 #include <QVariantMap>
 #include <QByteArray>
 #include <QQmlEngine>
+#include <QFuture>
+#include <QMutex>
+#include <atomic>
 #include <vector>
 #include <sndfile.h>
+#include "WaveformPyramid.h"
 
 class WaveformProvider : public QObject
 {
@@ -27,12 +31,24 @@ public:
     explicit WaveformProvider(QObject *parent = nullptr);
     virtual ~WaveformProvider();
     
-    // Loads a WAV file and extracts data
+    // Opens an audio file and decodes its waveform in background.
+    // fileLoaded is emitted as soon as the file is open; the waveform then
+    // fills in progressively, as reported by loadProgress.
     Q_INVOKABLE bool loadFile(const QString &filePath);
     
+    // Returns the fraction of the file already decoded for display (0.0 to 1.0)
+    Q_INVOKABLE double getLoadProgress() const;
+    
+    // Indicates whether the whole waveform has been decoded
+    Q_INVOKABLE bool isFullyLoaded() const;
+    
     // Returns data for waveform display
     Q_INVOKABLE QVariantList getWaveformData(int width);
     
+    // Returns packed float data for waveform display: width minimums, then width
+    // maximums, then width RMS values, for the window [startRatio, endRatio] of the file
+    Q_INVOKABLE QByteArray getWaveformDataPacked(int width, double startRatio = 0.0, double endRatio = 1.0);
+    
     // Calculates the segment to extract based on parameters
     Q_INVOKABLE QVariantMap calculateExtractionSegment(
         double cursorPosition,
@@ -55,21 +71,48 @@ public:
     
     // Returns the current audio file path
     Q_INVOKABLE QString getFilePath() const;
+    
+    // Sets the virtual gain applied to display data and extracted segments (1.0 = none)
+    Q_INVOKABLE void setGain(double gain);
+    
+    // Returns the virtual gain applied to display data and extracted segments
+    Q_INVOKABLE double getGain() const;
+    
+    // Summarizes the window [startRatio, endRatio] of the file into width columns
+    // (gain applied). Used by WaveformItem to fill its vertex buffer without going
+    // through QML values.
+    bool summarizeWindow(double startRatio, double endRatio, int width,
+                         float *minOut, float *maxOut, float *rmsOut);
 
 signals:
     void fileLoaded(bool success, double durationSeconds, int sampleRate);
+    void loadProgress(double progress);
+    
+    // Emitted whenever the displayed waveform changes (file, decoded chunk or gain)
+    void waveformChanged();
 
 private:
     // Audio file data
     SF_INFO m_fileInfo;
     SNDFILE* m_file;
-    std::vector<float> m_audioData;
+    WaveformPyramid m_pyramid;
+    mutable QMutex m_pyramidMutex;       // Protects m_pyramid while it is being built
     QString m_filePath;
     bool m_fileLoaded;
+    double m_gain;
+    
+    // Background decoding state
+    QFuture<void> m_loadFuture;
+    std::atomic<bool> m_cancelLoad;
+    std::atomic<double> m_loadProgress;
+    std::atomic<quint64> m_loadSerial;   // Current load; reports of older loads are dropped
     
     // Private analysis methods
-    void analyzeAudio();
+    void analyzeAudio(const QString &filePath, SF_INFO fileInfo, quint64 serial);
+    void reportProgress(double progress, quint64 serial);
     void resampleForDisplay(int targetWidth, QVariantList &result);
+    bool summarize(qint64 startFrame, qint64 endFrame, int width, float *minOut, float *maxOut, float *rmsOut);
+    void summarizeRaw(qint64 startFrame, qint64 endFrame, int width, float *minOut, float *maxOut, float *rmsOut);
     void closeFile();
 };
 
@@ -1,13 +1,14 @@
 import QtQuick 2.15
 import QtQuick.Controls 2.15
 import QtMultimedia 5.15
+import com.Sp3ctraGen.backend 1.0
 import "../styles" as AppStyles
 
 Rectangle {
     id: waveformView
     
     // Propriétés exposées
-    property var waveformData: []
+    property var waveformProvider: null
     property double cursorPosition: 0
     property double segmentStart: 0
     property double segmentDuration: 0
@@ -19,6 +20,7 @@ Rectangle {
     property bool showSegment: true
     property bool interactive: true
     property string audioSource: ""
+    property real playbackVolume: 1.0  // Gain de lecture (0.0 à 1.0)
     property real totalDuration: 0
     property bool isPlaying: false
     property real segmentEndTime: 0 // Position de fin du segment en millisecondes
@@ -31,135 +33,16 @@ Rectangle {
     // Propriétés internes
     color: backgroundColor
     
-    // Canvas pour dessiner la forme d'onde
-    Canvas {
-        id: waveformCanvas
+    // Forme d'onde dessinée par le scene graph à partir de la pyramide du fournisseur
+    // (au-dessus du segment, sous la poignée du curseur)
+    WaveformItem {
+        id: waveformItem
         anchors.fill: parent
-        
-        // Méthode de dessin de la forme d'onde
-        onPaint: {
-            var ctx = getContext("2d");
-            ctx.clearRect(0, 0, width, height);
-            
-            if (waveformData.length === 0) {
-                return;
-            }
-            
-            // Calculer le centre vertical
-            var centerY = height / 2;
-            var maxAmplitude = height / 2 * 0.9; // 90% de la moitié de la hauteur
-            
-            // Dessiner la forme d'onde
-            ctx.lineWidth = 1;
-            ctx.strokeStyle = waveColor;
-            ctx.fillStyle = Qt.rgba(waveColor.r, waveColor.g, waveColor.b, 0.2);
-            
-            // Vérifier le format des données (objet ou valeur simple)
-            var isObjectData = typeof waveformData[0] === 'object';
-            
-            // Dessiner le remplissage
-            ctx.beginPath();
-            ctx.moveTo(0, centerY);
-            
-            for (var i = 0; i < waveformData.length; i++) {
-                var x = (i / waveformData.length) * width;
-                var y;
-                
-                if (isObjectData) {
-                    // Format avec objets {min, max, rms}
-                    y = centerY - (waveformData[i].max * maxAmplitude);
-                } else {
-                    // Format avec valeurs simples (comme dans simple_ui.qml)
-                    y = centerY - (waveformData[i] * maxAmplitude);
-                }
-                
-                if (i === 0) {
-                    ctx.lineTo(x, y);
-                } else {
-                    ctx.lineTo(x, y);
-                }
-            }
-            
-            if (isObjectData) {
-                // Compléter le chemin pour les données d'objet
-                for (var j = waveformData.length - 1; j >= 0; j--) {
-                    var x2 = (j / waveformData.length) * width;
-                    var y2 = centerY - (waveformData[j].min * maxAmplitude);
-                    ctx.lineTo(x2, y2);
-                }
-            } else {
-                // Compléter le chemin pour les données simples
-                for (var j2 = waveformData.length - 1; j2 >= 0; j2--) {
-                    var x2b = (j2 / waveformData.length) * width;
-                    var y2b = centerY + (waveformData[j2] * maxAmplitude);
-                    ctx.lineTo(x2b, y2b);
-                }
-            }
-            
-            ctx.lineTo(0, centerY);
-            ctx.closePath();
-            ctx.fill();
-            
-            // Pour les données d'objet, dessiner les contours et RMS
-            if (isObjectData) {
-                // Dessiner les contours supérieurs
-                ctx.beginPath();
-                for (var k = 0; k < waveformData.length; k++) {
-                    var x3 = (k / waveformData.length) * width;
-                    var y3 = centerY - (waveformData[k].max * maxAmplitude);
-                    
-                    if (k === 0) {
-                        ctx.moveTo(x3, y3);
-                    } else {
-                        ctx.lineTo(x3, y3);
-                    }
-                }
-                ctx.stroke();
-                
-                // Dessiner les contours inférieurs
-                ctx.beginPath();
-                for (var l = 0; l < waveformData.length; l++) {
-                    var x4 = (l / waveformData.length) * width;
-                    var y4 = centerY - (waveformData[l].min * maxAmplitude);
-                    
-                    if (l === 0) {
-                        ctx.moveTo(x4, y4);
-                    } else {
-                        ctx.lineTo(x4, y4);
-                    }
-                }
-                ctx.stroke();
-                
-                // Dessiner la ligne RMS
-                ctx.beginPath();
-                ctx.strokeStyle = Qt.rgba(waveColor.r, waveColor.g, waveColor.b, 0.7);
-                for (var m = 0; m < waveformData.length; m++) {
-                    var x5 = (m / waveformData.length) * width;
-                    var y5 = centerY - (waveformData[m].rms * maxAmplitude);
-                    
-                    if (m === 0) {
-                        ctx.moveTo(x5, y5);
-                    } else {
-                        ctx.lineTo(x5, y5);
-                    }
-                }
-                ctx.stroke();
-            } else {
-                // Pour les données simples, dessiner juste le contour
-                ctx.beginPath();
-                for (var n = 0; n < waveformData.length; n++) {
-                    var x6 = (n / waveformData.length) * width;
-                    var y6 = centerY - (waveformData[n] * maxAmplitude);
-                    
-                    if (n === 0) {
-                        ctx.moveTo(x6, y6);
-                    } else {
-                        ctx.lineTo(x6, y6);
-                    }
-                }
-                ctx.stroke();
-            }
-        }
+        provider: waveformProvider
+        color: waveColor
+        cursorPosition: waveformView.cursorPosition
+        cursorColor: waveformView.cursorColor
+        z: 6
     }
     
     // Zone du segment à extraire
@@ -177,13 +60,12 @@ Rectangle {
         border.color: segmentBorderColor
     }
     
-    // Curseur mobile
-    Rectangle {
+    // Poignée du curseur (la ligne est dessinée par waveformItem)
+    Item {
         id: cursor
         width: 2
         height: parent.height
         x: cursorPosition * parent.width - width / 2
-        color: cursorColor
         z: 10
         
         // Poignée du curseur en forme de triangle
@@ -248,23 +130,9 @@ Rectangle {
         }
     }
     
-    // Mettre à jour le canvas lorsque les données changent
-    onWaveformDataChanged: {
-        waveformCanvas.requestPaint();
-    }
-    
-    // Fonction pour forcer explicitement le redessinage du canvas
+    // Fonction pour forcer explicitement le redessinage de la forme d'onde
     function forceRedraw() {
-        console.log("AudioWaveform: forceRedraw called");
-        
-        // Peut-être que les données n'ont pas été détectées comme changées
-        // si c'est juste leurs propriétés internes qui ont été modifiées
-        waveformCanvas.requestPaint();
-        
-        // Astuce pour forcer le QML à recalculer le layout
-        var oldHeight = height;
-        height = oldHeight + 0.1;
-        height = oldHeight;
+        waveformItem.update();
     }
     
     // Afficher un message si aucune donnée n'est disponible
@@ -273,13 +141,14 @@ Rectangle {
         text: "No audio data loaded"
         color: "#AAAAAA"
         font.pixelSize: 14
-        visible: waveformData.length === 0
+        visible: !waveformItem.hasData
     }
     
     // Composant Audio pour la lecture
     Audio {
         id: audioPlayer
         source: audioSource
+        volume: playbackVolume
         
         onPositionChanged: {
             // Arrêter la lecture si nous atteignons la fin du segment
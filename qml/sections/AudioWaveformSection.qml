@@ -25,7 +25,7 @@ SectionContainer {
     property bool isAudioNormalized: false
     property real normalizationFactor: 1.0
     property string originalAudioPath: ""
-    property string normalizedAudioPath: ""
+    property bool normalizationPending: false  // Facteur attendu de l'analyse en arrière-plan
     
     // Propriétés exposées
     property alias audioWaveform: audioWaveform
@@ -130,10 +130,6 @@ SectionContainer {
             if (audioWaveform) {
                 console.log("AudioWaveformSection: audioWaveform is correctly initialized");
                 
-                // Obtenir les données de forme d'onde pour l'affichage
-                var waveformWidth = audioWaveform.width;
-                audioWaveform.waveformData = waveformProvider.getWaveformData(waveformWidth);
-                
                 // Calculer le segment initial
                 var segment = waveformProvider.calculateExtractionSegment(
                     audioWaveform.cursorPosition,
@@ -165,6 +161,14 @@ SectionContainer {
         }
     }
     
+    // Handler pour le décodage progressif de la forme d'onde
+    function onLoadProgress(progress) {
+        // waveformItem se redessine lui-même à chaque bloc décodé
+        if (statusText && progress < 1.0) {
+            statusText.text = "Loading waveform: " + Math.round(progress * 100) + "%";
+        }
+    }
+    
     // Composant invisible pour le timer
     Item {
         id: timerContainer
@@ -195,6 +199,7 @@ SectionContainer {
         // Composant de visualisation de forme d'onde
         AudioWaveform {
             id: audioWaveform
+            waveformProvider: audioWaveformSection.waveformProvider
             Layout.fillWidth: true
             Layout.fillHeight: true
             waveColor: AppStyles.Theme.primaryTextColor
@@ -407,6 +412,7 @@ SectionContainer {
     Component.onCompleted: {
         if (waveformProvider) {
             waveformProvider.fileLoaded.connect(onFileLoaded)
+            waveformProvider.loadProgress.connect(onLoadProgress)
         }
     }
     
@@ -421,8 +427,15 @@ SectionContainer {
             
             // Réinitialiser l'état de normalisation
             isAudioNormalized = false;
+            normalizationPending = false;
             normalizationFactor = 1.0;
-            normalizedAudioPath = "";
+            waveformProvider.setGain(1.0);
+            if (generator) {
+                generator.setInputGain(1.0);
+            }
+            if (audioWaveform) {
+                audioWaveform.playbackVolume = 1.0;
+            }
             
             // Convertir le chemin de fichier en URL compatible avec QtMultimedia
             // Pour macOS, nous assurons que le chemin est correctement formaté
@@ -471,8 +484,7 @@ SectionContainer {
         );
         
         // Extraire le segment audio
-        // Puisqu'on utilise déjà le fichier audio normalisé si la normalisation est activée,
-        // nous n'avons plus besoin d'appliquer la normalisation ici
+        // Le gain de normalisation éventuel est appliqué par le fournisseur lors de l'extraction
         var audioData = waveformProvider.extractSegment(
             segment.startPosition,
             segment.duration
@@ -553,6 +565,8 @@ SectionContainer {
     }
     
     // Fonction pour normaliser l'audio et mettre à jour l'affichage
+    // La normalisation est un gain virtuel appliqué par le fournisseur et le générateur;
+    // seule la lecture d'un gain supérieur à 1 passe par une copie normalisée
     function normalizeAudio() {
         console.log("Normalizing audio...");
         
@@ -561,67 +575,36 @@ SectionContainer {
             return;
         }
         
-        // Si l'audio est déjà normalisé, désactiver la normalisation et revenir au fichier original
-        if (isAudioNormalized) {
+        // Si l'audio est déjà normalisé (ou en attente), désactiver la normalisation
+        if (isAudioNormalized || normalizationPending) {
             console.log("Audio already normalized - toggling normalization off");
             isAudioNormalized = false;
-            normalizationFactor = 1.0;
-            
-            // Recharger le fichier audio original
-            console.log("Reverting to original audio file:", originalAudioPath);
-            waveformProvider.loadFile(originalAudioPath);
-            
-            // Mettre à jour l'URL source pour la lecture
-            if (originalAudioPath.startsWith("file://")) {
-                audioSourceUrl = originalAudioPath;
-            } else {
-                audioSourceUrl = "file://" + originalAudioPath;
-            }
-            
-            // Mettre à jour la source audio pour le composant AudioWaveform
-            if (audioWaveform) {
-                audioWaveform.setAudioSource(audioSourceUrl, waveformProvider.getTotalDuration());
-            }
-            
+            normalizationPending = false;
+            applyAudioGain(1.0);
             statusText.showSuccess("Audio normalization disabled");
             return;
         }
         
-        // Si nous n'avons pas encore calculé le facteur de normalisation, le faire maintenant
+        // Le facteur provient du cache d'analyse (calculé en arrière-plan au chargement);
+        // 0 signifie que l'analyse n'est pas encore terminée: onNormalizationFactorReady suivra
         if (normalizationFactor === 1.0) {
             console.log("Calculating normalization factor for:", originalAudioPath);
-            normalizationFactor = generator.calculateNormalizationFactor(originalAudioPath);
-            console.log("Calculated normalization factor:", normalizationFactor);
-        }
-        
-        // Vérifier si nous avons déjà un fichier normalisé
-        if (!normalizedAudioPath || normalizedAudioPath === "") {
-            console.log("Creating normalized audio file with factor:", normalizationFactor);
-            normalizedAudioPath = generator.normalizeAudioFile(originalAudioPath, normalizationFactor);
-            
-            if (!normalizedAudioPath || normalizedAudioPath === "") {
-                statusText.showError("Failed to create normalized audio file");
+            var factor = generator.calculateNormalizationFactor(originalAudioPath);
+            console.log("Calculated normalization factor:", factor);
+            if (factor <= 0) {
+                normalizationPending = true;
+                statusText.text = "Analyzing audio for normalization...";
                 return;
             }
-            
-            console.log("Normalized audio file created at:", normalizedAudioPath);
-        }
-        
-        // Charger le fichier audio normalisé
-        console.log("Loading normalized audio file into provider");
-        waveformProvider.loadFile(normalizedAudioPath);
-        
-        // Mettre à jour l'URL source pour la lecture
-        if (normalizedAudioPath.startsWith("file://")) {
-            audioSourceUrl = normalizedAudioPath;
-        } else {
-            audioSourceUrl = "file://" + normalizedAudioPath;
+            normalizationFactor = factor;
         }
         
-        // Mettre à jour la source audio pour le composant AudioWaveform
-        if (audioWaveform) {
-            audioWaveform.setAudioSource(audioSourceUrl, waveformProvider.getTotalDuration());
-        }
+        enableNormalization();
+    }
+    
+    // Active la normalisation avec le facteur connu
+    function enableNormalization() {
+        applyAudioGain(normalizationFactor);
         
         // Activer l'état normalisé
         isAudioNormalized = true;
@@ -629,4 +612,58 @@ SectionContainer {
         // Afficher un message de confirmation
         statusText.showSuccess("Audio normalized (factor: " + normalizationFactor.toFixed(2) + ")");
     }
+    
+    // Applique un gain virtuel à l'affichage, aux segments extraits, à la génération
+    // et à la lecture
+    function applyAudioGain(gain) {
+        waveformProvider.setGain(gain);
+        if (generator) {
+            generator.setInputGain(gain);
+        }
+        
+        // Le lecteur ne sait qu'atténuer: au-delà de 1, on écoute une copie normalisée
+        // écrite en arrière-plan (onNormalizedAudioReady), l'original reste lu en attendant
+        audioWaveform.playbackVolume = Math.min(gain, 1.0);
+        setPlaybackSource(audioSourceUrl);
+        if (gain > 1.0 && generator) {
+            generator.requestNormalizedAudio(originalAudioPath, gain);
+        }
+    }
+    
+    // Change la source de lecture sans toucher à la durée ni au segment
+    function setPlaybackSource(source) {
+        if (audioWaveform.audioSource === source) {
+            return;
+        }
+        if (audioWaveform.isPlaying) {
+            audioWaveform.stopPlayback();
+        }
+        audioWaveform.setAudioSource(source, audioWaveform.totalDuration);
+    }
+    
+    // Résultats des traitements de normalisation faits en arrière-plan
+    Connections {
+        target: generator
+        
+        function onNormalizationFactorReady(audioPath, factor) {
+            if (!normalizationPending || audioPath !== originalAudioPath) {
+                return;
+            }
+            normalizationPending = false;
+            normalizationFactor = factor;
+            enableNormalization();
+        }
+        
+        function onNormalizedAudioReady(inputPath, factor, outputPath) {
+            // Ignorer une copie devenue obsolète (normalisation désactivée, autre fichier)
+            if (!isAudioNormalized || inputPath !== originalAudioPath || factor !== normalizationFactor) {
+                return;
+            }
+            if (outputPath === "") {
+                statusText.showError("Normalized playback unavailable: playing original audio");
+                return;
+            }
+            setPlaybackSource("file://" + outputPath);
+        }
+    }
 }
@@ -1,6 +1,7 @@
 import QtQuick 2.15
 import QtQuick.Controls 2.15
 import QtQuick.Layouts 1.15
+import QtQuick.Window 2.15
 import "../components"
 import "../styles" as AppStyles
 
@@ -19,6 +20,10 @@ Rectangle {
     property alias savePreviewButton: savePreviewButton
     property alias statusText: statusText
     
+    // Compteurs de la dernière génération (SpectrogramViewModel.generationStats)
+    property var generationStats: typeof viewModel !== "undefined" && viewModel ? viewModel.generationStats : ({})
+    property bool showDiagnostics: false
+    
     // Signaux
     signal saveRequested(string format)
     signal printRequested()
@@ -50,6 +55,15 @@ Rectangle {
         }
     }
     
+    function onPreviewDraftGenerated(segment) {
+        // L'ébauche à la résolution de l'écran est affichée en attendant l'affinage
+        if (generator) {
+            generator.previewCounter++
+        }
+        
+        statusText.showInfo("Refining preview...")
+    }
+    
     function onPreviewSaved(success, outputPath, format, errorMessage) {
         // Réinitialiser le bouton de sauvegarde
         savePreviewButton.isProcessing = false
@@ -62,6 +76,28 @@ Rectangle {
         }
     }
     
+    // Texte du panneau de diagnostic
+    function formatGenerationStats(stats) {
+        if (!stats || stats.fftCount === undefined) {
+            return "No generation yet"
+        }
+        
+        var mb = 1024 * 1024
+        var lines = [
+            "FFTs: " + stats.fftCount,
+            "Decoded: " + (stats.bytesDecoded / mb).toFixed(1) + " MB",
+            "Peak memory: " + (stats.peakAllocatedBytes / mb).toFixed(1) + " MB",
+            "FFT plans: " + stats.planCacheHits + " hit / " + stats.planCacheMisses + " miss (" +
+                Math.round(stats.planCacheHitRate * 100) + "%)"
+        ]
+        for (var i = 0; i < stats.stages.length; i++) {
+            var stage = stats.stages[i]
+            lines.push(stage.label + ": " + stage.wallMs.toFixed(1) + " ms (CPU " + stage.cpuMs.toFixed(1) + " ms)")
+        }
+        lines.push("Total: " + stats.wallMs.toFixed(1) + " ms (CPU " + stats.cpuMs.toFixed(1) + " ms)")
+        return lines.join("\n")
+    }
+    
     // Fonctions pour le zoom et le déplacement de l'image
     function zoomImage(newZoom, centerX, centerY) {
         if (!previewImage || previewImage.status !== Image.Ready) return
@@ -107,6 +143,29 @@ Rectangle {
                 Layout.fillWidth: true
             }
             
+            // Affichage du panneau de diagnostic
+            Button {
+                width: 40
+                height: 24
+                
+                onClicked: {
+                    showDiagnostics = !showDiagnostics
+                }
+                
+                contentItem: Text {
+                    text: "Stats"
+                    color: parent.hovered || showDiagnostics ? AppStyles.Theme.buttonHoverText : AppStyles.Theme.buttonText
+                    horizontalAlignment: Text.AlignHCenter
+                    verticalAlignment: Text.AlignVCenter
+                    font.pixelSize: AppStyles.Theme.smallFontSize
+                }
+                
+                background: Rectangle {
+                    color: parent.hovered || showDiagnostics ? AppStyles.Theme.buttonHoverBackground : AppStyles.Theme.buttonBackground
+                    radius: AppStyles.Theme.borderRadius / 2
+                }
+            }
+            
                 // Bouton de contrôle du zoom
             Button {
                 width: 30
@@ -167,6 +226,14 @@ Rectangle {
             Layout.fillHeight: true
             clip: true
             
+            // Taille de la zone en pixels physiques, utilisée pour les ébauches de prévisualisation
+            Binding {
+                target: generator ? generator.previewController : null
+                property: "viewportSize"
+                value: Qt.size(Math.round(viewportContainer.width * Screen.devicePixelRatio),
+                               Math.round(viewportContainer.height * Screen.devicePixelRatio))
+            }
+            
                 // Rectangle pour montrer que le zoom sur le fond fonctionne
             Rectangle {
                 anchors.fill: parent
@@ -376,6 +443,27 @@ Rectangle {
                 color: AppStyles.Theme.fieldText
                 visible: !generator || generator.previewCounter === 0 || previewImage.status === Image.Null
             }
+            
+            // Panneau de diagnostic : compteurs de la dernière génération
+            Rectangle {
+                anchors.top: parent.top
+                anchors.right: parent.right
+                anchors.margins: AppStyles.Theme.padding
+                width: diagnosticsText.implicitWidth + AppStyles.Theme.padding * 2
+                height: diagnosticsText.implicitHeight + AppStyles.Theme.padding * 2
+                color: "#CC000000"
+                radius: AppStyles.Theme.borderRadius
+                visible: showDiagnostics
+                
+                Text {
+                    id: diagnosticsText
+                    anchors.centerIn: parent
+                    text: formatGenerationStats(generationStats)
+                    color: AppStyles.Theme.fieldText
+                    font.pixelSize: AppStyles.Theme.smallFontSize
+                    font.family: "monospace"
+                }
+            }
         }
         
         // Conteneur pour les contrôles d'exportation
@@ -507,6 +595,7 @@ Rectangle {
         if (generator) {
             generator.previewGenerated.connect(onPreviewGenerated)
             generator.segmentPreviewGenerated.connect(onSegmentPreviewGenerated)
+            generator.previewDraftGenerated.connect(onPreviewDraftGenerated)
             generator.previewSaved.connect(onPreviewSaved)
         }
     }
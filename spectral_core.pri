@@ -0,0 +1,45 @@
+###############################################################################
+# Noyau C de génération des spectrogrammes
+# Partagé par l'application (Sp3ctraGen.pro) et l'outil en ligne de commande
+# (cli/Sp3ctraGenCli.pro)
+###############################################################################
+
+SOURCES += \
+    $$PWD/src/spectral_generator.c \
+    $$PWD/src/spectral_wav_processing.c \
+    $$PWD/src/spectral_fft.c \
+    $$PWD/src/spectral_cqt.c \
+    $$PWD/src/spectral_raster.c \
+    $$PWD/src/spectral_vector.c \
+    $$PWD/src/spectral_audio_analysis.c \
+    $$PWD/src/spectral_decoder.c \
+    $$PWD/src/spectral_analyze.c \
+    $$PWD/src/spectral_plan.c \
+    $$PWD/src/spectral_trace.c \
+    $$PWD/src/spectral_log.c
+
+HEADERS += \
+    $$PWD/include/spectral_generator.h \
+    $$PWD/src/spectral_common.h \
+    $$PWD/src/spectral_wav_processing.h \
+    $$PWD/src/spectral_fft.h \
+    $$PWD/src/spectral_cqt.h \
+    $$PWD/src/spectral_audio_analysis.h \
+    $$PWD/src/spectral_decoder.h \
+    $$PWD/src/spectral_analyze.h
+
+INCLUDEPATH += $$PWD/include
+
+# Les messages de débogage du noyau sont retirés des versions release
+CONFIG(release, debug|release): DEFINES += SPECTRAL_LOG_MIN_LEVEL=SPECTRAL_LOG_INFO
+
+# Configuration des bibliothèques externes
+unix:!macx {
+    # Configuration Linux
+    LIBS += -lfftw3 -lcairo -lsndfile -lpthread
+}
+macx {
+    # Configuration macOS
+    LIBS += -L/opt/homebrew/lib -lfftw3 -lcairo -lsndfile
+    INCLUDEPATH += /opt/homebrew/include
+}
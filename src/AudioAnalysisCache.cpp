@@ -0,0 +1,195 @@
+/*
+ * Copyright (C) 2025 - present Ondulab
+ * All rights reserved.
+ *
+ * This software is licensed under terms that can be found in the LICENSE file
+ * in the root directory of this software component.
+ */
+
+#include "../include/AudioAnalysisCache.h"
+#include "../include/PathManager.h"
+#include "../include/TaskManager.h"
+#include <QDateTime>
+#include <QDebug>
+#include <QFileInfo>
+#include <QMutexLocker>
+
+// Initialization of the static instance
+AudioAnalysisCache* AudioAnalysisCache::s_instance = nullptr;
+
+namespace {
+// Takes ownership of a filled AudioAnalysis and frees its blocks on release
+AudioAnalysisCache::AnalysisPtr wrapAnalysis(const AudioAnalysis& source)
+{
+    return AudioAnalysisCache::AnalysisPtr(new AudioAnalysis(source), [](const AudioAnalysis* analysis) {
+        AudioAnalysis* owned = const_cast<AudioAnalysis*>(analysis);
+        audio_analysis_free(owned);
+        delete owned;
+    });
+}
+}
+
+AudioAnalysisCache* AudioAnalysisCache::getInstance()
+{
+    if (!s_instance) {
+        s_instance = new AudioAnalysisCache();
+    }
+    return s_instance;
+}
+
+AudioAnalysisCache::AudioAnalysisCache(QObject *parent)
+    : QObject(parent)
+{
+}
+
+QString AudioAnalysisCache::cacheKey(const QString& audioPath)
+{
+    QFileInfo fileInfo(audioPath);
+    if (!fileInfo.exists()) {
+        return QString();
+    }
+
+    return fileInfo.absoluteFilePath() + "|" +
+           QString::number(fileInfo.size()) + "|" +
+           QString::number(fileInfo.lastModified().toMSecsSinceEpoch());
+}
+
+void AudioAnalysisCache::requestAnalysis(const QString& audioPath)
+{
+    QString key = cacheKey(audioPath);
+    if (key.isEmpty()) {
+        return;
+    }
+
+    {
+        QMutexLocker locker(&m_mutex);
+        if (m_entries.contains(key) || m_pending.contains(key)) {
+            return;
+        }
+        m_pending.insert(key);
+    }
+
+    auto success = std::make_shared<bool>(false);
+
+    TaskManager::getInstance()->runTask(
+        [this, audioPath, key, success](TaskManager::ProgressCallback progressCallback) {
+            progressCallback(0, "Analyse du fichier audio...");
+
+            // A sidecar from a previous session avoids decoding the file again
+            AnalysisPtr result = cachedAnalysis(audioPath);
+            if (!result) {
+                result = computeAndStore(audioPath, key);
+            }
+            *success = (result != nullptr);
+
+            progressCallback(100, "Analyse du fichier audio terminée");
+        },
+        [this, audioPath, key, success](bool, const QString&) {
+            {
+                QMutexLocker locker(&m_mutex);
+                m_pending.remove(key);
+            }
+            emit analysisReady(audioPath, *success);
+        },
+        JobScheduler::Background
+    );
+}
+
+AudioAnalysisCache::AnalysisPtr AudioAnalysisCache::cachedAnalysis(const QString& audioPath)
+{
+    QString key = cacheKey(audioPath);
+    if (key.isEmpty()) {
+        return nullptr;
+    }
+
+    {
+        QMutexLocker locker(&m_mutex);
+        auto it = m_entries.constFind(key);
+        if (it != m_entries.constEnd()) {
+            return it.value();
+        }
+    }
+
+    AudioAnalysis loaded;
+    QString sidecar = PathManager::getCacheFilePath(audioPath, "analysis", "s3an");
+    if (audio_analysis_load(sidecar.toUtf8().constData(), &loaded) != 0) {
+        return nullptr;
+    }
+
+    AnalysisPtr result = wrapAnalysis(loaded);
+    QMutexLocker locker(&m_mutex);
+    m_entries.insert(key, result);
+    return result;
+}
+
+AudioAnalysisCache::AnalysisPtr AudioAnalysisCache::analysis(const QString& audioPath)
+{
+    AnalysisPtr result = cachedAnalysis(audioPath);
+    if (result) {
+        return result;
+    }
+
+    QString key = cacheKey(audioPath);
+    if (key.isEmpty()) {
+        qWarning() << "AudioAnalysisCache: le fichier n'existe pas:" << audioPath;
+        return nullptr;
+    }
+
+    return computeAndStore(audioPath, key);
+}
+
+AudioAnalysisCache::AnalysisPtr AudioAnalysisCache::computeAndStore(const QString& audioPath, const QString& key)
+{
+    AudioAnalysis computed;
+    if (audio_analysis_compute(audioPath.toUtf8().constData(), AUDIO_ANALYSIS_BLOCK_SIZE, &computed) != 0) {
+        qWarning() << "AudioAnalysisCache: échec de l'analyse de" << audioPath;
+        return nullptr;
+    }
+
+    AnalysisPtr result = wrapAnalysis(computed);
+
+    // The sidecar is only an optimization: a write failure is not an error
+    QString sidecar = PathManager::getCacheFilePath(audioPath, "analysis", "s3an");
+    if (audio_analysis_save(result.get(), sidecar.toUtf8().constData()) != 0) {
+        qWarning() << "AudioAnalysisCache: impossible d'écrire" << sidecar;
+    }
+
+    qDebug() << "AudioAnalysisCache: analyse de" << audioPath
+             << "- crête:" << result->channel_peak
+             << "- RMS:" << result->rms
+             << "-" << result->num_blocks << "blocs";
+
+    QMutexLocker locker(&m_mutex);
+    m_entries.insert(key, result);
+    return result;
+}
+
+double AudioAnalysisCache::factorOf(const AudioAnalysis& analysis, double targetPeak)
+{
+    // Limiter le facteur à une valeur raisonnable pour éviter une amplification excessive
+    // des fichiers avec de très faibles amplitudes
+    if (analysis.channel_peak > 0.001) {
+        return targetPeak / analysis.channel_peak;
+    }
+    return 10.0;
+}
+
+double AudioAnalysisCache::normalizationFactor(const QString& audioPath, double targetPeak)
+{
+    AnalysisPtr result = analysis(audioPath);
+    if (!result) {
+        return 1.0; // Valeur par défaut (pas de changement)
+    }
+    return factorOf(*result, targetPeak);
+}
+
+double AudioAnalysisCache::cachedNormalizationFactor(const QString& audioPath, double targetPeak)
+{
+    AnalysisPtr result = cachedAnalysis(audioPath);
+    if (!result) {
+        // Pas de décodage ici : l'analyse est faite en arrière-plan
+        requestAnalysis(audioPath);
+        return 0.0;
+    }
+    return factorOf(*result, targetPeak);
+}
@@ -0,0 +1,495 @@
+/*
+ * Copyright (C) 2025 - present Ondulab
+ * All rights reserved.
+ *
+ * This software is licensed under terms that can be found in the LICENSE file
+ * in the root directory of this software component.
+ */
+
+#include "../include/BatchRunner.h"
+#include "../include/JobScheduler.h"
+#include "../include/TaskManager.h"
+#include <QDebug>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QFuture>
+#include <QHash>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QMutexLocker>
+#include <cstring>
+#include <functional>
+#include <sndfile.h>
+
+namespace {
+// Extensions of the audio files picked up in a directory (formats read by libsndfile)
+const QStringList AUDIO_FILTERS = {"*.wav", "*.flac", "*.aif", "*.aiff", "*.ogg"};
+
+using Setter = std::function<bool(SpectrogramSettingsCpp&, const QString&)>;
+
+Setter doubleSetter(void (SpectrogramSettingsCpp::*setter)(double))
+{
+    return [setter](SpectrogramSettingsCpp& settings, const QString& text) {
+        bool ok = false;
+        double value = text.toDouble(&ok);
+        if (ok) {
+            (settings.*setter)(value);
+        }
+        return ok;
+    };
+}
+
+Setter intSetter(void (SpectrogramSettingsCpp::*setter)(int))
+{
+    return [setter](SpectrogramSettingsCpp& settings, const QString& text) {
+        bool ok = false;
+        int value = text.toInt(&ok);
+        if (ok) {
+            (settings.*setter)(value);
+        }
+        return ok;
+    };
+}
+
+Setter boolSetter(void (SpectrogramSettingsCpp::*setter)(bool))
+{
+    return [setter](SpectrogramSettingsCpp& settings, const QString& text) {
+        QString value = text.trimmed().toLower();
+        if (value == "1" || value == "true" || value == "yes" || value == "on") {
+            (settings.*setter)(true);
+        } else if (value == "0" || value == "false" || value == "no" || value == "off") {
+            (settings.*setter)(false);
+        } else {
+            return false;
+        }
+        return true;
+    };
+}
+
+// Settings keys, named after the fields of SpectrogramSettings
+const QHash<QString, Setter>& settingSetters()
+{
+    using S = SpectrogramSettingsCpp;
+    static const QHash<QString, Setter> setters = {
+        {"minFreq", doubleSetter(&S::setMinFreq)},
+        {"maxFreq", doubleSetter(&S::setMaxFreq)},
+        {"duration", doubleSetter(&S::setDuration)},
+        {"sampleRate", intSetter(&S::setSampleRate)},
+        {"dynamicRangeDB", doubleSetter(&S::setDynamicRangeDB)},
+        {"gammaCorrection", doubleSetter(&S::setGammaCorrection)},
+        {"enableDithering", boolSetter(&S::setEnableDithering)},
+        {"contrastFactor", doubleSetter(&S::setContrastFactor)},
+        {"enableHighBoost", boolSetter(&S::setEnableHighBoost)},
+        {"highBoostAlpha", doubleSetter(&S::setHighBoostAlpha)},
+        {"pageFormat", intSetter(&S::setPageFormat)},
+        {"bottomMarginMM", doubleSetter(&S::setBottomMarginMM)},
+        {"spectroHeightMM", doubleSetter(&S::setSpectroHeightMM)},
+        {"writingSpeed", doubleSetter(&S::setWritingSpeed)},
+        {"fftSize", intSetter(&S::setFftSize)},
+        {"enableHighPassFilter", boolSetter(&S::setEnableHighPassFilter)},
+        {"highPassCutoffFreq", doubleSetter(&S::setHighPassCutoffFreq)},
+        {"highPassFilterOrder", intSetter(&S::setHighPassFilterOrder)},
+        {"enableNormalization", boolSetter(&S::setEnableNormalization)},
+        {"enableVerticalScale", boolSetter(&S::setEnableVerticalScale)},
+        {"enableBottomReferenceLine", boolSetter(&S::setEnableBottomReferenceLine)},
+        {"bottomReferenceLineOffset", doubleSetter(&S::setBottomReferenceLineOffset)},
+        {"enableTopReferenceLine", boolSetter(&S::setEnableTopReferenceLine)},
+        {"topReferenceLineOffset", doubleSetter(&S::setTopReferenceLineOffset)},
+        {"displayParameters", boolSetter(&S::setDisplayParameters)},
+        {"textScaleFactor", doubleSetter(&S::setTextScaleFactor)},
+        {"lineThicknessFactor", doubleSetter(&S::setLineThicknessFactor)},
+        {"binsPerSecond", doubleSetter(&S::setBinsPerSecond)},
+        {"overlapPreset", intSetter(&S::setOverlapPreset)},
+        {"inputGain", doubleSetter(&S::setInputGain)},
+        {"pdfEmbedImage", boolSetter(&S::setPdfEmbedImage)},
+        {"paginate", boolSetter(&S::setPaginate)},
+        {"analysisEngine", intSetter(&S::setAnalysisEngine)}
+    };
+    return setters;
+}
+
+// Textual form of a manifest value (CSV cells are already strings)
+QString valueText(const QJsonValue& value)
+{
+    if (value.isBool()) {
+        return value.toBool() ? "true" : "false";
+    }
+    if (value.isDouble()) {
+        return QString::number(value.toDouble(), 'g', 17);
+    }
+    return value.toString();
+}
+
+// Splits a CSV line; fields may be quoted, with "" standing for a quote
+QStringList splitCsvLine(const QString& line)
+{
+    QStringList fields;
+    QString field;
+    bool quoted = false;
+
+    for (int i = 0; i < line.size(); ++i) {
+        QChar c = line.at(i);
+        if (quoted) {
+            if (c == '"' && i + 1 < line.size() && line.at(i + 1) == '"') {
+                field += '"';
+                ++i;
+            } else if (c == '"') {
+                quoted = false;
+            } else {
+                field += c;
+            }
+        } else if (c == '"') {
+            quoted = true;
+        } else if (c == ',') {
+            fields << field.trimmed();
+            field.clear();
+        } else {
+            field += c;
+        }
+    }
+    fields << field.trimmed();
+    return fields;
+}
+}
+
+BatchRunner::BatchRunner()
+    : m_outputDirectory(".")
+    , m_png(true)
+    , m_pdf(false)
+    , m_dpi(static_cast<int>(PRINTER_DPI))
+    , m_out(stdout)
+    , m_finished(0)
+{
+}
+
+bool BatchRunner::applySetting(SpectrogramSettingsCpp& settings, const QString& key,
+                               const QString& value, QString* error)
+{
+    auto it = settingSetters().constFind(key);
+    if (it == settingSetters().constEnd()) {
+        *error = QString("paramètre inconnu: %1").arg(key);
+        return false;
+    }
+    if (!it.value()(settings, value)) {
+        *error = QString("valeur invalide pour %1: %2").arg(key, value);
+        return false;
+    }
+    return true;
+}
+
+bool BatchRunner::addDirectory(const QString& path, QString* error)
+{
+    QDir directory(path);
+    if (!directory.exists()) {
+        *error = QString("répertoire introuvable: %1").arg(path);
+        return false;
+    }
+
+    const QFileInfoList files = directory.entryInfoList(AUDIO_FILTERS, QDir::Files, QDir::Name);
+    for (const QFileInfo& file : files) {
+        QJsonObject entry;
+        entry.insert("file", file.absoluteFilePath());
+        if (!addEntry(QJsonObject(), entry, directory.absolutePath(), error)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool BatchRunner::addManifest(const QString& path, QString* error)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        *error = QString("impossible d'ouvrir %1: %2").arg(path, file.errorString());
+        return false;
+    }
+    QString baseDirectory = QFileInfo(path).absolutePath();
+
+    if (path.endsWith(".csv", Qt::CaseInsensitive)) {
+        QTextStream in(&file);
+        QStringList header;
+        int lineNumber = 0;
+        while (!in.atEnd()) {
+            QString line = in.readLine();
+            ++lineNumber;
+            if (line.trimmed().isEmpty() || line.startsWith('#')) {
+                continue;
+            }
+            QStringList fields = splitCsvLine(line);
+            if (header.isEmpty()) {
+                header = fields;
+                continue;
+            }
+
+            // Empty cells keep the defaults
+            QJsonObject entry;
+            for (int i = 0; i < header.size() && i < fields.size(); ++i) {
+                if (!fields.at(i).isEmpty()) {
+                    entry.insert(header.at(i), fields.at(i));
+                }
+            }
+            if (!addEntry(QJsonObject(), entry, baseDirectory, error)) {
+                *error = QString("%1:%2: %3").arg(path).arg(lineNumber).arg(*error);
+                return false;
+            }
+        }
+        return true;
+    }
+
+    QJsonParseError parseError;
+    QJsonDocument document = QJsonDocument::fromJson(file.readAll(), &parseError);
+    if (document.isNull()) {
+        *error = QString("%1: %2").arg(path, parseError.errorString());
+        return false;
+    }
+
+    QJsonObject defaults;
+    QJsonArray entries;
+    if (document.isArray()) {
+        entries = document.array();
+    } else {
+        defaults = document.object().value("defaults").toObject();
+        entries = document.object().value("jobs").toArray();
+    }
+
+    for (int i = 0; i < entries.size(); ++i) {
+        if (!addEntry(defaults, entries.at(i).toObject(), baseDirectory, error)) {
+            *error = QString("%1: tâche %2: %3").arg(path).arg(i + 1).arg(*error);
+            return false;
+        }
+    }
+    return true;
+}
+
+bool BatchRunner::addEntry(const QJsonObject& defaults, const QJsonObject& entry,
+                           const QString& baseDirectory, QString* error)
+{
+    // The entry overrides the manifest defaults, which override the runner ones
+    QJsonObject values = defaults;
+    for (auto it = entry.constBegin(); it != entry.constEnd(); ++it) {
+        values.insert(it.key(), it.value());
+    }
+
+    Job job;
+    job.png = m_png;
+    job.pdf = m_pdf;
+    job.dpi = m_dpi;
+    job.settings = m_defaults;
+    QString output;
+
+    for (auto it = values.constBegin(); it != values.constEnd(); ++it) {
+        QString key = it.key();
+        QString value = valueText(it.value());
+
+        if (key == "file") {
+            job.inputFile = QDir(baseDirectory).absoluteFilePath(value);
+        } else if (key == "output") {
+            output = value;
+        } else if (key == "format") {
+            QString format = value.toLower();
+            if (format != "png" && format != "pdf" && format != "both") {
+                *error = QString("format invalide: %1").arg(value);
+                return false;
+            }
+            job.png = format != "pdf";
+            job.pdf = format != "png";
+        } else if (key == "dpi") {
+            bool ok = false;
+            job.dpi = value.toInt(&ok);
+            if (!ok || job.dpi <= 0) {
+                *error = QString("résolution invalide: %1").arg(value);
+                return false;
+            }
+        } else if (!applySetting(job.settings, key, value, error)) {
+            return false;
+        }
+    }
+
+    if (job.inputFile.isEmpty()) {
+        *error = "champ \"file\" manquant";
+        return false;
+    }
+
+    // Outputs are named after the input unless the entry names them
+    if (output.isEmpty()) {
+        output = QFileInfo(job.inputFile).completeBaseName();
+    } else if (output.endsWith(".png", Qt::CaseInsensitive) || output.endsWith(".pdf", Qt::CaseInsensitive)) {
+        output.chop(4);
+    }
+    job.outputBase = QDir(m_outputDirectory).absoluteFilePath(output);
+
+    m_jobs.append(job);
+    return true;
+}
+
+BatchRunner::Result BatchRunner::runJob(const Job& job) const
+{
+    Result result;
+    result.success = false;
+    result.audioSeconds = 0.0;
+    result.analyzeMs = 0.0;
+    result.renderMs = 0.0;
+    result.totalMs = 0.0;
+
+    QElapsedTimer timer;
+    timer.start();
+
+    // The length comes from the header: nothing is decoded outside the analysis,
+    // which normalizes the signal itself
+    QByteArray inputFile = job.inputFile.toUtf8();
+    SF_INFO info;
+    memset(&info, 0, sizeof(info));
+    SNDFILE* file = sf_open(inputFile.constData(), SFM_READ, &info);
+    if (!file) {
+        result.message = "lecture du fichier audio impossible";
+        result.totalMs = timer.nsecsElapsed() / 1.0e6;
+        return result;
+    }
+    sf_close(file);
+    if (info.samplerate > 0) {
+        result.audioSeconds = static_cast<double>(info.frames) / info.samplerate;
+    }
+
+    QDir().mkpath(QFileInfo(job.outputBase).absolutePath());
+
+    SpectralJob spectralJob;
+    spectral_job_init(&spectralJob, 0.0);
+    TaskManager::getInstance()->prepareJob(&spectralJob);
+
+    SpectrogramSettings cSettings = job.settings.toCStruct();
+    if (!job.png) {
+        // Only the PNG needs the dithering; it would split the merged PDF cells
+        cSettings.enableDithering = 0;
+    }
+    SpectralAnalysis* analysis = nullptr;
+
+    int status = spectral_analyze(&cSettings, inputFile.constData(), &analysis, &spectralJob);
+    result.analyzeMs = timer.nsecsElapsed() / 1.0e6;
+
+    if (status == EXIT_SUCCESS && job.png) {
+        QByteArray outputFile = (job.outputBase + ".png").toUtf8();
+        status = spectral_render_png(analysis, nullptr, outputFile.constData(), &spectralJob);
+    }
+    if (status == EXIT_SUCCESS && job.pdf) {
+        QByteArray outputFile = (job.outputBase + ".pdf").toUtf8();
+        status = spectral_render_vector_pdf(analysis, nullptr, outputFile.constData(), job.dpi, &spectralJob);
+    }
+    if (analysis) {
+        spectral_analysis_free(analysis);
+    }
+
+    result.totalMs = timer.nsecsElapsed() / 1.0e6;
+    result.renderMs = result.totalMs - result.analyzeMs;
+    result.success = (status == EXIT_SUCCESS);
+    if (!result.success) {
+        result.message = QString("échec de la génération (code %1)").arg(status);
+    }
+    return result;
+}
+
+void BatchRunner::printResult(int index, const Job& job, const Result& result)
+{
+    QMutexLocker locker(&m_outputMutex);
+    ++m_finished;
+
+    m_out << QString("[%1/%2] ").arg(m_finished).arg(m_jobs.size())
+          << (result.success ? "OK     " : "ÉCHEC  ")
+          << QFileInfo(job.inputFile).fileName()
+          << QString(" - audio %1 s - analyse %2 ms - rendu %3 ms - total %4 ms")
+                 .arg(result.audioSeconds, 0, 'f', 1)
+                 .arg(result.analyzeMs, 0, 'f', 0)
+                 .arg(result.renderMs, 0, 'f', 0)
+                 .arg(result.totalMs, 0, 'f', 0);
+    if (!result.success) {
+        m_out << " - " << result.message;
+    }
+    m_out << " (#" << index + 1 << ")\n";
+    m_out.flush();
+}
+
+int BatchRunner::run(int concurrency, const QString& reportFile)
+{
+    JobScheduler* scheduler = JobScheduler::getInstance();
+    // No preview runs in batch mode: the exports may use every worker
+    scheduler->setInteractiveReserve(false);
+    if (concurrency > 0) {
+        scheduler->setConcurrencyLimit(JobScheduler::Export, concurrency);
+    }
+    int effective = scheduler->effectiveConcurrency(JobScheduler::Export);
+    m_out << QString("Lot de %1 fichiers: %2 tâches simultanées").arg(m_jobs.size()).arg(effective);
+    if (concurrency > effective) {
+        m_out << QString(" (%1 demandées, %2 threads de travail)").arg(concurrency).arg(scheduler->workerCount());
+    }
+    m_out << "\n";
+    m_out.flush();
+
+    QVector<Result> results(m_jobs.size());
+    QList<QFuture<void>> futures;
+    m_finished = 0;
+
+    QElapsedTimer batchTimer;
+    batchTimer.start();
+
+    // Every job writes its own slot; the vector is not resized while they run
+    Result* outcomes = results.data();
+    for (int i = 0; i < m_jobs.size(); ++i) {
+        futures << scheduler->schedule(JobScheduler::Export, [this, outcomes, i]() {
+            outcomes[i] = runJob(m_jobs.at(i));
+            printResult(i, m_jobs.at(i), outcomes[i]);
+        });
+    }
+    for (QFuture<void>& future : futures) {
+        future.waitForFinished();
+    }
+
+    double wallSeconds = batchTimer.nsecsElapsed() / 1.0e9;
+
+    int failed = 0;
+    double audioSeconds = 0.0;
+    for (const Result& result : results) {
+        if (result.success) {
+            audioSeconds += result.audioSeconds;
+        } else {
+            ++failed;
+        }
+    }
+
+    // Throughput counts the files and the audio that were actually rendered
+    double minutes = wallSeconds / 60.0;
+    int succeeded = m_jobs.size() - failed;
+    m_out << "\n"
+          << QString("%1 fichiers, %2 échecs, %3 h d'audio en %4 s (%5 tâches simultanées)\n")
+                 .arg(m_jobs.size())
+                 .arg(failed)
+                 .arg(audioSeconds / 3600.0, 0, 'f', 2)
+                 .arg(wallSeconds, 0, 'f', 1)
+                 .arg(effective)
+          << QString("Débit: %1 fichiers/min, %2 h d'audio/min\n")
+                 .arg(minutes > 0.0 ? succeeded / minutes : 0.0, 0, 'f', 2)
+                 .arg(minutes > 0.0 ? audioSeconds / 3600.0 / minutes : 0.0, 0, 'f', 3);
+    m_out.flush();
+
+    if (!reportFile.isEmpty()) {
+        QFile file(reportFile);
+        if (file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+            QTextStream report(&file);
+            report << "file,status,audio_s,analyze_ms,render_ms,total_ms,message\n";
+            for (int i = 0; i < m_jobs.size(); ++i) {
+                const Result& result = results.at(i);
+                report << '"' << QString(m_jobs.at(i).inputFile).replace('"', "\"\"") << "\","
+                       << (result.success ? "ok" : "failed") << ','
+                       << QString::number(result.audioSeconds, 'f', 3) << ','
+                       << QString::number(result.analyzeMs, 'f', 1) << ','
+                       << QString::number(result.renderMs, 'f', 1) << ','
+                       << QString::number(result.totalMs, 'f', 1) << ','
+                       << '"' << QString(result.message).replace('"', "\"\"") << "\"\n";
+            }
+        } else {
+            qWarning() << "BatchRunner: impossible d'écrire le rapport" << reportFile;
+        }
+    }
+
+    return failed;
+}
@@ -0,0 +1,363 @@
+/*
+ * Copyright (C) 2025 - present Ondulab
+ * All rights reserved.
+ *
+ * This software is licensed under terms that can be found in the LICENSE file
+ * in the root directory of this software component.
+ */
+
+#include "../include/JobScheduler.h"
+#include "../include/spectral_generator.h"
+#include <QDebug>
+#include <QThread>
+#include <algorithm>
+
+// Initialization of the static instance
+JobScheduler* JobScheduler::s_instance = nullptr;
+
+namespace {
+// Index of the worker running the current thread, -1 outside the pool
+thread_local int t_workerIndex = -1;
+
+// Sub-tasks of one parallelFor() still running or queued; the last one
+// wakes the caller
+struct SubtaskGroup {
+    QMutex mutex;
+    QWaitCondition done;
+    int remaining;
+};
+
+// Names of the scheduled jobs in the timeline trace, by priority
+const char* const TRACE_JOB_NAMES[JobScheduler::PriorityCount] = {
+    "interactive_job", "export_job", "background_job"
+};
+}
+
+JobScheduler* JobScheduler::getInstance()
+{
+    if (!s_instance) {
+        s_instance = new JobScheduler();
+    }
+    return s_instance;
+}
+
+JobScheduler::JobScheduler(QObject *parent)
+    : QObject(parent)
+    , m_subtaskEpoch(0)
+    , m_nextWorker(0)
+    , m_reserveInteractive(true)
+    , m_stopping(false)
+{
+    // At least two workers, so that one can stay reserved for previews
+    int workers = std::max(2, QThread::idealThreadCount());
+
+    m_limits[Interactive] = workers;
+    m_limits[Export] = std::max(1, workers / 2);
+    m_limits[Background] = 1;
+    for (int p = 0; p < PriorityCount; ++p) {
+        m_running[p] = 0;
+    }
+
+    for (int i = 0; i < workers; ++i) {
+        m_workers.emplace_back(new Worker());
+    }
+    for (int i = 0; i < workers; ++i) {
+        m_workers[i]->thread = QThread::create([this, i]() { workerLoop(i); });
+        m_workers[i]->thread->start();
+    }
+
+    qDebug() << "JobScheduler: started" << workers << "workers";
+}
+
+JobScheduler::~JobScheduler()
+{
+    {
+        QMutexLocker locker(&m_mutex);
+        m_stopping = true;
+
+        // Jobs that never ran are reported as cancelled
+        for (std::deque<PendingJob>& queue : m_queues) {
+            for (PendingJob& pending : queue) {
+                pending.promise.cancel();
+                pending.promise.reportFinished();
+            }
+            queue.clear();
+        }
+        m_wakeup.wakeAll();
+    }
+
+    for (std::unique_ptr<Worker>& worker : m_workers) {
+        worker->thread->wait();
+        delete worker->thread;
+    }
+}
+
+QFuture<void> JobScheduler::schedule(Priority priority, Job job,
+                                     const QList<QFuture<void>>& dependencies)
+{
+    PendingJob pending;
+    pending.job = std::move(job);
+    pending.dependencies = dependencies;
+    pending.promise.reportStarted();
+    QFuture<void> future = pending.promise.future();
+
+    QMutexLocker locker(&m_mutex);
+    m_queues[priority].push_back(std::move(pending));
+    m_wakeup.wakeAll();
+    return future;
+}
+
+void JobScheduler::setConcurrencyLimit(Priority priority, int limit)
+{
+    QMutexLocker locker(&m_mutex);
+    m_limits[priority] = std::max(1, limit);
+    m_wakeup.wakeAll();
+}
+
+int JobScheduler::concurrencyLimit(Priority priority) const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_limits[priority];
+}
+
+void JobScheduler::setInteractiveReserve(bool reserved)
+{
+    QMutexLocker locker(&m_mutex);
+    m_reserveInteractive = reserved;
+    m_wakeup.wakeAll();
+}
+
+int JobScheduler::effectiveConcurrency(Priority priority) const
+{
+    QMutexLocker locker(&m_mutex);
+    int workers = workerCount();
+    if (priority != Interactive && m_reserveInteractive) {
+        workers -= 1;
+    }
+    return std::min(m_limits[priority], workers);
+}
+
+void JobScheduler::waitForDone()
+{
+    QMutexLocker locker(&m_mutex);
+    for (;;) {
+        bool idle = true;
+        for (int p = 0; p < PriorityCount; ++p) {
+            if (!m_queues[p].empty() || m_running[p] > 0) {
+                idle = false;
+            }
+        }
+        if (idle || m_stopping) {
+            return;
+        }
+        m_wakeup.wait(&m_mutex);
+    }
+}
+
+bool JobScheduler::takeJob(PendingJob& job, Priority& priority)
+{
+    int workers = workerCount();
+    int nonInteractive = m_running[Export] + m_running[Background];
+    int reserved = m_reserveInteractive ? 1 : 0;
+
+    // A cancelled job, or one depending on a cancelled job, never runs: it
+    // is reported cancelled, which cancels its own dependents in turn
+    bool cancelled = false;
+    for (std::deque<PendingJob>& queue : m_queues) {
+        for (auto it = queue.begin(); it != queue.end();) {
+            bool dropped = it->promise.isCanceled() ||
+                           std::any_of(it->dependencies.cbegin(), it->dependencies.cend(),
+                                       [](const QFuture<void>& dependency) {
+                                           return dependency.isCanceled();
+                                       });
+            if (dropped) {
+                it->promise.cancel();
+                it->promise.reportFinished();
+                it = queue.erase(it);
+                cancelled = true;
+            } else {
+                ++it;
+            }
+        }
+    }
+    if (cancelled) {
+        // waitForDone() and the dependents of the dropped jobs re-check
+        m_wakeup.wakeAll();
+    }
+
+    for (int p = 0; p < PriorityCount; ++p) {
+        if (m_running[p] >= m_limits[p]) {
+            continue;
+        }
+        // One worker stays available for interactive jobs (unless the reservation is off)
+        if (p != Interactive && nonInteractive >= workers - reserved) {
+            continue;
+        }
+
+        std::deque<PendingJob>& queue = m_queues[p];
+        for (auto it = queue.begin(); it != queue.end(); ++it) {
+            bool ready = std::all_of(it->dependencies.cbegin(), it->dependencies.cend(),
+                                     [](const QFuture<void>& dependency) {
+                                         return dependency.isFinished();
+                                     });
+            if (ready) {
+                job = std::move(*it);
+                queue.erase(it);
+                priority = static_cast<Priority>(p);
+                ++m_running[p];
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+bool JobScheduler::runSubtask(int index)
+{
+    std::function<void()> subtask;
+    int count = workerCount();
+
+    // Own deque from the back (most recent, still in cache), others from the front
+    for (int offset = 0; offset < count && !subtask; ++offset) {
+        Worker& worker = *m_workers[(index + offset) % count];
+        QMutexLocker locker(&worker.mutex);
+        if (worker.subtasks.empty()) {
+            continue;
+        }
+        if (offset == 0) {
+            subtask = std::move(worker.subtasks.back());
+            worker.subtasks.pop_back();
+        } else {
+            subtask = std::move(worker.subtasks.front());
+            worker.subtasks.pop_front();
+        }
+    }
+
+    if (!subtask) {
+        return false;
+    }
+    subtask();
+    return true;
+}
+
+void JobScheduler::workerLoop(int index)
+{
+    t_workerIndex = index;
+
+    for (;;) {
+        quint64 epoch;
+        {
+            QMutexLocker locker(&m_mutex);
+            if (m_stopping) {
+                return;
+            }
+            epoch = m_subtaskEpoch;
+        }
+
+        // Sub-tasks first: they belong to jobs that are already running
+        if (runSubtask(index)) {
+            continue;
+        }
+
+        PendingJob pending;
+        Priority priority = Interactive;
+        {
+            QMutexLocker locker(&m_mutex);
+            if (m_stopping) {
+                return;
+            }
+            if (!takeJob(pending, priority)) {
+                // Sleep unless sub-tasks were pushed since the check above
+                if (epoch == m_subtaskEpoch) {
+                    m_wakeup.wait(&m_mutex);
+                }
+                continue;
+            }
+        }
+
+        double trace = spectral_trace_begin();
+        try {
+            pending.job();
+        } catch (const std::exception& e) {
+            qWarning() << "Exception in scheduled job:" << e.what();
+        } catch (...) {
+            qWarning() << "Unknown exception in scheduled job";
+        }
+        spectral_trace_end(nullptr, TRACE_JOB_NAMES[priority], trace, 0, 0);
+
+        pending.promise.reportFinished();
+
+        // The completion may free a slot or make dependent jobs ready
+        QMutexLocker locker(&m_mutex);
+        --m_running[priority];
+        m_wakeup.wakeAll();
+    }
+}
+
+void JobScheduler::parallelFor(int count, const std::function<void(int)>& body)
+{
+    if (count <= 0) {
+        return;
+    }
+    if (count == 1) {
+        body(0);
+        return;
+    }
+
+    int target = t_workerIndex;
+    if (target < 0) {
+        QMutexLocker locker(&m_mutex);
+        target = m_nextWorker;
+        m_nextWorker = (m_nextWorker + 1) % workerCount();
+    }
+
+    // The group lives on this stack frame: the loop below waits for every
+    // sub-task, and each one only touches the group under its mutex
+    SubtaskGroup group;
+    group.remaining = count;
+    {
+        Worker& worker = *m_workers[target];
+        QMutexLocker locker(&worker.mutex);
+        for (int i = 0; i < count; ++i) {
+            worker.subtasks.push_back([&body, &group, i]() {
+                body(i);
+                QMutexLocker groupLocker(&group.mutex);
+                if (--group.remaining == 0) {
+                    group.done.wakeAll();
+                }
+            });
+        }
+    }
+    {
+        QMutexLocker locker(&m_mutex);
+        ++m_subtaskEpoch;
+        m_wakeup.wakeAll();
+    }
+
+    // Help while there is work: run this group's sub-tasks, or any other one.
+    // Once every deque is empty, the rest of the group is running on other
+    // workers: sleep until the last of them finishes.
+    for (;;) {
+        {
+            QMutexLocker locker(&group.mutex);
+            if (group.remaining == 0) {
+                return;
+            }
+        }
+        if (!runSubtask(target)) {
+            QMutexLocker locker(&group.mutex);
+            if (group.remaining > 0) {
+                group.done.wait(&group.mutex);
+            }
+        }
+    }
+}
+
+void JobScheduler::runParallelFor(void *userData, int count,
+                                  void (*body)(void *arg, int index), void *arg)
+{
+    JobScheduler *scheduler = static_cast<JobScheduler*>(userData);
+    scheduler->parallelFor(count, [body, arg](int index) {
+        body(arg, index);
+    });
+}
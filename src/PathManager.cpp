@@ -9,6 +9,9 @@
 #include "../include/PathManager.h"
 #include <QCoreApplication>
 #include <QStandardPaths>
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QFileInfo>
 #include "../include/Constants.h"
 
 QString PathManager::getDefaultInputPath()
@@ -52,4 +55,34 @@ QString PathManager::getApplicationDir()
 QString PathManager::getResourcesDir()
 {
     return QDir::cleanPath(getApplicationDir() + QDir::separator() + "resources");
+}
+
+QString PathManager::getCacheDir(const QString& subFolder)
+{
+    QString cacheDir = QStandardPaths::writableLocation(QStandardPaths::CacheLocation);
+    if (cacheDir.isEmpty()) {
+        cacheDir = QDir::tempPath() + QDir::separator() + "Sp3ctraGen";
+    }
+    
+    if (!subFolder.isEmpty()) {
+        cacheDir = QDir::cleanPath(cacheDir + QDir::separator() + subFolder);
+    }
+    
+    QDir().mkpath(cacheDir);
+    return cacheDir;
+}
+
+QString PathManager::getCacheFilePath(const QString& sourcePath, const QString& subFolder, const QString& extension)
+{
+    QFileInfo fileInfo(sourcePath);
+    if (!fileInfo.exists()) {
+        return QString();
+    }
+    
+    QString key = fileInfo.absoluteFilePath() + "|" +
+                  QString::number(fileInfo.size()) + "|" +
+                  QString::number(fileInfo.lastModified().toMSecsSinceEpoch());
+    QByteArray hash = QCryptographicHash::hash(key.toUtf8(), QCryptographicHash::Sha1).toHex();
+    
+    return getCacheDir(subFolder) + QDir::separator() + QString::fromLatin1(hash) + "." + extension;
 }
\ No newline at end of file
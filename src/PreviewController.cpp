@@ -0,0 +1,176 @@
+/*
+ * Copyright (C) 2025 - present Ondulab
+ * All rights reserved.
+ *
+ * This software is licensed under terms that can be found in the LICENSE file
+ * in the root directory of this software component.
+ */
+
+#include "../include/PreviewController.h"
+#include <QDebug>
+#include <algorithm>
+
+namespace {
+// Bounds and steps of the adaptive draft size
+const double MIN_DRAFT_SCALE = 0.25;
+const double DRAFT_SHRINK = 0.75;
+const double DRAFT_GROW = 1.25;
+}
+
+PreviewController::PreviewController(QObject *parent)
+    : QObject(parent)
+    , m_pendingRequestTime(0)
+    , m_latestSerial(0)
+    , m_displayedSerial(0)
+    , m_displayedDraft(false)
+    , m_draftBudget(DEFAULT_DRAFT_BUDGET_MS)
+    , m_draftScale(1.0)
+    , m_lastLatencyMs(0.0)
+    , m_totalLatencyMs(0.0)
+    , m_maxLatencyMs(0.0)
+    , m_lastRefineLatencyMs(0.0)
+    , m_completedCount(0)
+    , m_coalescedCount(0)
+    , m_droppedCount(0)
+{
+    m_debounce.setSingleShot(true);
+    m_debounce.setInterval(DEFAULT_DEBOUNCE_MS);
+    connect(&m_debounce, &QTimer::timeout, this, &PreviewController::launchPending);
+    m_clock.start();
+}
+
+void PreviewController::request(Launch launch)
+{
+    // The previous request of the burst was never launched: it is simply replaced
+    if (m_pending) {
+        ++m_coalescedCount;
+    }
+    m_pending = std::move(launch);
+    m_pendingRequestTime = m_clock.elapsed();
+    m_debounce.start();
+}
+
+void PreviewController::flush()
+{
+    if (m_pending) {
+        m_debounce.stop();
+        launchPending();
+    }
+}
+
+void PreviewController::launchPending()
+{
+    if (!m_pending) {
+        return;
+    }
+
+    Launch launch = std::move(m_pending);
+    m_pending = nullptr;
+
+    quint64 serial = ++m_latestSerial;
+    m_requestTimes.insert(serial, m_pendingRequestTime);
+    launch(serial);
+}
+
+bool PreviewController::accept(quint64 serial, bool draft)
+{
+    // The refined image of the displayed draft replaces it
+    bool refinesDisplayed = serial == m_displayedSerial && m_displayedDraft && !draft;
+    if (serial < m_displayedSerial || (serial == m_displayedSerial && !refinesDisplayed)) {
+        m_requestTimes.remove(serial);
+        ++m_droppedCount;
+        qDebug() << "PreviewController: résultat obsolète ignoré" << serial
+                 << "(affiché:" << m_displayedSerial << ")";
+        emit metricsChanged();
+        return false;
+    }
+
+    // The request time is kept until the refined image of a draft arrives
+    qint64 requestTime = draft ? m_requestTimes.value(serial) : m_requestTimes.take(serial);
+    double latency = static_cast<double>(m_clock.elapsed() - requestTime);
+    m_displayedDraft = draft;
+
+    if (refinesDisplayed) {
+        m_lastRefineLatencyMs = latency;
+        emit metricsChanged();
+        return true;
+    }
+    m_displayedSerial = serial;
+
+    // Older serials can no longer be displayed: forget their request times
+    for (auto it = m_requestTimes.begin(); it != m_requestTimes.end(); ) {
+        it = it.key() < serial ? m_requestTimes.erase(it) : it + 1;
+    }
+
+    m_lastLatencyMs = latency;
+    m_totalLatencyMs += m_lastLatencyMs;
+    m_maxLatencyMs = std::max(m_maxLatencyMs, m_lastLatencyMs);
+    ++m_completedCount;
+
+    // The next drafts follow the budget (request → draft pixels)
+    if (draft) {
+        if (latency > m_draftBudget) {
+            m_draftScale = std::max(MIN_DRAFT_SCALE, m_draftScale * DRAFT_SHRINK);
+        } else if (latency < m_draftBudget / 2.0) {
+            m_draftScale = std::min(1.0, m_draftScale * DRAFT_GROW);
+        }
+    }
+
+    emit metricsChanged();
+    return true;
+}
+
+void PreviewController::setDebounceInterval(int milliseconds)
+{
+    milliseconds = std::max(0, milliseconds);
+    if (milliseconds == m_debounce.interval()) {
+        return;
+    }
+    m_debounce.setInterval(milliseconds);
+    emit debounceIntervalChanged();
+}
+
+void PreviewController::setViewportSize(const QSize &size)
+{
+    if (size == m_viewportSize) {
+        return;
+    }
+    m_viewportSize = size;
+    emit viewportSizeChanged();
+}
+
+void PreviewController::setDraftBudget(int milliseconds)
+{
+    milliseconds = std::max(1, milliseconds);
+    if (milliseconds == m_draftBudget) {
+        return;
+    }
+    m_draftBudget = milliseconds;
+    emit draftBudgetChanged();
+}
+
+QSize PreviewController::draftSize() const
+{
+    if (m_viewportSize.isEmpty()) {
+        return QSize();
+    }
+    return QSize(std::max(1, static_cast<int>(m_viewportSize.width() * m_draftScale)),
+                 std::max(1, static_cast<int>(m_viewportSize.height() * m_draftScale)));
+}
+
+double PreviewController::averageLatencyMs() const
+{
+    return m_completedCount > 0 ? m_totalLatencyMs / m_completedCount : 0.0;
+}
+
+void PreviewController::resetMetrics()
+{
+    m_lastLatencyMs = 0.0;
+    m_totalLatencyMs = 0.0;
+    m_maxLatencyMs = 0.0;
+    m_lastRefineLatencyMs = 0.0;
+    m_completedCount = 0;
+    m_coalescedCount = 0;
+    m_droppedCount = 0;
+    emit metricsChanged();
+}
@@ -5,7 +5,8 @@
 extern "C" {
     int spectral_generator_impl(const SpectrogramSettings *cfg,
                                const char *inputFile,
-                               const char *outputFile);
+                               const char *outputFile,
+                               SpectralJob *job);
 }
 
 RasterVisualizationStrategy::RasterVisualizationStrategy(QObject *parent)
@@ -16,10 +17,11 @@ RasterVisualizationStrategy::RasterVisualizationStrategy(QObject *parent)
 
 int RasterVisualizationStrategy::callGeneratorFunction(const SpectrogramSettings& settings,
                                                      const char* inputFile,
-                                                     const char* outputFile)
+                                                     const char* outputFile,
+                                                     SpectralJob* job)
 {
     qDebug() << "Appel de spectral_generator_impl pour la génération du spectrogramme raster";
-    return spectral_generator_impl(&settings, inputFile, outputFile);
+    return spectral_generator_impl(&settings, inputFile, outputFile, job);
 }
 
 QString RasterVisualizationStrategy::getName() const
@@ -8,6 +8,7 @@
 
 #include "../include/SpectrogramParametersModel.h"
 #include "../include/SharedConstants.h"
+#include "../include/TaskManager.h"
 #include <QtMath>
 #include <QDebug>
 
@@ -52,6 +53,12 @@ SpectrogramParametersModel::SpectrogramParametersModel(QObject *parent)
 {
     // Initial calculation of derived values
     recalculateDerivedValues();
+    
+    // Le plan suit les paramètres et le modèle de coût calibré
+    connect(this, &SpectrogramParametersModel::parametersChanged,
+            this, &SpectrogramParametersModel::generationPlanChanged);
+    connect(TaskManager::getInstance(), &TaskManager::costModelChanged,
+            this, &SpectrogramParametersModel::generationPlanChanged);
 }
 
 SpectrogramParametersModel::~SpectrogramParametersModel()
@@ -171,6 +178,15 @@ double SpectrogramParametersModel::calculateMaxBps(double writingSpeed)
     return maxBps;
 }
 
+QVariantMap SpectrogramParametersModel::planForFile(const QString &inputFile)
+{
+    // Sans fichier, le plan porte sur la durée demandée (une page à la vitesse d'écriture)
+    SpectralPlan plan;
+    TaskManager* taskManager = TaskManager::getInstance();
+    bool valid = taskManager->planGeneration(toCStruct(), inputFile, &plan);
+    return taskManager->planMap(plan, valid);
+}
+
 SpectrogramSettings SpectrogramParametersModel::toCStruct() const
 {
     // Convert the C++ model to the C structure
@@ -213,6 +229,10 @@ SpectrogramSettings SpectrogramParametersModel::toCStruct() const
     settings.binsPerSecond = m_cachedBps;
     settings.overlapPreset = m_overlapPreset;
     settings.fftSize = m_cachedFftSize; // Transmettre la taille FFT calculée
+    settings.inputGain = 1.0;
+    settings.pdfEmbedImage = 0;
+    settings.paginate = 0;
+    settings.analysisEngine = SPECTRAL_ENGINE_FFT;
     
     return settings;
 }
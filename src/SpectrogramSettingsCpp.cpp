@@ -42,6 +42,10 @@ SpectrogramSettingsCpp::SpectrogramSettingsCpp()
     , m_resolutionSliderValue(0.5) // Valeur initiale du curseur: Balanced
     , m_isResolutionLimited(false) // Pas de limitation initialement
     , m_fftSize(0) // 0 signifie calcul automatique
+    , m_inputGain(1.0) // Gain virtuel (1.0 = signal inchangé)
+    , m_pdfEmbedImage(false) // PDF entièrement vectoriel par défaut
+    , m_paginate(false) // Première page seulement par défaut
+    , m_analysisEngine(SPECTRAL_ENGINE_FFT) // Moteur FFT par défaut
 {
 }
 
@@ -112,6 +116,10 @@ SpectrogramSettings SpectrogramSettingsCpp::toCStruct() const
     cSettings.binsPerSecond = m_binsPerSecond;
     cSettings.overlapPreset = m_overlapPreset;
     cSettings.fftSize = m_fftSize; // Transfert de la taille FFT calculée
+    cSettings.inputGain = m_inputGain;
+    cSettings.pdfEmbedImage = m_pdfEmbedImage ? 1 : 0;
+    cSettings.paginate = m_paginate ? 1 : 0;
+    cSettings.analysisEngine = m_analysisEngine;
     return cSettings;
 }
 
@@ -148,6 +156,11 @@ SpectrogramSettingsCpp SpectrogramSettingsCpp::fromCStruct(const SpectrogramSett
     settings.m_binsPerSecond = cSettings.binsPerSecond;
     settings.m_overlapPreset = cSettings.overlapPreset;
     settings.m_fftSize = cSettings.fftSize; // Récupération de la taille FFT
+    settings.m_inputGain = cSettings.inputGain > 0.0 ? cSettings.inputGain : 1.0;
+    settings.m_pdfEmbedImage = cSettings.pdfEmbedImage == 1;
+    settings.m_paginate = cSettings.paginate == 1;
+    settings.m_analysisEngine = cSettings.analysisEngine == SPECTRAL_ENGINE_CONSTANT_Q ?
+        SPECTRAL_ENGINE_CONSTANT_Q : SPECTRAL_ENGINE_FFT;
     return settings;
 }
 
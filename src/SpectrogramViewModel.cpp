@@ -7,8 +7,10 @@
  */
 
 #include "../include/SpectrogramViewModel.h"
+#include "../include/TaskManager.h"
 #include <QDebug>
 #include <QUuid>
+#include <QtMath>
 
 SpectrogramViewModel::SpectrogramViewModel(QObject *parent)
     : QObject(parent)
@@ -29,6 +31,10 @@ SpectrogramViewModel::SpectrogramViewModel(QObject *parent)
     
     // Connect signals
     connectSignals();
+    
+    // Les compteurs viennent de toutes les générations, quel que soit le générateur
+    connect(TaskManager::getInstance(), &TaskManager::jobStatsCollected,
+            this, &SpectrogramViewModel::onJobStatsCollected);
 }
 
 SpectrogramViewModel::~SpectrogramViewModel()
@@ -405,10 +411,14 @@ void SpectrogramViewModel::onPreviewSaved(bool success, const QString &outputPat
     emit previewSaved(success, outputPath, format, errorMessage);
 }
 
-void SpectrogramViewModel::onTaskProgressUpdated(const QUuid &taskId, int progress, const QString &message)
+void SpectrogramViewModel::onTaskProgressUpdated(const QUuid &taskId, int progress, const QString &message, double etaSeconds)
 {
     Q_UNUSED(taskId);
-    m_statusMessage = message + " (" + QString::number(progress) + "%)";
+    m_statusMessage = message + " (" + QString::number(progress) + "%";
+    if (etaSeconds > 0.0) {
+        m_statusMessage += ", ~" + QString::number(qCeil(etaSeconds)) + " s restantes";
+    }
+    m_statusMessage += ")";
     emit statusMessageChanged();
     
     // Forward signal to QML
@@ -423,3 +433,9 @@ void SpectrogramViewModel::onFftParametersCalculated(int calculatedFftSize, doub
              << ", overlap=" << effectiveOverlap 
              << ", bps=" << binsPerSecond;
 }
+
+void SpectrogramViewModel::onJobStatsCollected(const QVariantMap &stats)
+{
+    m_generationStats = stats;
+    emit generationStatsChanged();
+}
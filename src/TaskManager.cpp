@@ -7,8 +7,41 @@
  */
 
 #include "../include/TaskManager.h"
+#include "../include/Constants.h"
 #include <QDebug>
-#include <QtConcurrent/QtConcurrent>
+#include <QLoggingCategory>
+
+namespace {
+// Catégories Qt des messages du noyau C, filtrables par QT_LOGGING_RULES
+// (par ex. "sp3ctragen.audio.debug=false")
+Q_LOGGING_CATEGORY(lcSpectralCore, "sp3ctragen.core")
+Q_LOGGING_CATEGORY(lcSpectralAudio, "sp3ctragen.audio")
+Q_LOGGING_CATEGORY(lcSpectralAnalyze, "sp3ctragen.analyze")
+Q_LOGGING_CATEGORY(lcSpectralFft, "sp3ctragen.fft")
+Q_LOGGING_CATEGORY(lcSpectralRaster, "sp3ctragen.raster")
+Q_LOGGING_CATEGORY(lcSpectralVector, "sp3ctragen.vector")
+Q_LOGGING_CATEGORY(lcSpectralJob, "sp3ctragen.job")
+
+typedef const QLoggingCategory& (*LogCategory)();
+
+LogCategory spectralLogCategory(const char *category)
+{
+    static const struct { const char *name; LogCategory category; } categories[] = {
+        {"audio", &lcSpectralAudio},
+        {"analyze", &lcSpectralAnalyze},
+        {"fft", &lcSpectralFft},
+        {"raster", &lcSpectralRaster},
+        {"vector", &lcSpectralVector},
+        {"job", &lcSpectralJob},
+    };
+    for (const auto& entry : categories) {
+        if (qstrcmp(category, entry.name) == 0) {
+            return entry.category;
+        }
+    }
+    return &lcSpectralCore;
+}
+}
 
 // Initialization of the static instance
 TaskManager* TaskManager::s_instance = nullptr;
@@ -23,31 +56,77 @@ TaskManager* TaskManager::getInstance()
 
 TaskManager::TaskManager(QObject *parent)
     : QObject(parent)
+    , m_progressInterval(SPECTRAL_DEFAULT_PROGRESS_INTERVAL)
+    , m_planCache(spectral_plan_cache_create())
+    , m_memoryBudget(Constants::MEMORY_BUDGET)
+    , m_timeBudget(Constants::TIME_BUDGET)
 {
+    spectral_cost_model_init(&m_costModel);
 }
 
 TaskManager::~TaskManager()
 {
     // Cancel all running tasks
     cancelAllTasks();
+    
+    // Cancelled generations stop at their next poll point; wait for them
+    // before releasing the plans they may still be using
+    JobScheduler::getInstance()->waitForDone();
+    spectral_plan_cache_destroy(m_planCache);
 }
 
 QUuid TaskManager::runTask(std::function<void(ProgressCallback)> task, 
-                         TaskCallback callback)
+                         TaskCallback callback,
+                         JobScheduler::Priority priority)
+{
+    return runCancellableTask([task](SpectralJob*, ProgressCallback progressCallback) {
+        task(progressCallback);
+    }, callback, 0.0, priority);
+}
+
+QUuid TaskManager::runCancellableTask(CancellableTask task,
+                                      TaskCallback callback,
+                                      double timeoutSeconds,
+                                      JobScheduler::Priority priority)
 {
     // Generate a unique identifier for the task
     QUuid taskId = QUuid::createUuid();
     
+    // The job outlives the task entry: the thread keeps its own reference
+    std::shared_ptr<SpectralJob> job = std::make_shared<SpectralJob>();
+    spectral_job_init(job.get(), timeoutSeconds);
+    prepareJob(job.get());
+    
     // Create a watcher to track the task
     QFutureWatcher<void>* watcher = new QFutureWatcher<void>(this);
     
-    // Create a progress function that emits the appropriate signal
-    ProgressCallback progressCallback = [this, taskId](int progress, const QString& message) {
-        emit taskProgressUpdated(taskId, progress, message);
+    // Create a progress function that emits the appropriate signal, with an ETA
+    // extrapolated from the time elapsed since the task started
+    std::shared_ptr<QElapsedTimer> timer = std::make_shared<QElapsedTimer>();
+    timer->start();
+    ProgressCallback progressCallback = [this, taskId, timer](int progress, const QString& message) {
+        double etaSeconds = -1.0;
+        if (progress > 0 && progress < 100) {
+            double elapsed = timer->elapsed() / 1000.0;
+            etaSeconds = elapsed * (100 - progress) / progress;
+        } else if (progress >= 100) {
+            etaSeconds = 0.0;
+        }
+        emit taskProgressUpdated(taskId, progress, message, etaSeconds);
     };
     
+    // The C job reports its stages through the same callback; the thread owns the copy
+    std::shared_ptr<ProgressCallback> jobProgress = std::make_shared<ProgressCallback>(progressCallback);
+    spectral_job_set_progress(job.get(), &TaskManager::forwardJobProgress, jobProgress.get(),
+                              m_progressInterval);
+    
     // Connect the watcher signals
     connect(watcher, &QFutureWatcher<void>::finished, this, [this, taskId, watcher, callback]() {
+        // A cancelled task has already been reported and removed
+        if (!m_tasks.contains(taskId)) {
+            return;
+        }
+        
         // Call the callback function
         if (callback) {
             callback(true, "Task completed successfully");
@@ -66,12 +145,13 @@ QUuid TaskManager::runTask(std::function<void(ProgressCallback)> task,
     taskInfo.watcher = watcher;
     taskInfo.callback = callback;
     taskInfo.progressCallback = progressCallback;
+    taskInfo.job = job;
     m_tasks[taskId] = taskInfo;
     
     // Start the task
-    QFuture<void> future = QtConcurrent::run([task, progressCallback]() {
+    QFuture<void> future = JobScheduler::getInstance()->schedule(priority, [task, progressCallback, job, jobProgress]() {
         try {
-            task(progressCallback);
+            task(job.get(), progressCallback);
         } catch (const std::exception& e) {
             qWarning() << "Exception in task:" << e.what();
         } catch (...) {
@@ -97,7 +177,9 @@ bool TaskManager::cancelTask(const QUuid& taskId)
     
     TaskInfo taskInfo = m_tasks[taskId];
     
-    // Cancel the task
+    // Ask the running generation to stop at its next poll point
+    // (QFutureWatcher::cancel() alone has no effect on a running job)
+    spectral_job_cancel(taskInfo.job.get());
     taskInfo.watcher->cancel();
     
     // Call the callback function with a failure status
@@ -134,4 +216,177 @@ bool TaskManager::isTaskRunning(const QUuid& taskId) const
 int TaskManager::runningTaskCount() const
 {
     return m_tasks.size();
+}
+
+void TaskManager::setProgressInterval(double seconds)
+{
+    m_progressInterval = seconds > 0.0 ? seconds : SPECTRAL_DEFAULT_PROGRESS_INTERVAL;
+}
+
+void TaskManager::prepareJob(SpectralJob* job)
+{
+    spectral_job_set_plan_cache(job, m_planCache);
+    spectral_job_set_parallel_for(job, &JobScheduler::runParallelFor, JobScheduler::getInstance());
+    spectral_job_set_logger(job, &TaskManager::forwardJobLog, nullptr);
+    
+    SpectralCostModel model = costModel();
+    spectral_job_set_budget(job, m_memoryBudget, m_timeBudget, &model);
+}
+
+void TaskManager::setBudgets(qint64 memoryBytes, double seconds)
+{
+    m_memoryBudget = memoryBytes > 0 ? memoryBytes : 0;
+    m_timeBudget = seconds > 0.0 ? seconds : 0.0;
+    emit costModelChanged();
+}
+
+SpectralCostModel TaskManager::costModel() const
+{
+    QMutexLocker locker(&m_costMutex);
+    return m_costModel;
+}
+
+bool TaskManager::planGeneration(const SpectrogramSettings& settings, const QString& inputFile,
+                                 SpectralPlan* plan) const
+{
+    SpectralCostModel model = costModel();
+    if (inputFile.isEmpty()) {
+        return spectral_plan(&settings, 0.0, 0, &model, plan) == EXIT_SUCCESS;
+    }
+    QByteArray inputFileBytes = inputFile.toLocal8Bit();
+    return spectral_plan_file(&settings, inputFileBytes.constData(), &model, plan) == EXIT_SUCCESS;
+}
+
+bool TaskManager::withinBudget(const SpectralPlan& plan, QString* reason) const
+{
+    if (spectral_plan_within_budget(&plan, m_memoryBudget, m_timeBudget)) {
+        return true;
+    }
+    if (reason) {
+        *reason = QString("Generation refused: about %1 MB and %2 s needed (budget: %3 MB, %4 s)")
+                      .arg(plan.peakBytes / (1024 * 1024))
+                      .arg(plan.estimatedSeconds, 0, 'f', 1)
+                      .arg(m_memoryBudget / (1024 * 1024))
+                      .arg(m_timeBudget, 0, 'f', 1);
+    }
+    return false;
+}
+
+void TaskManager::calibrateCostModel(const SpectrogramSettings& settings, const QString& inputFile,
+                                     const SpectralJobStats& stats)
+{
+    SpectralPlan plan;
+    if (!planGeneration(settings, inputFile, &plan)) {
+        return;
+    }
+    
+    {
+        QMutexLocker locker(&m_costMutex);
+        spectral_cost_model_update(&m_costModel, &plan, &stats);
+    }
+    
+    // Les estimations affichées suivent le modèle recalibré
+    QMetaObject::invokeMethod(this, &TaskManager::costModelChanged, Qt::QueuedConnection);
+}
+
+QVariantMap TaskManager::planMap(const SpectralPlan& plan, bool valid) const
+{
+    QVariantMap map;
+    map["valid"] = valid;
+    if (!valid) {
+        return map;
+    }
+    map["sampleCount"] = plan.sampleCount;
+    map["contextSamples"] = plan.contextSamples;
+    map["windows"] = plan.windows;
+    map["windowsPerPage"] = plan.windowsPerPage;
+    map["fftSize"] = plan.fftSize;
+    map["paddedFftSize"] = plan.paddedFftSize;
+    map["hopSize"] = plan.hopSize;
+    map["binMin"] = plan.binMin;
+    map["binMax"] = plan.binMax;
+    map["bins"] = plan.bins;
+    map["pages"] = plan.pages;
+    map["canvasWidth"] = plan.canvasWidth;
+    map["canvasHeight"] = plan.canvasHeight;
+    map["signalBytes"] = plan.signalBytes;
+    map["matrixBytes"] = plan.matrixBytes;
+    map["kernelBytes"] = plan.kernelBytes;
+    map["canvasBytes"] = plan.canvasBytes;
+    map["peakBytes"] = plan.peakBytes;
+    map["estimatedSeconds"] = plan.estimatedSeconds;
+    map["withinBudget"] = withinBudget(plan);
+    return map;
+}
+
+void TaskManager::publishJobStats(const SpectralJob* job)
+{
+    if (!job) {
+        return;
+    }
+    
+    // Les receveurs du thread de l'interface reçoivent le signal en file d'attente
+    emit jobStatsCollected(jobStatsMap(job->stats));
+}
+
+QVariantMap TaskManager::jobStatsMap(const SpectralJobStats& stats)
+{
+    static const char *const stageKeys[SPECTRAL_STAGE_COUNT] = {
+        "decode", "filter", "fft", "tone_map", "raster", "encode"
+    };
+    
+    QVariantMap map;
+    map["fftCount"] = stats.fftCount;
+    map["bytesDecoded"] = stats.bytesDecoded;
+    map["peakAllocatedBytes"] = stats.peakAllocatedBytes;
+    map["planCacheHits"] = stats.planCacheHits;
+    map["planCacheMisses"] = stats.planCacheMisses;
+    map["vectorRects"] = stats.vectorRects;
+    map["vectorFills"] = stats.vectorFills;
+    long long lookups = stats.planCacheHits + stats.planCacheMisses;
+    map["planCacheHitRate"] = lookups > 0 ? static_cast<double>(stats.planCacheHits) / lookups : 0.0;
+    
+    QVariantList stages;
+    double wallMs = 0.0;
+    double cpuMs = 0.0;
+    for (int stage = 0; stage < SPECTRAL_STAGE_COUNT; ++stage) {
+        if (stats.stageWallUs[stage] <= 0) {
+            continue;
+        }
+        QVariantMap entry;
+        entry["stage"] = QString::fromLatin1(stageKeys[stage]);
+        entry["label"] = QString::fromUtf8(spectral_stage_name(static_cast<SpectralStage>(stage)));
+        entry["wallMs"] = stats.stageWallUs[stage] / 1000.0;
+        entry["cpuMs"] = stats.stageCpuUs[stage] / 1000.0;
+        stages.append(entry);
+        wallMs += stats.stageWallUs[stage] / 1000.0;
+        cpuMs += stats.stageCpuUs[stage] / 1000.0;
+    }
+    map["stages"] = stages;
+    map["wallMs"] = wallMs;
+    map["cpuMs"] = cpuMs;
+    return map;
+}
+
+void TaskManager::forwardJobLog(void *userData, SpectralLogLevel level,
+                                const char *category, const char *message)
+{
+    Q_UNUSED(userData);
+    LogCategory logCategory = spectralLogCategory(category);
+    if (level >= SPECTRAL_LOG_WARNING) {
+        qCWarning(logCategory).noquote() << message;
+    } else if (level == SPECTRAL_LOG_INFO) {
+        qCInfo(logCategory).noquote() << message;
+    } else {
+        qCDebug(logCategory).noquote() << message;
+    }
+}
+
+void TaskManager::forwardJobProgress(void *userData, SpectralStage stage,
+                                     double stageFraction, double overallFraction)
+{
+    Q_UNUSED(stageFraction);
+    const ProgressCallback& progressCallback = *static_cast<ProgressCallback*>(userData);
+    progressCallback(static_cast<int>(overallFraction * 100.0),
+                     QString::fromUtf8(spectral_stage_name(stage)) + "...");
 }
\ No newline at end of file
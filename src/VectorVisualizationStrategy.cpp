@@ -6,7 +6,8 @@ extern "C" {
     int spectral_generator_vector_pdf_impl(const SpectrogramSettings *cfg,
                                           const char *inputFile,
                                           const char *outputFile,
-                                          int dpi);
+                                          int dpi,
+                                          SpectralJob *job);
 }
 
 VectorVisualizationStrategy::VectorVisualizationStrategy(QObject *parent)
@@ -44,9 +45,10 @@ int VectorVisualizationStrategy::getDpi() const
 
 int VectorVisualizationStrategy::callGeneratorFunction(const SpectrogramSettings& settings,
                                                      const char* inputFile,
-                                                     const char* outputFile)
+                                                     const char* outputFile,
+                                                     SpectralJob* job)
 {
     qDebug() << "Appel de spectral_generator_vector_pdf_impl pour la génération du PDF vectoriel";
     qDebug() << "Résolution: " << m_dpi << " DPI";
-    return spectral_generator_vector_pdf_impl(&settings, inputFile, outputFile, m_dpi);
+    return spectral_generator_vector_pdf_impl(&settings, inputFile, outputFile, m_dpi, job);
 }
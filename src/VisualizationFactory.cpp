@@ -93,4 +93,4 @@ QStringList VisualizationFactory::getSupportedExtensions() const
     extensions.removeDuplicates();
     
     return extensions;
-}
\ No newline at end of file
+}
@@ -8,15 +8,51 @@
 
 #include "../include/VisualizationStrategy.h"
 #include "../include/FileManager.h"
+#include "../include/TaskManager.h"
 #include <QDebug>
 #include <QFuture>
-#include <QtConcurrent/QtConcurrent>
+
+namespace {
+// Forwards the stages reported by the C job as progressUpdated() signals
+void forwardJobProgress(void *userData, SpectralStage stage, double, double overallFraction)
+{
+    VisualizationStrategy *strategy = static_cast<VisualizationStrategy*>(userData);
+    emit strategy->progressUpdated(static_cast<int>(overallFraction * 100.0),
+                                   QString::fromUtf8(spectral_stage_name(stage)) + "...");
+}
+}
 
 VisualizationStrategy::VisualizationStrategy(QObject *parent)
     : QObject(parent)
 {
 }
 
+VisualizationStrategy::~VisualizationStrategy()
+{
+    // The threads reference this object: they must be gone before it is
+    cancel();
+    for (RunningGeneration& generation : m_running) {
+        generation.future.waitForFinished();
+    }
+}
+
+void VisualizationStrategy::cancel()
+{
+    for (RunningGeneration& generation : m_running) {
+        spectral_job_cancel(generation.job.get());
+    }
+}
+
+bool VisualizationStrategy::isRunning() const
+{
+    for (const RunningGeneration& generation : m_running) {
+        if (generation.future.isRunning()) {
+            return true;
+        }
+    }
+    return false;
+}
+
 bool VisualizationStrategy::generate(const SpectrogramSettingsCpp& settings, 
                                    const QString& inputFile,
                                    const QString& outputFile)
@@ -37,17 +73,40 @@ bool VisualizationStrategy::generate(const SpectrogramSettingsCpp& settings,
     // Convert parameters to C structure
     SpectrogramSettings cSettings = settings.toCStruct();
     
-    // Execute generation in a separate thread
-    QFuture<void> future = QtConcurrent::run([=]() {
-        this->runGeneration(cSettings, inputFile, outputFile);
+    // Execute generation on the scheduler (export class), keeping its future and job for cancel()
+    RunningGeneration generation = startGeneration();
+    std::shared_ptr<SpectralJob> job = generation.job;
+    generation.future = JobScheduler::getInstance()->schedule(JobScheduler::Export, [=]() {
+        this->runGeneration(cSettings, inputFile, outputFile, job.get());
     });
+    m_running.append(generation);
     
     return true;
 }
 
+VisualizationStrategy::RunningGeneration VisualizationStrategy::startGeneration()
+{
+    // Forget the generations that are over
+    for (int i = m_running.size() - 1; i >= 0; --i) {
+        if (m_running[i].future.isFinished()) {
+            m_running.removeAt(i);
+        }
+    }
+    
+    RunningGeneration generation;
+    generation.job = std::make_shared<SpectralJob>();
+    spectral_job_init(generation.job.get(), 0.0);
+    TaskManager::getInstance()->prepareJob(generation.job.get());
+    // The destructor waits for the thread, so the strategy outlives the callback
+    spectral_job_set_progress(generation.job.get(), forwardJobProgress, this,
+                              SPECTRAL_DEFAULT_PROGRESS_INTERVAL);
+    return generation;
+}
+
 void VisualizationStrategy::runGeneration(const SpectrogramSettings& settings,
                                         const QString& inputFile,
-                                        const QString& outputFile)
+                                        const QString& outputFile,
+                                        SpectralJob* job)
 {
     // Add detailed logs
     qDebug() << "Generating spectrogram with strategy: " << getName();
@@ -57,7 +116,7 @@ void VisualizationStrategy::runGeneration(const SpectrogramSettings& settings,
     qDebug() << "Overlap preset: " << (settings.overlapPreset == 0 ? "Low" :
                                      settings.overlapPreset == 2 ? "High" : "Medium");
     
-    emit progressUpdated(10, "Preparing generation...");
+    emit progressUpdated(0, "Preparing generation...");
     
     // Convert QString to const char* for C API
     QByteArray inputFileBytes = inputFile.toLocal8Bit();
@@ -66,21 +125,43 @@ void VisualizationStrategy::runGeneration(const SpectrogramSettings& settings,
     const char *inputFileCStr = inputFileBytes.constData();
     const char *outputFileCStr = outputFileBytes.constData();
     
-    emit progressUpdated(20, "Generating spectrogram...");
-    
-    // Call the strategy-specific C function
-    int result = callGeneratorFunction(settings, inputFileCStr, outputFileCStr);
+    // Call the strategy-specific C function (it reports its own stages)
+    int result = callGeneratorFunction(settings, inputFileCStr, outputFileCStr, job);
+    if (result == EXIT_SUCCESS) {
+        TaskManager::getInstance()->publishJobStats(job);
+        // The plans model the PNG render: the vector renders do not calibrate them
+        if (getSupportedExtensions().contains("png")) {
+            TaskManager::getInstance()->calibrateCostModel(settings, inputFile, job->stats);
+        }
+    }
     
-    emit progressUpdated(90, "Finalizing...");
+    reportResult(result, outputFile);
+}
+
+void VisualizationStrategy::reportResult(int result, const QString& outputFile)
+{
+    if (result == SPECTRAL_CANCELLED) {
+        qDebug() << "Generation cancelled: " << outputFile;
+        emit generationCompleted(false, "", "Generation cancelled");
+        return;
+    }
     
     // Emit signal with the result
     if (result == EXIT_SUCCESS) {
         qDebug() << "Spectrogram successfully generated at: " << outputFile;
-        // Check that the file exists
-        if (QFile::exists(outputFile)) {
+        // Check that the file exists (a paginated PNG is written as numbered pages)
+        QString producedFile = outputFile;
+        if (!QFile::exists(producedFile)) {
+            char firstPage[SPECTRAL_PATH_MAX];
+            QByteArray outputFileBytes = outputFile.toLocal8Bit();
+            if (spectral_page_file_name(outputFileBytes.constData(), 1, firstPage, sizeof(firstPage)) == 0) {
+                producedFile = QString::fromLocal8Bit(firstPage);
+            }
+        }
+        if (QFile::exists(producedFile)) {
             qDebug() << "Output file exists, emitting success signal";
             emit progressUpdated(100, "Generation completed successfully");
-            emit generationCompleted(true, outputFile);
+            emit generationCompleted(true, producedFile);
         } else {
             qWarning() << "Output file does not exist: " << outputFile;
             emit generationCompleted(false, "", "Output file was not created");
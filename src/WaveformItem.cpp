@@ -0,0 +1,288 @@
+/*
+ * Copyright (C) 2025 - present Ondulab
+ * All rights reserved.
+ *
+ * This software is licensed under terms that can be found in the LICENSE file
+ * in the root directory of this software component.
+ */
+
+#include "../include/WaveformItem.h"
+#include <QSGFlatColorMaterial>
+#include <QSGGeometryNode>
+#include <QSGNode>
+#include <algorithm>
+
+namespace {
+// Child nodes of the root, in drawing order
+enum NodeIndex {
+    FillNode = 0,
+    UpperNode,
+    LowerNode,
+    RmsNode,
+    CursorNode,
+    NodeCount
+};
+
+const double AMPLITUDE_SCALE = 0.9; // 90% de la demi-hauteur, comme l'ancien Canvas
+const float CURSOR_WIDTH = 2.0f;
+
+QSGGeometryNode *createNode(QSGGeometry::DrawingMode mode)
+{
+    QSGGeometry *geometry = new QSGGeometry(QSGGeometry::defaultAttributes_Point2D(), 0);
+    geometry->setDrawingMode(mode);
+    geometry->setLineWidth(1.0f);
+    geometry->setVertexDataPattern(QSGGeometry::DynamicPattern);
+
+    QSGGeometryNode *node = new QSGGeometryNode();
+    node->setGeometry(geometry);
+    node->setMaterial(new QSGFlatColorMaterial());
+    node->setFlags(QSGNode::OwnsGeometry | QSGNode::OwnsMaterial);
+    return node;
+}
+
+// Reallocates only when the vertex count changes; otherwise the buffer is rewritten in place
+QSGGeometry::Point2D *prepareVertices(QSGGeometryNode *node, int vertexCount)
+{
+    QSGGeometry *geometry = node->geometry();
+    if (geometry->vertexCount() != vertexCount) {
+        geometry->allocate(vertexCount);
+    }
+    node->markDirty(QSGNode::DirtyGeometry);
+    return geometry->vertexDataAsPoint2D();
+}
+
+void setNodeColor(QSGGeometryNode *node, const QColor &color)
+{
+    QSGFlatColorMaterial *material = static_cast<QSGFlatColorMaterial *>(node->material());
+    if (material->color() != color) {
+        material->setColor(color);
+        node->markDirty(QSGNode::DirtyMaterial);
+    }
+}
+
+QColor withAlpha(const QColor &color, double alpha)
+{
+    QColor result = color;
+    result.setAlphaF(color.alphaF() * alpha);
+    return result;
+}
+}
+
+WaveformItem::WaveformItem(QQuickItem *parent)
+    : QQuickItem(parent)
+    , m_startRatio(0.0)
+    , m_endRatio(1.0)
+    , m_color(Qt::white)
+    , m_cursorPosition(-1.0)
+    , m_cursorColor(Qt::white)
+    , m_hasData(false)
+    , m_columns(0)
+    , m_waveformDirty(true)
+    , m_colorDirty(true)
+    , m_cursorDirty(true)
+{
+    setFlag(ItemHasContents, true);
+}
+
+void WaveformItem::setProvider(WaveformProvider *provider)
+{
+    if (m_provider == provider) {
+        return;
+    }
+
+    if (m_provider) {
+        disconnect(m_provider, nullptr, this, nullptr);
+    }
+    m_provider = provider;
+    if (m_provider) {
+        connect(m_provider, &WaveformProvider::waveformChanged, this, &WaveformItem::onWaveformChanged);
+    }
+
+    emit providerChanged();
+    polish();
+}
+
+void WaveformItem::setStartRatio(double ratio)
+{
+    ratio = std::clamp(ratio, 0.0, 1.0);
+    if (ratio == m_startRatio) {
+        return;
+    }
+    m_startRatio = ratio;
+    emit viewWindowChanged();
+    polish();
+}
+
+void WaveformItem::setEndRatio(double ratio)
+{
+    ratio = std::clamp(ratio, 0.0, 1.0);
+    if (ratio == m_endRatio) {
+        return;
+    }
+    m_endRatio = ratio;
+    emit viewWindowChanged();
+    polish();
+}
+
+void WaveformItem::setColor(const QColor &color)
+{
+    if (color == m_color) {
+        return;
+    }
+    m_color = color;
+    m_colorDirty = true;
+    emit colorChanged();
+    update();
+}
+
+void WaveformItem::setCursorPosition(double position)
+{
+    if (position == m_cursorPosition) {
+        return;
+    }
+    m_cursorPosition = position;
+    m_cursorDirty = true;
+    emit cursorPositionChanged();
+    update();
+}
+
+void WaveformItem::setCursorColor(const QColor &color)
+{
+    if (color == m_cursorColor) {
+        return;
+    }
+    m_cursorColor = color;
+    m_colorDirty = true;
+    emit cursorColorChanged();
+    update();
+}
+
+void WaveformItem::onWaveformChanged()
+{
+    // Progress signals may arrive many times per frame: polish() runs once per frame
+    polish();
+}
+
+#if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
+void WaveformItem::geometryChange(const QRectF &newGeometry, const QRectF &oldGeometry)
+{
+    QQuickItem::geometryChange(newGeometry, oldGeometry);
+#else
+void WaveformItem::geometryChanged(const QRectF &newGeometry, const QRectF &oldGeometry)
+{
+    QQuickItem::geometryChanged(newGeometry, oldGeometry);
+#endif
+    if (newGeometry.size() != oldGeometry.size()) {
+        m_cursorDirty = true;
+        polish();
+    }
+}
+
+void WaveformItem::updatePolish()
+{
+    // One column per logical pixel; buffers only grow, so steady redraws don't allocate
+    int columns = std::max(0, static_cast<int>(width()));
+    if (static_cast<int>(m_min.size()) < columns) {
+        m_min.resize(columns);
+        m_max.resize(columns);
+        m_rms.resize(columns);
+    }
+
+    bool hasData = m_provider && columns > 0 &&
+                   m_provider->summarizeWindow(m_startRatio, m_endRatio, columns,
+                                               m_min.data(), m_max.data(), m_rms.data());
+    m_columns = hasData ? columns : 0;
+    m_waveformDirty = true;
+
+    if (hasData != m_hasData) {
+        m_hasData = hasData;
+        emit hasDataChanged();
+    }
+
+    update();
+}
+
+QSGNode *WaveformItem::updatePaintNode(QSGNode *oldNode, UpdatePaintNodeData *)
+{
+    QSGNode *root = oldNode;
+    if (!root) {
+        root = new QSGNode();
+        root->appendChildNode(createNode(QSGGeometry::DrawTriangleStrip)); // FillNode
+        root->appendChildNode(createNode(QSGGeometry::DrawLineStrip));     // UpperNode
+        root->appendChildNode(createNode(QSGGeometry::DrawLineStrip));     // LowerNode
+        root->appendChildNode(createNode(QSGGeometry::DrawLineStrip));     // RmsNode
+        root->appendChildNode(createNode(QSGGeometry::DrawTriangleStrip)); // CursorNode
+        m_waveformDirty = true;
+        m_colorDirty = true;
+        m_cursorDirty = true;
+    }
+
+    QSGGeometryNode *nodes[NodeCount];
+    for (int i = 0; i < NodeCount; ++i) {
+        nodes[i] = static_cast<QSGGeometryNode *>(root->childAtIndex(i));
+    }
+
+    if (m_colorDirty) {
+        setNodeColor(nodes[FillNode], withAlpha(m_color, 0.2));
+        setNodeColor(nodes[UpperNode], m_color);
+        setNodeColor(nodes[LowerNode], m_color);
+        setNodeColor(nodes[RmsNode], withAlpha(m_color, 0.7));
+        setNodeColor(nodes[CursorNode], m_cursorColor);
+        m_colorDirty = false;
+    }
+
+    if (m_waveformDirty) {
+        updateWaveformGeometry(nodes[FillNode], nodes[UpperNode], nodes[LowerNode], nodes[RmsNode]);
+        m_waveformDirty = false;
+    }
+
+    if (m_cursorDirty) {
+        updateCursorGeometry(nodes[CursorNode]);
+        m_cursorDirty = false;
+    }
+
+    return root;
+}
+
+void WaveformItem::updateWaveformGeometry(QSGGeometryNode *fill, QSGGeometryNode *upper,
+                                          QSGGeometryNode *lower, QSGGeometryNode *rms)
+{
+    int columns = m_columns;
+    QSGGeometry::Point2D *fillVertices = prepareVertices(fill, 2 * columns);
+    QSGGeometry::Point2D *upperVertices = prepareVertices(upper, columns);
+    QSGGeometry::Point2D *lowerVertices = prepareVertices(lower, columns);
+    QSGGeometry::Point2D *rmsVertices = prepareVertices(rms, columns);
+
+    float centerY = static_cast<float>(height() / 2.0);
+    float amplitude = static_cast<float>(height() / 2.0 * AMPLITUDE_SCALE);
+    float columnWidth = columns > 0 ? static_cast<float>(width()) / columns : 0.0f;
+
+    for (int i = 0; i < columns; ++i) {
+        float x = (i + 0.5f) * columnWidth;
+        float yMax = centerY - m_max[i] * amplitude;
+        float yMin = centerY - m_min[i] * amplitude;
+
+        // The strip alternates top and bottom of each column to fill the envelope
+        fillVertices[2 * i].set(x, yMax);
+        fillVertices[2 * i + 1].set(x, yMin);
+        upperVertices[i].set(x, yMax);
+        lowerVertices[i].set(x, yMin);
+        rmsVertices[i].set(x, centerY - m_rms[i] * amplitude);
+    }
+}
+
+void WaveformItem::updateCursorGeometry(QSGGeometryNode *cursor)
+{
+    bool visible = m_cursorPosition >= 0.0 && m_cursorPosition <= 1.0 && width() > 0;
+    QSGGeometry::Point2D *vertices = prepareVertices(cursor, visible ? 4 : 0);
+    if (!visible) {
+        return;
+    }
+
+    float x = static_cast<float>(m_cursorPosition * width()) - CURSOR_WIDTH / 2.0f;
+    float h = static_cast<float>(height());
+    vertices[0].set(x, 0.0f);
+    vertices[1].set(x, h);
+    vertices[2].set(x + CURSOR_WIDTH, 0.0f);
+    vertices[3].set(x + CURSOR_WIDTH, h);
+}
@@ -0,0 +1,285 @@
+/*
+ * Copyright (C) 2025 - present Ondulab
+ * All rights reserved.
+ *
+ * This software is licensed under terms that can be found in the LICENSE file
+ * in the root directory of this software component.
+ */
+
+#include "../include/WaveformPyramid.h"
+#include <QDataStream>
+#include <QFile>
+#include <QSaveFile>
+#include <algorithm>
+#include <cmath>
+
+namespace {
+const quint32 PYRAMID_MAGIC = 0x53335750; // "S3WP"
+const quint32 PYRAMID_VERSION = 1;
+}
+
+WaveformPyramid::WaveformPyramid()
+    : m_channels(1)
+    , m_totalFrames(0)
+    , m_complete(false)
+    , m_pendingMin(0.0f)
+    , m_pendingMax(0.0f)
+    , m_pendingSumSquares(0.0f)
+    , m_pendingCount(0)
+{
+}
+
+void WaveformPyramid::reset(int channels)
+{
+    m_levels.clear();
+    m_levels.resize(1);
+    m_channels = std::max(1, channels);
+    m_totalFrames = 0;
+    m_complete = false;
+    m_pendingMin = 0.0f;
+    m_pendingMax = 0.0f;
+    m_pendingSumSquares = 0.0f;
+    m_pendingCount = 0;
+}
+
+void WaveformPyramid::appendFrames(const float *interleaved, qint64 frames)
+{
+    if (m_levels.empty()) {
+        reset(m_channels);
+    }
+
+    for (qint64 i = 0; i < frames; ++i) {
+        // Average of channels for each sample
+        float sampleValue = 0.0f;
+        for (int ch = 0; ch < m_channels; ++ch) {
+            sampleValue += interleaved[i * m_channels + ch];
+        }
+        sampleValue /= m_channels;
+
+        m_pendingMin = std::min(m_pendingMin, sampleValue);
+        m_pendingMax = std::max(m_pendingMax, sampleValue);
+        m_pendingSumSquares += sampleValue * sampleValue;
+
+        if (++m_pendingCount == BASE_BLOCK_SIZE) {
+            pushBlock(m_pendingMin, m_pendingMax, m_pendingSumSquares);
+            m_pendingMin = 0.0f;
+            m_pendingMax = 0.0f;
+            m_pendingSumSquares = 0.0f;
+            m_pendingCount = 0;
+        }
+    }
+
+    m_totalFrames += frames;
+}
+
+void WaveformPyramid::pushBlock(float minValue, float maxValue, float sumSquares)
+{
+    // Append to level 0, then merge each completed pair into the level above
+    size_t level = 0;
+    for (;;) {
+        Level &current = m_levels[level];
+        current.min.push_back(minValue);
+        current.max.push_back(maxValue);
+        current.sumSquares.push_back(sumSquares);
+
+        size_t count = current.min.size();
+        if (count % 2 != 0) {
+            break;
+        }
+
+        minValue = std::min(current.min[count - 2], current.min[count - 1]);
+        maxValue = std::max(current.max[count - 2], current.max[count - 1]);
+        sumSquares = current.sumSquares[count - 2] + current.sumSquares[count - 1];
+
+        if (++level == m_levels.size()) {
+            m_levels.emplace_back();
+        }
+    }
+}
+
+void WaveformPyramid::finalize()
+{
+    if (m_levels.empty()) {
+        reset(m_channels);
+    }
+
+    if (m_pendingCount > 0) {
+        pushBlock(m_pendingMin, m_pendingMax, m_pendingSumSquares);
+        m_pendingCount = 0;
+    }
+
+    // Complete every level with the blocks covering the odd trailing children
+    for (size_t level = 0; m_levels[level].min.size() > 1; ++level) {
+        if (level + 1 == m_levels.size()) {
+            m_levels.emplace_back();
+        }
+        const Level &lower = m_levels[level];
+        Level &upper = m_levels[level + 1];
+        size_t expected = (lower.min.size() + 1) / 2;
+
+        for (size_t j = upper.min.size(); j < expected; ++j) {
+            size_t first = 2 * j;
+            size_t last = std::min(first + 1, lower.min.size() - 1);
+            upper.min.push_back(std::min(lower.min[first], lower.min[last]));
+            upper.max.push_back(std::max(lower.max[first], lower.max[last]));
+            upper.sumSquares.push_back(last != first
+                ? lower.sumSquares[first] + lower.sumSquares[last]
+                : lower.sumSquares[first]);
+        }
+    }
+
+    // Drop empty levels left above the single top block
+    while (m_levels.size() > 1 && m_levels.back().min.empty()) {
+        m_levels.pop_back();
+    }
+
+    m_complete = true;
+}
+
+qint64 WaveformPyramid::summarizedFrames() const
+{
+    if (m_complete) {
+        return m_totalFrames;
+    }
+    return m_levels.empty() ? 0 : static_cast<qint64>(m_levels[0].min.size()) * BASE_BLOCK_SIZE;
+}
+
+void WaveformPyramid::query(qint64 startFrame, qint64 endFrame, int width,
+                            float *minOut, float *maxOut, float *rmsOut) const
+{
+    qint64 available = summarizedFrames();
+    qint64 span = endFrame - startFrame;
+
+    for (int i = 0; i < width; ++i) {
+        minOut[i] = 0.0f;
+        maxOut[i] = 0.0f;
+        rmsOut[i] = 0.0f;
+
+        if (isEmpty() || span <= 0) {
+            continue;
+        }
+
+        // Frame range of this column
+        qint64 a = startFrame + (span * i) / width;
+        qint64 b = startFrame + (span * (i + 1)) / width;
+        if (b <= a) {
+            b = a + 1;
+        }
+        a = std::max<qint64>(a, 0);
+        b = std::min(b, available);
+        if (a >= b) {
+            continue;
+        }
+
+        // Coarsest level whose blocks are not larger than the column
+        int level = 0;
+        while (level + 1 < levelCount() &&
+               (static_cast<qint64>(BASE_BLOCK_SIZE) << (level + 1)) <= (b - a)) {
+            ++level;
+        }
+
+        // While loading, a level only holds its complete blocks: the decoded
+        // frames past the last one are read from the finer levels
+        float minValue = 0.0f;
+        float maxValue = 0.0f;
+        double sumSquares = 0.0;
+        qint64 frames = 0;
+        for (qint64 position = a; level >= 0 && position < b; --level) {
+            const Level &summary = m_levels[level];
+            qint64 blockSize = static_cast<qint64>(BASE_BLOCK_SIZE) << level;
+            qint64 first = position / blockSize;
+            qint64 last = std::min<qint64>((b - 1) / blockSize, static_cast<qint64>(summary.min.size()) - 1);
+            for (qint64 block = first; block <= last; ++block) {
+                minValue = std::min(minValue, summary.min[block]);
+                maxValue = std::max(maxValue, summary.max[block]);
+                sumSquares += summary.sumSquares[block];
+                frames += std::min(blockSize, available - block * blockSize);
+            }
+            if (last >= first) {
+                position = (last + 1) * blockSize;
+            }
+        }
+
+        minOut[i] = minValue;
+        maxOut[i] = maxValue;
+        rmsOut[i] = frames > 0 ? static_cast<float>(std::sqrt(sumSquares / frames)) : 0.0f;
+    }
+}
+
+bool WaveformPyramid::save(const QString &path) const
+{
+    if (!m_complete) {
+        return false;
+    }
+
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+
+    QDataStream out(&file);
+    out << PYRAMID_MAGIC << PYRAMID_VERSION
+        << static_cast<qint32>(m_channels)
+        << static_cast<qint64>(m_totalFrames)
+        << static_cast<qint32>(BASE_BLOCK_SIZE)
+        << static_cast<qint32>(m_levels.size());
+
+    for (const Level &level : m_levels) {
+        qint64 count = static_cast<qint64>(level.min.size());
+        int bytes = static_cast<int>(count * sizeof(float));
+        out << count;
+        out.writeRawData(reinterpret_cast<const char *>(level.min.data()), bytes);
+        out.writeRawData(reinterpret_cast<const char *>(level.max.data()), bytes);
+        out.writeRawData(reinterpret_cast<const char *>(level.sumSquares.data()), bytes);
+    }
+
+    return out.status() == QDataStream::Ok && file.commit();
+}
+
+bool WaveformPyramid::load(const QString &path)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    QDataStream in(&file);
+    quint32 magic = 0;
+    quint32 version = 0;
+    qint32 channels = 0;
+    qint64 totalFrames = 0;
+    qint32 blockSize = 0;
+    qint32 levelCount = 0;
+    in >> magic >> version >> channels >> totalFrames >> blockSize >> levelCount;
+
+    if (in.status() != QDataStream::Ok || magic != PYRAMID_MAGIC || version != PYRAMID_VERSION ||
+        blockSize != BASE_BLOCK_SIZE || channels <= 0 || levelCount <= 0 || levelCount > 64) {
+        return false;
+    }
+
+    std::vector<Level> levels(levelCount);
+    for (Level &level : levels) {
+        qint64 count = 0;
+        in >> count;
+        if (in.status() != QDataStream::Ok || count < 0 ||
+            count * static_cast<qint64>(sizeof(float)) * 3 > file.size()) {
+            return false;
+        }
+        int bytes = static_cast<int>(count * sizeof(float));
+        level.min.resize(count);
+        level.max.resize(count);
+        level.sumSquares.resize(count);
+        if (in.readRawData(reinterpret_cast<char *>(level.min.data()), bytes) != bytes ||
+            in.readRawData(reinterpret_cast<char *>(level.max.data()), bytes) != bytes ||
+            in.readRawData(reinterpret_cast<char *>(level.sumSquares.data()), bytes) != bytes) {
+            return false;
+        }
+    }
+
+    m_levels.swap(levels);
+    m_channels = channels;
+    m_totalFrames = totalFrames;
+    m_complete = true;
+    m_pendingCount = 0;
+    return true;
+}
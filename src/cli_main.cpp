@@ -0,0 +1,143 @@
+/*
+ * Copyright (C) 2025 - present Ondulab
+ * All rights reserved.
+ *
+ * This software is licensed under terms that can be found in the LICENSE file
+ * in the root directory of this software component.
+ */
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QFileInfo>
+#include <QLoggingCategory>
+#include <QTextStream>
+#include "../include/BatchRunner.h"
+#include "../include/TaskManager.h"
+
+namespace {
+// Writing speed of the application's parameters model (cm/s)
+const double CLI_WRITING_SPEED = 2.5;
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("sp3ctragen-cli");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription(
+        "Génère les spectrogrammes d'un répertoire de fichiers audio ou d'un manifeste "
+        "de tâches (JSON ou CSV), sans interface graphique.");
+    parser.addHelpOption();
+    parser.addPositionalArgument("source", "Répertoire de fichiers audio, ou manifeste .json / .csv");
+
+    QCommandLineOption outputOption({"o", "output"}, "Répertoire des fichiers générés (défaut: .)", "dir", ".");
+    QCommandLineOption formatOption({"f", "format"}, "Format par défaut: png, pdf ou both (défaut: png)", "format", "png");
+    QCommandLineOption jobsOption({"j", "jobs"},
+        "Nombre maximal de fichiers traités simultanément (défaut: moitié des cœurs; "
+        "un cœur reste réservé aux tâches interactives)", "n", "0");
+    QCommandLineOption dpiOption("dpi", "Résolution des PDF", "dpi", QString::number(PRINTER_DPI));
+    QCommandLineOption setOption({"s", "set"},
+        "Paramètre par défaut des tâches, par ex. writingSpeed=5 (répétable)", "key=value");
+    QCommandLineOption reportOption("report", "Fichier CSV recevant la durée de chaque tâche", "file");
+    QCommandLineOption traceOption("trace",
+        QString("Fichier de chronologie Chrome trace / Perfetto (défaut: $%1)").arg(SPECTRAL_TRACE_ENV), "file",
+        qEnvironmentVariable(SPECTRAL_TRACE_ENV));
+    QCommandLineOption maxMemoryOption("max-memory",
+        "Mémoire maximale d'une tâche en Mo, 0 = illimitée (défaut: budget de l'application)", "mb");
+    QCommandLineOption maxTimeOption("max-time", "Durée estimée maximale d'une tâche en secondes, 0 = illimitée", "s");
+    QCommandLineOption verboseOption({"v", "verbose"}, "Affiche les messages de débogage du générateur");
+    parser.addOptions({outputOption, formatOption, jobsOption, dpiOption, setOption, reportOption,
+                       traceOption, maxMemoryOption, maxTimeOption, verboseOption});
+    parser.process(app);
+
+    QTextStream err(stderr);
+    const QStringList sources = parser.positionalArguments();
+    if (sources.size() != 1) {
+        parser.showHelp(1);
+    }
+
+    if (!parser.isSet(verboseOption)) {
+        QLoggingCategory::setFilterRules("*.debug=false\n*.info=false");
+        spectral_log_set_level(SPECTRAL_LOG_WARNING);
+    }
+
+    // Whole recordings, laid out page after page at the application's writing speed
+    SpectrogramSettingsCpp defaults;
+    defaults.setDuration(0.0);
+    defaults.setWritingSpeed(CLI_WRITING_SPEED);
+    defaults.setPaginate(true);
+
+    for (const QString& assignment : parser.values(setOption)) {
+        int separator = assignment.indexOf('=');
+        QString error;
+        if (separator <= 0 ||
+            !BatchRunner::applySetting(defaults, assignment.left(separator), assignment.mid(separator + 1), &error)) {
+            err << "sp3ctragen-cli: " << (separator <= 0 ? QString("--set attend key=value: %1").arg(assignment) : error) << "\n";
+            return 1;
+        }
+    }
+
+    QString format = parser.value(formatOption).toLower();
+    if (format != "png" && format != "pdf" && format != "both") {
+        err << "sp3ctragen-cli: format invalide: " << format << "\n";
+        return 1;
+    }
+    bool dpiOk = false;
+    bool jobsOk = false;
+    int dpi = parser.value(dpiOption).toInt(&dpiOk);
+    int jobs = parser.value(jobsOption).toInt(&jobsOk);
+    if (!dpiOk || !jobsOk || dpi <= 0 || jobs < 0) {
+        err << "sp3ctragen-cli: valeur numérique invalide\n";
+        return 1;
+    }
+
+    // Jobs whose plan exceeds the budgets are refused before decoding
+    TaskManager* taskManager = TaskManager::getInstance();
+    qint64 memoryBudget = taskManager->memoryBudget();
+    double timeBudget = taskManager->timeBudget();
+    bool budgetOk = true;
+    if (parser.isSet(maxMemoryOption)) {
+        memoryBudget = parser.value(maxMemoryOption).toLongLong(&budgetOk) * 1024 * 1024;
+    }
+    if (budgetOk && parser.isSet(maxTimeOption)) {
+        timeBudget = parser.value(maxTimeOption).toDouble(&budgetOk);
+    }
+    if (!budgetOk || memoryBudget < 0 || timeBudget < 0.0) {
+        err << "sp3ctragen-cli: budget invalide\n";
+        return 1;
+    }
+    taskManager->setBudgets(memoryBudget, timeBudget);
+
+    BatchRunner runner;
+    runner.setDefaults(defaults);
+    runner.setOutputDirectory(parser.value(outputOption));
+    runner.setFormats(format != "pdf", format != "png");
+    runner.setDpi(dpi);
+
+    QString error;
+    QString source = sources.first();
+    bool loaded = QFileInfo(source).isDir() ? runner.addDirectory(source, &error)
+                                            : runner.addManifest(source, &error);
+    if (!loaded) {
+        err << "sp3ctragen-cli: " << error << "\n";
+        return 1;
+    }
+    if (runner.jobCount() == 0) {
+        err << "sp3ctragen-cli: aucun fichier à traiter\n";
+        return 1;
+    }
+
+    QString tracePath = parser.value(traceOption);
+    if (!tracePath.isEmpty()) {
+        spectral_trace_start();
+    }
+
+    int failed = runner.run(jobs, parser.value(reportOption));
+    spectral_log_flush();
+
+    if (!tracePath.isEmpty() && spectral_trace_stop(tracePath.toUtf8().constData()) != 0) {
+        err << "sp3ctragen-cli: impossible d'écrire la trace " << tracePath << "\n";
+    }
+    return failed == 0 ? 0 : 2;
+}
@@ -5,8 +5,10 @@
 #include "../include/spectrogramgenerator.h"
 #include "../include/previewimageprovider.h"
 #include "../include/waveformprovider.h"
+#include "../include/WaveformItem.h"
 #include "../include/VisualizationFactory.h"
 #include "../include/TaskManager.h"
+#include "../include/spectral_generator.h"
 #include "../include/Constants.h"
 #include "../include/QmlConstants.h"
 #include "../include/PathManager.h"
@@ -41,6 +43,17 @@ int main(int argc, char *argv[])
     VisualizationFactory::getInstance();
     TaskManager::getInstance();
     
+    // Chronologie des générations (chrome://tracing, Perfetto) si la variable d'environnement est définie
+    QString tracePath = qEnvironmentVariable(SPECTRAL_TRACE_ENV);
+    if (!tracePath.isEmpty()) {
+        spectral_trace_start();
+        QObject::connect(&app, &QCoreApplication::aboutToQuit, [tracePath]() {
+            if (spectral_trace_stop(tracePath.toUtf8().constData()) == 0) {
+                qDebug() << "Trace écrite dans" << tracePath;
+            }
+        });
+    }
+    
     qDebug() << "Initialisation de l'application Sp3ctraGen";
     qDebug() << "Types de visualisation disponibles:" << VisualizationFactory::getInstance()->getAvailableStrategyNames();
     qDebug() << "Extensions supportées:" << VisualizationFactory::getInstance()->getSupportedExtensions();
@@ -48,6 +61,7 @@ int main(int argc, char *argv[])
     // Enregistrer nos types C++ pour QML
     qmlRegisterType<SpectrogramGenerator>("com.Sp3ctraGen.backend", 1, 0, "SpectrogramGenerator");
     qmlRegisterType<WaveformProvider>("com.Sp3ctraGen.backend", 1, 0, "WaveformProvider");
+    qmlRegisterType<WaveformItem>("com.Sp3ctraGen.backend", 1, 0, "WaveformItem");
     qmlRegisterType<MacOSBridge>("com.Sp3ctraGen.backend", 1, 0, "MacOSBridge");
     qmlRegisterType<SpectrogramParametersModel>("com.Sp3ctraGen.backend", 1, 0, "SpectrogramParametersModel");
     qmlRegisterType<SpectrogramViewModel>("com.Sp3ctraGen.backend", 1, 0, "SpectrogramViewModel");
@@ -98,6 +112,9 @@ int main(int argc, char *argv[])
         // Annuler toutes les tâches en cours
         TaskManager::getInstance()->cancelAllTasks();
         
+        // Écrire les derniers messages du noyau encore en file d'attente
+        spectral_log_flush();
+        
         qDebug() << "Nettoyage terminé";
     });
     
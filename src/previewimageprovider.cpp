@@ -8,6 +8,8 @@
 #include <QtPrintSupport/QPrintDialog>
 #include "SharedConstants.h"
 
+bool PreviewImageProvider::s_debugImageDumps = qEnvironmentVariableIsSet(PREVIEW_DEBUG_IMAGES_ENV);
+
 PreviewImageProvider::PreviewImageProvider()
     : QQuickImageProvider(QQuickImageProvider::Image)
 {
@@ -19,34 +21,31 @@ PreviewImageProvider::PreviewImageProvider()
 
 QImage PreviewImageProvider::requestImage(const QString &id, QSize *size, const QSize &requestedSize)
 {
-    qDebug() << "PreviewImageProvider::requestImage - ID: " << id;
-    qDebug() << "Display image: " << m_displayImage.width() << "x" << m_displayImage.height() << ", format: " << m_displayImage.format();
-    qDebug() << "Display image is null: " << m_displayImage.isNull();
-    qDebug() << "Original image: " << m_originalImage.width() << "x" << m_originalImage.height();
-    qDebug() << "Original image is null: " << m_originalImage.isNull();
+    qDebug() << "PreviewImageProvider::requestImage - ID:" << id
+             << "display:" << m_displayImage.size() << "requested:" << requestedSize;
     
-    // Sauvegarder l'image pour le débogage
-    bool saved = m_displayImage.save("/tmp/preview_debug.png");
-    qDebug() << "Display image saved for debug: " << saved;
+    // Sauvegarder l'image pour le débogage (uniquement sur demande explicite)
+    if (s_debugImageDumps) {
+        bool saved = m_displayImage.save("/tmp/preview_debug.png");
+        qDebug() << "Display image saved for debug: " << saved;
+    }
     
     if (size) {
         *size = m_displayImage.size();
-        qDebug() << "Size returned: " << size->width() << "x" << size->height();
     }
     
     if (requestedSize.width() > 0 && requestedSize.height() > 0) {
-        qDebug() << "Requested size: " << requestedSize.width() << "x" << requestedSize.height();
         QImage scaledImage = m_displayImage.scaled(requestedSize, Qt::KeepAspectRatio, Qt::SmoothTransformation);
-        qDebug() << "Scaled image: " << scaledImage.width() << "x" << scaledImage.height();
         
         // Sauvegarder l'image redimensionnée pour le débogage
-        bool scaledSaved = scaledImage.save("/tmp/preview_scaled_debug.png");
-        qDebug() << "Scaled image saved for debug: " << scaledSaved;
+        if (s_debugImageDumps) {
+            bool scaledSaved = scaledImage.save("/tmp/preview_scaled_debug.png");
+            qDebug() << "Scaled image saved for debug: " << scaledSaved;
+        }
         
         return scaledImage;
     }
     
-    qDebug() << "Returning display image";
     return m_displayImage;
 }
 
@@ -71,6 +70,20 @@ void PreviewImageProvider::updateImage(const QImage &image)
     qDebug() << "Image updated successfully";
 }
 
+void PreviewImageProvider::updateDraftImage(const QImage &image)
+{
+    if (image.isNull()) {
+        qDebug() << "WARNING: Draft image is null!";
+        return;
+    }
+    
+    // The previous print-resolution image no longer matches the parameters
+    m_originalImage = QImage();
+    m_displayImage = image;
+    
+    qDebug() << "PreviewImageProvider::updateDraftImage - Draft:" << image.width() << "x" << image.height();
+}
+
 bool PreviewImageProvider::saveOriginalImage(const QString &filePath, const QString &format) const
 {
     qDebug() << "PreviewImageProvider::saveOriginalImage - Saving to: " << filePath;
@@ -0,0 +1,550 @@
+/*
+ * Copyright (C) 2025 - present Ondulab
+ * All rights reserved.
+ *
+ * This software is licensed under terms that can be found in the LICENSE file
+ * in the root directory of this software component.
+ */
+
+#define SPECTRAL_LOG_CATEGORY "analyze"
+#include "spectral_common.h"
+#include "spectral_wav_processing.h"
+#include "spectral_fft.h"
+#include "spectral_cqt.h"
+#include "spectral_analyze.h"
+
+/*---------------------------------------------------------------------
+ * spectral_load_source()
+ *
+ * Resolves the settings (defaults, bins/s, FFT size), plans the page
+ * layout, loads the samples of the planned windows and applies the
+ * filters.
+ *
+ * Returns:
+ *  - EXIT_SUCCESS on success, EXIT_FAILURE on error,
+ *    SPECTRAL_CANCELLED if the job was cancelled.
+ *---------------------------------------------------------------------*/
+int spectral_load_source(const SpectrogramSettings *cfg,
+                         const char *inputFile,
+                         const char *outputFile,
+                         SpectralSource *src,
+                         SpectralJob *job)
+{
+    /* Copy configuration and fallback to defaults if necessary */
+    SpectrogramSettings s = *cfg;
+    double  minFreq         = DEFAULT_DBL(s.minFreq,        DEFAULT_MIN_FREQ);
+    double  maxFreq         = DEFAULT_DBL(s.maxFreq,        DEFAULT_MAX_FREQ);
+    double  writingSpeed    = DEFAULT_DBL(s.writingSpeed,   0.0);
+    double  duration        = DEFAULT_DBL(s.duration,       DEFAULT_DURATION);
+    int     sample_rate     = DEFAULT_INT(s.sampleRate,     DEFAULT_SAMPLE_RATE);
+    double  dynamicRangeDB  = DEFAULT_DBL(s.dynamicRangeDB, DYNAMIC_RANGE_DB);
+    double  gammaCorr       = DEFAULT_DBL(s.gammaCorrection, GAMMA_CORRECTION);
+    int     enableDither    = DEFAULT_BOOL(s.enableDithering, ENABLE_DITHERING);
+    double  contrastFactor  = DEFAULT_DBL(s.contrastFactor, CONTRAST_FACTOR);
+    int     enableHighBoost = DEFAULT_BOOL(s.enableHighBoost, ENABLE_HIGH_BOOST);
+    double  highBoostAlpha  = DEFAULT_DBL(s.highBoostAlpha, HIGH_BOOST_ALPHA);
+    
+    // Bins/s, overlap and FFT size (shared with spectral_plan())
+    SpectralTiming timing;
+    spectral_resolve_timing(&s, &timing);
+    double binsPerSecond = timing.binsPerSecond;
+    int overlapPreset = timing.overlapPreset;
+    double overlapValue = timing.overlap;
+    int fft_size = timing.fftSize;
+    
+    if (writingSpeed > 0.0) {
+        spectral_log(job, SPECTRAL_LOG_INFO, " - Calculated optimal bins/s: %.1f based on writing speed: %.2f cm/s\n", binsPerSecond, writingSpeed);
+    } else {
+        spectral_log(job, SPECTRAL_LOG_INFO, " - Using provided bins/s: %.1f (no writing speed specified)\n", binsPerSecond);
+    }
+    spectral_log(job, SPECTRAL_LOG_INFO, " - Using %s overlap preset (%.2f)\n",
+                 overlapPreset == 0 ? "low" : overlapPreset == 2 ? "high" : "medium", overlapValue);
+    
+    if (cfg->fftSize > 0) {
+        spectral_log(job, SPECTRAL_LOG_INFO, " - Using precalculated FFT size: %d (from resolution slider)\n", fft_size);
+    } else {
+        spectral_log(job, SPECTRAL_LOG_INFO, " - Calculated FFT size: %d (from bins/s=%.1f, overlap=%.2f)\n",
+               fft_size, binsPerSecond, overlapValue);
+    }
+    
+    /* Use default paths if input/output files are not specified */
+    const char* inputFilePath = DEFAULT_STR(inputFile, DEFAULT_INPUT_FILENAME);
+    const char* outputFilePath = DEFAULT_STR(outputFile, DEFAULT_OUTPUT_FILENAME);
+
+    // The page layout decides the windows, hence the samples to decode; the
+    // plan also checks the budgets before decoding
+    SpectralPlan plan;
+    int planned = spectral_plan_file(cfg, inputFilePath, job != NULL ? &job->costModel : NULL, &plan) == EXIT_SUCCESS;
+    if (planned) {
+        spectral_log(job, SPECTRAL_LOG_INFO, "Layout plan: %d windows (%d per page), samples [0, %d) with %d of context, bins %d to %d\n",
+                     plan.windows, plan.windowsPerPage, plan.sampleCount, plan.contextSamples,
+                     plan.binMin, plan.binMax);
+    }
+    if (planned && job != NULL && !spectral_plan_within_budget(&plan, job->memoryBudget, job->timeBudget)) {
+        spectral_log(job, SPECTRAL_LOG_ERROR,
+                     "Error: Generation refused: about %.0f MB and %.1f s needed (budget: %.0f MB, %.1f s)\n",
+                     plan.peakBytes / 1048576.0, plan.estimatedSeconds,
+                     job->memoryBudget / 1048576.0, job->timeBudget);
+        return EXIT_FAILURE;
+    }
+
+    spectral_log(job, SPECTRAL_LOG_INFO, "Spectrogram generation parameters:\n");
+    spectral_log(job, SPECTRAL_LOG_INFO, " - FFT size: %d\n", fft_size);
+    spectral_log(job, SPECTRAL_LOG_INFO, " - Overlap preset: %d (%s - %.2f)\n", overlapPreset,
+           overlapPreset == 0 ? "Low" :
+           overlapPreset == 2 ? "High" : "Medium",
+           overlapValue);
+    spectral_log(job, SPECTRAL_LOG_INFO, " - Bins per second: %.1f\n", binsPerSecond);
+    spectral_log(job, SPECTRAL_LOG_INFO, " - Min frequency: %f\n", minFreq);
+    spectral_log(job, SPECTRAL_LOG_INFO, " - Max frequency: %f\n", maxFreq);
+    spectral_log(job, SPECTRAL_LOG_INFO, " - Writing speed: %f cm/s\n", writingSpeed);
+    spectral_log(job, SPECTRAL_LOG_INFO, " - Duration: %f\n", duration);
+    spectral_log(job, SPECTRAL_LOG_INFO, " - Sample rate: %d\n", sample_rate);
+    spectral_log(job, SPECTRAL_LOG_INFO, " - Dynamic range (dB): %f\n", dynamicRangeDB);
+    spectral_log(job, SPECTRAL_LOG_INFO, " - Gamma correction: %f\n", gammaCorr);
+    spectral_log(job, SPECTRAL_LOG_INFO, " - Dithering: %d\n", enableDither);
+    spectral_log(job, SPECTRAL_LOG_INFO, " - Contrast factor: %f\n", contrastFactor);
+    spectral_log(job, SPECTRAL_LOG_INFO, " - High boost: %d (alpha = %f)\n", enableHighBoost, highBoostAlpha);
+    spectral_log(job, SPECTRAL_LOG_INFO, " - Input file: %s\n", inputFilePath);
+    if (outputFile != NULL) {
+        // An analysis rendered to several formats has no output file yet
+        spectral_log(job, SPECTRAL_LOG_INFO, " - Output file: %s\n", outputFilePath);
+    }
+    spectral_log(job, SPECTRAL_LOG_INFO, " - Log frequency scale: %s\n", USE_LOG_FREQUENCY ? "enabled" : "disabled");
+
+    /* ------------------------------ */
+    /* 1. Load audio signal from WAV  */
+    /* ------------------------------ */
+    int total_samples = 0;
+    double *signal = NULL;
+    
+    // Récupérer le paramètre de normalisation
+    int enableNormalization = DEFAULT_BOOL(s.enableNormalization, 1);
+    
+    double inputGain = DEFAULT_DBL(s.inputGain, 1.0);
+    
+    spectral_log(job, SPECTRAL_LOG_INFO, " - Loading WAV file with duration: %.2f seconds\n", s.duration);
+    spectral_log(job, SPECTRAL_LOG_INFO, " - Normalization: %s\n", enableNormalization ? "enabled" : "disabled");
+    
+    spectral_job_report(job, SPECTRAL_STAGE_DECODE, 0.0);
+    SpectralStageTimer timer;
+    spectral_stage_begin(job, SPECTRAL_STAGE_DECODE, &timer);
+    double trace = spectral_trace_begin();
+    if (load_wav_file_scaled(inputFilePath, &signal, &total_samples, &sample_rate, s.duration,
+                             planned ? plan.sampleCount : 0, enableNormalization, inputGain, job) != 0) {
+        spectral_stage_end(job, SPECTRAL_STAGE_DECODE, &timer);
+        spectral_log(job, SPECTRAL_LOG_ERROR, "Error: Unable to load WAV file.\n");
+        return EXIT_FAILURE;
+    }
+    spectral_trace_end(job, "decode", trace, (long long)total_samples * (long long)sizeof(double), total_samples);
+    spectral_stage_end(job, SPECTRAL_STAGE_DECODE, &timer);
+    SPECTRAL_JOB_COUNT(job, bytesDecoded, (long long)total_samples * (long long)sizeof(double));
+    spectral_job_report(job, SPECTRAL_STAGE_DECODE, 1.0);
+    spectral_job_report(job, SPECTRAL_STAGE_FILTER, 0.0);
+    spectral_stage_begin(job, SPECTRAL_STAGE_FILTER, &timer);
+    trace = spectral_trace_begin();
+    
+    // Samples of the drawn windows; the context past them is only read by the long windows
+    int analyzed_samples = total_samples;
+    if (planned && analyzed_samples > plan.sampleCount - plan.contextSamples) {
+        analyzed_samples = plan.sampleCount - plan.contextSamples;
+    }
+    if (s.duration <= 0.0 || (double)analyzed_samples / sample_rate < s.duration) {
+        // Durée réellement analysée (texte des paramètres)
+        s.duration = (double)analyzed_samples / sample_rate;
+    }
+
+    /* Apply high-pass filter if enabled */
+    int enableHighPass = DEFAULT_BOOL(s.enableHighPassFilter, 0);
+    
+    // Utiliser DIRECTEMENT la valeur brute sans DEFAULT_DBL
+    double highPassCutoff = s.highPassCutoffFreq;
+    int highPassOrder = s.highPassFilterOrder;
+    
+    if (enableHighPass && highPassCutoff > 0.0) {
+        spectral_log(job, SPECTRAL_LOG_INFO, " - High-pass filter: enabled (cutoff = %.2f Hz, order = %d)\n",
+               highPassCutoff, highPassOrder);
+        
+        // Limit order to valid range (1-12)
+        if (highPassOrder < 1) highPassOrder = 1;
+        if (highPassOrder > 12) highPassOrder = 12;
+        
+        // Allocate coefficient arrays
+        double a[13] = {0}; // Max order 12 + 1
+        double b[13] = {0};
+        
+        // Design the filter
+        design_highpass_filter(highPassCutoff, highPassOrder, sample_rate, a, b, job);
+        
+        // Apply the filter
+        apply_highpass_filter(signal, total_samples, a, b, highPassOrder, job);
+    } else {
+        spectral_log(job, SPECTRAL_LOG_INFO, " - High-pass filter: disabled\n");
+    }
+    
+    /* Apply high frequency boost if enabled */
+    if (enableHighBoost) {
+        apply_high_freq_boost_filter(signal, total_samples, highBoostAlpha, job);
+    }
+    
+    spectral_trace_end(job, "filter", trace, (long long)total_samples * (long long)sizeof(double), total_samples);
+    spectral_stage_end(job, SPECTRAL_STAGE_FILTER, &timer);
+    spectral_job_report(job, SPECTRAL_STAGE_FILTER, 1.0);
+    
+    if (spectral_job_should_stop(job)) {
+        spectral_log(job, SPECTRAL_LOG_INFO, " - Generation cancelled after loading\n");
+        free(signal);
+        return SPECTRAL_CANCELLED;
+    }
+    
+    src->s = s;
+    src->minFreq = minFreq;
+    src->maxFreq = maxFreq;
+    src->writingSpeed = writingSpeed;
+    src->binsPerSecond = binsPerSecond;
+    src->dynamicRangeDB = dynamicRangeDB;
+    src->gammaCorr = gammaCorr;
+    src->enableDither = enableDither;
+    src->contrastFactor = contrastFactor;
+    src->overlapPreset = overlapPreset;
+    src->fftSize = fft_size;
+    src->sampleRate = sample_rate;
+    src->totalSamples = total_samples;
+    src->windows = planned ? plan.windows : 0;
+    src->signal = signal;
+    
+    return EXIT_SUCCESS;
+}
+
+void spectral_free_source(SpectralSource *src)
+{
+    free(src->signal);
+    src->signal = NULL;
+}
+
+/*---------------------------------------------------------------------
+ * spectral_source_window_count()
+ *
+ * Returns the windows of a source: those of its plan, capped by the
+ * signal, or every window of the signal without a plan (0 if it is
+ * shorter than one window).
+ *---------------------------------------------------------------------*/
+static int spectral_source_window_count(const SpectralSource *src)
+{
+    int step = (int)(src->sampleRate / src->binsPerSecond);
+    if (step < 1) step = 1;
+    int windows = src->totalSamples >= src->fftSize ? (src->totalSamples - src->fftSize) / step + 1 : 0;
+    if (src->windows > 0 && windows > src->windows) {
+        windows = src->windows;
+    }
+    return windows;
+}
+
+/*---------------------------------------------------------------------
+ * spectral_compute_windows()
+ *
+ * Computes the windows [first_window, first_window + num_windows) of a
+ * source with the engine of its settings (num_windows 0 = up to the end
+ * of the signal), without tone mapping.
+ *
+ * Returns:
+ *  - EXIT_SUCCESS on success, EXIT_FAILURE on error,
+ *    SPECTRAL_CANCELLED if the job was cancelled.
+ *---------------------------------------------------------------------*/
+static int spectral_compute_windows(const SpectralSource *src, int pad_size,
+                                    int first_window, int num_windows,
+                                    SpectrogramData *spectro_data, SpectralJob *job)
+{
+    // Compute spectrogram with bins per second and overlap preset
+    SpectralStageTimer timer;
+    spectral_stage_begin(job, SPECTRAL_STAGE_FFT, &timer);
+    int spectro_status;
+    if (src->s.analysisEngine == SPECTRAL_ENGINE_CONSTANT_Q) {
+        spectro_status = compute_constant_q(src->signal, src->totalSamples, first_window, num_windows,
+                                            src->sampleRate, src->fftSize,
+                                            src->binsPerSecond, src->minFreq, src->maxFreq,
+                                            cqt_rows(&src->s), spectro_data, job);
+    } else {
+        spectro_status = compute_spectrogram(src->signal, src->totalSamples, first_window, num_windows,
+                                             src->sampleRate, src->fftSize,
+                                             pad_size, src->overlapPreset, src->binsPerSecond,
+                                             src->minFreq, src->maxFreq, spectro_data, job);
+    }
+    spectral_stage_end(job, SPECTRAL_STAGE_FFT, &timer);
+    if (spectro_status != 0) {
+        if (spectro_status == SPECTRAL_CANCELLED) {
+            return SPECTRAL_CANCELLED;
+        }
+        spectral_log(job, SPECTRAL_LOG_ERROR, "Error: Failed to compute spectrogram.\n");
+        return EXIT_FAILURE;
+    }
+    
+    if (spectral_job_should_stop(job)) {
+        spectral_free(job, spectro_data->data);
+        spectro_data->data = NULL;
+        return SPECTRAL_CANCELLED;
+    }
+    return EXIT_SUCCESS;
+}
+
+/* Tone-maps a matrix with the settings of its source */
+static void spectral_tone_map(const SpectralSource *src, SpectrogramData *spectro_data, SpectralJob *job)
+{
+    SpectralStageTimer timer;
+    spectral_stage_begin(job, SPECTRAL_STAGE_TONE_MAP, &timer);
+    apply_image_processing(spectro_data, src->dynamicRangeDB, src->gammaCorr, src->enableDither,
+                           src->contrastFactor, job);
+    spectral_stage_end(job, SPECTRAL_STAGE_TONE_MAP, &timer);
+}
+
+/*---------------------------------------------------------------------
+ * spectral_compute_analysis()
+ *
+ * Computes and tone-maps the spectrogram of a source with the engine of
+ * its settings. pad_size is the zero-padded FFT size (0 = default); the
+ * constant-Q engine ignores it and analyzes one bin per pixel row of the
+ * PNG page.
+ *
+ * Returns:
+ *  - EXIT_SUCCESS on success, EXIT_FAILURE on error,
+ *    SPECTRAL_CANCELLED if the job was cancelled.
+ *---------------------------------------------------------------------*/
+int spectral_compute_analysis(const SpectralSource *src, int pad_size,
+                              SpectrogramData *spectro_data, SpectralJob *job)
+{
+    int status = spectral_compute_windows(src, pad_size, 0, src->windows, spectro_data, job);
+    if (status != EXIT_SUCCESS) {
+        return status;
+    }
+    
+    // Apply image processing
+    spectral_tone_map(src, spectro_data, job);
+    
+    return EXIT_SUCCESS;
+}
+
+/*---------------------------------------------------------------------
+ * spectral_analysis_peak()
+ *
+ * First pass of a paginated analysis: computes the spectrogram of the
+ * source one page of windows at a time and keeps its shape and global
+ * maximum only (spectro_data->data is NULL). The renders compute each
+ * page again with spectral_page_matrix(), so the transforms run twice,
+ * but the memory holds one page of the matrix instead of the recording.
+ *
+ * Returns:
+ *  - EXIT_SUCCESS on success, EXIT_FAILURE on error,
+ *    SPECTRAL_CANCELLED if the job was cancelled.
+ *---------------------------------------------------------------------*/
+static int spectral_analysis_peak(const SpectralSource *src, int windows_per_page,
+                                  SpectrogramData *spectro_data, SpectralJob *job)
+{
+    int total_windows = spectral_source_window_count(src);
+    double global_max = 0.0;
+    int first_window = 0;
+    
+    spectral_log(job, SPECTRAL_LOG_INFO, " - Paginated analysis: maximum of %d windows, %d at a time\n",
+                 total_windows, windows_per_page);
+    do {
+        int count = total_windows - first_window;
+        if (count > windows_per_page) count = windows_per_page;
+        
+        SpectrogramData page;
+        int status = spectral_compute_windows(src, 0, first_window, count, &page, job);
+        if (status != EXIT_SUCCESS) {
+            return status;
+        }
+        spectral_free(job, page.data);
+        page.data = NULL;
+        
+        if (first_window == 0) {
+            *spectro_data = page;
+        }
+        if (page.global_max > global_max) {
+            global_max = page.global_max;
+        }
+        first_window += page.num_windows;
+    } while (first_window < total_windows);
+    
+    spectro_data->num_windows = first_window;
+    spectro_data->global_max = global_max;
+    return EXIT_SUCCESS;
+}
+
+/*---------------------------------------------------------------------
+ * spectral_page_matrix()
+ *
+ * Gives the tone-mapped windows [first_window, first_window + num_windows)
+ * of an analysis. A whole analysis lends its rows. A paginated one
+ * (spectro_data->data NULL) computes and tone-maps them from the signal
+ * of src with the global maximum of the recording, so a page has the
+ * levels it would have in one matrix; its dithering noise follows its
+ * first window. Release with spectral_page_matrix_release().
+ *
+ * Returns:
+ *  - EXIT_SUCCESS on success (*page is set), EXIT_FAILURE on error,
+ *    SPECTRAL_CANCELLED if the job was cancelled.
+ *---------------------------------------------------------------------*/
+int spectral_page_matrix(const SpectralSource *src, const SpectrogramData *spectro_data,
+                         int first_window, int num_windows,
+                         SpectrogramData *page, SpectralJob *job)
+{
+    if (spectro_data->data != NULL) {
+        *page = *spectro_data;
+        page->data = spectro_data->data + (size_t)(first_window - spectro_data->first_window) * spectro_data->num_bins;
+        page->first_window = first_window;
+        page->num_windows = num_windows;
+        return EXIT_SUCCESS;
+    }
+    
+    memset(page, 0, sizeof(*page));
+    if (src->signal == NULL) {
+        spectral_log(job, SPECTRAL_LOG_ERROR, "Error: The analysis holds neither the spectrogram nor the signal.\n");
+        return EXIT_FAILURE;
+    }
+    int status = spectral_compute_windows(src, 0, first_window, num_windows, page, job);
+    if (status != EXIT_SUCCESS) {
+        return status;
+    }
+    page->global_max = spectro_data->global_max;
+    spectral_tone_map(src, page, job);
+    return EXIT_SUCCESS;
+}
+
+/*---------------------------------------------------------------------
+ * spectral_page_matrix_release()
+ *
+ * Releases a page of spectral_page_matrix(); the rows lent by a whole
+ * analysis stay with it.
+ *---------------------------------------------------------------------*/
+void spectral_page_matrix_release(const SpectrogramData *spectro_data, SpectrogramData *page,
+                                  SpectralJob *job)
+{
+    if (spectro_data->data == NULL) {
+        spectral_free(job, page->data);
+    }
+    page->data = NULL;
+}
+
+/*---------------------------------------------------------------------
+ * spectral_source_with_layout()
+ *
+ * Copies a source and replaces its overlay settings (margins, height,
+ * scale, reference lines, parameters text, PDF image mode) by those of
+ * cfg. The page format and the pagination are kept with the analysis
+ * settings: they decided the windows that were analyzed (spectral_plan()),
+ * so a wider page or a paginated render would be truncated. A cfg asking
+ * for others is logged. A NULL cfg keeps everything.
+ *---------------------------------------------------------------------*/
+void spectral_source_with_layout(const SpectralSource *src, const SpectrogramSettings *cfg,
+                                 SpectralSource *view, SpectralJob *job)
+{
+    *view = *src;
+    if (cfg == NULL) {
+        return;
+    }
+    
+    if (cfg->pageFormat != src->s.pageFormat || (cfg->paginate == 1) != (src->s.paginate == 1)) {
+        spectral_log(job, SPECTRAL_LOG_WARNING,
+                     "Warning: Render keeps the page format (%s) and pagination (%s) of the analysis\n",
+                     src->s.pageFormat == 1 ? "A3" : "A4", src->s.paginate == 1 ? "on" : "off");
+    }
+    view->s.bottomMarginMM = cfg->bottomMarginMM;
+    view->s.spectroHeightMM = cfg->spectroHeightMM;
+    view->s.enableVerticalScale = cfg->enableVerticalScale;
+    view->s.enableBottomReferenceLine = cfg->enableBottomReferenceLine;
+    view->s.bottomReferenceLineOffset = cfg->bottomReferenceLineOffset;
+    view->s.enableTopReferenceLine = cfg->enableTopReferenceLine;
+    view->s.topReferenceLineOffset = cfg->topReferenceLineOffset;
+    view->s.displayParameters = cfg->displayParameters;
+    view->s.textScaleFactor = cfg->textScaleFactor;
+    view->s.lineThicknessFactor = cfg->lineThicknessFactor;
+    view->s.pdfEmbedImage = cfg->pdfEmbedImage;
+}
+
+/*---------------------------------------------------------------------
+ * spectral_analyze()
+ *
+ * Decodes, filters and analyzes an audio file once for the page layout
+ * of cfg. The result is immutable: the renders of that layout, in any
+ * format, may read it concurrently. The signal is freed as soon as the
+ * spectrogram is computed. A paginated layout keeps the signal and the
+ * global maximum instead (spectral_analysis_peak()): its renders analyze
+ * one page at a time, so a long recording never holds its whole matrix.
+ *
+ * Returns:
+ *  - EXIT_SUCCESS on success (*analysis is set), EXIT_FAILURE on error,
+ *    SPECTRAL_CANCELLED if the job was cancelled (*analysis is NULL).
+ *---------------------------------------------------------------------*/
+int spectral_analyze(const SpectrogramSettings *cfg,
+                     const char *inputFile,
+                     SpectralAnalysis **analysis,
+                     SpectralJob *job)
+{
+    *analysis = NULL;
+    
+    const char *inputFilePath = DEFAULT_STR(inputFile, DEFAULT_INPUT_FILENAME);
+    SpectralAnalysis *result = (SpectralAnalysis *)calloc(1, sizeof(SpectralAnalysis));
+    char *inputCopy = (char *)malloc(strlen(inputFilePath) + 1);
+    if (result == NULL || inputCopy == NULL) {
+        spectral_log(job, SPECTRAL_LOG_ERROR, "Error: Unable to allocate the analysis.\n");
+        free(result);
+        free(inputCopy);
+        return EXIT_FAILURE;
+    }
+    strcpy(inputCopy, inputFilePath);
+    result->inputFile = inputCopy;
+    
+    int status = spectral_load_source(cfg, inputFile, NULL, &result->src, job);
+    if (status != EXIT_SUCCESS) {
+        free(result->inputFile);
+        free(result);
+        return status;
+    }
+    
+    int windows_per_page = spectral_page_windows(&result->src.s, result->src.binsPerSecond);
+    if (result->src.s.paginate == 1 && result->src.writingSpeed > 0.0 && windows_per_page > 0) {
+        status = spectral_analysis_peak(&result->src, windows_per_page, &result->data, job);
+    } else {
+        status = spectral_compute_analysis(&result->src, 0, &result->data, job);
+        
+        // Renders only read the spectrogram
+        spectral_free_source(&result->src);
+    }
+    
+    if (status != EXIT_SUCCESS) {
+        spectral_free_source(&result->src);
+        free(result->inputFile);
+        free(result);
+        return status;
+    }
+    
+    // The matrix is released with the allocator of the job that created it
+    if (job != NULL) {
+        result->allocator = job->allocator;
+    }
+    
+    *analysis = result;
+    return EXIT_SUCCESS;
+}
+
+/*---------------------------------------------------------------------
+ * spectral_analysis_free()
+ *
+ * Frees an analysis. No render may still use it.
+ *---------------------------------------------------------------------*/
+void spectral_analysis_free(SpectralAnalysis *analysis)
+{
+    if (analysis == NULL) {
+        return;
+    }
+    
+    if (analysis->data.data != NULL && analysis->allocator.release != NULL) {
+        spectral_free_detached(&analysis->allocator, analysis->data.data);
+    } else {
+        free(analysis->data.data);
+    }
+    spectral_free_source(&analysis->src);
+    free(analysis->inputFile);
+    free(analysis);
+}
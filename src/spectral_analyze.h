@@ -0,0 +1,73 @@
+/*
+ * Copyright (C) 2025 - present Ondulab
+ * All rights reserved.
+ *
+ * This software is licensed under terms that can be found in the LICENSE file
+ * in the root directory of this software component.
+ */
+
+#ifndef SPECTRAL_ANALYZE_H
+#define SPECTRAL_ANALYZE_H
+
+#include "spectral_common.h"
+#include "spectral_fft.h"
+
+// Decoded and filtered signal with the resolved settings. A progressive
+// preview renders it twice (draft, then print resolution) without
+// decoding the file again; the signal is freed by spectral_free_source().
+typedef struct SpectralSource {
+    SpectrogramSettings s;      // Settings, duration derived from the writing speed
+    double  minFreq;
+    double  maxFreq;
+    double  writingSpeed;
+    double  binsPerSecond;
+    double  dynamicRangeDB;
+    double  gammaCorr;
+    int     enableDither;
+    double  contrastFactor;
+    int     overlapPreset;
+    int     fftSize;
+    int     sampleRate;
+    int     totalSamples;
+    int     windows;            // Windows analyzed (those of the plan), 0 = every window of the signal
+    double *signal;
+} SpectralSource;
+
+// Analysis shared by the renders (opaque in spectral_generator.h). The
+// signal of src is already freed: renders only read the settings, the
+// tone-mapped spectrogram and the input path. A paginated analysis keeps
+// the signal instead of the matrix (data.data is NULL, data.global_max is
+// that of the recording); renders get each page with spectral_page_matrix().
+struct SpectralAnalysis {
+    SpectralSource    src;
+    SpectrogramData   data;         // Tone-mapped spectrogram, or its shape when paginated
+    SpectralAllocator allocator;    // Allocator of data (release NULL = free)
+    char             *inputFile;    // Path of the analyzed file
+};
+
+// Analysis settings resolved from the user settings, shared by
+// spectral_load_source() and spectral_plan() (spectral_plan.c)
+typedef struct SpectralTiming {
+    double  binsPerSecond;
+    int     overlapPreset;
+    double  overlap;            // Overlap of the preset
+    int     fftSize;            // Window length, in samples
+} SpectralTiming;
+
+// Function prototypes
+void spectral_resolve_timing(const SpectrogramSettings *cfg, SpectralTiming *timing);
+int spectral_page_windows(const SpectrogramSettings *cfg, double binsPerSecond);
+int spectral_load_source(const SpectrogramSettings *cfg, const char *inputFile,
+                         const char *outputFile, SpectralSource *src, SpectralJob *job);
+void spectral_free_source(SpectralSource *src);
+int spectral_compute_analysis(const SpectralSource *src, int pad_size,
+                              SpectrogramData *spectro_data, SpectralJob *job);
+int spectral_page_matrix(const SpectralSource *src, const SpectrogramData *spectro_data,
+                         int first_window, int num_windows,
+                         SpectrogramData *page, SpectralJob *job);
+void spectral_page_matrix_release(const SpectrogramData *spectro_data, SpectrogramData *page,
+                                  SpectralJob *job);
+void spectral_source_with_layout(const SpectralSource *src, const SpectrogramSettings *cfg,
+                                 SpectralSource *view, SpectralJob *job);
+
+#endif /* SPECTRAL_ANALYZE_H */
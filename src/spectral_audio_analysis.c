@@ -0,0 +1,255 @@
+/*
+ * Copyright (C) 2025 - present Ondulab
+ * All rights reserved.
+ *
+ * This software is licensed under terms that can be found in the LICENSE file
+ * in the root directory of this software component.
+ */
+
+#define SPECTRAL_LOG_CATEGORY "audio"
+#include "spectral_audio_analysis.h"
+#include "spectral_common.h"
+
+/*---------------------------------------------------------------------
+ * audio_analysis_compute()
+ *
+ * Reads an audio file once, block by block, and records the peak and
+ * RMS of the mono mix for every block of block_size frames, together
+ * with the file-wide channel peak, mono peak and RMS.
+ *
+ * Returns:
+ *  - 0 on success, non-zero on error.
+ *---------------------------------------------------------------------*/
+int audio_analysis_compute(const char *filename, int block_size, AudioAnalysis *analysis)
+{
+    SNDFILE *sf;
+    SF_INFO info;
+
+    memset(analysis, 0, sizeof(*analysis));
+    memset(&info, 0, sizeof(info));
+
+    if (block_size <= 0) {
+        block_size = AUDIO_ANALYSIS_BLOCK_SIZE;
+    }
+
+    sf = sf_open(filename, SFM_READ, &info);
+    if (sf == NULL) {
+        spectral_log(NULL, SPECTRAL_LOG_ERROR, "Error: Could not open file %s: %s\n", filename, sf_strerror(NULL));
+        return 1;
+    }
+
+    long long num_blocks = (info.frames + block_size - 1) / block_size;
+
+    double *buffer = (double *)malloc((size_t)block_size * info.channels * sizeof(double));
+    AudioBlockSummary *blocks = (AudioBlockSummary *)malloc((size_t)(num_blocks > 0 ? num_blocks : 1) * sizeof(AudioBlockSummary));
+    if (buffer == NULL || blocks == NULL) {
+        free(buffer);
+        free(blocks);
+        sf_close(sf);
+        spectral_log(NULL, SPECTRAL_LOG_ERROR, "Error: Memory allocation failed for audio analysis.\n");
+        return 2;
+    }
+
+    double channel_peak = 0.0;
+    double mono_peak = 0.0;
+    double total_energy = 0.0;
+    long long total_frames = 0;
+    int block_count = 0;
+    sf_count_t frames_read;
+
+    // Single pass: one block summary per read
+    while (block_count < num_blocks &&
+           (frames_read = sf_readf_double(sf, buffer, block_size)) > 0) {
+        double block_peak = 0.0;
+        double block_energy = 0.0;
+
+        for (sf_count_t i = 0; i < frames_read; i++) {
+            double sum = 0.0;
+            for (int j = 0; j < info.channels; j++) {
+                double value = buffer[i * info.channels + j];
+                double abs_value = fabs(value);
+                if (abs_value > channel_peak) {
+                    channel_peak = abs_value;
+                }
+                sum += value;
+            }
+            double mono = sum / info.channels;
+            double abs_mono = fabs(mono);
+            if (abs_mono > block_peak) {
+                block_peak = abs_mono;
+            }
+            block_energy += mono * mono;
+        }
+
+        blocks[block_count].peak = (float)block_peak;
+        blocks[block_count].rms = (float)sqrt(block_energy / frames_read);
+        block_count++;
+
+        if (block_peak > mono_peak) {
+            mono_peak = block_peak;
+        }
+        total_energy += block_energy;
+        total_frames += frames_read;
+    }
+
+    free(buffer);
+    sf_close(sf);
+
+    analysis->sample_rate = info.samplerate;
+    analysis->channels = info.channels;
+    analysis->frames = total_frames;
+    analysis->block_size = block_size;
+    analysis->num_blocks = block_count;
+    analysis->channel_peak = channel_peak;
+    analysis->mono_peak = mono_peak;
+    analysis->rms = total_frames > 0 ? sqrt(total_energy / total_frames) : 0.0;
+    analysis->blocks = blocks;
+
+    return 0;
+}
+
+/*---------------------------------------------------------------------
+ * audio_analysis_save()
+ *
+ * Writes an analysis to a sidecar file (native byte order) so that it
+ * can be reloaded without decoding the audio again.
+ *
+ * Returns:
+ *  - 0 on success, non-zero on error.
+ *---------------------------------------------------------------------*/
+int audio_analysis_save(const AudioAnalysis *analysis, const char *path)
+{
+    FILE *fp = fopen(path, "wb");
+    if (fp == NULL) {
+        spectral_log(NULL, SPECTRAL_LOG_ERROR, "Error: Could not create analysis file %s\n", path);
+        return 1;
+    }
+
+    int version = AUDIO_ANALYSIS_VERSION;
+    int ok = fwrite(AUDIO_ANALYSIS_MAGIC, 1, 4, fp) == 4
+          && fwrite(&version, sizeof(version), 1, fp) == 1
+          && fwrite(&analysis->sample_rate, sizeof(analysis->sample_rate), 1, fp) == 1
+          && fwrite(&analysis->channels, sizeof(analysis->channels), 1, fp) == 1
+          && fwrite(&analysis->frames, sizeof(analysis->frames), 1, fp) == 1
+          && fwrite(&analysis->block_size, sizeof(analysis->block_size), 1, fp) == 1
+          && fwrite(&analysis->num_blocks, sizeof(analysis->num_blocks), 1, fp) == 1
+          && fwrite(&analysis->channel_peak, sizeof(analysis->channel_peak), 1, fp) == 1
+          && fwrite(&analysis->mono_peak, sizeof(analysis->mono_peak), 1, fp) == 1
+          && fwrite(&analysis->rms, sizeof(analysis->rms), 1, fp) == 1
+          && fwrite(analysis->blocks, sizeof(AudioBlockSummary), (size_t)analysis->num_blocks, fp)
+                 == (size_t)analysis->num_blocks;
+
+    if (fclose(fp) != 0 || !ok) {
+        spectral_log(NULL, SPECTRAL_LOG_ERROR, "Error: Could not write analysis file %s\n", path);
+        remove(path);
+        return 2;
+    }
+
+    return 0;
+}
+
+/*---------------------------------------------------------------------
+ * audio_analysis_load()
+ *
+ * Reads an analysis previously written by audio_analysis_save().
+ *
+ * Returns:
+ *  - 0 on success
+ *  - 1 if the file cannot be opened
+ *  - 2 if the file is not a valid analysis of the current version
+ *  - 3 on memory allocation failure
+ *---------------------------------------------------------------------*/
+int audio_analysis_load(const char *path, AudioAnalysis *analysis)
+{
+    memset(analysis, 0, sizeof(*analysis));
+
+    FILE *fp = fopen(path, "rb");
+    if (fp == NULL) {
+        return 1;
+    }
+
+    char magic[4];
+    int version = 0;
+    int ok = fread(magic, 1, 4, fp) == 4
+          && memcmp(magic, AUDIO_ANALYSIS_MAGIC, 4) == 0
+          && fread(&version, sizeof(version), 1, fp) == 1
+          && version == AUDIO_ANALYSIS_VERSION
+          && fread(&analysis->sample_rate, sizeof(analysis->sample_rate), 1, fp) == 1
+          && fread(&analysis->channels, sizeof(analysis->channels), 1, fp) == 1
+          && fread(&analysis->frames, sizeof(analysis->frames), 1, fp) == 1
+          && fread(&analysis->block_size, sizeof(analysis->block_size), 1, fp) == 1
+          && fread(&analysis->num_blocks, sizeof(analysis->num_blocks), 1, fp) == 1
+          && fread(&analysis->channel_peak, sizeof(analysis->channel_peak), 1, fp) == 1
+          && fread(&analysis->mono_peak, sizeof(analysis->mono_peak), 1, fp) == 1
+          && fread(&analysis->rms, sizeof(analysis->rms), 1, fp) == 1
+          && analysis->block_size > 0
+          && analysis->num_blocks >= 0;
+
+    if (!ok) {
+        fclose(fp);
+        memset(analysis, 0, sizeof(*analysis));
+        return 2;
+    }
+
+    analysis->blocks = (AudioBlockSummary *)malloc((size_t)(analysis->num_blocks > 0 ? analysis->num_blocks : 1) * sizeof(AudioBlockSummary));
+    if (analysis->blocks == NULL) {
+        fclose(fp);
+        memset(analysis, 0, sizeof(*analysis));
+        return 3;
+    }
+
+    if (fread(analysis->blocks, sizeof(AudioBlockSummary), (size_t)analysis->num_blocks, fp)
+            != (size_t)analysis->num_blocks) {
+        fclose(fp);
+        audio_analysis_free(analysis);
+        return 2;
+    }
+
+    fclose(fp);
+    return 0;
+}
+
+/*---------------------------------------------------------------------
+ * audio_analysis_range_peak()
+ *
+ * Returns the peak of the mono mix over a frame range, using the block
+ * summaries that overlap it. The result is exact when the range is
+ * block-aligned and an upper bound otherwise.
+ *---------------------------------------------------------------------*/
+double audio_analysis_range_peak(const AudioAnalysis *analysis, long long start_frame, long long frame_count)
+{
+    if (analysis == NULL || analysis->blocks == NULL || analysis->num_blocks == 0 || frame_count <= 0) {
+        return 0.0;
+    }
+
+    if (start_frame < 0) {
+        start_frame = 0;
+    }
+
+    long long first_block = start_frame / analysis->block_size;
+    long long last_block = (start_frame + frame_count - 1) / analysis->block_size;
+    if (last_block >= analysis->num_blocks) {
+        last_block = analysis->num_blocks - 1;
+    }
+
+    double peak = 0.0;
+    for (long long b = first_block; b <= last_block; b++) {
+        if (analysis->blocks[b].peak > peak) {
+            peak = analysis->blocks[b].peak;
+        }
+    }
+
+    return peak;
+}
+
+/*---------------------------------------------------------------------
+ * audio_analysis_free()
+ *
+ * Frees the block summaries of an analysis.
+ *---------------------------------------------------------------------*/
+void audio_analysis_free(AudioAnalysis *analysis)
+{
+    if (analysis == NULL) return;
+    free(analysis->blocks);
+    memset(analysis, 0, sizeof(*analysis));
+}
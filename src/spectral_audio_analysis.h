@@ -0,0 +1,57 @@
+/*
+ * Copyright (C) 2025 - present Ondulab
+ * All rights reserved.
+ *
+ * This software is licensed under terms that can be found in the LICENSE file
+ * in the root directory of this software component.
+ */
+
+#ifndef SPECTRAL_AUDIO_ANALYSIS_H
+#define SPECTRAL_AUDIO_ANALYSIS_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <sndfile.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Analysis parameters */
+#define AUDIO_ANALYSIS_BLOCK_SIZE  4096       /* Frames summarized by one block */
+#define AUDIO_ANALYSIS_MAGIC       "S3AN"     /* Sidecar file signature */
+#define AUDIO_ANALYSIS_VERSION     1          /* Sidecar format version */
+
+// Peak/RMS summary of one block of the mono mix
+typedef struct AudioBlockSummary {
+    float peak;             // Maximum absolute amplitude in the block
+    float rms;              // RMS amplitude of the block
+} AudioBlockSummary;
+
+// Whole-file analysis, computed in a single pass over the audio
+typedef struct AudioAnalysis {
+    int sample_rate;        // Sample rate of the analyzed file
+    int channels;           // Number of channels of the analyzed file
+    long long frames;       // Total number of frames
+    int block_size;         // Frames per block summary
+    int num_blocks;         // Number of block summaries
+    double channel_peak;    // Maximum absolute amplitude over all channels
+    double mono_peak;       // Maximum absolute amplitude of the mono mix
+    double rms;             // RMS amplitude of the mono mix
+    AudioBlockSummary *blocks;
+} AudioAnalysis;
+
+// Function prototypes
+int audio_analysis_compute(const char *filename, int block_size, AudioAnalysis *analysis);
+int audio_analysis_save(const AudioAnalysis *analysis, const char *path);
+int audio_analysis_load(const char *path, AudioAnalysis *analysis);
+double audio_analysis_range_peak(const AudioAnalysis *analysis, long long start_frame, long long frame_count);
+void audio_analysis_free(AudioAnalysis *analysis);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SPECTRAL_AUDIO_ANALYSIS_H */
@@ -0,0 +1,342 @@
+/*
+ * Copyright (C) 2025 - present Ondulab
+ * All rights reserved.
+ *
+ * This software is licensed under terms that can be found in the LICENSE file
+ * in the root directory of this software component.
+ */
+
+/*
+ * Benchmark of the generation pipeline on synthetic recordings.
+ *
+ * For every point of a parameter matrix (signal, duration, sample rate,
+ * channels, bins/s, overlap preset), a reproducible recording is written
+ * once, then analyzed and rendered to PNG several times. The time of each
+ * stage (decode, filter, FFT, tone map, raster, encode) is taken from the
+ * completion reports of the job, so the measured code is exactly the one
+ * of the application. The results are written as JSON, to be compared
+ * between commits.
+ */
+
+#include "spectral_common.h"
+#include "spectral_analyze.h"
+#include "spectral_synth.h"
+#include <unistd.h>
+
+#define BENCH_MAX_VALUES    16          /* Values per matrix dimension */
+#define BENCH_MAX_REPEATS   64
+
+/* JSON keys of the stages (load_wav_file, filters, compute_spectrogram,
+   apply_image_processing, raster drawing, PNG writing) */
+static const char *bench_stage_keys[SPECTRAL_STAGE_COUNT] = {
+    "decode", "filter", "fft", "tone_map", "raster", "encode"
+};
+
+typedef struct BenchMatrix {
+    int     signals[BENCH_MAX_VALUES];
+    int     num_signals;
+    double  durations[BENCH_MAX_VALUES];
+    int     num_durations;
+    double  rates[BENCH_MAX_VALUES];
+    int     num_rates;
+    double  channels[BENCH_MAX_VALUES];
+    int     num_channels;
+    double  bins_per_second[BENCH_MAX_VALUES];
+    int     num_bins_per_second;
+    double  overlaps[BENCH_MAX_VALUES];
+    int     num_overlaps;
+    int     repeats;
+} BenchMatrix;
+
+/* End time of every stage of the current run */
+typedef struct BenchClock {
+    double  stage_end[SPECTRAL_STAGE_COUNT];
+} BenchClock;
+
+static double bench_now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+/*---------------------------------------------------------------------
+ * bench_record_stage()
+ *
+ * Progress callback: the completion report of a stage always reaches
+ * the callback, whatever the throttling interval.
+ *---------------------------------------------------------------------*/
+static void bench_record_stage(void *userData, SpectralStage stage,
+                               double stageFraction, double overallFraction)
+{
+    (void)overallFraction;
+    BenchClock *clock = (BenchClock *)userData;
+    if (stageFraction >= 1.0) {
+        clock->stage_end[stage] = bench_now();
+    }
+}
+
+/* Parses a comma-separated list of numbers */
+static int bench_parse_list(const char *text, double *values, int max_values)
+{
+    int count = 0;
+    char *copy = strdup(text);
+    for (char *item = strtok(copy, ","); item != NULL && count < max_values; item = strtok(NULL, ",")) {
+        values[count++] = atof(item);
+    }
+    free(copy);
+    return count;
+}
+
+static int bench_compare(const void *a, const void *b)
+{
+    double x = *(const double *)a;
+    double y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+/* Writes {"min": ..., "median": ..., "mean": ...} of a series of durations in ms */
+static void bench_write_stats(FILE *out, const char *name, double *values, int count)
+{
+    double sum = 0.0;
+    for (int i = 0; i < count; i++) {
+        sum += values[i];
+    }
+    qsort(values, count, sizeof(double), bench_compare);
+    double median = (count % 2) ? values[count / 2] : 0.5 * (values[count / 2 - 1] + values[count / 2]);
+    fprintf(out, "\"%s\": {\"min\": %.3f, \"median\": %.3f, \"mean\": %.3f}",
+            name, values[0], median, sum / count);
+}
+
+/*---------------------------------------------------------------------
+ * bench_run_point()
+ *
+ * Analyzes and renders one recording repeats times with the given
+ * settings, and writes the JSON object of the point.
+ *
+ * Returns:
+ *  - EXIT_SUCCESS on success, EXIT_FAILURE if a generation failed.
+ *---------------------------------------------------------------------*/
+static int bench_run_point(FILE *out, const char *source, const char *png,
+                           const SpectrogramSettings *settings, int repeats,
+                           const char *signal_name, double duration,
+                           int sample_rate, int channels)
+{
+    double stage_ms[SPECTRAL_STAGE_COUNT][BENCH_MAX_REPEATS];
+    double total_ms[BENCH_MAX_REPEATS];
+    int num_windows = 0;
+    int fft_size = 0;
+
+    for (int r = 0; r < repeats; r++) {
+        BenchClock clock;
+        memset(&clock, 0, sizeof(clock));
+
+        SpectralJob job;
+        spectral_job_init(&job, 0.0);
+        // Only the completion reports matter: throttle everything else away
+        spectral_job_set_progress(&job, bench_record_stage, &clock, 1.0e9);
+
+        double start = bench_now();
+        SpectralAnalysis *analysis = NULL;
+        int status = spectral_analyze(settings, source, &analysis, &job);
+        double render_start = bench_now();
+        if (status == EXIT_SUCCESS) {
+            num_windows = analysis->data.num_windows;
+            fft_size = analysis->src.fftSize;
+            status = spectral_render_png(analysis, NULL, png, &job);
+            spectral_analysis_free(analysis);
+        }
+        double end = bench_now();
+        unlink(png);
+
+        if (status != EXIT_SUCCESS) {
+            fprintf(stderr, "bench: generation failed on %s (%d)\n", source, status);
+            return EXIT_FAILURE;
+        }
+
+        // A stage lasts from the end of the previous one; the render starts its own chain
+        double previous = start;
+        for (int stage = 0; stage < SPECTRAL_STAGE_COUNT; stage++) {
+            if (stage == SPECTRAL_STAGE_RASTER) {
+                previous = render_start;
+            }
+            double stage_end = clock.stage_end[stage] > 0.0 ? clock.stage_end[stage] : previous;
+            stage_ms[stage][r] = (stage_end - previous) * 1000.0;
+            previous = stage_end;
+        }
+        total_ms[r] = (end - start) * 1000.0;
+    }
+
+    fprintf(out, "    {\"signal\": \"%s\", \"duration_s\": %.3f, \"sample_rate\": %d, \"channels\": %d, "
+                 "\"bins_per_second\": %.1f, \"overlap_preset\": %d, \"fft_size\": %d, \"windows\": %d, "
+                 "\"repeats\": %d,\n     \"stages_ms\": {",
+            signal_name, duration, sample_rate, channels, settings->binsPerSecond,
+            settings->overlapPreset, fft_size, num_windows, repeats);
+    for (int stage = 0; stage < SPECTRAL_STAGE_COUNT; stage++) {
+        bench_write_stats(out, bench_stage_keys[stage], stage_ms[stage], repeats);
+        fputs(stage + 1 < SPECTRAL_STAGE_COUNT ? ", " : "},\n     ", out);
+    }
+    bench_write_stats(out, "total_ms", total_ms, repeats);
+    fputs("}", out);
+    return EXIT_SUCCESS;
+}
+
+static void bench_usage(const char *program)
+{
+    fprintf(stderr,
+            "Usage: %s [options]\n"
+            "  --signals LIST      sine,chirp,pink,impulses (default: all)\n"
+            "  --durations LIST    Seconds, e.g. 10,600,3600 (default: 10,60)\n"
+            "  --rates LIST        Sample rates in Hz (default: 44100,96000,192000,384000)\n"
+            "  --channels LIST     Channel counts (default: 1,2)\n"
+            "  --bps LIST          Bins per second (default: %.0f)\n"
+            "  --overlap LIST      Overlap presets 0-2 (default: %d)\n"
+            "  --repeat N          Runs per point (default: 3)\n"
+            "  --workdir DIR       Directory of the synthetic recordings (default: .)\n"
+            "  --keep              Keep the synthetic recordings\n"
+            "  --label TEXT        Label of the run in the report (e.g. a commit hash)\n"
+            "  --output FILE       JSON report (default: bench.json)\n",
+            program, DEFAULT_BINS_PER_SECOND, DEFAULT_OVERLAP_PRESET);
+}
+
+int main(int argc, char *argv[])
+{
+    BenchMatrix m;
+    memset(&m, 0, sizeof(m));
+    for (int i = 0; i < SYNTH_SIGNAL_COUNT; i++) {
+        m.signals[m.num_signals++] = i;
+    }
+    m.num_durations = bench_parse_list("10,60", m.durations, BENCH_MAX_VALUES);
+    m.num_rates = bench_parse_list("44100,96000,192000,384000", m.rates, BENCH_MAX_VALUES);
+    m.num_channels = bench_parse_list("1,2", m.channels, BENCH_MAX_VALUES);
+    m.bins_per_second[m.num_bins_per_second++] = DEFAULT_BINS_PER_SECOND;
+    m.overlaps[m.num_overlaps++] = DEFAULT_OVERLAP_PRESET;
+    m.repeats = 3;
+
+    const char *workdir = ".";
+    const char *label = "";
+    const char *output = "bench.json";
+    int keep = 0;
+
+    for (int i = 1; i < argc; i++) {
+        const char *arg = argv[i];
+        const char *value = (i + 1 < argc) ? argv[i + 1] : NULL;
+        int takes_value = 1;
+
+        if (strcmp(arg, "--keep") == 0) {
+            keep = 1;
+            takes_value = 0;
+        } else if (value == NULL) {
+            bench_usage(argv[0]);
+            return EXIT_FAILURE;
+        } else if (strcmp(arg, "--signals") == 0) {
+            m.num_signals = synth_parse_signals(value, m.signals, BENCH_MAX_VALUES);
+        } else if (strcmp(arg, "--durations") == 0) {
+            m.num_durations = bench_parse_list(value, m.durations, BENCH_MAX_VALUES);
+        } else if (strcmp(arg, "--rates") == 0) {
+            m.num_rates = bench_parse_list(value, m.rates, BENCH_MAX_VALUES);
+        } else if (strcmp(arg, "--channels") == 0) {
+            m.num_channels = bench_parse_list(value, m.channels, BENCH_MAX_VALUES);
+        } else if (strcmp(arg, "--bps") == 0) {
+            m.num_bins_per_second = bench_parse_list(value, m.bins_per_second, BENCH_MAX_VALUES);
+        } else if (strcmp(arg, "--overlap") == 0) {
+            m.num_overlaps = bench_parse_list(value, m.overlaps, BENCH_MAX_VALUES);
+        } else if (strcmp(arg, "--repeat") == 0) {
+            m.repeats = atoi(value);
+        } else if (strcmp(arg, "--workdir") == 0) {
+            workdir = value;
+        } else if (strcmp(arg, "--label") == 0) {
+            label = value;
+        } else if (strcmp(arg, "--output") == 0) {
+            output = value;
+        } else {
+            bench_usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+        i += takes_value;
+    }
+
+    if (m.num_signals <= 0 || m.num_durations <= 0 || m.num_rates <= 0 || m.num_channels <= 0 ||
+        m.num_bins_per_second <= 0 || m.num_overlaps <= 0 ||
+        m.repeats < 1 || m.repeats > BENCH_MAX_REPEATS) {
+        bench_usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    // The generator messages would drown the report
+    spectral_log_set_level(SPECTRAL_LOG_ERROR);
+
+    FILE *out = fopen(output, "w");
+    if (out == NULL) {
+        fprintf(stderr, "bench: cannot write %s\n", output);
+        return EXIT_FAILURE;
+    }
+
+    fprintf(out, "{\n  \"version\": 1,\n  \"label\": \"%s\",\n  \"timestamp\": %ld,\n"
+                 "  \"cpus\": %ld,\n  \"results\": [\n",
+            label, (long)time(NULL), sysconf(_SC_NPROCESSORS_ONLN));
+
+    char source[SPECTRAL_PATH_MAX];
+    char png[SPECTRAL_PATH_MAX];
+    snprintf(png, sizeof(png), "%s/bench_output.png", workdir);
+    int status = EXIT_SUCCESS;
+    int first = 1;
+
+    for (int si = 0; si < m.num_signals && status == EXIT_SUCCESS; si++)
+    for (int di = 0; di < m.num_durations && status == EXIT_SUCCESS; di++)
+    for (int ri = 0; ri < m.num_rates && status == EXIT_SUCCESS; ri++)
+    for (int ci = 0; ci < m.num_channels && status == EXIT_SUCCESS; ci++) {
+        SynthSignal signal = (SynthSignal)m.signals[si];
+        double duration = m.durations[di];
+        int sample_rate = (int)m.rates[ri];
+        int channels = (int)m.channels[ci];
+
+        snprintf(source, sizeof(source), "%s/bench_%s_%.0fs_%dHz_%dch.wav",
+                 workdir, synth_signal_names[signal], duration, sample_rate, channels);
+        if (access(source, R_OK) != 0 &&
+            synth_write_source(source, signal, duration, sample_rate, channels) != 0) {
+            status = EXIT_FAILURE;
+            break;
+        }
+
+        for (int bi = 0; bi < m.num_bins_per_second && status == EXIT_SUCCESS; bi++)
+        for (int oi = 0; oi < m.num_overlaps && status == EXIT_SUCCESS; oi++) {
+            // Whole recording on one page, with both filters so that every stage has work
+            SpectrogramSettings settings;
+            memset(&settings, 0, sizeof(settings));
+            settings.duration = duration;
+            settings.sampleRate = sample_rate;
+            settings.binsPerSecond = m.bins_per_second[bi];
+            settings.overlapPreset = (int)m.overlaps[oi];
+            settings.enableNormalization = 1;
+            settings.enableVerticalScale = 1;
+            settings.enableHighPassFilter = 1;
+            settings.highPassCutoffFreq = 100.0;
+            settings.highPassFilterOrder = 2;
+            settings.enableHighBoost = 1;
+
+            fprintf(stderr, "bench: %s %.0f s %d Hz %d ch, %.0f bins/s, overlap %d\n",
+                    synth_signal_names[signal], duration, sample_rate, channels,
+                    settings.binsPerSecond, settings.overlapPreset);
+
+            if (!first) {
+                fputs(",\n", out);
+            }
+            first = 0;
+            status = bench_run_point(out, source, png, &settings, m.repeats,
+                                     synth_signal_names[signal], duration, sample_rate, channels);
+        }
+
+        if (!keep) {
+            unlink(source);
+        }
+    }
+
+    fputs("\n  ]\n}\n", out);
+    fclose(out);
+
+    if (status == EXIT_SUCCESS) {
+        fprintf(stderr, "bench: report written to %s\n", output);
+    }
+    return status;
+}
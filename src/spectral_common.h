@@ -17,6 +17,7 @@
 #include <cairo/cairo.h>
 #include <sndfile.h>
 #include <time.h>
+#include <stdarg.h>
 #include "../include/spectral_generator.h"
 #include "../include/SharedConstants.h"
 
@@ -37,6 +38,7 @@
 #define TOP_MARGIN             (1600.0/(800/PRINTER_DPI))
 #define DEFAULT_BOTTOM_MARGIN  (DEFAULT_BOTTOM_MARGIN_MM * MM_TO_PIXELS)
 #define DEFAULT_SPECTRO_HEIGHT (DEFAULT_SPECTRO_HEIGHT_MM * MM_TO_PIXELS)
+#define LABEL_MARGIN           150.0    /* Frequency labels left of the spectrogram */
 
 /* Image processing parameters */
 #define USE_LOG_AMPLITUDE      1
@@ -47,22 +49,149 @@
 
 /* FFT-related options */
 #define USE_ZERO_PADDING         1    /* Use zero-padding solution */
-#define USE_HYBRID_FFT           0    /* Use hybrid FFT for low frequencies */
+#define USE_HYBRID_FFT           1    /* Use hybrid FFT for low frequencies */
 #define USE_MODIFIED_LOG_MAPPING 0    /* Use modified logarithmic mapping */
 
 #if USE_ZERO_PADDING
     #define ZERO_PAD_SIZE 65535
+    #define SPECTRAL_DRAFT_PAD_FACTOR 4   /* Drafts pad the FFT to 4x its size only */
 #endif
 
+/* Multi-resolution analysis (fft_hybrid_layout()): a long window on a
+   decimated signal below the crossover, a short one above it */
 #if USE_HYBRID_FFT
-    #define HYBRID_LOW_FREQ_THRESHOLD 500.0
-    #define HYBRID_FFT_SIZE 65535
+    #define HYBRID_LOW_FREQ_THRESHOLD 500.0   /* Crossover frequency, in Hz */
+    #define HYBRID_BLEND_OCTAVES      0.25    /* Cross-fade of the two windows below the crossover */
+    #define HYBRID_LOW_WINDOW_FACTOR  4       /* Long window, in short windows */
+    #define HYBRID_PAD_FACTOR         4       /* Both transforms padded to 4x their window */
+    #define HYBRID_FILTER_TAPS        12      /* Anti-aliasing filter taps per unit of decimation */
 #endif
 
+/* Constant-Q engine (spectral_cqt.c), selected by SpectrogramSettings::analysisEngine */
+#define CQT_WINDOW_FACTOR    4         /* Window of the lowest bin, in FFT windows */
+#define CQT_MIN_Q            2.0       /* Shortest window of a bin, in periods */
+#define CQT_KERNEL_THRESHOLD 0.0054    /* Spectral kernel coefficients kept, relative to its peak */
+#define CQT_KERNEL_CHUNK     16        /* Kernel bins per parallel task */
+
 #if USE_MODIFIED_LOG_MAPPING
     #define LOG_MAPPING_EXPONENT 0.7
 #endif
 
+/* Cancellation: the job is polled once per block of FFT windows / render columns */
+#define SPECTRAL_JOB_POLL_INTERVAL 64
+
+/* Overall progress at the end of the draft of spectral_generator_progressive();
+   the refinement reports the rest */
+#define SPECTRAL_DRAFT_PROGRESS 0.30
+
+/* Gray levels of the vector PDF cells (cells of one level are merged and
+   filled together): coarser than the 8-bit PNG, so that neighbouring cells
+   of close intensities merge; the embedded image keeps 8 bits */
+#define SPECTRAL_PDF_GRAY_LEVELS 64
+
+/* Atomic accesses of the fields shared between threads: relaxed counters
+   of the parallel stages and run-time switches (log level, tracing),
+   acquire/release flags of the job (int only).
+   The GCC/Clang builtins, or the MSVC interlocked intrinsics (full
+   barriers); there is no unsynchronized fallback. */
+#if defined(__GNUC__) || defined(__clang__)
+    #define SPECTRAL_ATOMIC_INCREMENT(ptr)     __atomic_add_fetch((ptr), 1, __ATOMIC_RELAXED)
+    #define SPECTRAL_ATOMIC_ADD(ptr, value)    __atomic_add_fetch((ptr), (value), __ATOMIC_RELAXED)
+    #define SPECTRAL_ATOMIC_STORE(ptr, value)  __atomic_store_n((ptr), (value), __ATOMIC_RELAXED)
+    #define SPECTRAL_ATOMIC_LOAD(ptr)          __atomic_load_n((ptr), __ATOMIC_RELAXED)
+    #define SPECTRAL_ATOMIC_LOAD_ACQUIRE(ptr)  __atomic_load_n((ptr), __ATOMIC_ACQUIRE)
+    #define SPECTRAL_ATOMIC_STORE_RELEASE(ptr, value) __atomic_store_n((ptr), (value), __ATOMIC_RELEASE)
+    #define SPECTRAL_ATOMIC_EXCHANGE(ptr, value) __atomic_exchange_n((ptr), (value), __ATOMIC_ACQ_REL)
+#elif defined(_MSC_VER)
+    #include <intrin.h>
+    #define SPECTRAL_ATOMIC_ADD(ptr, value) \
+        (sizeof(*(ptr)) == 8 ? _InterlockedExchangeAdd64((volatile __int64 *)(ptr), (__int64)(value)) + (value) \
+                             : _InterlockedExchangeAdd((volatile long *)(ptr), (long)(value)) + (value))
+    #define SPECTRAL_ATOMIC_INCREMENT(ptr)     SPECTRAL_ATOMIC_ADD((ptr), 1)
+    #define SPECTRAL_ATOMIC_STORE(ptr, value)  ((void)_InterlockedExchange((volatile long *)(ptr), (long)(value)))
+    #define SPECTRAL_ATOMIC_LOAD_ACQUIRE(ptr)  ((int)_InterlockedOr((volatile long *)(ptr), 0))
+    #define SPECTRAL_ATOMIC_LOAD(ptr)          SPECTRAL_ATOMIC_LOAD_ACQUIRE(ptr)
+    #define SPECTRAL_ATOMIC_STORE_RELEASE(ptr, value) SPECTRAL_ATOMIC_STORE((ptr), (value))
+    #define SPECTRAL_ATOMIC_EXCHANGE(ptr, value) ((int)_InterlockedExchange((volatile long *)(ptr), (long)(value)))
+#else
+    #error "Sp3ctraGen needs the GCC/Clang atomic builtins or the MSVC interlocked intrinsics"
+#endif
+
+/* Thread-local storage of the trace buffers and stage timers */
+#ifdef _WIN32
+    #define SPECTRAL_THREAD_LOCAL __declspec(thread)
+#else
+    #define SPECTRAL_THREAD_LOCAL __thread
+#endif
+
+/* Adds amount to a counter of the job's statistics (no-op for a NULL job) */
+#define SPECTRAL_JOB_COUNT(job, counter, amount) \
+    do { \
+        if ((job) != NULL) { \
+            SPECTRAL_ATOMIC_ADD(&(job)->stats.counter, (long long)(amount)); \
+        } \
+    } while (0)
+
+/* Size prefix of the buffers of spectral_alloc(), keeping their 16-byte alignment */
+#define SPECTRAL_ALLOC_HEADER 16
+
+/* Longest message formatted by spectral_log() */
+#define SPECTRAL_LOG_MAX_LENGTH 1024
+
+/* Messages waiting for the logging thread (power of two); when the queue is
+   full, messages below SPECTRAL_LOG_ERROR are dropped and counted */
+#define SPECTRAL_LOG_QUEUE_SIZE 256
+
+/* Messages below this level are compiled out (the release builds define it
+   to SPECTRAL_LOG_INFO in spectral_core.pri) */
+#ifndef SPECTRAL_LOG_MIN_LEVEL
+    #define SPECTRAL_LOG_MIN_LEVEL SPECTRAL_LOG_DEBUG
+#endif
+
+/* Category of the messages of a source file, defined before its includes */
+#ifndef SPECTRAL_LOG_CATEGORY
+    #define SPECTRAL_LOG_CATEGORY "core"
+#endif
+
+/* Plans kept by a plan cache (one per FFT size) */
+#define SPECTRAL_PLAN_CACHE_CAPACITY 16
+
+/* Leveled logging (spectral_log.c); a NULL job writes to stdout/stderr */
+void spectral_log_message(SpectralJob *job, SpectralLogLevel level, const char *category,
+                          const char *format, ...)
+#if defined(__GNUC__)
+    __attribute__((format(printf, 4, 5)))
+#endif
+    ;
+#define spectral_log(job, level, ...) \
+    do { \
+        if ((level) >= SPECTRAL_LOG_MIN_LEVEL) { \
+            spectral_log_message((job), (level), SPECTRAL_LOG_CATEGORY, __VA_ARGS__); \
+        } \
+    } while (0)
+
+/* Job context helpers (spectral_generator.c); all accept a NULL job */
+void *spectral_alloc(SpectralJob *job, size_t size);
+void spectral_free(SpectralJob *job, void *ptr);
+void spectral_free_detached(const SpectralAllocator *allocator, void *ptr);
+unsigned long long spectral_job_seed(const SpectralJob *job);
+void spectral_job_progress_range(SpectralJob *job, SpectralStage first, SpectralStage last, double end);
+double spectral_random_uniform(unsigned long long *state);
+void spectral_parallel_for(SpectralJob *job, int count,
+                           void (*body)(void *arg, int index), void *arg);
+
+/* Wall and CPU time of one run of a stage, added to the job's statistics.
+   The parallel loops started in between charge their helper threads' CPU
+   time to the stage. */
+typedef struct SpectralStageTimer {
+    double wall;
+    double cpu;
+    int    previousStage;
+} SpectralStageTimer;
+
+void spectral_stage_begin(SpectralJob *job, SpectralStage stage, SpectralStageTimer *timer);
+void spectral_stage_end(SpectralJob *job, SpectralStage stage, const SpectralStageTimer *timer);
+
 /* Exit status */
 #ifndef EXIT_SUCCESS
     #define EXIT_SUCCESS 0
@@ -0,0 +1,523 @@
+/*
+ * Copyright (C) 2025 - present Ondulab
+ * All rights reserved.
+ *
+ * This software is licensed under terms that can be found in the LICENSE file
+ * in the root directory of this software component.
+ */
+
+#define SPECTRAL_LOG_CATEGORY "cqt"
+#include "spectral_cqt.h"
+
+/*
+ * Constant-Q transform after Brown and Puckette: the windowed complex
+ * exponential of every bin (its temporal kernel) is transformed once, and
+ * only the coefficients of its spectrum above CQT_KERNEL_THRESHOLD are
+ * kept. Each hop then runs a single FFT of the signal, and every bin is
+ * the dot product of that spectrum with its sparse spectral kernel
+ * (Parseval). Bins are geometrically spaced, one per pixel row of the
+ * spectrogram, so the page draws each of them exactly once.
+ *
+ * The saving is downstream of the analysis: tone mapping and raster
+ * handle one bin per row instead of the thousands of bins of the padded
+ * FFT. The analysis itself is not cheaper than the multi-resolution FFT:
+ * the high bins have windows of a few periods, hence wide spectral
+ * kernels (see cqt_window_work()).
+ */
+
+/* Kept width of a spectral kernel, in bins of its own window (main lobe
+   of the Hann window and the sidelobes above the threshold); only used to
+   estimate the work of the plan */
+#define CQT_KERNEL_SPAN 7.5
+
+// Sparse spectral kernel of one bin: the conjugated coefficients of the
+// FFT bins [first, first + count), divided by the transform size
+typedef struct CqtKernelBin {
+    int     first;
+    int     count;
+    double *coefficients;       // count interleaved (real, imaginary) pairs
+} CqtKernelBin;
+
+// Shared state of the kernel computation and of the parallel hops
+typedef struct CqtContext {
+    const CqtLayout *layout;
+    int sample_rate;
+    double min_freq;
+    fftw_plan plan;             // Transform of layout->transform_size, shared
+    CqtKernelBin *kernel;       // layout->bins sparse kernels
+    long long kernel_entries;   // Coefficients kept, all bins together
+    const double *signal;
+    int total_samples;
+    int fft_size;
+    int step;
+    int first_window;           // Window of the recording in row 0
+    int num_windows;
+    int num_blocks;
+    double *spectrogram;
+    double *block_max;          // Maximum magnitude of each block
+    volatile int blocks_done;   // Completed blocks, for progress
+    volatile int failed;        // Set if a task could not allocate its buffers
+    SpectralJob *job;
+} CqtContext;
+
+/*---------------------------------------------------------------------
+ * cqt_rows()
+ *
+ * Returns the pixel rows of the spectrogram of the PNG render, the bins
+ * of a constant-Q analysis with these settings.
+ *---------------------------------------------------------------------*/
+int cqt_rows(const SpectrogramSettings *cfg)
+{
+    return (int)lround(DEFAULT_DBL(cfg->spectroHeightMM * MM_TO_PIXELS, DEFAULT_SPECTRO_HEIGHT));
+}
+
+/*---------------------------------------------------------------------
+ * cqt_layout()
+ *
+ * Lays out a constant-Q analysis of rows bins over [min_freq, max_freq].
+ * The window of the lowest bin is CQT_WINDOW_FACTOR windows of fft_size
+ * samples, which sets the quality factor of all bins: the resolution
+ * slider keeps its meaning, and higher bins get proportionally shorter
+ * windows. The bandwidth never drops below the spacing of the bins nor
+ * the window below CQT_MIN_Q periods. A min_freq of 0 or less, which has
+ * no octave, stands for DEFAULT_MIN_FREQ (as in compute_constant_q()).
+ *
+ * Returns:
+ *  - 0 on success, non-zero if the range or the rows cannot be analyzed.
+ *---------------------------------------------------------------------*/
+int cqt_layout(int sample_rate, int fft_size, double min_freq, double max_freq, int rows,
+               CqtLayout *layout)
+{
+    min_freq = DEFAULT_DBL(min_freq, DEFAULT_MIN_FREQ);
+    if (rows < 2 || max_freq <= min_freq || sample_rate <= 0) {
+        return 1;
+    }
+
+    layout->bins = rows;
+    layout->bins_per_octave = rows / log2(max_freq / min_freq);
+
+    double bin_q = 1.0 / (pow(2.0, 1.0 / layout->bins_per_octave) - 1.0);
+    double q = (double)CQT_WINDOW_FACTOR * fft_size * min_freq / sample_rate;
+    if (q > bin_q) q = bin_q;
+    if (q < CQT_MIN_Q) q = CQT_MIN_Q;
+    layout->q = q;
+
+    layout->longest_window = (int)lround(q * sample_rate / min_freq);
+    layout->transform_size = 1;
+    while (layout->transform_size < layout->longest_window) {
+        layout->transform_size <<= 1;
+    }
+    return 0;
+}
+
+/*---------------------------------------------------------------------
+ * cqt_window_work()
+ *
+ * Returns the work units of one hop of compute_constant_q() (n log2 n
+ * for the transform, one unit per kernel coefficient), for the cost
+ * model of spectral_plan().
+ *---------------------------------------------------------------------*/
+double cqt_window_work(const CqtLayout *layout, int sample_rate, double min_freq)
+{
+    double size = layout->transform_size;
+    double work = size * log2(size);
+    for (int k = 0; k < layout->bins; k++) {
+        double freq = min_freq * pow(2.0, k / layout->bins_per_octave);
+        if (freq >= sample_rate / 2.0) {
+            break;
+        }
+        double span = CQT_KERNEL_SPAN * size * freq / (layout->q * sample_rate);
+        work += fmin(span, size / 2 + 1);
+    }
+    return work;
+}
+
+/*---------------------------------------------------------------------
+ * cqt_kernel_bytes()
+ *
+ * Returns the estimated size of the sparse kernels of compute_constant_q()
+ * (the same coefficient bands as cqt_window_work()), for the memory
+ * estimate of spectral_plan().
+ *---------------------------------------------------------------------*/
+long long cqt_kernel_bytes(const CqtLayout *layout, int sample_rate, double min_freq)
+{
+    double size = layout->transform_size;
+    double coefficients = 0.0;
+    for (int k = 0; k < layout->bins; k++) {
+        double freq = min_freq * pow(2.0, k / layout->bins_per_octave);
+        if (freq >= sample_rate / 2.0) {
+            break;
+        }
+        double span = CQT_KERNEL_SPAN * size * freq / (layout->q * sample_rate);
+        coefficients += fmin(span, size / 2 + 1);
+    }
+    return (long long)layout->bins * (long long)sizeof(CqtKernelBin) +
+           (long long)(coefficients * 2.0 * sizeof(double));
+}
+
+/*---------------------------------------------------------------------
+ * cqt_context_samples()
+ *
+ * Returns the samples that compute_constant_q() reads past the end of
+ * an FFT window: half of the longest window beyond the FFT window it is
+ * centered on.
+ *---------------------------------------------------------------------*/
+int cqt_context_samples(const CqtLayout *layout, int fft_size)
+{
+    int context = (layout->longest_window + 1) / 2 - fft_size / 2;
+    return context > 0 ? context : 0;
+}
+
+/*---------------------------------------------------------------------
+ * cqt_kernel_chunk()
+ *
+ * Computes the sparse spectral kernels of one chunk of bins with its own
+ * buffers; the plan is shared. The temporal kernel of a bin is its
+ * Hann-windowed complex exponential, centered in the transform and
+ * normalized so that a sinusoid at the bin frequency gives the same
+ * magnitude in every bin. Its real and imaginary parts go through the
+ * real transform separately. Bins at or above Nyquist stay empty.
+ *---------------------------------------------------------------------*/
+static void cqt_kernel_chunk(void *arg, int chunk)
+{
+    CqtContext *ctx = (CqtContext *)arg;
+    const CqtLayout *layout = ctx->layout;
+    int size = layout->transform_size;
+    int transform_bins = size / 2 + 1;
+    int first = chunk * CQT_KERNEL_CHUNK;
+    int last = first + CQT_KERNEL_CHUNK;
+    if (last > layout->bins) last = layout->bins;
+
+    if (spectral_job_should_stop(ctx->job)) {
+        return;
+    }
+
+    double *real_in = (double *)fftw_malloc(sizeof(double) * size);
+    double *imag_in = (double *)fftw_malloc(sizeof(double) * size);
+    fftw_complex *real_out = (fftw_complex *)fftw_malloc(sizeof(fftw_complex) * transform_bins);
+    fftw_complex *imag_out = (fftw_complex *)fftw_malloc(sizeof(fftw_complex) * transform_bins);
+    double *magnitude = (double *)spectral_alloc(ctx->job, sizeof(double) * transform_bins);
+    if (real_in == NULL || imag_in == NULL || real_out == NULL || imag_out == NULL || magnitude == NULL) {
+        SPECTRAL_ATOMIC_STORE(&ctx->failed, 1);
+        goto done;
+    }
+
+    for (int k = first; k < last; k++) {
+        CqtKernelBin *bin = &ctx->kernel[k];
+        bin->first = 0;
+        bin->count = 0;
+        bin->coefficients = NULL;
+
+        double freq = ctx->min_freq * pow(2.0, k / layout->bins_per_octave);
+        if (freq >= ctx->sample_rate / 2.0) {
+            continue;
+        }
+
+        int length = (int)lround(layout->q * ctx->sample_rate / freq);
+        if (length < 2) length = 2;
+        if (length > size) length = size;
+        int offset = (size - length) / 2;
+
+        double window_sum = 0.0;
+        for (int n = 0; n < length; n++) {
+            window_sum += 0.5 * (1.0 - cos(2.0 * M_PI * n / (length - 1)));
+        }
+
+        memset(real_in, 0, sizeof(double) * size);
+        memset(imag_in, 0, sizeof(double) * size);
+        for (int n = 0; n < length; n++) {
+            double window = 0.5 * (1.0 - cos(2.0 * M_PI * n / (length - 1))) / window_sum;
+            double phase = 2.0 * M_PI * freq * (n - 0.5 * (length - 1)) / ctx->sample_rate;
+            real_in[offset + n] = window * cos(phase);
+            imag_in[offset + n] = window * sin(phase);
+        }
+        fftw_execute_dft_r2c(ctx->plan, real_in, real_out);
+        fftw_execute_dft_r2c(ctx->plan, imag_in, imag_out);
+
+        // Spectrum of the complex kernel: FFT(re) + i FFT(im)
+        double peak = 0.0;
+        for (int j = 0; j < transform_bins; j++) {
+            double real = real_out[j][0] - imag_out[j][1];
+            double imag = real_out[j][1] + imag_out[j][0];
+            magnitude[j] = sqrt(real * real + imag * imag);
+            if (magnitude[j] > peak) peak = magnitude[j];
+        }
+
+        // Contiguous band of the coefficients above the threshold
+        double threshold = CQT_KERNEL_THRESHOLD * peak;
+        int low = 0;
+        int high = transform_bins - 1;
+        while (low < high && magnitude[low] < threshold) low++;
+        while (high > low && magnitude[high] < threshold) high--;
+
+        bin->coefficients = (double *)spectral_alloc(ctx->job, sizeof(double) * 2 * (high - low + 1));
+        if (bin->coefficients == NULL) {
+            SPECTRAL_ATOMIC_STORE(&ctx->failed, 1);
+            break;
+        }
+        for (int j = low; j <= high; j++) {
+            double *c = bin->coefficients + 2 * (j - low);
+            c[0] = (real_out[j][0] - imag_out[j][1]) / size;
+            c[1] = -(real_out[j][1] + imag_out[j][0]) / size;
+        }
+        bin->first = low;
+        bin->count = high - low + 1;
+        SPECTRAL_ATOMIC_ADD(&ctx->kernel_entries, (long long)bin->count);
+    }
+
+done:
+    if (real_in) fftw_free(real_in);
+    if (imag_in) fftw_free(imag_in);
+    if (real_out) fftw_free(real_out);
+    if (imag_out) fftw_free(imag_out);
+    spectral_free(ctx->job, magnitude);
+}
+
+/*---------------------------------------------------------------------
+ * cqt_kernel_free()
+ *
+ * Frees the sparse kernels of a context (job allocator).
+ *---------------------------------------------------------------------*/
+static void cqt_kernel_free(CqtContext *ctx)
+{
+    if (ctx->kernel == NULL) {
+        return;
+    }
+    for (int k = 0; k < ctx->layout->bins; k++) {
+        spectral_free(ctx->job, ctx->kernel[k].coefficients);
+    }
+    spectral_free(ctx->job, ctx->kernel);
+    ctx->kernel = NULL;
+}
+
+/*---------------------------------------------------------------------
+ * cqt_block()
+ *
+ * Computes the windows of one block: one transform of the signal around
+ * the center of each FFT window, then the sparse product with the kernel
+ * of every bin. Samples beyond the signal count as silence. Skips the
+ * block if the job was cancelled.
+ *---------------------------------------------------------------------*/
+static void cqt_block(void *arg, int block)
+{
+    CqtContext *ctx = (CqtContext *)arg;
+    const CqtLayout *layout = ctx->layout;
+    int size = layout->transform_size;
+    int first = block * SPECTRAL_JOB_POLL_INTERVAL;
+    int last = first + SPECTRAL_JOB_POLL_INTERVAL;
+    if (last > ctx->num_windows) last = ctx->num_windows;
+
+    ctx->block_max[block] = 0.0;
+    if (spectral_job_should_stop(ctx->job)) {
+        return;
+    }
+    double trace = spectral_trace_begin();
+
+    double *in = (double *)fftw_malloc(sizeof(double) * size);
+    fftw_complex *out = (fftw_complex *)fftw_malloc(sizeof(fftw_complex) * (size / 2 + 1));
+    if (in == NULL || out == NULL) {
+        if (in) fftw_free(in);
+        if (out) fftw_free(out);
+        SPECTRAL_ATOMIC_STORE(&ctx->failed, 1);
+        return;
+    }
+
+    double block_max = 0.0;
+    for (int w = first; w < last; w++) {
+        int start_index = (ctx->first_window + w) * ctx->step + ctx->fft_size / 2 - size / 2;
+        for (int i = 0; i < size; i++) {
+            int sample = start_index + i;
+            in[i] = (sample >= 0 && sample < ctx->total_samples) ? ctx->signal[sample] : 0.0;
+        }
+
+        fftw_execute_dft_r2c(ctx->plan, in, out);
+
+        double *row = ctx->spectrogram + (size_t)w * layout->bins;
+        for (int k = 0; k < layout->bins; k++) {
+            const CqtKernelBin *bin = &ctx->kernel[k];
+            const double *c = bin->coefficients;
+            const fftw_complex *x = out + bin->first;
+            double real = 0.0;
+            double imag = 0.0;
+            for (int j = 0; j < bin->count; j++) {
+                real += x[j][0] * c[2 * j] - x[j][1] * c[2 * j + 1];
+                imag += x[j][0] * c[2 * j + 1] + x[j][1] * c[2 * j];
+            }
+            double magnitude = sqrt(real * real + imag * imag);
+
+            row[k] = magnitude;
+            if (magnitude > block_max) {
+                block_max = magnitude;
+            }
+        }
+    }
+
+    fftw_free(in);
+    fftw_free(out);
+    ctx->block_max[block] = block_max;
+    spectral_trace_end(ctx->job, "cqt_block", trace,
+                       (long long)(last - first) * size * (long long)sizeof(double), last - first);
+    SPECTRAL_JOB_COUNT(ctx->job, fftCount, last - first);
+
+    int done = SPECTRAL_ATOMIC_INCREMENT(&ctx->blocks_done);
+    spectral_job_report(ctx->job, SPECTRAL_STAGE_FFT, (double)done / ctx->num_blocks);
+}
+
+/*---------------------------------------------------------------------
+ * compute_constant_q()
+ *
+ * Computes the constant-Q spectrogram of a signal: rows bins over
+ * [min_freq, max_freq] (see cqt_layout()), on the windows of
+ * compute_spectrogram() with the same fft_size and bins_per_second, so
+ * the page layout does not depend on the engine (the windows from
+ * first_window on, max_windows of them at most, 0 = all; see
+ * cqt_context_samples()). The kernels are built on each call, so a
+ * paginated analysis pays for them once per page. The matrix holds the
+ * rows bins of each window (index_min = 0, index_max = rows - 1) and
+ * spectro_data->bins_per_octave is set.
+ *
+ * Returns:
+ *  - 0 on success, SPECTRAL_CANCELLED if the job was cancelled,
+ *    other non-zero values on error.
+ *---------------------------------------------------------------------*/
+int compute_constant_q(double *signal, int total_samples, int first_window, int max_windows, int sample_rate,
+                       int fft_size, double bins_per_second,
+                       double min_freq, double max_freq, int rows,
+                       SpectrogramData *spectro_data,
+                       SpectralJob *job)
+{
+    double trace = spectral_trace_begin();
+
+    // The bins are octaves above min_freq: a range starting at 0 Hz has none
+    if (min_freq <= 0.0) {
+        spectral_log(job, SPECTRAL_LOG_WARNING, "Warning: Constant-Q analysis from %.2f Hz is not possible, starting at %.2f Hz.\n",
+                     min_freq, DEFAULT_MIN_FREQ);
+        min_freq = DEFAULT_MIN_FREQ;
+    }
+
+    CqtLayout layout;
+    if (cqt_layout(sample_rate, fft_size, min_freq, max_freq, rows, &layout) != 0) {
+        spectral_log(job, SPECTRAL_LOG_ERROR, "Error: Constant-Q analysis of %d rows over %.2f-%.2f Hz is not possible.\n",
+                     rows, min_freq, max_freq);
+        return 1;
+    }
+
+    int step = (int)(sample_rate / bins_per_second);
+    if (step < 1) step = 1;
+
+    int num_windows = (total_samples - fft_size) / step + 1 - first_window;
+    if (first_window < 0 || num_windows <= 0) {
+        spectral_log(job, SPECTRAL_LOG_ERROR, "Error: Signal too short for FFT size.\n");
+        return 2;
+    }
+    if (max_windows > 0 && num_windows > max_windows) {
+        num_windows = max_windows;
+    }
+
+    // The plan is shared by the kernel and the hops, which use their own buffers
+    int transform_size;
+    fftw_plan plan;
+    int owns_plan;
+    double *in;
+    fftw_complex *out;
+    if (fft_init(layout.transform_size, layout.transform_size, &transform_size,
+                 &plan, &owns_plan, &in, &out, job) != 0) {
+        return 1;
+    }
+
+    spectral_log(job, SPECTRAL_LOG_INFO, " - Constant-Q: %d bins (%.2f per octave), Q = %.1f, windows of %d down to %d samples\n",
+                 layout.bins, layout.bins_per_octave, layout.q, layout.longest_window,
+                 (int)lround(layout.q * sample_rate / max_freq));
+    spectral_log(job, SPECTRAL_LOG_INFO, " - Computing spectrogram: %d windows, hop size %d samples\n",
+                 num_windows, step);
+
+    CqtContext ctx;
+    memset(&ctx, 0, sizeof(ctx));
+    ctx.layout = &layout;
+    ctx.sample_rate = sample_rate;
+    ctx.min_freq = min_freq;
+    ctx.plan = plan;
+    ctx.signal = signal;
+    ctx.total_samples = total_samples;
+    ctx.fft_size = fft_size;
+    ctx.step = step;
+    ctx.first_window = first_window;
+    ctx.num_windows = num_windows;
+    ctx.job = job;
+
+    // Sparse kernels, one chunk of bins per parallel task; the job's
+    // allocator counts them with the matrix
+    ctx.kernel = (CqtKernelBin *)spectral_alloc(job, (size_t)layout.bins * sizeof(CqtKernelBin));
+    if (ctx.kernel == NULL) {
+        spectral_log(job, SPECTRAL_LOG_ERROR, "Error: Unable to allocate the constant-Q kernel.\n");
+        fft_cleanup(plan, owns_plan, in, out);
+        return 3;
+    }
+    memset(ctx.kernel, 0, (size_t)layout.bins * sizeof(CqtKernelBin));
+    spectral_parallel_for(job, (layout.bins + CQT_KERNEL_CHUNK - 1) / CQT_KERNEL_CHUNK,
+                          cqt_kernel_chunk, &ctx);
+    if (ctx.failed || spectral_job_should_stop(job)) {
+        cqt_kernel_free(&ctx);
+        fft_cleanup(plan, owns_plan, in, out);
+        if (ctx.failed) {
+            spectral_log(job, SPECTRAL_LOG_ERROR, "Error: Unable to allocate the constant-Q kernel.\n");
+            return 3;
+        }
+        return SPECTRAL_CANCELLED;
+    }
+    spectral_log(job, SPECTRAL_LOG_INFO, " - Constant-Q kernel: %lld coefficients (%.1f per bin) on a %d-point transform\n",
+                 ctx.kernel_entries, (double)ctx.kernel_entries / layout.bins, transform_size);
+
+    double *spectrogram = (double *)spectral_alloc(job, (size_t)num_windows * layout.bins * sizeof(double));
+    ctx.num_blocks = (num_windows + SPECTRAL_JOB_POLL_INTERVAL - 1) / SPECTRAL_JOB_POLL_INTERVAL;
+    double *block_max = (double *)spectral_alloc(job, (size_t)ctx.num_blocks * sizeof(double));
+    if (spectrogram == NULL || block_max == NULL) {
+        spectral_log(job, SPECTRAL_LOG_ERROR, "Error: Unable to allocate memory for spectrogram.\n");
+        spectral_free(job, spectrogram);
+        spectral_free(job, block_max);
+        cqt_kernel_free(&ctx);
+        fft_cleanup(plan, owns_plan, in, out);
+        return 3;
+    }
+    ctx.spectrogram = spectrogram;
+    ctx.block_max = block_max;
+
+    // Each block keeps its own maximum so the result does not depend on scheduling
+    spectral_parallel_for(job, ctx.num_blocks, cqt_block, &ctx);
+
+    double global_max = 0.0;
+    for (int i = 0; i < ctx.num_blocks; i++) {
+        if (block_max[i] > global_max) {
+            global_max = block_max[i];
+        }
+    }
+    spectral_free(job, block_max);
+    cqt_kernel_free(&ctx);
+    fft_cleanup(plan, owns_plan, in, out);
+
+    if (ctx.failed || spectral_job_should_stop(job)) {
+        spectral_free(job, spectrogram);
+        if (ctx.failed) {
+            spectral_log(job, SPECTRAL_LOG_ERROR, "Error: Unable to allocate FFT block buffers.\n");
+            return 3;
+        }
+        spectral_log(job, SPECTRAL_LOG_INFO, " - Spectrogram computation cancelled\n");
+        return SPECTRAL_CANCELLED;
+    }
+
+    spectro_data->data = spectrogram;
+    spectro_data->first_window = first_window;
+    spectro_data->num_windows = num_windows;
+    spectro_data->num_bins = layout.bins;
+    spectro_data->index_min = 0;
+    spectro_data->index_max = layout.bins - 1;
+    spectro_data->global_max = global_max;
+    spectro_data->freq_resolution = 0.0;
+    spectro_data->bins_per_octave = layout.bins_per_octave;
+    spectro_data->base_freq = min_freq;
+
+    spectral_trace_end(job, "cqt", trace, (long long)total_samples * (long long)sizeof(double), num_windows);
+    spectral_job_report(job, SPECTRAL_STAGE_FFT, 1.0);
+
+    return 0;
+}
@@ -0,0 +1,38 @@
+/*
+ * Copyright (C) 2025 - present Ondulab
+ * All rights reserved.
+ *
+ * This software is licensed under terms that can be found in the LICENSE file
+ * in the root directory of this software component.
+ */
+
+#ifndef SPECTRAL_CQT_H
+#define SPECTRAL_CQT_H
+
+#include "spectral_fft.h"
+
+// Geometry of a constant-Q analysis (cqt_layout()). Bin k is centered on
+// min_freq * 2^(k / bins_per_octave); the bins of [min_freq, max_freq]
+// are the pixel rows of the spectrogram.
+typedef struct {
+    int    bins;                // Constant-Q bins, one per pixel row
+    double bins_per_octave;
+    double q;                   // Center frequency over bandwidth, the same for every bin
+    int    longest_window;      // Window of the lowest bin, in samples
+    int    transform_size;      // FFT run once per hop (power of two)
+} CqtLayout;
+
+// Function prototypes
+int cqt_rows(const SpectrogramSettings *cfg);
+int cqt_layout(int sample_rate, int fft_size, double min_freq, double max_freq, int rows,
+               CqtLayout *layout);
+double cqt_window_work(const CqtLayout *layout, int sample_rate, double min_freq);
+long long cqt_kernel_bytes(const CqtLayout *layout, int sample_rate, double min_freq);
+int cqt_context_samples(const CqtLayout *layout, int fft_size);
+int compute_constant_q(double *signal, int total_samples, int first_window, int max_windows, int sample_rate,
+                       int fft_size, double bins_per_second,
+                       double min_freq, double max_freq, int rows,
+                       SpectrogramData *spectro_data,
+                       SpectralJob *job);
+
+#endif /* SPECTRAL_CQT_H */
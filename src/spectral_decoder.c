@@ -0,0 +1,307 @@
+/*
+ * Copyright (C) 2025 - present Ondulab
+ * All rights reserved.
+ *
+ * This software is licensed under terms that can be found in the LICENSE file
+ * in the root directory of this software component.
+ */
+
+#define SPECTRAL_LOG_CATEGORY "audio"
+#include "spectral_decoder.h"
+#include "spectral_common.h"
+
+#ifndef _WIN32
+#include <pthread.h>
+#include <unistd.h>
+#endif
+
+#define DECODE_CHUNK_FRAMES 4096
+
+// One contiguous frame range decoded by its own SNDFILE handle
+typedef struct DecodeRange {
+    const char *filename;
+    sf_count_t start;       // First frame written to dst
+    sf_count_t count;       // Frames to write to dst
+    int overlap;            // Frames decoded before start and discarded
+    int mono;               // 1 = mix down to double mono, 0 = interleaved float
+    void *dst;              // Start of this range's slice in the shared buffer
+    sf_count_t decoded;     // Frames actually written
+    int status;             // 0 on success
+    SpectralJob *job;       // Receives the messages, NULL = stdout/stderr
+} DecodeRange;
+
+/*---------------------------------------------------------------------
+ * decode_range_worker()
+ *
+ * Opens an independent handle, seeks ahead of the range by the overlap,
+ * discards the overlap frames and decodes the range into its slice.
+ * An overlap that cannot be discarded completely fails the range: the
+ * frames would land misaligned in the slice.
+ *---------------------------------------------------------------------*/
+static void *decode_range_worker(void *arg)
+{
+    DecodeRange *range = (DecodeRange *)arg;
+    double trace = spectral_trace_begin();
+    SF_INFO info;
+    memset(&info, 0, sizeof(info));
+
+    range->decoded = 0;
+    range->status = 0;
+
+    SNDFILE *sf = sf_open(range->filename, SFM_READ, &info);
+    if (sf == NULL) {
+        spectral_log(range->job, SPECTRAL_LOG_ERROR, "Error: Could not open file %s: %s\n", range->filename, sf_strerror(NULL));
+        range->status = 1;
+        return NULL;
+    }
+
+    double *scratch = (double *)malloc((size_t)DECODE_CHUNK_FRAMES * info.channels * sizeof(double));
+    if (scratch == NULL) {
+        sf_close(sf);
+        range->status = 2;
+        return NULL;
+    }
+
+    // Position the handle ahead of the range, then decode and drop the overlap
+    sf_count_t seek_pos = range->start - range->overlap;
+    if (seek_pos < 0) {
+        seek_pos = 0;
+    }
+    if (seek_pos > 0 && sf_seek(sf, seek_pos, SEEK_SET) < 0) {
+        spectral_log(range->job, SPECTRAL_LOG_ERROR, "Error: Could not seek to frame %lld in %s\n", (long long)seek_pos, range->filename);
+        free(scratch);
+        sf_close(sf);
+        range->status = 3;
+        return NULL;
+    }
+
+    sf_count_t to_skip = range->start - seek_pos;
+    while (to_skip > 0) {
+        sf_count_t wanted = to_skip < DECODE_CHUNK_FRAMES ? to_skip : DECODE_CHUNK_FRAMES;
+        sf_count_t skipped = sf_readf_double(sf, scratch, wanted);
+        if (skipped <= 0) {
+            break;
+        }
+        to_skip -= skipped;
+    }
+    if (to_skip > 0) {
+        spectral_log(range->job, SPECTRAL_LOG_ERROR, "Error: Could not decode the %lld frames before frame %lld in %s\n",
+                     (long long)(range->start - seek_pos), (long long)range->start, range->filename);
+        free(scratch);
+        sf_close(sf);
+        range->status = 4;
+        return NULL;
+    }
+
+    sf_count_t written = 0;
+    if (!range->mono) {
+        float *dst = (float *)range->dst;
+        while (written < range->count) {
+            sf_count_t frames_read = sf_readf_float(sf, dst + written * info.channels, range->count - written);
+            if (frames_read <= 0) {
+                break;
+            }
+            written += frames_read;
+        }
+    } else {
+        double *dst = (double *)range->dst;
+        while (written < range->count) {
+            sf_count_t wanted = range->count - written;
+            if (wanted > DECODE_CHUNK_FRAMES) {
+                wanted = DECODE_CHUNK_FRAMES;
+            }
+            sf_count_t frames_read = sf_readf_double(sf, scratch, wanted);
+            if (frames_read <= 0) {
+                break;
+            }
+            // Same arithmetic as the serial mix-down so results match exactly
+            for (sf_count_t i = 0; i < frames_read; i++) {
+                double sum = 0;
+                for (int j = 0; j < info.channels; j++) {
+                    sum += scratch[i * info.channels + j];
+                }
+                dst[written + i] = sum / info.channels;
+            }
+            written += frames_read;
+        }
+    }
+
+    free(scratch);
+    sf_close(sf);
+
+    range->decoded = written;
+    spectral_trace_end(range->job, "decode_range", trace,
+                       (long long)written * info.channels * (long long)(range->mono ? sizeof(double) : sizeof(float)),
+                       (long long)written);
+    return NULL;
+}
+
+/*---------------------------------------------------------------------
+ * decoder_recommended_threads()
+ *
+ * Returns the number of decoding threads worth using for a frame count.
+ * Only seekable compressed formats (FLAC, OGG) are split: PCM decoding
+ * is bound by I/O and gains nothing from extra handles.
+ *
+ * Returns:
+ *  - the number of threads (1 = serial decoding)
+ *---------------------------------------------------------------------*/
+int decoder_recommended_threads(const SF_INFO *info, sf_count_t frame_count)
+{
+#ifdef _WIN32
+    (void)info;
+    (void)frame_count;
+    return 1;
+#else
+    int type = info->format & SF_FORMAT_TYPEMASK;
+    if ((type != SF_FORMAT_FLAC && type != SF_FORMAT_OGG) || !info->seekable || info->samplerate <= 0) {
+        return 1;
+    }
+
+    long cpu_count = sysconf(_SC_NPROCESSORS_ONLN);
+    if (cpu_count < 1) {
+        cpu_count = 1;
+    }
+
+    sf_count_t min_frames = (sf_count_t)(DECODER_MIN_RANGE_SECONDS * info->samplerate);
+    sf_count_t by_length = frame_count / (min_frames > 0 ? min_frames : 1);
+
+    int threads = (int)(cpu_count < DECODER_MAX_THREADS ? cpu_count : DECODER_MAX_THREADS);
+    if (by_length < threads) {
+        threads = (int)by_length;
+    }
+    return threads > 1 ? threads : 1;
+#endif
+}
+
+/*---------------------------------------------------------------------
+ * decode_ranges()
+ *
+ * Splits [start_frame, start_frame + frame_count) into disjoint ranges,
+ * decodes them in parallel into the shared buffer and stitches the
+ * result. Each range lands directly in its own slice, so stitching only
+ * checks that every range but the last was decoded completely. If a
+ * parallel range fails, the whole range is decoded again serially.
+ *
+ * Returns:
+ *  - the number of contiguous frames decoded, or -1 on error.
+ *---------------------------------------------------------------------*/
+static sf_count_t decode_ranges(const char *filename, sf_count_t start_frame, sf_count_t frame_count,
+                                void *dst, int mono, int num_threads, SpectralJob *job)
+{
+    SF_INFO info;
+    memset(&info, 0, sizeof(info));
+
+    SNDFILE *sf = sf_open(filename, SFM_READ, &info);
+    if (sf == NULL) {
+        spectral_log(job, SPECTRAL_LOG_ERROR, "Error: Could not open file %s: %s\n", filename, sf_strerror(NULL));
+        return -1;
+    }
+    sf_close(sf);
+
+    if (start_frame + frame_count > info.frames) {
+        frame_count = info.frames - start_frame;
+    }
+    if (frame_count <= 0) {
+        return 0;
+    }
+
+#ifdef _WIN32
+    num_threads = 1;
+#endif
+    if (num_threads < 1) {
+        num_threads = 1;
+    }
+    if (num_threads > DECODER_MAX_THREADS) {
+        num_threads = DECODER_MAX_THREADS;
+    }
+
+    size_t frame_bytes = mono ? sizeof(double) : sizeof(float) * (size_t)info.channels;
+    DecodeRange ranges[DECODER_MAX_THREADS];
+    sf_count_t per_range = frame_count / num_threads;
+
+    for (int t = 0; t < num_threads; t++) {
+        sf_count_t offset = per_range * t;
+        ranges[t].filename = filename;
+        ranges[t].start = start_frame + offset;
+        ranges[t].count = (t == num_threads - 1) ? frame_count - offset : per_range;
+        ranges[t].overlap = DECODER_RANGE_OVERLAP;
+        ranges[t].mono = mono;
+        ranges[t].dst = (char *)dst + (size_t)offset * frame_bytes;
+        ranges[t].decoded = 0;
+        ranges[t].status = 0;
+        ranges[t].job = job;
+    }
+
+    if (num_threads == 1) {
+        ranges[0].overlap = 0;
+        decode_range_worker(&ranges[0]);
+    }
+#ifndef _WIN32
+    else {
+        pthread_t threads[DECODER_MAX_THREADS];
+        int started[DECODER_MAX_THREADS];
+
+        for (int t = 0; t < num_threads; t++) {
+            started[t] = pthread_create(&threads[t], NULL, decode_range_worker, &ranges[t]) == 0;
+            if (!started[t]) {
+                // Fall back to decoding this range on the calling thread
+                decode_range_worker(&ranges[t]);
+            }
+        }
+        for (int t = 0; t < num_threads; t++) {
+            if (started[t]) {
+                pthread_join(threads[t], NULL);
+            }
+        }
+    }
+#endif
+
+    // Stitch: ranges are contiguous as long as each one is complete
+    sf_count_t total = 0;
+    for (int t = 0; t < num_threads; t++) {
+        if (ranges[t].status != 0) {
+            if (num_threads > 1) {
+                spectral_log(job, SPECTRAL_LOG_WARNING, "Warning: Parallel decoding failed for %s, decoding it serially\n", filename);
+                return decode_ranges(filename, start_frame, frame_count, dst, mono, 1, job);
+            }
+            return -1;
+        }
+        total += ranges[t].decoded;
+        if (ranges[t].decoded < ranges[t].count) {
+            break;
+        }
+    }
+
+    return total;
+}
+
+/*---------------------------------------------------------------------
+ * decode_range_float()
+ *
+ * Decodes a frame range as interleaved floats using num_threads handles.
+ * Messages go to the job (NULL = stdout/stderr).
+ *
+ * Returns:
+ *  - the number of frames decoded, or -1 on error.
+ *---------------------------------------------------------------------*/
+sf_count_t decode_range_float(const char *filename, sf_count_t start_frame, sf_count_t frame_count,
+                              float *dst, int num_threads, SpectralJob *job)
+{
+    return decode_ranges(filename, start_frame, frame_count, dst, 0, num_threads, job);
+}
+
+/*---------------------------------------------------------------------
+ * decode_range_mono()
+ *
+ * Decodes a frame range mixed down to mono doubles (channel average)
+ * using num_threads handles.
+ *
+ * Returns:
+ *  - the number of frames decoded, or -1 on error.
+ *---------------------------------------------------------------------*/
+sf_count_t decode_range_mono(const char *filename, sf_count_t start_frame, sf_count_t frame_count,
+                             double *dst, int num_threads, SpectralJob *job)
+{
+    return decode_ranges(filename, start_frame, frame_count, dst, 1, num_threads, job);
+}
@@ -0,0 +1,38 @@
+/*
+ * Copyright (C) 2025 - present Ondulab
+ * All rights reserved.
+ *
+ * This software is licensed under terms that can be found in the LICENSE file
+ * in the root directory of this software component.
+ */
+
+#ifndef SPECTRAL_DECODER_H
+#define SPECTRAL_DECODER_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sndfile.h>
+#include "../include/spectral_generator.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Parallel decoding parameters */
+#define DECODER_MAX_THREADS        8         /* Upper bound on decoding threads */
+#define DECODER_MIN_RANGE_SECONDS  10.0      /* Minimum audio per thread worth a new handle */
+#define DECODER_RANGE_OVERLAP      4096      /* Frames decoded before each range and discarded */
+
+// Function prototypes
+int decoder_recommended_threads(const SF_INFO *info, sf_count_t frame_count);
+sf_count_t decode_range_float(const char *filename, sf_count_t start_frame, sf_count_t frame_count,
+                              float *dst, int num_threads, SpectralJob *job);
+sf_count_t decode_range_mono(const char *filename, sf_count_t start_frame, sf_count_t frame_count,
+                             double *dst, int num_threads, SpectralJob *job);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SPECTRAL_DECODER_H */
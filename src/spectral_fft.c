@@ -6,25 +6,316 @@
  * in the root directory of this software component.
  */
 
+#define SPECTRAL_LOG_CATEGORY "fft"
 #include "spectral_fft.h"
 #include "spectral_wav_processing.h"
 
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <pthread.h>
+#endif
+
+/*
+ * The FFTW planner is not thread-safe: plan creation and destruction are
+ * serialized by this lock, which also protects the plan caches. Executing
+ * a plan on the caller's own buffers (fftw_execute_dft_r2c) is safe from
+ * any thread, so a cached plan is shared without locking.
+ */
+#ifdef _WIN32
+static SRWLOCK planner_lock = SRWLOCK_INIT;
+#define PLANNER_LOCK()   AcquireSRWLockExclusive(&planner_lock)
+#define PLANNER_UNLOCK() ReleaseSRWLockExclusive(&planner_lock)
+#else
+static pthread_mutex_t planner_lock = PTHREAD_MUTEX_INITIALIZER;
+#define PLANNER_LOCK()   pthread_mutex_lock(&planner_lock)
+#define PLANNER_UNLOCK() pthread_mutex_unlock(&planner_lock)
+#endif
+
+struct SpectralPlanCache {
+    int sizes[SPECTRAL_PLAN_CACHE_CAPACITY];
+    fftw_plan plans[SPECTRAL_PLAN_CACHE_CAPACITY];
+    int count;
+};
+
 /*---------------------------------------------------------------------
- * fft_init()
+ * spectral_plan_cache_create()
  *
- * Initializes FFT resources and allocates memory.
+ * Returns:
+ *  - a new empty plan cache, or NULL if out of memory.
+ *---------------------------------------------------------------------*/
+SpectralPlanCache *spectral_plan_cache_create(void)
+{
+    return (SpectralPlanCache *)calloc(1, sizeof(SpectralPlanCache));
+}
+
+/*---------------------------------------------------------------------
+ * spectral_plan_cache_destroy()
+ *
+ * Destroys the cached plans and the cache itself.
+ *---------------------------------------------------------------------*/
+void spectral_plan_cache_destroy(SpectralPlanCache *cache)
+{
+    if (cache == NULL) {
+        return;
+    }
+
+    PLANNER_LOCK();
+    for (int i = 0; i < cache->count; i++) {
+        fftw_destroy_plan(cache->plans[i]);
+    }
+    PLANNER_UNLOCK();
+
+    free(cache);
+}
+
+/*---------------------------------------------------------------------
+ * fft_acquire_plan()
+ *
+ * Looks up the plan of a given size in the job's cache, or creates it.
+ * A plan that cannot be stored in a cache belongs to the caller.
  *
  * Returns:
- *  - 0 on success, non-zero on error.
+ *  - the plan, or NULL on error; *owns_plan tells whether the caller
+ *    must destroy it.
  *---------------------------------------------------------------------*/
-int fft_init(int fft_size, int *fft_effective_size, fftw_plan *plan, double **in, fftw_complex **out)
+static fftw_plan fft_acquire_plan(SpectralJob *job, int size, double *in, fftw_complex *out,
+                                  int *owns_plan)
 {
-    // Determine effective FFT size based on zero padding option
+    SpectralPlanCache *cache = job != NULL ? job->planCache : NULL;
+    fftw_plan plan = NULL;
+
+    PLANNER_LOCK();
+
+    if (cache != NULL) {
+        for (int i = 0; i < cache->count; i++) {
+            if (cache->sizes[i] == size) {
+                plan = cache->plans[i];
+                break;
+            }
+        }
+    }
+
+    *owns_plan = 0;
+    if (plan != NULL) {
+        SPECTRAL_JOB_COUNT(job, planCacheHits, 1);
+    } else {
+        SPECTRAL_JOB_COUNT(job, planCacheMisses, 1);
+        // FFTW_ESTIMATE does not touch the buffers while planning
+        plan = fftw_plan_dft_r2c_1d(size, in, out, FFTW_ESTIMATE);
+        if (plan != NULL && cache != NULL && cache->count < SPECTRAL_PLAN_CACHE_CAPACITY) {
+            cache->sizes[cache->count] = size;
+            cache->plans[cache->count] = plan;
+            cache->count++;
+        } else {
+            *owns_plan = (plan != NULL);
+        }
+    }
+
+    PLANNER_UNLOCK();
+    return plan;
+}
+
+/*---------------------------------------------------------------------
+ * spectrogram_bin_frequency()
+ *
+ * Returns the frequency of a (possibly fractional) bin of a spectrogram:
+ * uniform FFT bins, or geometric constant-Q bins.
+ *---------------------------------------------------------------------*/
+double spectrogram_bin_frequency(const SpectrogramData *spectro, double bin)
+{
+    if (spectro->bins_per_octave > 0.0) {
+        return spectro->base_freq * pow(2.0, bin / spectro->bins_per_octave);
+    }
+    return bin * spectro->freq_resolution;
+}
+
+/*---------------------------------------------------------------------
+ * spectrogram_bin_position()
+ *
+ * Returns the fractional bin of a frequency, the inverse of
+ * spectrogram_bin_frequency().
+ *---------------------------------------------------------------------*/
+double spectrogram_bin_position(const SpectrogramData *spectro, double freq)
+{
+    if (spectro->bins_per_octave > 0.0) {
+        return spectro->bins_per_octave * log2(freq / spectro->base_freq);
+    }
+    return freq / spectro->freq_resolution;
+}
+
+/*---------------------------------------------------------------------
+ * fft_padded_size()
+ *
+ * Returns the transform length of a window of fft_size samples: the
+ * zero-padded size, or pad_size when it is at least fft_size (0 selects
+ * the default).
+ *---------------------------------------------------------------------*/
+int fft_padded_size(int fft_size, int pad_size)
+{
+    if (pad_size >= fft_size) {
+        return pad_size;
+    }
     #if USE_ZERO_PADDING
-        *fft_effective_size = ZERO_PAD_SIZE;
+        return ZERO_PAD_SIZE;
     #else
-        *fft_effective_size = fft_size;
+        return fft_size;
     #endif
+}
+
+/*---------------------------------------------------------------------
+ * fft_bin_range()
+ *
+ * Computes the bins of a transform of fft_effective_size samples that
+ * cover [min_freq, max_freq].
+ *
+ * Returns:
+ *  - 0 on success, 1 if the range holds less than two bins (every bin
+ *    is then selected).
+ *---------------------------------------------------------------------*/
+int fft_bin_range(int sample_rate, int fft_effective_size, double min_freq, double max_freq,
+                  int *index_min, int *index_max)
+{
+    int num_bins = fft_effective_size / 2 + 1;
+    double freq_resolution = sample_rate / (double)fft_effective_size;
+    
+    *index_min = (int)ceil(min_freq / freq_resolution);
+    *index_max = (int)floor(max_freq / freq_resolution);
+    if (*index_min < 0) *index_min = 0;
+    if (*index_max > num_bins - 1) *index_max = num_bins - 1;
+    if (*index_min >= *index_max) {
+        *index_min = 0;
+        *index_max = num_bins - 1;
+        return 1;
+    }
+    return 0;
+}
+
+#if USE_HYBRID_FFT
+/* Smallest power of two >= n */
+static int fft_next_power_of_two(int n)
+{
+    int size = 1;
+    while (size < n) {
+        size <<= 1;
+    }
+    return size;
+}
+#endif
+
+/*---------------------------------------------------------------------
+ * fft_hybrid_layout()
+ *
+ * Lays out the multi-resolution analysis of windows of fft_size samples
+ * drawn on the bins of a display_size transform. Above the crossover,
+ * the window is padded to HYBRID_PAD_FACTOR times its length only; the
+ * zero padding to display_size would just interpolate the same spectrum
+ * more finely. Below it, a window HYBRID_LOW_WINDOW_FACTOR times longer
+ * is taken on the signal decimated to about four times the crossover,
+ * which resolves the bottom octaves of the log-frequency scale at a
+ * fraction of the cost. There is no low band when min_freq is above the
+ * crossover or the signal cannot be decimated.
+ *
+ * Returns:
+ *  - 1 if the analysis is multi-resolution, 0 if the display transform
+ *    is cheaper (or USE_HYBRID_FFT is off).
+ *---------------------------------------------------------------------*/
+int fft_hybrid_layout(int sample_rate, int fft_size, int display_size, double min_freq,
+                      HybridFftLayout *layout)
+{
+    memset(layout, 0, sizeof(*layout));
+    #if USE_HYBRID_FFT
+        layout->short_size = fft_next_power_of_two(HYBRID_PAD_FACTOR * fft_size);
+        if (layout->short_size >= display_size) {
+            return 0;
+        }
+        layout->decimation = 1;
+
+        double freq_resolution = sample_rate / (double)display_size;
+        int decimation = (int)(sample_rate / (4.0 * HYBRID_LOW_FREQ_THRESHOLD));
+        int long_window = HYBRID_LOW_WINDOW_FACTOR * fft_size / (decimation > 0 ? decimation : 1);
+        if (min_freq < HYBRID_LOW_FREQ_THRESHOLD && decimation >= 2 && long_window >= 16) {
+            int long_size = fft_next_power_of_two(HYBRID_PAD_FACTOR * long_window);
+            int display_long_size = fft_next_power_of_two((display_size + decimation - 1) / decimation);
+
+            layout->decimation = decimation;
+            layout->long_window = long_window;
+            // At least as fine as the display bins, which are interpolated from it
+            layout->long_size = long_size > display_long_size ? long_size : display_long_size;
+            layout->filter_taps = HYBRID_FILTER_TAPS * decimation + 1;
+            layout->crossover_bin = (int)ceil(HYBRID_LOW_FREQ_THRESHOLD / freq_resolution);
+            layout->blend_bin = (int)ceil(HYBRID_LOW_FREQ_THRESHOLD * pow(2.0, -HYBRID_BLEND_OCTAVES) / freq_resolution);
+        }
+        return 1;
+    #else
+        (void)sample_rate;
+        (void)fft_size;
+        (void)display_size;
+        (void)min_freq;
+        return 0;
+    #endif
+}
+
+/*---------------------------------------------------------------------
+ * fft_window_work()
+ *
+ * Returns the work units of one window (n log2 n per transform, one
+ * unit per filter tap) of the analysis compute_spectrogram() runs with
+ * these settings, for the cost model of spectral_plan().
+ *---------------------------------------------------------------------*/
+double fft_window_work(int sample_rate, int fft_size, int pad_size, double min_freq, int hop_size)
+{
+    int display_size = fft_padded_size(fft_size, pad_size);
+    HybridFftLayout hybrid;
+    if (pad_size != 0 || !fft_hybrid_layout(sample_rate, fft_size, display_size, min_freq, &hybrid)) {
+        return display_size * log2(display_size);
+    }
+
+    double work = hybrid.short_size * log2(hybrid.short_size);
+    if (hybrid.decimation > 1) {
+        work += hybrid.long_size * log2(hybrid.long_size);
+        work += (double)hop_size / hybrid.decimation * hybrid.filter_taps;
+    }
+    return work;
+}
+
+/*---------------------------------------------------------------------
+ * fft_context_samples()
+ *
+ * Returns the samples that the analysis compute_spectrogram() runs with
+ * these settings reads past the end of a window: half of the long
+ * window beyond the short one it is centered on, one decimated sample
+ * for the rounding of its start, and half of the anti-aliasing filter.
+ * 0 without a low band.
+ *---------------------------------------------------------------------*/
+int fft_context_samples(int sample_rate, int fft_size, int pad_size, double min_freq)
+{
+    HybridFftLayout hybrid;
+    if (pad_size != 0 ||
+        !fft_hybrid_layout(sample_rate, fft_size, fft_padded_size(fft_size, pad_size), min_freq, &hybrid) ||
+        hybrid.decimation <= 1) {
+        return 0;
+    }
+    return (hybrid.long_window * hybrid.decimation - fft_size) / 2 + hybrid.decimation +
+           (hybrid.filter_taps - 1) / 2;
+}
+
+/*---------------------------------------------------------------------
+ * fft_init()
+ *
+ * Initializes FFT resources and allocates memory. The buffers belong to
+ * the calling generation; the plan may be shared through the job's cache.
+ * pad_size overrides the zero-padded size when it is at least fft_size
+ * (drafts use a shorter padding); 0 selects the default.
+ *
+ * Returns:
+ *  - 0 on success, non-zero on error.
+ *---------------------------------------------------------------------*/
+int fft_init(int fft_size, int pad_size, int *fft_effective_size, fftw_plan *plan, int *owns_plan,
+             double **in, fftw_complex **out, SpectralJob *job)
+{
+    // Determine effective FFT size based on zero padding option
+    *fft_effective_size = fft_padded_size(fft_size, pad_size);
     
     // Calculate number of frequency bins
     int num_bins = (*fft_effective_size) / 2 + 1;
@@ -32,23 +323,23 @@ int fft_init(int fft_size, int *fft_effective_size, fftw_plan *plan, double **in
     // Allocate input buffer
     *in = (double *)fftw_malloc(sizeof(double) * (*fft_effective_size));
     if (*in == NULL) {
-        fprintf(stderr, "Error: Unable to allocate FFT input buffer.\n");
+        spectral_log(job, SPECTRAL_LOG_ERROR, "Error: Unable to allocate FFT input buffer.\n");
         return 1;
     }
     
     // Allocate output buffer
     *out = (fftw_complex *)fftw_malloc(sizeof(fftw_complex) * num_bins);
     if (*out == NULL) {
-        fprintf(stderr, "Error: Unable to allocate FFT output buffer.\n");
+        spectral_log(job, SPECTRAL_LOG_ERROR, "Error: Unable to allocate FFT output buffer.\n");
         fftw_free(*in);
         *in = NULL;
         return 2;
     }
     
-    // Create FFT plan
-    *plan = fftw_plan_dft_r2c_1d(*fft_effective_size, *in, *out, FFTW_ESTIMATE);
+    // Create FFT plan, or reuse the cached one
+    *plan = fft_acquire_plan(job, *fft_effective_size, *in, *out, owns_plan);
     if (*plan == NULL) {
-        fprintf(stderr, "Error: Unable to create FFT plan.\n");
+        spectral_log(job, SPECTRAL_LOG_ERROR, "Error: Unable to create FFT plan.\n");
         fftw_free(*in);
         fftw_free(*out);
         *in = NULL;
@@ -56,7 +347,7 @@ int fft_init(int fft_size, int *fft_effective_size, fftw_plan *plan, double **in
         return 3;
     }
     
-    printf(" - Initialized FFT with size %d (effective size %d, %d frequency bins)\n", 
+    spectral_log(job, SPECTRAL_LOG_INFO, " - Initialized FFT with size %d (effective size %d, %d frequency bins)\n", 
            fft_size, *fft_effective_size, num_bins);
            
     return 0;
@@ -65,37 +356,445 @@ int fft_init(int fft_size, int *fft_effective_size, fftw_plan *plan, double **in
 /*---------------------------------------------------------------------
  * fft_cleanup()
  *
- * Frees FFT resources.
+ * Frees FFT resources. Cached plans are left to their cache.
  *---------------------------------------------------------------------*/
-void fft_cleanup(fftw_plan plan, double *in, fftw_complex *out)
+void fft_cleanup(fftw_plan plan, int owns_plan, double *in, fftw_complex *out)
 {
-    if (plan) fftw_destroy_plan(plan);
+    if (plan && owns_plan) {
+        PLANNER_LOCK();
+        fftw_destroy_plan(plan);
+        PLANNER_UNLOCK();
+    }
     if (in) fftw_free(in);
     if (out) fftw_free(out);
 }
 
+// Shared state of the parallel FFT blocks of one spectrogram
+typedef struct FftBlockContext {
+    const double *signal;
+    int total_samples;
+    int fft_size;
+    int fft_effective_size;
+    int step;
+    int first_window;           // Window 0 of the block context in the recording
+    int num_windows;
+    int num_bins;               // Bins stored per window (up to index_max)
+    int transform_bins;         // Bins of the transform
+    int index_min;              // Lowest bin of the block maxima
+    int num_blocks;
+    fftw_plan plan;
+    double *spectrogram;
+    double *block_max;          // Maximum magnitude of each block
+    volatile int blocks_done;   // Completed blocks, for progress
+    volatile int failed;        // Set if a block could not allocate its buffers
+    SpectralJob *job;
+    // Multi-resolution analysis (fft_hybrid_block()): fft_effective_size is
+    // then the short transform, interpolated onto the display transform
+    const HybridFftLayout *hybrid;
+    int display_size;
+    const double *decimated;    // Low band signal, one sample every hybrid->decimation
+    int decimated_first;        // Decimated index of decimated[0]
+    int decimated_samples;
+    fftw_plan long_plan;
+} FftBlockContext;
+
+/*---------------------------------------------------------------------
+ * fft_block()
+ *
+ * Computes the windows of one block with its own FFT buffers; the plan
+ * is shared. Skips the block if the job was cancelled.
+ *---------------------------------------------------------------------*/
+static void fft_block(void *arg, int block)
+{
+    FftBlockContext *ctx = (FftBlockContext *)arg;
+    int first = block * SPECTRAL_JOB_POLL_INTERVAL;
+    int last = first + SPECTRAL_JOB_POLL_INTERVAL;
+    if (last > ctx->num_windows) last = ctx->num_windows;
+    
+    ctx->block_max[block] = 0.0;
+    if (spectral_job_should_stop(ctx->job)) {
+        return;
+    }
+    double trace = spectral_trace_begin();
+    
+    double *in = (double *)fftw_malloc(sizeof(double) * ctx->fft_effective_size);
+    fftw_complex *out = (fftw_complex *)fftw_malloc(sizeof(fftw_complex) * ctx->transform_bins);
+    if (in == NULL || out == NULL) {
+        if (in) fftw_free(in);
+        if (out) fftw_free(out);
+        SPECTRAL_ATOMIC_STORE(&ctx->failed, 1);
+        return;
+    }
+    
+    double block_max = 0.0;
+    for (int w = first; w < last; w++) {
+        int start_index = (ctx->first_window + w) * ctx->step;
+        
+        // Copy signal chunk to FFT input buffer with zero padding if needed
+        for (int i = 0; i < ctx->fft_size; i++) {
+            if (start_index + i < ctx->total_samples) {
+                in[i] = ctx->signal[start_index + i];
+            } else {
+                in[i] = 0.0;
+            }
+        }
+        
+        // Zero-pad the rest of the buffer if needed
+        for (int i = ctx->fft_size; i < ctx->fft_effective_size; i++) {
+            in[i] = 0.0;
+        }
+        
+        // Apply window function
+        apply_hann_window(in, ctx->fft_size);
+        
+        // Execute FFT on this block's buffers (the plan may be shared)
+        fftw_execute_dft_r2c(ctx->plan, in, out);
+        
+        // Calculate magnitude for each stored frequency bin
+        double *row = ctx->spectrogram + (size_t)w * ctx->num_bins;
+        for (int b = 0; b < ctx->num_bins; b++) {
+            double real = out[b][0];
+            double imag = out[b][1];
+            double magnitude = sqrt(real * real + imag * imag);
+            
+            row[b] = magnitude;
+            
+            // Update block maximum over the drawn frequency range
+            if (b >= ctx->index_min && magnitude > block_max) {
+                block_max = magnitude;
+            }
+        }
+    }
+    
+    fftw_free(in);
+    fftw_free(out);
+    ctx->block_max[block] = block_max;
+    spectral_trace_end(ctx->job, "fft_block", trace,
+                       (long long)(last - first) * ctx->fft_size * (long long)sizeof(double), last - first);
+    SPECTRAL_JOB_COUNT(ctx->job, fftCount, last - first);
+    
+    int done = SPECTRAL_ATOMIC_INCREMENT(&ctx->blocks_done);
+    spectral_job_report(ctx->job, SPECTRAL_STAGE_FFT, (double)done / ctx->num_blocks);
+}
+
+#if USE_HYBRID_FFT
+/* Decimated samples per parallel task */
+#define HYBRID_DECIMATE_CHUNK 16384
+
+// Low band of a multi-resolution analysis, shared by the blocks
+typedef struct HybridLowBand {
+    const double *signal;
+    int total_samples;
+    double *filter;             // Windowed-sinc low-pass, filter_taps coefficients
+    double *decimated;
+    int decimated_first;        // Decimated index of decimated[0]
+    int decimated_samples;
+    fftw_plan plan;             // Long transform
+    int owns_plan;
+    double *in;                 // Planning buffers of the long transform
+    fftw_complex *out;
+    const HybridFftLayout *layout;
+} HybridLowBand;
+
+/* First decimated sample of the long window centered on the short window at start_index */
+static inline int fft_hybrid_long_start(const HybridFftLayout *hybrid, int fft_size, int start_index)
+{
+    double center = (start_index + (fft_size - 1) / 2.0) / hybrid->decimation;
+    return (int)lround(center - (hybrid->long_window - 1) / 2.0);
+}
+
+/*---------------------------------------------------------------------
+ * fft_decimate_chunk()
+ *
+ * Filters and decimates one chunk of the low band signal. Decimated
+ * sample j is centered on source sample j * decimation; samples beyond
+ * the signal count as silence.
+ *---------------------------------------------------------------------*/
+static void fft_decimate_chunk(void *arg, int chunk)
+{
+    HybridLowBand *low = (HybridLowBand *)arg;
+    int first = chunk * HYBRID_DECIMATE_CHUNK;
+    int last = first + HYBRID_DECIMATE_CHUNK;
+    if (last > low->decimated_samples) last = low->decimated_samples;
+    
+    int taps = low->layout->filter_taps;
+    int half = (taps - 1) / 2;
+    for (int j = first; j < last; j++) {
+        int origin = (low->decimated_first + j) * low->layout->decimation - half;
+        int k_first = origin < 0 ? -origin : 0;
+        int k_last = low->total_samples - origin;
+        if (k_last > taps) k_last = taps;
+        
+        double sum = 0.0;
+        for (int k = k_first; k < k_last; k++) {
+            sum += low->filter[k] * low->signal[origin + k];
+        }
+        low->decimated[j] = sum;
+    }
+}
+
+/*---------------------------------------------------------------------
+ * fft_hybrid_prepare()
+ *
+ * Decimates the signal for the long window (Blackman-windowed sinc
+ * low-pass at the decimated Nyquist frequency, 0.5 / decimation of the
+ * source rate, so the bins below the crossover receive no alias) and
+ * plans the long transform. Only the decimated samples that the long
+ * windows of [first_window, first_window + num_windows) read are
+ * computed, so a page of a long recording decimates its own span.
+ *
+ * Returns:
+ *  - 0 on success, non-zero on error.
+ *---------------------------------------------------------------------*/
+static int fft_hybrid_prepare(const double *signal, int total_samples, int fft_size, int step,
+                              int first_window, int num_windows, const HybridFftLayout *layout,
+                              HybridLowBand *low, SpectralJob *job)
+{
+    memset(low, 0, sizeof(*low));
+    low->signal = signal;
+    low->total_samples = total_samples;
+    low->layout = layout;
+    if (layout->decimation <= 1) {
+        return 0;
+    }
+    
+    // Decimated span of the long windows; the samples beyond the signal stay silent
+    int decimated_total = (total_samples + layout->decimation - 1) / layout->decimation;
+    int decimated_first = fft_hybrid_long_start(layout, fft_size, first_window * step);
+    int decimated_last = fft_hybrid_long_start(layout, fft_size, (first_window + num_windows - 1) * step) +
+                         layout->long_window;
+    if (decimated_first < 0) decimated_first = 0;
+    if (decimated_last > decimated_total) decimated_last = decimated_total;
+    if (decimated_last <= decimated_first) decimated_last = decimated_first + 1;
+    
+    int taps = layout->filter_taps;
+    low->filter = (double *)spectral_alloc(job, (size_t)taps * sizeof(double));
+    low->decimated_first = decimated_first;
+    low->decimated_samples = decimated_last - decimated_first;
+    low->decimated = (double *)spectral_alloc(job, (size_t)low->decimated_samples * sizeof(double));
+    if (low->filter == NULL || low->decimated == NULL) {
+        spectral_log(job, SPECTRAL_LOG_ERROR, "Error: Unable to allocate the decimated signal.\n");
+        return 1;
+    }
+    
+    double cutoff = 0.5 / layout->decimation;
+    double sum = 0.0;
+    for (int k = 0; k < taps; k++) {
+        double x = k - (taps - 1) / 2.0;
+        double sinc = (x == 0.0) ? 2.0 * cutoff : sin(2.0 * M_PI * cutoff * x) / (M_PI * x);
+        double window = 0.42 - 0.5 * cos(2.0 * M_PI * k / (taps - 1)) + 0.08 * cos(4.0 * M_PI * k / (taps - 1));
+        low->filter[k] = sinc * window;
+        sum += low->filter[k];
+    }
+    for (int k = 0; k < taps; k++) {
+        low->filter[k] /= sum;
+    }
+    
+    int chunks = (low->decimated_samples + HYBRID_DECIMATE_CHUNK - 1) / HYBRID_DECIMATE_CHUNK;
+    spectral_parallel_for(job, chunks, fft_decimate_chunk, low);
+    
+    int long_size;
+    return fft_init(layout->long_window, layout->long_size, &long_size, &low->plan, &low->owns_plan,
+                    &low->in, &low->out, job);
+}
+
+/*---------------------------------------------------------------------
+ * fft_hybrid_release()
+ *
+ * Frees the low band of a multi-resolution analysis.
+ *---------------------------------------------------------------------*/
+static void fft_hybrid_release(HybridLowBand *low, SpectralJob *job)
+{
+    fft_cleanup(low->plan, low->owns_plan, low->in, low->out);
+    spectral_free(job, low->filter);
+    spectral_free(job, low->decimated);
+    memset(low, 0, sizeof(*low));
+}
+
+/* Magnitude at fractional bin x of a transform of count bins (linear interpolation) */
+static inline double fft_interpolate(const double *magnitudes, int count, double x)
+{
+    int i = (int)x;
+    if (i >= count - 1) {
+        return magnitudes[count - 1];
+    }
+    return magnitudes[i] + (magnitudes[i + 1] - magnitudes[i]) * (x - i);
+}
+
+/* Windows the samples [start, start + window) of a signal into in, then zero pads it */
+static void fft_load_window(double *in, const double *signal, int total_samples,
+                            int start, int window, int size)
+{
+    for (int i = 0; i < window; i++) {
+        int index = start + i;
+        in[i] = (index >= 0 && index < total_samples) ? signal[index] : 0.0;
+    }
+    for (int i = window; i < size; i++) {
+        in[i] = 0.0;
+    }
+    apply_hann_window(in, window);
+}
+
+/*---------------------------------------------------------------------
+ * fft_hybrid_block()
+ *
+ * Multi-resolution version of fft_block(): the short window above the
+ * crossover, the long window centered on it below, both interpolated
+ * onto the display bins and cross-faded over HYBRID_BLEND_OCTAVES. The
+ * long magnitudes are scaled by the ratio of the window sums, so that a
+ * steady tone has the same level in both bands.
+ *---------------------------------------------------------------------*/
+static void fft_hybrid_block(void *arg, int block)
+{
+    FftBlockContext *ctx = (FftBlockContext *)arg;
+    const HybridFftLayout *hybrid = ctx->hybrid;
+    int first = block * SPECTRAL_JOB_POLL_INTERVAL;
+    int last = first + SPECTRAL_JOB_POLL_INTERVAL;
+    if (last > ctx->num_windows) last = ctx->num_windows;
+    
+    ctx->block_max[block] = 0.0;
+    if (spectral_job_should_stop(ctx->job)) {
+        return;
+    }
+    double trace = spectral_trace_begin();
+    
+    int has_low = hybrid->decimation > 1;
+    int short_bins = ctx->transform_bins;
+    int long_bins = hybrid->long_size / 2 + 1;
+    double *in = (double *)fftw_malloc(sizeof(double) * ctx->fft_effective_size);
+    fftw_complex *out = (fftw_complex *)fftw_malloc(sizeof(fftw_complex) * short_bins);
+    double *short_magnitudes = (double *)malloc(sizeof(double) * short_bins);
+    double *long_in = NULL;
+    fftw_complex *long_out = NULL;
+    double *long_magnitudes = NULL;
+    if (has_low) {
+        long_in = (double *)fftw_malloc(sizeof(double) * hybrid->long_size);
+        long_out = (fftw_complex *)fftw_malloc(sizeof(fftw_complex) * long_bins);
+        long_magnitudes = (double *)malloc(sizeof(double) * long_bins);
+    }
+    if (in == NULL || out == NULL || short_magnitudes == NULL ||
+        (has_low && (long_in == NULL || long_out == NULL || long_magnitudes == NULL))) {
+        if (in) fftw_free(in);
+        if (out) fftw_free(out);
+        if (long_in) fftw_free(long_in);
+        if (long_out) fftw_free(long_out);
+        free(short_magnitudes);
+        free(long_magnitudes);
+        SPECTRAL_ATOMIC_STORE(&ctx->failed, 1);
+        return;
+    }
+    
+    // Transform bins per display bin, and level of the long window
+    double short_scale = ctx->fft_effective_size / (double)ctx->display_size;
+    double long_scale = (double)hybrid->decimation * hybrid->long_size / ctx->display_size;
+    double long_gain = (ctx->fft_size - 1.0) / (hybrid->long_window - 1.0);
+    int blend_span = hybrid->crossover_bin - hybrid->blend_bin;
+    
+    double block_max = 0.0;
+    for (int w = first; w < last; w++) {
+        int start_index = (ctx->first_window + w) * ctx->step;
+        
+        fft_load_window(in, ctx->signal, ctx->total_samples, start_index, ctx->fft_size, ctx->fft_effective_size);
+        fftw_execute_dft_r2c(ctx->plan, in, out);
+        for (int b = 0; b < short_bins; b++) {
+            short_magnitudes[b] = sqrt(out[b][0] * out[b][0] + out[b][1] * out[b][1]);
+        }
+        
+        if (has_low) {
+            int long_start = fft_hybrid_long_start(hybrid, ctx->fft_size, start_index) - ctx->decimated_first;
+            fft_load_window(long_in, ctx->decimated, ctx->decimated_samples, long_start,
+                            hybrid->long_window, hybrid->long_size);
+            fftw_execute_dft_r2c(ctx->long_plan, long_in, long_out);
+            for (int b = 0; b < long_bins; b++) {
+                long_magnitudes[b] = long_gain * sqrt(long_out[b][0] * long_out[b][0] +
+                                                      long_out[b][1] * long_out[b][1]);
+            }
+        }
+        
+        double *row = ctx->spectrogram + (size_t)w * ctx->num_bins;
+        for (int b = 0; b < ctx->num_bins; b++) {
+            double magnitude;
+            if (b >= hybrid->crossover_bin) {
+                magnitude = fft_interpolate(short_magnitudes, short_bins, b * short_scale);
+            } else {
+                magnitude = fft_interpolate(long_magnitudes, long_bins, b * long_scale);
+                if (b >= hybrid->blend_bin) {
+                    double t = (double)(b - hybrid->blend_bin) / blend_span;
+                    magnitude += t * (fft_interpolate(short_magnitudes, short_bins, b * short_scale) - magnitude);
+                }
+            }
+            row[b] = magnitude;
+            
+            if (b >= ctx->index_min && magnitude > block_max) {
+                block_max = magnitude;
+            }
+        }
+    }
+    
+    fftw_free(in);
+    fftw_free(out);
+    if (long_in) fftw_free(long_in);
+    if (long_out) fftw_free(long_out);
+    free(short_magnitudes);
+    free(long_magnitudes);
+    ctx->block_max[block] = block_max;
+    spectral_trace_end(ctx->job, "fft_block", trace,
+                       (long long)(last - first) * ctx->fft_size * (long long)sizeof(double), last - first);
+    SPECTRAL_JOB_COUNT(ctx->job, fftCount, (last - first) * (has_low ? 2 : 1));
+    
+    int done = SPECTRAL_ATOMIC_INCREMENT(&ctx->blocks_done);
+    spectral_job_report(ctx->job, SPECTRAL_STAGE_FFT, (double)done / ctx->num_blocks);
+}
+#endif
+
 /*---------------------------------------------------------------------
  * compute_spectrogram()
  *
  * Computes the spectrogram matrix from an audio signal.
  * Uses FFT size and bins_per_second to handle the temporal/spectral
  * resolution trade-off according to the new adaptive algorithm.
+ * The matrix holds the windows from first_window on, max_windows of
+ * them at most (0 = up to the end of the signal); the long windows
+ * around them still read the samples before and past them
+ * (fft_context_samples()), so a range of windows is analyzed as it is
+ * in the whole recording and one page can be computed at a time.
+ * Windows are processed in blocks of SPECTRAL_JOB_POLL_INTERVAL, in
+ * parallel when the job provides a parallel loop; the job is polled
+ * before each block. The bins are those of a transform padded to
+ * fft_padded_size(fft_size, pad_size). With pad_size 0 the analysis
+ * is multi-resolution when fft_hybrid_layout() finds it cheaper; an
+ * explicit pad_size always runs that transform. Only the bins below
+ * max_freq are stored, and the global maximum is that of the
+ * [min_freq, max_freq] range drawn on the page.
  *
  * Returns:
- *  - 0 on success, non-zero on error.
+ *  - 0 on success, SPECTRAL_CANCELLED if the job was cancelled,
+ *    other non-zero values on error.
  *---------------------------------------------------------------------*/
-int compute_spectrogram(double *signal, int total_samples, int sample_rate,
-                         int fft_size, int overlap_preset, double bins_per_second,
+int compute_spectrogram(double *signal, int total_samples, int first_window, int max_windows, int sample_rate,
+                         int fft_size, int pad_size, int overlap_preset, double bins_per_second,
                          double min_freq, double max_freq,
-                         SpectrogramData *spectro_data)
+                         SpectrogramData *spectro_data,
+                         SpectralJob *job)
 {
-    // Initialize FFT
-    int fft_effective_size;
+    double trace = spectral_trace_begin();
+    
+    // Transform whose bins are stored and drawn
+    int fft_effective_size = fft_padded_size(fft_size, pad_size);
+    HybridFftLayout hybrid;
+    int use_hybrid = pad_size == 0 &&
+                     fft_hybrid_layout(sample_rate, fft_size, fft_effective_size, min_freq, &hybrid);
+    
+    // Initialize FFT (the plan is shared by the blocks, which use their own buffers);
+    // a multi-resolution analysis runs the short transform instead
+    int transform_size;
     fftw_plan plan;
+    int owns_plan;
     double *in;
     fftw_complex *out;
     
-    if (fft_init(fft_size, &fft_effective_size, &plan, &in, &out) != 0) {
+    if (fft_init(fft_size, use_hybrid ? hybrid.short_size : pad_size, &transform_size,
+                 &plan, &owns_plan, &in, &out, job) != 0) {
         return 1;
     }
     
@@ -113,7 +812,7 @@ int compute_spectrogram(double *signal, int total_samples, int sample_rate,
             overlap_preset_name = "Medium";
             break;
     }
-    printf(" - Overlap preset: %s\n", overlap_preset_name);
+    spectral_log(job, SPECTRAL_LOG_INFO, " - Overlap preset: %s\n", overlap_preset_name);
     
     // Calculer le step size basé sur bins_per_second
     // Ce paramètre est directement lié à la vitesse d'écriture (WS)
@@ -121,147 +820,202 @@ int compute_spectrogram(double *signal, int total_samples, int sample_rate,
     int step = (int)(sample_rate / bins_per_second);
     if (step < 1) step = 1;
     
-    printf(" - Using bins/s: %.2f (hop size: %d samples)\n", 
+    spectral_log(job, SPECTRAL_LOG_INFO, " - Using bins/s: %.2f (hop size: %d samples)\n", 
            bins_per_second, step);
     
     // L'overlap effectif est maintenant une conséquence de la taille FFT et du step
     double effective_overlap = 1.0 - ((double)step / fft_size);
-    printf(" - Resulting effective overlap: %.4f\n", effective_overlap);
+    spectral_log(job, SPECTRAL_LOG_INFO, " - Resulting effective overlap: %.4f\n", effective_overlap);
     
     // Calculate number of windows
-    int num_windows = (total_samples - fft_size) / step + 1;
-    if (num_windows <= 0) {
-        fprintf(stderr, "Error: Signal too short for FFT size.\n");
-        fft_cleanup(plan, in, out);
+    int num_windows = (total_samples - fft_size) / step + 1 - first_window;
+    if (first_window < 0 || num_windows <= 0) {
+        spectral_log(job, SPECTRAL_LOG_ERROR, "Error: Signal too short for FFT size.\n");
+        fft_cleanup(plan, owns_plan, in, out);
         return 2;
     }
+    if (max_windows > 0 && num_windows > max_windows) {
+        num_windows = max_windows;
+    }
     
-    // Calculate number of frequency bins
-    int num_bins = fft_effective_size / 2 + 1;
+    // Calculate frequency bin indices from user-specified frequency range
+    int display_bins = fft_effective_size / 2 + 1;
     double freq_resolution = sample_rate / (double)fft_effective_size;
+    int index_min, index_max;
+    if (fft_bin_range(sample_rate, fft_effective_size, min_freq, max_freq, &index_min, &index_max) != 0) {
+        spectral_log(job, SPECTRAL_LOG_WARNING, "Warning: Frequency range %.2f-%.2f Hz holds less than two bins. Using all bins.\n",
+               min_freq, max_freq);
+    }
+    
+    // Only the bins up to the top of the drawn range are stored
+    int num_bins = index_max + 1;
     
     // Allocate memory for spectrogram data
-    double *spectrogram = (double *)malloc(num_windows * num_bins * sizeof(double));
+    double *spectrogram = (double *)spectral_alloc(job, (size_t)num_windows * num_bins * sizeof(double));
     if (spectrogram == NULL) {
-        fprintf(stderr, "Error: Unable to allocate memory for spectrogram.\n");
-        fft_cleanup(plan, in, out);
+        spectral_log(job, SPECTRAL_LOG_ERROR, "Error: Unable to allocate memory for spectrogram.\n");
+        fft_cleanup(plan, owns_plan, in, out);
         return 3;
     }
     
-    // Reset global max
-    double global_max = 0.0;
-    
-    // Calculate frequency bin indices from user-specified frequency range
-    int index_min = (int)ceil(min_freq / freq_resolution);
-    int index_max = (int)floor(max_freq / freq_resolution);
+    spectral_log(job, SPECTRAL_LOG_INFO, " - Computing spectrogram: %d windows, %d of %d frequency bins\n",
+           num_windows, num_bins, display_bins);
+    spectral_log(job, SPECTRAL_LOG_INFO, " - Using overlap preset: %s (effective overlap: %.4f, step size: %d samples)\n",
+           overlap_preset_name, effective_overlap, step);
+    spectral_log(job, SPECTRAL_LOG_INFO, " - Frequency range: %.2f Hz to %.2f Hz (bins %d to %d)\n",
+           min_freq, max_freq, index_min, index_max);
     
-    // Validate bin indices
-    if (index_min < 0) index_min = 0;
-    if (index_max > num_bins - 1) index_max = num_bins - 1;
-    if (index_min >= index_max) {
-        fprintf(stderr, "Warning: Min frequency index (%d) >= max frequency index (%d). Adjusting.\n", 
-               index_min, index_max);
-        index_min = 0;
-        index_max = num_bins - 1;
+    // Compute spectrogram, one block of windows per parallel task; each block
+    // keeps its own maximum so the result does not depend on scheduling
+    int num_blocks = (num_windows + SPECTRAL_JOB_POLL_INTERVAL - 1) / SPECTRAL_JOB_POLL_INTERVAL;
+    double *block_max = (double *)spectral_alloc(job, (size_t)num_blocks * sizeof(double));
+    if (block_max == NULL) {
+        spectral_log(job, SPECTRAL_LOG_ERROR, "Error: Unable to allocate memory for spectrogram.\n");
+        spectral_free(job, spectrogram);
+        fft_cleanup(plan, owns_plan, in, out);
+        return 3;
     }
     
-    printf(" - Computing spectrogram: %d windows, %d frequency bins\n", num_windows, num_bins);
-    printf(" - Using overlap preset: %s (effective overlap: %.4f, step size: %d samples)\n",
-           overlap_preset_name, effective_overlap, step);
-    printf(" - Frequency range: %.2f Hz to %.2f Hz (bins %d to %d)\n",
-           min_freq, max_freq, index_min, index_max);
+    FftBlockContext ctx;
+    ctx.signal = signal;
+    ctx.total_samples = total_samples;
+    ctx.fft_size = fft_size;
+    ctx.fft_effective_size = transform_size;
+    ctx.step = step;
+    ctx.first_window = first_window;
+    ctx.num_windows = num_windows;
+    ctx.num_bins = num_bins;
+    ctx.transform_bins = transform_size / 2 + 1;
+    ctx.index_min = index_min;
+    ctx.num_blocks = num_blocks;
+    ctx.plan = plan;
+    ctx.spectrogram = spectrogram;
+    ctx.block_max = block_max;
+    ctx.blocks_done = 0;
+    ctx.failed = 0;
+    ctx.job = job;
+    ctx.hybrid = NULL;
+    ctx.display_size = fft_effective_size;
+    ctx.decimated = NULL;
+    ctx.decimated_first = 0;
+    ctx.decimated_samples = 0;
+    ctx.long_plan = NULL;
     
-    // Compute spectrogram
-    for (int w = 0; w < num_windows; w++) {
-        int start_index = w * step;
-        
-        // Copy signal chunk to FFT input buffer with zero padding if needed
-        for (int i = 0; i < fft_size; i++) {
-            if (start_index + i < total_samples) {
-                in[i] = signal[start_index + i];
+    #if USE_HYBRID_FFT
+        if (use_hybrid) {
+            HybridLowBand low;
+            if (fft_hybrid_prepare(signal, total_samples, fft_size, step, first_window, num_windows,
+                                   &hybrid, &low, job) != 0) {
+                fft_hybrid_release(&low, job);
+                spectral_free(job, block_max);
+                spectral_free(job, spectrogram);
+                fft_cleanup(plan, owns_plan, in, out);
+                return 3;
+            }
+            if (hybrid.decimation > 1) {
+                spectral_log(job, SPECTRAL_LOG_INFO, " - Multi-resolution: short window padded to %d; below %.0f Hz, %d-sample window decimated by %d (transform %d)\n",
+                             transform_size, HYBRID_LOW_FREQ_THRESHOLD, hybrid.long_window, hybrid.decimation, hybrid.long_size);
             } else {
-                in[i] = 0.0;
+                spectral_log(job, SPECTRAL_LOG_INFO, " - Multi-resolution: short window padded to %d\n", transform_size);
             }
+            ctx.hybrid = &hybrid;
+            ctx.decimated = low.decimated;
+            ctx.decimated_first = low.decimated_first;
+            ctx.decimated_samples = low.decimated_samples;
+            ctx.long_plan = low.plan;
+            spectral_parallel_for(job, num_blocks, fft_hybrid_block, &ctx);
+            fft_hybrid_release(&low, job);
+        } else {
+            spectral_parallel_for(job, num_blocks, fft_block, &ctx);
         }
-        
-        // Zero-pad the rest of the buffer if needed
-        for (int i = fft_size; i < fft_effective_size; i++) {
-            in[i] = 0.0;
+    #else
+        spectral_parallel_for(job, num_blocks, fft_block, &ctx);
+    #endif
+    
+    double global_max = 0.0;
+    for (int i = 0; i < num_blocks; i++) {
+        if (block_max[i] > global_max) {
+            global_max = block_max[i];
         }
-        
-        // Apply window function
-        apply_hann_window(in, fft_size);
-        
-        // Execute FFT
-        fftw_execute(plan);
-        
-        // Calculate magnitude for each frequency bin
-        for (int b = 0; b < num_bins; b++) {
-            double real = out[b][0];
-            double imag = out[b][1];
-            double magnitude = sqrt(real * real + imag * imag);
-            
-            spectrogram[w * num_bins + b] = magnitude;
-            
-            // Update global maximum
-            if (magnitude > global_max) {
-                global_max = magnitude;
-            }
+    }
+    spectral_free(job, block_max);
+    
+    if (ctx.failed || spectral_job_should_stop(job)) {
+        spectral_free(job, spectrogram);
+        fft_cleanup(plan, owns_plan, in, out);
+        if (ctx.failed) {
+            spectral_log(job, SPECTRAL_LOG_ERROR, "Error: Unable to allocate FFT block buffers.\n");
+            return 3;
         }
+        spectral_log(job, SPECTRAL_LOG_INFO, " - Spectrogram computation cancelled\n");
+        return SPECTRAL_CANCELLED;
     }
     
     // Populate spectrogram data structure
     spectro_data->data = spectrogram;
+    spectro_data->first_window = first_window;
     spectro_data->num_windows = num_windows;
     spectro_data->num_bins = num_bins;
     spectro_data->index_min = index_min;
     spectro_data->index_max = index_max;
     spectro_data->global_max = global_max;
+    spectro_data->freq_resolution = freq_resolution;
+    spectro_data->bins_per_octave = 0.0;
+    spectro_data->base_freq = 0.0;
     
     // Clean up FFT resources
-    fft_cleanup(plan, in, out);
+    fft_cleanup(plan, owns_plan, in, out);
+    
+    spectral_trace_end(job, "fft", trace, (long long)total_samples * (long long)sizeof(double), num_windows);
+    spectral_job_report(job, SPECTRAL_STAGE_FFT, 1.0);
     
     return 0;
 }
 
+// Shared parameters of the parallel tone-mapping blocks
+typedef struct ToneMapContext {
+    double *spectrogram;
+    int num_windows;
+    int num_bins;
+    int index_min;
+    int index_max;
+    int num_blocks;
+    double global_max;
+    double dynamic_range_db;
+    double gamma_correction;
+    int enable_dither;
+    double contrast_factor;
+    unsigned long long seed;
+    volatile int blocks_done;
+    SpectralJob *job;
+} ToneMapContext;
+
 /*---------------------------------------------------------------------
- * apply_image_processing()
+ * tone_map_block()
  *
- * Applies various image processing techniques to the spectrogram data.
- * Follows the same sequence of operations as the original code for
- * intensity computation and mapping.
+ * Maps the magnitudes of one block of windows to display intensities.
+ * The dithering noise of a block is derived from the seed and the block
+ * index only, so the image does not depend on scheduling.
  *---------------------------------------------------------------------*/
-void apply_image_processing(SpectrogramData *spectro_data, 
-                           double dynamic_range_db, double gamma_correction,
-                           int enable_dither, double contrast_factor)
+static void tone_map_block(void *arg, int block)
 {
-    int num_windows = spectro_data->num_windows;
-    int num_bins = spectro_data->num_bins;
-    int index_min = spectro_data->index_min;
-    int index_max = spectro_data->index_max;
-    double global_max = spectro_data->global_max;
-    double *spectrogram = spectro_data->data;
+    ToneMapContext *ctx = (ToneMapContext *)arg;
+    int first = block * SPECTRAL_JOB_POLL_INTERVAL;
+    int last = first + SPECTRAL_JOB_POLL_INTERVAL;
+    if (last > ctx->num_windows) last = ctx->num_windows;
     
-    // Validate parameters
-    if (dynamic_range_db <= 0.0) dynamic_range_db = DYNAMIC_RANGE_DB;
-    if (gamma_correction <= 0.0) gamma_correction = GAMMA_CORRECTION;
-    if (contrast_factor <= 0.0) contrast_factor = CONTRAST_FACTOR;
-    
-    printf(" - Applying image processing:\n");
-    printf("   - Dynamic range: %.2f dB\n", dynamic_range_db);
-    printf("   - Gamma correction: %.2f\n", gamma_correction);
-    printf("   - Contrast factor: %.2f\n", contrast_factor);
-    printf("   - Dithering: %s\n", enable_dither ? "enabled" : "disabled");
-    
-    // Initialize seed for dithering if enabled
-    if (enable_dither) {
-        srand((unsigned int)time(NULL));
-    }
+    unsigned long long rng_state = ctx->seed ^ ((unsigned long long)block * 0xD1B54A32D192ED03ULL);
+    double *spectrogram = ctx->spectrogram;
+    int num_bins = ctx->num_bins;
+    double global_max = ctx->global_max;
+    double dynamic_range_db = ctx->dynamic_range_db;
+    double gamma_correction = ctx->gamma_correction;
+    double contrast_factor = ctx->contrast_factor;
     
     // Process each pixel in the spectrogram following original algorithm
-    for (int w = 0; w < num_windows; w++) {
-        for (int b = index_min; b <= index_max; b++) {
-            double magnitude = spectrogram[w * num_bins + b];
+    for (int w = first; w < last; w++) {
+        for (int b = ctx->index_min; b <= ctx->index_max; b++) {
+            double magnitude = spectrogram[(size_t)w * num_bins + b];
             double intensity = 0.0;
             double epsilon = 1e-10; // Prevent log of zero
             
@@ -292,8 +1046,8 @@ void apply_image_processing(SpectrogramData *spectro_data,
             double quantized = inverted_intensity * 255.0;
             
             // Apply dithering if enabled
-            if (enable_dither) {
-                double dither = ((double)rand() / (double)RAND_MAX) - 0.5;
+            if (ctx->enable_dither) {
+                double dither = spectral_random_uniform(&rng_state) - 0.5;
                 quantized += dither;
             }
             
@@ -312,7 +1066,61 @@ void apply_image_processing(SpectrogramData *spectro_data,
             if (final_intensity > 1.0) final_intensity = 1.0;
             
             // Store processed value in the spectrogram
-            spectrogram[w * num_bins + b] = final_intensity;
+            spectrogram[(size_t)w * num_bins + b] = final_intensity;
         }
     }
+    
+    int done = SPECTRAL_ATOMIC_INCREMENT(&ctx->blocks_done);
+    spectral_job_report(ctx->job, SPECTRAL_STAGE_TONE_MAP, (double)done / ctx->num_blocks);
+}
+
+/*---------------------------------------------------------------------
+ * apply_image_processing()
+ *
+ * Applies various image processing techniques to the spectrogram data.
+ * Follows the same sequence of operations as the original code for
+ * intensity computation and mapping. Blocks of SPECTRAL_JOB_POLL_INTERVAL
+ * windows are processed in parallel when the job provides a parallel
+ * loop; the dithering noise follows the job's seed and the first window
+ * of the matrix, so the pages of a recording get different noise.
+ *---------------------------------------------------------------------*/
+void apply_image_processing(SpectrogramData *spectro_data, 
+                           double dynamic_range_db, double gamma_correction,
+                           int enable_dither, double contrast_factor,
+                           SpectralJob *job)
+{
+    // Validate parameters
+    if (dynamic_range_db <= 0.0) dynamic_range_db = DYNAMIC_RANGE_DB;
+    if (gamma_correction <= 0.0) gamma_correction = GAMMA_CORRECTION;
+    if (contrast_factor <= 0.0) contrast_factor = CONTRAST_FACTOR;
+    
+    spectral_log(job, SPECTRAL_LOG_INFO, " - Applying image processing:\n");
+    spectral_log(job, SPECTRAL_LOG_INFO, "   - Dynamic range: %.2f dB\n", dynamic_range_db);
+    spectral_log(job, SPECTRAL_LOG_INFO, "   - Gamma correction: %.2f\n", gamma_correction);
+    spectral_log(job, SPECTRAL_LOG_INFO, "   - Contrast factor: %.2f\n", contrast_factor);
+    spectral_log(job, SPECTRAL_LOG_INFO, "   - Dithering: %s\n", enable_dither ? "enabled" : "disabled");
+    
+    ToneMapContext ctx;
+    ctx.spectrogram = spectro_data->data;
+    ctx.num_windows = spectro_data->num_windows;
+    ctx.num_bins = spectro_data->num_bins;
+    ctx.index_min = spectro_data->index_min;
+    ctx.index_max = spectro_data->index_max;
+    ctx.num_blocks = (ctx.num_windows + SPECTRAL_JOB_POLL_INTERVAL - 1) / SPECTRAL_JOB_POLL_INTERVAL;
+    ctx.global_max = spectro_data->global_max;
+    ctx.dynamic_range_db = dynamic_range_db;
+    ctx.gamma_correction = gamma_correction;
+    ctx.enable_dither = enable_dither;
+    ctx.contrast_factor = contrast_factor;
+    // Dithering noise is drawn from the job's seed, never from the global rand()
+    ctx.seed = spectral_job_seed(job) ^ ((unsigned long long)spectro_data->first_window * 0x9E3779B97F4A7C15ULL);
+    ctx.blocks_done = 0;
+    ctx.job = job;
+    
+    double trace = spectral_trace_begin();
+    spectral_parallel_for(job, ctx.num_blocks, tone_map_block, &ctx);
+    spectral_trace_end(job, "tone_map", trace,
+                       (long long)ctx.num_windows * ctx.num_bins * (long long)sizeof(double), ctx.num_windows);
+    
+    spectral_job_report(job, SPECTRAL_STAGE_TONE_MAP, 1.0);
 }
@@ -20,22 +20,50 @@
 // Structure to hold spectrogram data
 typedef struct {
     double *data;           // The spectrogram matrix
+    int first_window;       // Window of the recording in row 0 (one page of a paginated analysis)
     int num_windows;        // Number of time windows
-    int num_bins;           // Number of frequency bins
+    int num_bins;           // Frequency bins stored per window (index_max + 1)
     int index_min;          // Minimum frequency bin index for the specified range
     int index_max;          // Maximum frequency bin index for the specified range
     double global_max;      // Maximum magnitude value in the spectrogram
+    double freq_resolution; // Hz per frequency bin (depends on the zero padding)
+    double bins_per_octave; // Constant-Q bins per octave (0 = uniform FFT bins)
+    double base_freq;       // Frequency of constant-Q bin 0
 } SpectrogramData;
 
+// Multi-resolution layout of an analysis (fft_hybrid_layout()). Both
+// transforms are interpolated onto the bins of the display transform.
+typedef struct {
+    int short_size;         // Transform length of the short window
+    int decimation;         // Decimation of the low band (1 = no low band)
+    int long_window;        // Long window, in decimated samples
+    int long_size;          // Transform length of the long window
+    int filter_taps;        // Anti-aliasing filter length, at the source rate
+    int blend_bin;          // Display bins below come from the long window only
+    int crossover_bin;      // Display bins from here come from the short window only
+} HybridFftLayout;
+
 // Function prototypes
-int fft_init(int fft_size, int *fft_effective_size, fftw_plan *plan, double **in, fftw_complex **out);
-void fft_cleanup(fftw_plan plan, double *in, fftw_complex *out);
-int compute_spectrogram(double *signal, int total_samples, int sample_rate,
-                         int fft_size, int overlap_preset, double bins_per_second,
+double spectrogram_bin_frequency(const SpectrogramData *spectro, double bin);
+double spectrogram_bin_position(const SpectrogramData *spectro, double freq);
+int fft_padded_size(int fft_size, int pad_size);
+int fft_bin_range(int sample_rate, int fft_effective_size, double min_freq, double max_freq,
+                  int *index_min, int *index_max);
+int fft_hybrid_layout(int sample_rate, int fft_size, int display_size, double min_freq,
+                      HybridFftLayout *layout);
+double fft_window_work(int sample_rate, int fft_size, int pad_size, double min_freq, int hop_size);
+int fft_context_samples(int sample_rate, int fft_size, int pad_size, double min_freq);
+int fft_init(int fft_size, int pad_size, int *fft_effective_size, fftw_plan *plan, int *owns_plan,
+             double **in, fftw_complex **out, SpectralJob *job);
+void fft_cleanup(fftw_plan plan, int owns_plan, double *in, fftw_complex *out);
+int compute_spectrogram(double *signal, int total_samples, int first_window, int max_windows, int sample_rate,
+                         int fft_size, int pad_size, int overlap_preset, double bins_per_second,
                          double min_freq, double max_freq,
-                         SpectrogramData *spectro_data);
+                         SpectrogramData *spectro_data,
+                         SpectralJob *job);
 void apply_image_processing(SpectrogramData *spectro_data, 
                            double dynamic_range_db, double gamma_correction,
-                           int enable_dither, double contrast_factor);
+                           int enable_dither, double contrast_factor,
+                           SpectralJob *job);
 
 #endif /* SPECTRAL_FFT_H */
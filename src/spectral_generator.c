@@ -6,19 +6,599 @@
  * in the root directory of this software component.
  */
 
+#define SPECTRAL_LOG_CATEGORY "job"
 #include "spectral_common.h"
 #include "spectral_wav_processing.h"
 #include "spectral_fft.h"
 
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
 // External declarations of functions implemented in other modules
 extern int spectral_generator_impl(const SpectrogramSettings *cfg, 
                                   const char *inputFile, 
-                                  const char *outputFile);
+                                  const char *outputFile,
+                                  SpectralJob *job);
 
 extern int spectral_generator_vector_pdf_impl(const SpectrogramSettings *cfg, 
                                              const char *inputFile, 
                                              const char *outputFile, 
-                                             int dpi);
+                                             int dpi,
+                                             SpectralJob *job);
+
+/*---------------------------------------------------------------------
+ * spectral_job_now()
+ *
+ * Returns the monotonic time in seconds.
+ *---------------------------------------------------------------------*/
+static double spectral_job_now(void)
+{
+#ifdef _WIN32
+    return (double)GetTickCount64() / 1000.0;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+#endif
+}
+
+/*---------------------------------------------------------------------
+ * spectral_thread_cpu_time()
+ *
+ * Returns the CPU time consumed by the calling thread, in seconds.
+ *---------------------------------------------------------------------*/
+static double spectral_thread_cpu_time(void)
+{
+#ifdef _WIN32
+    FILETIME creation, exit, kernel, user;
+    if (!GetThreadTimes(GetCurrentThread(), &creation, &exit, &kernel, &user)) {
+        return 0.0;
+    }
+    ULARGE_INTEGER k, u;
+    k.LowPart = kernel.dwLowDateTime;
+    k.HighPart = kernel.dwHighDateTime;
+    u.LowPart = user.dwLowDateTime;
+    u.HighPart = user.dwHighDateTime;
+    return (double)(k.QuadPart + u.QuadPart) / 1e7;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+#endif
+}
+
+/* Stage timed by the calling thread, charged with the CPU time of its parallel loops */
+static SPECTRAL_THREAD_LOCAL int stage_current = -1;
+
+/*---------------------------------------------------------------------
+ * spectral_job_init()
+ *
+ * Initializes a job context. A timeout <= 0 disables the deadline.
+ *---------------------------------------------------------------------*/
+void spectral_job_init(SpectralJob *job, double timeoutSeconds)
+{
+    job->cancelRequested = 0;
+    job->deadline = timeoutSeconds > 0.0 ? spectral_job_now() + timeoutSeconds : 0.0;
+    job->progress = NULL;
+    job->progressUserData = NULL;
+    job->progressInterval = SPECTRAL_DEFAULT_PROGRESS_INTERVAL;
+    job->lastProgressTime = 0.0;
+    job->lastProgressStage = -1;
+    job->lastProgressOverall = 0.0;
+    spectral_job_progress_range(job, SPECTRAL_STAGE_DECODE, SPECTRAL_STAGE_ENCODE, 1.0);
+    job->seed = SPECTRAL_DEFAULT_SEED;
+    job->log = NULL;
+    job->logUserData = NULL;
+    spectral_job_set_allocator(job, NULL);
+    job->planCache = NULL;
+    job->parallelFor = NULL;
+    job->parallelUserData = NULL;
+    job->reporting = 0;
+    memset(&job->stats, 0, sizeof(job->stats));
+    job->memoryBudget = 0;
+    job->timeBudget = 0.0;
+    spectral_cost_model_init(&job->costModel);
+}
+
+/*---------------------------------------------------------------------
+ * spectral_job_set_progress()
+ *
+ * Installs the progress callback of a job and its throttling interval.
+ *---------------------------------------------------------------------*/
+void spectral_job_set_progress(SpectralJob *job, SpectralProgressCallback callback,
+                               void *userData, double intervalSeconds)
+{
+    job->progress = callback;
+    job->progressUserData = userData;
+    job->progressInterval = intervalSeconds > 0.0 ? intervalSeconds : SPECTRAL_DEFAULT_PROGRESS_INTERVAL;
+    job->lastProgressTime = 0.0;
+    job->lastProgressStage = -1;
+    job->lastProgressOverall = 0.0;
+    spectral_job_progress_range(job, SPECTRAL_STAGE_DECODE, SPECTRAL_STAGE_ENCODE, 1.0);
+}
+
+/*---------------------------------------------------------------------
+ * spectral_job_progress_range()
+ *
+ * Maps the next reports of the stages [first, last] onto the overall
+ * fractions from the last one reported up to end, so that a generation
+ * running some stages twice (the draft, then the refinement of
+ * spectral_generator_progressive()) keeps a monotonic progress.
+ *---------------------------------------------------------------------*/
+void spectral_job_progress_range(SpectralJob *job, SpectralStage first, SpectralStage last, double end)
+{
+    if (job == NULL) {
+        return;
+    }
+    job->progressFirstStage = (int)first;
+    job->progressLastStage = (int)last;
+    job->progressStart = job->lastProgressOverall;
+    job->progressEnd = end > job->progressStart ? end : job->progressStart;
+}
+
+/*---------------------------------------------------------------------
+ * spectral_job_report_locked()
+ *
+ * Body of spectral_job_report(), run by one thread at a time.
+ *---------------------------------------------------------------------*/
+static void spectral_job_report_locked(SpectralJob *job, SpectralStage stage, double stageFraction)
+{
+    // Typical share of each stage in the generation time
+    static const double stage_weights[SPECTRAL_STAGE_COUNT] = {
+        0.10,   // decode
+        0.05,   // filter
+        0.45,   // FFT
+        0.10,   // tone map
+        0.20,   // raster
+        0.10    // encode
+    };
+
+    double now = spectral_job_now();
+    if ((int)stage == job->lastProgressStage && stageFraction < 1.0 &&
+        now - job->lastProgressTime < job->progressInterval) {
+        return;
+    }
+    job->lastProgressTime = now;
+    job->lastProgressStage = (int)stage;
+
+    // Weighted position within the stages of the current range...
+    double first = 0.0;
+    double position = 0.0;
+    double span = 0.0;
+    for (int i = 0; i < SPECTRAL_STAGE_COUNT; i++) {
+        if (i < job->progressFirstStage) {
+            first += stage_weights[i];
+        }
+        if (i < (int)stage) {
+            position += stage_weights[i];
+        }
+        if (i >= job->progressFirstStage && i <= job->progressLastStage) {
+            span += stage_weights[i];
+        }
+    }
+    position += stage_weights[stage] * stageFraction;
+    double fraction = span > 0.0 ? (position - first) / span : 1.0;
+    if (fraction < 0.0) fraction = 0.0;
+    if (fraction > 1.0) fraction = 1.0;
+
+    // ...mapped onto its overall fractions; a stage run again (one per page)
+    // holds the bar instead of moving it back
+    double overall = job->progressStart + (job->progressEnd - job->progressStart) * fraction;
+    if (overall < job->lastProgressOverall) {
+        overall = job->lastProgressOverall;
+    }
+    job->lastProgressOverall = overall;
+
+    job->progress(job->progressUserData, stage, stageFraction, overall);
+}
+
+/*---------------------------------------------------------------------
+ * spectral_job_report()
+ *
+ * Reports the progress of a stage. The overall fraction weights each
+ * stage by its typical share of the generation time, within the range
+ * of spectral_job_progress_range(), and never decreases. Reports inside a
+ * stage are throttled to one per progressInterval; the first report of
+ * a stage and its completion always go through. Parallel stages report
+ * from several threads: an intermediate report arriving while another
+ * one is being delivered is dropped.
+ *---------------------------------------------------------------------*/
+void spectral_job_report(SpectralJob *job, SpectralStage stage, double stageFraction)
+{
+    if (job == NULL || job->progress == NULL || stage < 0 || stage >= SPECTRAL_STAGE_COUNT) {
+        return;
+    }
+
+    if (stageFraction < 0.0) stageFraction = 0.0;
+    if (stageFraction > 1.0) stageFraction = 1.0;
+
+    while (SPECTRAL_ATOMIC_EXCHANGE(&job->reporting, 1)) {
+        if (stageFraction < 1.0) {
+            return;
+        }
+    }
+    spectral_job_report_locked(job, stage, stageFraction);
+    SPECTRAL_ATOMIC_STORE_RELEASE(&job->reporting, 0);
+}
+
+/*---------------------------------------------------------------------
+ * spectral_stage_name()
+ *
+ * Returns:
+ *  - a short display name for a stage.
+ *---------------------------------------------------------------------*/
+const char *spectral_stage_name(SpectralStage stage)
+{
+    switch (stage) {
+        case SPECTRAL_STAGE_DECODE:   return "Decoding audio";
+        case SPECTRAL_STAGE_FILTER:   return "Filtering";
+        case SPECTRAL_STAGE_FFT:      return "Computing FFT";
+        case SPECTRAL_STAGE_TONE_MAP: return "Tone mapping";
+        case SPECTRAL_STAGE_RASTER:   return "Rendering";
+        case SPECTRAL_STAGE_ENCODE:   return "Encoding";
+        default:                      return "Processing";
+    }
+}
+
+/*---------------------------------------------------------------------
+ * spectral_page_file_name()
+ *
+ * Inserts the 1-based page number before the extension of outputFile
+ * ("spectrogram.png" -> "spectrogram_001.png"). A dot in a directory
+ * name is not an extension.
+ *
+ * Returns:
+ *  - 0 on success, -1 if the name does not fit in buffer.
+ *---------------------------------------------------------------------*/
+int spectral_page_file_name(const char *outputFile, int page, char *buffer, size_t size)
+{
+    const char *dot = strrchr(outputFile, '.');
+    const char *slash = strrchr(outputFile, '/');
+    const char *backslash = strrchr(outputFile, '\\');
+    if (backslash != NULL && (slash == NULL || backslash > slash)) slash = backslash;
+    if (dot == NULL || (slash != NULL && dot < slash)) {
+        dot = outputFile + strlen(outputFile);
+    }
+    
+    int written = snprintf(buffer, size, "%.*s_%03d%s", (int)(dot - outputFile), outputFile, page, dot);
+    return (written < 0 || (size_t)written >= size) ? -1 : 0;
+}
+
+/*---------------------------------------------------------------------
+ * spectral_job_set_seed()
+ *
+ * Sets the seed of the dithering noise. Two generations with the same
+ * settings and seed produce identical images.
+ *---------------------------------------------------------------------*/
+void spectral_job_set_seed(SpectralJob *job, unsigned long long seed)
+{
+    job->seed = seed;
+}
+
+/*---------------------------------------------------------------------
+ * spectral_job_seed()
+ *
+ * Returns:
+ *  - the seed of the job, SPECTRAL_DEFAULT_SEED for a NULL job.
+ *---------------------------------------------------------------------*/
+unsigned long long spectral_job_seed(const SpectralJob *job)
+{
+    return job != NULL ? job->seed : SPECTRAL_DEFAULT_SEED;
+}
+
+/*---------------------------------------------------------------------
+ * spectral_random_uniform()
+ *
+ * SplitMix64 generator: the whole state is the caller's 64-bit word,
+ * so each generation draws its own reproducible sequence.
+ *
+ * Returns:
+ *  - a uniform value in [0, 1).
+ *---------------------------------------------------------------------*/
+double spectral_random_uniform(unsigned long long *state)
+{
+    unsigned long long z = (*state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    z ^= z >> 31;
+    return (double)(z >> 11) * (1.0 / 9007199254740992.0);
+}
+
+/*---------------------------------------------------------------------
+ * spectral_job_set_logger()
+ *
+ * Routes the messages of the generation to a callback. A NULL callback
+ * restores the default output (stdout, stderr for warnings and errors).
+ * The callback runs on the logging thread (see spectral_log.c).
+ *---------------------------------------------------------------------*/
+void spectral_job_set_logger(SpectralJob *job, SpectralLogCallback callback, void *userData)
+{
+    job->log = callback;
+    job->logUserData = userData;
+}
+
+static void *spectral_default_allocate(void *userData, size_t size)
+{
+    (void)userData;
+    return malloc(size);
+}
+
+static void spectral_default_release(void *userData, void *ptr)
+{
+    (void)userData;
+    free(ptr);
+}
+
+/*---------------------------------------------------------------------
+ * spectral_job_set_allocator()
+ *
+ * Replaces the allocator of the job's buffers. NULL restores malloc/free.
+ *---------------------------------------------------------------------*/
+void spectral_job_set_allocator(SpectralJob *job, const SpectralAllocator *allocator)
+{
+    if (allocator != NULL && allocator->allocate != NULL && allocator->release != NULL) {
+        job->allocator = *allocator;
+    } else {
+        job->allocator.allocate = spectral_default_allocate;
+        job->allocator.release = spectral_default_release;
+        job->allocator.userData = NULL;
+    }
+}
+
+/*---------------------------------------------------------------------
+ * spectral_alloc() / spectral_free()
+ *
+ * Allocate and release a buffer through the job's allocator (malloc and
+ * free for a NULL job). Buffers must be released with the same job.
+ * Each buffer is prefixed with its size, so the job can count the bytes
+ * it holds and their high-water mark.
+ *---------------------------------------------------------------------*/
+void *spectral_alloc(SpectralJob *job, size_t size)
+{
+    if (job == NULL) {
+        return malloc(size);
+    }
+
+    unsigned char *block = (unsigned char *)job->allocator.allocate(job->allocator.userData,
+                                                                     size + SPECTRAL_ALLOC_HEADER);
+    if (block == NULL) {
+        return NULL;
+    }
+    *(size_t *)block = size;
+
+    long long held = SPECTRAL_ATOMIC_ADD(&job->stats.allocatedBytes, (long long)size);
+#if defined(__GNUC__) || defined(__clang__)
+    long long peak = __atomic_load_n(&job->stats.peakAllocatedBytes, __ATOMIC_RELAXED);
+    while (held > peak &&
+           !__atomic_compare_exchange_n(&job->stats.peakAllocatedBytes, &peak, held, 1,
+                                        __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+    }
+#else
+    if (held > job->stats.peakAllocatedBytes) {
+        job->stats.peakAllocatedBytes = held;
+    }
+#endif
+    return block + SPECTRAL_ALLOC_HEADER;
+}
+
+void spectral_free(SpectralJob *job, void *ptr)
+{
+    if (ptr == NULL) {
+        return;
+    }
+    if (job == NULL) {
+        free(ptr);
+        return;
+    }
+    unsigned char *block = (unsigned char *)ptr - SPECTRAL_ALLOC_HEADER;
+    SPECTRAL_ATOMIC_ADD(&job->stats.allocatedBytes, -(long long)*(size_t *)block);
+    job->allocator.release(job->allocator.userData, block);
+}
+
+/*---------------------------------------------------------------------
+ * spectral_free_detached()
+ *
+ * Releases a buffer of spectral_alloc() with the allocator of a job that
+ * may no longer exist (an analysis outliving its job).
+ *---------------------------------------------------------------------*/
+void spectral_free_detached(const SpectralAllocator *allocator, void *ptr)
+{
+    if (ptr != NULL) {
+        allocator->release(allocator->userData, (unsigned char *)ptr - SPECTRAL_ALLOC_HEADER);
+    }
+}
+
+/*---------------------------------------------------------------------
+ * spectral_stage_begin() / spectral_stage_end()
+ *
+ * Time one run of a stage on the calling thread and add its wall and CPU
+ * time to the job's statistics. Runs of a stage may nest in another one
+ * (the thread's stage is restored at the end).
+ *---------------------------------------------------------------------*/
+void spectral_stage_begin(SpectralJob *job, SpectralStage stage, SpectralStageTimer *timer)
+{
+    timer->previousStage = stage_current;
+    if (job == NULL) {
+        return;
+    }
+    timer->wall = spectral_job_now();
+    timer->cpu = spectral_thread_cpu_time();
+    stage_current = (int)stage;
+}
+
+void spectral_stage_end(SpectralJob *job, SpectralStage stage, const SpectralStageTimer *timer)
+{
+    if (job == NULL) {
+        return;
+    }
+    stage_current = timer->previousStage;
+    SPECTRAL_ATOMIC_ADD(&job->stats.stageWallUs[stage],
+                        (long long)((spectral_job_now() - timer->wall) * 1e6));
+    SPECTRAL_ATOMIC_ADD(&job->stats.stageCpuUs[stage],
+                        (long long)((spectral_thread_cpu_time() - timer->cpu) * 1e6));
+}
+
+/*---------------------------------------------------------------------
+ * spectral_job_stats_add()
+ *
+ * Adds the counters of another job.
+ *---------------------------------------------------------------------*/
+void spectral_job_stats_add(SpectralJobStats *stats, const SpectralJobStats *other)
+{
+    stats->fftCount += other->fftCount;
+    stats->bytesDecoded += other->bytesDecoded;
+    stats->allocatedBytes += other->allocatedBytes;
+    stats->peakAllocatedBytes += other->peakAllocatedBytes;
+    stats->planCacheHits += other->planCacheHits;
+    stats->planCacheMisses += other->planCacheMisses;
+    stats->vectorRects += other->vectorRects;
+    stats->vectorFills += other->vectorFills;
+    for (int i = 0; i < SPECTRAL_STAGE_COUNT; i++) {
+        stats->stageWallUs[i] += other->stageWallUs[i];
+        stats->stageCpuUs[i] += other->stageCpuUs[i];
+    }
+}
+
+/*---------------------------------------------------------------------
+ * spectral_job_stats_format()
+ *
+ * Formats the counters on one line; the stages that did not run are
+ * left out. Times are given as wall/CPU milliseconds.
+ *
+ * Returns:
+ *  - the length of the full summary (it is truncated to size - 1).
+ *---------------------------------------------------------------------*/
+int spectral_job_stats_format(const SpectralJobStats *stats, char *buffer, size_t size)
+{
+    static const char *stage_labels[SPECTRAL_STAGE_COUNT] = {
+        "Decode", "Filter", "FFT", "Tone map", "Raster", "Encode"
+    };
+
+    char line[1024];
+    int length = snprintf(line, sizeof(line),
+                          "Perf: %lld FFTs, Decoded: %.1f MB, Peak: %.1f MB, Plans: %lld hit / %lld miss",
+                          stats->fftCount, stats->bytesDecoded / 1048576.0,
+                          stats->peakAllocatedBytes / 1048576.0,
+                          stats->planCacheHits, stats->planCacheMisses);
+    for (int i = 0; i < SPECTRAL_STAGE_COUNT && length < (int)sizeof(line); i++) {
+        if (stats->stageWallUs[i] <= 0) {
+            continue;
+        }
+        length += snprintf(line + length, sizeof(line) - length, ", %s: %.0f/%.0f ms",
+                           stage_labels[i], stats->stageWallUs[i] / 1000.0, stats->stageCpuUs[i] / 1000.0);
+    }
+    return snprintf(buffer, size, "%s", line);
+}
+
+/*---------------------------------------------------------------------
+ * spectral_job_set_plan_cache()
+ *
+ * Lets the job reuse the FFT plans of a cache shared with other jobs.
+ *---------------------------------------------------------------------*/
+void spectral_job_set_plan_cache(SpectralJob *job, SpectralPlanCache *cache)
+{
+    job->planCache = cache;
+}
+
+/*---------------------------------------------------------------------
+ * spectral_job_set_parallel_for()
+ *
+ * Installs the parallel loop used by the block-parallel stages.
+ *---------------------------------------------------------------------*/
+void spectral_job_set_parallel_for(SpectralJob *job, SpectralParallelFor parallelFor,
+                                   void *userData)
+{
+    job->parallelFor = parallelFor;
+    job->parallelUserData = userData;
+}
+
+// A parallel loop of a timed stage: the iterations run on helper threads
+// charge their CPU time to the stage
+typedef struct ParallelStageContext {
+    SpectralJob *job;
+    int stage;
+    void (*body)(void *arg, int index);
+    void *arg;
+} ParallelStageContext;
+
+static SPECTRAL_THREAD_LOCAL const ParallelStageContext *parallel_caller = NULL;
+
+static void spectral_parallel_body(void *arg, int index)
+{
+    const ParallelStageContext *ctx = (const ParallelStageContext *)arg;
+    if (parallel_caller == ctx) {
+        // The caller's own CPU time is measured by its stage timer
+        ctx->body(ctx->arg, index);
+        return;
+    }
+    double cpu = spectral_thread_cpu_time();
+    ctx->body(ctx->arg, index);
+    SPECTRAL_ATOMIC_ADD(&ctx->job->stats.stageCpuUs[ctx->stage],
+                        (long long)((spectral_thread_cpu_time() - cpu) * 1e6));
+}
+
+/*---------------------------------------------------------------------
+ * spectral_parallel_for()
+ *
+ * Runs body(arg, i) for i in [0, count) through the job's parallel loop,
+ * or serially when the job has none.
+ *---------------------------------------------------------------------*/
+void spectral_parallel_for(SpectralJob *job, int count,
+                           void (*body)(void *arg, int index), void *arg)
+{
+    if (count <= 0) {
+        return;
+    }
+    if (job != NULL && job->parallelFor != NULL && count > 1) {
+        if (stage_current < 0) {
+            job->parallelFor(job->parallelUserData, count, body, arg);
+            return;
+        }
+        ParallelStageContext ctx = { job, stage_current, body, arg };
+        const ParallelStageContext *previous = parallel_caller;
+        parallel_caller = &ctx;
+        job->parallelFor(job->parallelUserData, count, spectral_parallel_body, &ctx);
+        parallel_caller = previous;
+        return;
+    }
+    for (int i = 0; i < count; i++) {
+        body(arg, i);
+    }
+}
+
+/*---------------------------------------------------------------------
+ * spectral_job_cancel()
+ *
+ * Requests the cancellation of a job. May be called from any thread.
+ *---------------------------------------------------------------------*/
+void spectral_job_cancel(SpectralJob *job)
+{
+    if (job == NULL) {
+        return;
+    }
+    SPECTRAL_ATOMIC_STORE_RELEASE(&job->cancelRequested, 1);
+}
+
+/*---------------------------------------------------------------------
+ * spectral_job_should_stop()
+ *
+ * Polled by the generators between blocks of work.
+ *
+ * Returns:
+ *  - 1 if the job was cancelled or its deadline has passed, 0 otherwise
+ *    (always 0 for a NULL job).
+ *---------------------------------------------------------------------*/
+int spectral_job_should_stop(const SpectralJob *job)
+{
+    if (job == NULL) {
+        return 0;
+    }
+    if (SPECTRAL_ATOMIC_LOAD_ACQUIRE(&job->cancelRequested)) {
+        return 1;
+    }
+    return job->deadline > 0.0 && spectral_job_now() >= job->deadline;
+}
 
 /*---------------------------------------------------------------------
  * spectral_generator()
@@ -31,14 +611,16 @@ extern int spectral_generator_vector_pdf_impl(const SpectrogramSettings *cfg,
  * If inputFile or outputFile is NULL or empty, default paths are used.
  *
  * Returns:
- *  - EXIT_SUCCESS on success, EXIT_FAILURE on error.
+ *  - EXIT_SUCCESS on success, EXIT_FAILURE on error,
+ *    SPECTRAL_CANCELLED if the job was cancelled.
  *---------------------------------------------------------------------*/
 int spectral_generator(const SpectrogramSettings *cfg,
                        const char *inputFile,
-                       const char *outputFile)
+                       const char *outputFile,
+                       SpectralJob *job)
 {
     // Redirects to the implementation in spectral_raster.c
-    return spectral_generator_impl(cfg, inputFile, outputFile);
+    return spectral_generator_impl(cfg, inputFile, outputFile, job);
 }
 
 /*---------------------------------------------------------------------
@@ -54,15 +636,18 @@ int spectral_generator(const SpectrogramSettings *cfg,
  *  - inputFile: Path to input WAV file
  *  - outputFile: Path to output PDF file
  *  - dpi: Requested DPI for the vector output (e.g. 800)
+ *  - job: Cancellation context (may be NULL)
  *
  * Returns:
- *  - EXIT_SUCCESS on success, EXIT_FAILURE on error.
+ *  - EXIT_SUCCESS on success, EXIT_FAILURE on error,
+ *    SPECTRAL_CANCELLED if the job was cancelled.
  *---------------------------------------------------------------------*/
 int spectral_generator_vector_pdf(const SpectrogramSettings *cfg,
                                   const char *inputFile,
                                   const char *outputFile,
-                                  int dpi)
+                                  int dpi,
+                                  SpectralJob *job)
 {
     // Redirects to the implementation in spectral_vector.c
-    return spectral_generator_vector_pdf_impl(cfg, inputFile, outputFile, dpi);
+    return spectral_generator_vector_pdf_impl(cfg, inputFile, outputFile, dpi, job);
 }
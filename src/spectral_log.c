@@ -0,0 +1,277 @@
+/*
+ * Copyright (C) 2025 - present Ondulab
+ * All rights reserved.
+ *
+ * This software is licensed under terms that can be found in the LICENSE file
+ * in the root directory of this software component.
+ */
+
+#define SPECTRAL_LOG_CATEGORY "log"
+#include "spectral_common.h"
+
+/* The queue needs the GCC/Clang atomics and pthreads; elsewhere the messages
+   are written synchronously, one call per message */
+#if !defined(_WIN32) && (defined(__GNUC__) || defined(__clang__))
+    #define LOG_ASYNC 1
+    #include <pthread.h>
+#else
+    #define LOG_ASYNC 0
+#endif
+
+#define LOG_QUEUE_MASK      (SPECTRAL_LOG_QUEUE_SIZE - 1)
+#define LOG_WRITER_WAIT_NS  50000000L   /* Longest sleep of the idle logging thread */
+#define LOG_FLUSH_POLLS     1000        /* spectral_log_flush() gives up after ~1 s */
+
+static int log_level = SPECTRAL_LOG_DEBUG;     // Read and written atomically
+
+/*---------------------------------------------------------------------
+ * log_deliver()
+ *
+ * Hands one formatted message to the job's callback (without its
+ * trailing newline), or writes it to stdout / stderr.
+ *---------------------------------------------------------------------*/
+static void log_deliver(SpectralLogCallback callback, void *userData, SpectralLogLevel level,
+                        const char *category, char *message)
+{
+    if (callback != NULL) {
+        size_t length = strlen(message);
+        if (length > 0 && message[length - 1] == '\n') {
+            message[length - 1] = '\0';
+        }
+        callback(userData, level, category, message);
+        return;
+    }
+
+    fputs(message, level >= SPECTRAL_LOG_WARNING ? stderr : stdout);
+}
+
+#if LOG_ASYNC
+
+/* One message of the queue. sequence follows Vyukov's bounded queue: it
+   equals the enqueue position when the slot is free and position + 1 once
+   the message is published. */
+typedef struct LogSlot {
+    volatile size_t     sequence;
+    SpectralLogLevel    level;
+    const char         *category;       // Static string
+    SpectralLogCallback callback;
+    void               *userData;
+    char                message[SPECTRAL_LOG_MAX_LENGTH];
+} LogSlot;
+
+static LogSlot log_queue[SPECTRAL_LOG_QUEUE_SIZE];
+static volatile size_t log_enqueue_pos = 0;     // Claimed by the producers
+static volatile size_t log_dequeue_pos = 0;     // Advanced by the logging thread only
+static volatile int log_dropped = 0;            // Messages lost to a full queue
+static int log_started = 0;                     // Logging thread running
+static pthread_once_t log_once = PTHREAD_ONCE_INIT;
+static pthread_mutex_t log_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t log_wakeup = PTHREAD_COND_INITIALIZER;
+
+/*---------------------------------------------------------------------
+ * log_drain()
+ *
+ * Delivers the published messages in order (logging thread).
+ *
+ * Returns:
+ *  - the number of messages delivered.
+ *---------------------------------------------------------------------*/
+static int log_drain(void)
+{
+    int delivered = 0;
+    for (;;) {
+        size_t pos = log_dequeue_pos;
+        LogSlot *slot = &log_queue[pos & LOG_QUEUE_MASK];
+        if (__atomic_load_n(&slot->sequence, __ATOMIC_ACQUIRE) != pos + 1) {
+            break;
+        }
+
+        log_deliver(slot->callback, slot->userData, slot->level, slot->category, slot->message);
+
+        // Hands the slot back to the producers one lap later
+        __atomic_store_n(&slot->sequence, pos + SPECTRAL_LOG_QUEUE_SIZE, __ATOMIC_RELEASE);
+        __atomic_store_n(&log_dequeue_pos, pos + 1, __ATOMIC_RELEASE);
+        delivered++;
+    }
+
+    int dropped = __atomic_exchange_n(&log_dropped, 0, __ATOMIC_ACQ_REL);
+    if (dropped > 0) {
+        fprintf(stderr, "Warning: %d log messages dropped (queue full)\n", dropped);
+    }
+    if (delivered > 0) {
+        fflush(stdout);
+    }
+    return delivered;
+}
+
+/*---------------------------------------------------------------------
+ * log_writer()
+ *
+ * Logging thread: the only thread that blocks on stdout, stderr or the
+ * callbacks. Producers do not lock; a missed wake-up only delays the
+ * messages until the next timed wake-up.
+ *---------------------------------------------------------------------*/
+static void *log_writer(void *arg)
+{
+    (void)arg;
+    for (;;) {
+        if (log_drain() > 0) {
+            continue;
+        }
+
+        struct timespec until;
+        clock_gettime(CLOCK_REALTIME, &until);
+        until.tv_nsec += LOG_WRITER_WAIT_NS;
+        if (until.tv_nsec >= 1000000000L) {
+            until.tv_sec++;
+            until.tv_nsec -= 1000000000L;
+        }
+        pthread_mutex_lock(&log_mutex);
+        pthread_cond_timedwait(&log_wakeup, &log_mutex, &until);
+        pthread_mutex_unlock(&log_mutex);
+    }
+    return NULL;
+}
+
+static void log_flush_at_exit(void)
+{
+    spectral_log_flush();
+}
+
+/*---------------------------------------------------------------------
+ * log_start()
+ *
+ * Prepares the queue and starts the logging thread (once). Without the
+ * thread the messages are written synchronously.
+ *---------------------------------------------------------------------*/
+static void log_start(void)
+{
+    for (size_t i = 0; i < SPECTRAL_LOG_QUEUE_SIZE; i++) {
+        log_queue[i].sequence = i;
+    }
+
+    pthread_t thread;
+    pthread_attr_t attr;
+    pthread_attr_init(&attr);
+    pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+    if (pthread_create(&thread, &attr, log_writer, NULL) == 0) {
+        __atomic_store_n(&log_started, 1, __ATOMIC_RELEASE);
+        atexit(log_flush_at_exit);
+    }
+    pthread_attr_destroy(&attr);
+}
+
+/*---------------------------------------------------------------------
+ * log_enqueue()
+ *
+ * Copies a message into a free slot and publishes it, without locking.
+ *
+ * Returns:
+ *  - 1 if the message was queued, 0 if the queue is full.
+ *---------------------------------------------------------------------*/
+static int log_enqueue(const SpectralJob *job, SpectralLogLevel level, const char *category,
+                       const char *message)
+{
+    size_t pos = __atomic_load_n(&log_enqueue_pos, __ATOMIC_RELAXED);
+    LogSlot *slot;
+    for (;;) {
+        slot = &log_queue[pos & LOG_QUEUE_MASK];
+        size_t sequence = __atomic_load_n(&slot->sequence, __ATOMIC_ACQUIRE);
+        long diff = (long)(sequence - pos);
+        if (diff == 0) {
+            if (__atomic_compare_exchange_n(&log_enqueue_pos, &pos, pos + 1, 1,
+                                            __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+                break;
+            }
+        } else if (diff < 0) {
+            return 0;
+        } else {
+            pos = __atomic_load_n(&log_enqueue_pos, __ATOMIC_RELAXED);
+        }
+    }
+
+    slot->level = level;
+    slot->category = category;
+    slot->callback = job != NULL ? job->log : NULL;
+    slot->userData = job != NULL ? job->logUserData : NULL;
+    strcpy(slot->message, message);
+    __atomic_store_n(&slot->sequence, pos + 1, __ATOMIC_RELEASE);
+    return 1;
+}
+
+#endif /* LOG_ASYNC */
+
+/*---------------------------------------------------------------------
+ * spectral_log_set_level()
+ *
+ * Sets the run-time threshold of the messages.
+ *---------------------------------------------------------------------*/
+void spectral_log_set_level(SpectralLogLevel level)
+{
+    SPECTRAL_ATOMIC_STORE(&log_level, (int)level);
+}
+
+/*---------------------------------------------------------------------
+ * spectral_log_message()
+ *
+ * Formats a message and queues it for the logging thread; called through
+ * the spectral_log() macro, which removes the calls below
+ * SPECTRAL_LOG_MIN_LEVEL. A full queue drops the message (errors are
+ * then written synchronously), so a generating thread never waits for
+ * the terminal or the disk.
+ *---------------------------------------------------------------------*/
+void spectral_log_message(SpectralJob *job, SpectralLogLevel level, const char *category,
+                          const char *format, ...)
+{
+    if ((int)level < SPECTRAL_ATOMIC_LOAD(&log_level)) {
+        return;
+    }
+
+    char message[SPECTRAL_LOG_MAX_LENGTH];
+    va_list args;
+
+    va_start(args, format);
+    vsnprintf(message, sizeof(message), format, args);
+    va_end(args);
+
+#if LOG_ASYNC
+    pthread_once(&log_once, log_start);
+    if (__atomic_load_n(&log_started, __ATOMIC_ACQUIRE)) {
+        if (log_enqueue(job, level, category, message)) {
+            pthread_cond_signal(&log_wakeup);
+            return;
+        }
+        if (level < SPECTRAL_LOG_ERROR) {
+            SPECTRAL_ATOMIC_INCREMENT(&log_dropped);
+            return;
+        }
+    }
+#endif
+
+    log_deliver(job != NULL ? job->log : NULL, job != NULL ? job->logUserData : NULL,
+                level, category, message);
+}
+
+/*---------------------------------------------------------------------
+ * spectral_log_flush()
+ *
+ * Waits until the messages queued before the call are delivered, then
+ * flushes stdout and stderr. Gives up after about a second (e.g. when
+ * called from a log callback).
+ *---------------------------------------------------------------------*/
+void spectral_log_flush(void)
+{
+#if LOG_ASYNC
+    if (__atomic_load_n(&log_started, __ATOMIC_ACQUIRE)) {
+        size_t target = __atomic_load_n(&log_enqueue_pos, __ATOMIC_ACQUIRE);
+        struct timespec pause = {0, 1000000L};
+        for (int i = 0; i < LOG_FLUSH_POLLS &&
+                        (long)(__atomic_load_n(&log_dequeue_pos, __ATOMIC_ACQUIRE) - target) < 0; i++) {
+            pthread_cond_signal(&log_wakeup);
+            nanosleep(&pause, NULL);
+        }
+    }
+#endif
+    fflush(stdout);
+    fflush(stderr);
+}
@@ -0,0 +1,319 @@
+/*
+ * Copyright (C) 2025 - present Ondulab
+ * All rights reserved.
+ *
+ * This software is licensed under terms that can be found in the LICENSE file
+ * in the root directory of this software component.
+ */
+
+#define SPECTRAL_LOG_CATEGORY "analyze"
+#include "spectral_common.h"
+#include "spectral_wav_processing.h"
+#include "spectral_cqt.h"
+#include "spectral_analyze.h"
+
+#define COST_MODEL_WEIGHT 0.3   /* Weight of the latest generation in the model */
+
+/* Seconds per work unit before any calibration, on the slow side so that a
+   new machine refuses too much rather than too little */
+static const double cost_model_defaults[SPECTRAL_STAGE_COUNT] = {
+    20e-9,      /* Decode: per sample */
+    10e-9,      /* Filter: per sample */
+    2e-9,       /* FFT: per N log2 N of the padded transform */
+    10e-9,      /* Tone map: per matrix cell */
+    10e-9,      /* Raster: per canvas pixel */
+    40e-9       /* Encode: per canvas pixel */
+};
+
+/*---------------------------------------------------------------------
+ * spectral_resolve_timing()
+ *
+ * Resolves the bins/s (from the writing speed when set), the overlap
+ * preset and the FFT window length, as the generation does.
+ *---------------------------------------------------------------------*/
+void spectral_resolve_timing(const SpectrogramSettings *cfg, SpectralTiming *timing)
+{
+    double writingSpeed = DEFAULT_DBL(cfg->writingSpeed, 0.0);
+    int    sample_rate  = DEFAULT_INT(cfg->sampleRate, DEFAULT_SAMPLE_RATE);
+
+    // Calcul du bins/s optimal basé sur la résolution d'impression
+    if (writingSpeed > 0.0) {
+        // Formula: bins_per_second = (800 dpi / 2.54 cm/inch) * writeSpeed, rounded down
+        // so that the physical resolution is never exceeded
+        double optimalBps = floor((PRINTER_DPI / INCH_TO_CM) * writingSpeed);
+        if (optimalBps < MIN_BINS_PER_SECOND) {
+            optimalBps = MIN_BINS_PER_SECOND;
+        } else if (optimalBps > MAX_BINS_PER_SECOND) {
+            optimalBps = MAX_BINS_PER_SECOND;
+        }
+        timing->binsPerSecond = optimalBps;
+    } else {
+        timing->binsPerSecond = DEFAULT_DBL(cfg->binsPerSecond, DEFAULT_BINS_PER_SECOND);
+    }
+
+    timing->overlapPreset = DEFAULT_INT(cfg->overlapPreset, DEFAULT_OVERLAP_PRESET);
+    switch (timing->overlapPreset) {
+        case 0:  timing->overlap = OVERLAP_PRESET_LOW; break;
+        case 2:  timing->overlap = OVERLAP_PRESET_HIGH; break;
+        default: timing->overlap = OVERLAP_PRESET_MEDIUM; break;
+    }
+
+    // Puissance de 2 supérieure à hop / (1 - overlap), sauf taille fournie par le curseur de résolution
+    if (cfg->fftSize > 0) {
+        timing->fftSize = cfg->fftSize;
+    } else {
+        double calculatedFftSize = (sample_rate / timing->binsPerSecond) / (1.0 - timing->overlap);
+        int fft_size = 1;
+        while (fft_size < calculatedFftSize) {
+            fft_size *= 2;
+        }
+        timing->fftSize = fft_size;
+    }
+}
+
+/*---------------------------------------------------------------------
+ * spectral_page_windows()
+ *
+ * Returns the number of windows drawn on one page of the PNG layout at
+ * the writing speed (at least 1), or 0 without a writing speed. The PDF
+ * layout has wider margins and draws fewer of them.
+ *---------------------------------------------------------------------*/
+int spectral_page_windows(const SpectrogramSettings *cfg, double binsPerSecond)
+{
+    double writingSpeed = DEFAULT_DBL(cfg->writingSpeed, 0.0);
+    if (writingSpeed <= 0.0 || binsPerSecond <= 0.0) {
+        return 0;
+    }
+
+    double page_width = (cfg->pageFormat == 1) ? A3_WIDTH : A4_WIDTH;
+    double window_width = (writingSpeed / binsPerSecond) / PIXELS_TO_CM;
+    int windows = (int)floor((page_width - LABEL_MARGIN) / window_width);
+    return windows > 0 ? windows : 1;
+}
+
+/*---------------------------------------------------------------------
+ * spectral_cost_model_init()
+ *
+ * Initializes a cost model with the default costs.
+ *---------------------------------------------------------------------*/
+void spectral_cost_model_init(SpectralCostModel *model)
+{
+    for (int i = 0; i < SPECTRAL_STAGE_COUNT; i++) {
+        model->secondsPerUnit[i] = cost_model_defaults[i];
+    }
+    model->observations = 0;
+}
+
+/*---------------------------------------------------------------------
+ * spectral_cost_model_update()
+ *
+ * Folds the measured stage times of a generation into the model. The
+ * first generation replaces the defaults; the next ones move the costs
+ * by COST_MODEL_WEIGHT towards the measure. Stages that did not run are
+ * left unchanged.
+ *---------------------------------------------------------------------*/
+void spectral_cost_model_update(SpectralCostModel *model, const SpectralPlan *plan,
+                                const SpectralJobStats *stats)
+{
+    int updated = 0;
+    for (int i = 0; i < SPECTRAL_STAGE_COUNT; i++) {
+        if (plan->stageWork[i] <= 0.0 || stats->stageWallUs[i] <= 0) {
+            continue;
+        }
+        double measured = stats->stageWallUs[i] / 1e6 / plan->stageWork[i];
+        if (model->observations == 0) {
+            model->secondsPerUnit[i] = measured;
+        } else {
+            model->secondsPerUnit[i] += (measured - model->secondsPerUnit[i]) * COST_MODEL_WEIGHT;
+        }
+        updated = 1;
+    }
+    if (updated) {
+        model->observations++;
+    }
+}
+
+/*---------------------------------------------------------------------
+ * spectral_plan()
+ *
+ * Plans a generation from its page layout: the windows that the page
+ * draws at the writing speed (every window of the requested duration
+ * when paginated or without a writing speed), the samples they read
+ * and the bins of [minFreq, maxFreq] (one per pixel row with the
+ * constant-Q engine). spectral_load_source() decodes exactly sampleCount
+ * samples and compute_spectrogram() keeps the bins up to binMax, so
+ * nothing is analyzed that the page does not show. The samples include
+ * the context that the long windows (multi-resolution low band,
+ * constant-Q) read past the last drawn window, so that it is analyzed
+ * as it would be in the whole recording.
+ * The time is estimated with a cost model. The peak memory is that of
+ * the generator's own buffers: the signal and the matrix during the
+ * analysis (with the constant-Q kernels), then the matrix and the page
+ * surfaces during the render (FFTW and cairo overheads are left out).
+ * A paginated analysis keeps the signal and holds one page of the matrix
+ * at a time, analyzed once for the global maximum and again when drawn.
+ *
+ * Returns:
+ *  - EXIT_SUCCESS on success, EXIT_FAILURE if the length of the recording
+ *    is unknown or shorter than one window.
+ *---------------------------------------------------------------------*/
+int spectral_plan(const SpectrogramSettings *cfg, double audioSeconds, int audioSampleRate,
+                  const SpectralCostModel *model, SpectralPlan *plan)
+{
+    memset(plan, 0, sizeof(*plan));
+
+    SpectralTiming timing;
+    spectral_resolve_timing(cfg, &timing);
+
+    int sample_rate = audioSampleRate > 0 ? audioSampleRate : DEFAULT_INT(cfg->sampleRate, DEFAULT_SAMPLE_RATE);
+    plan->binsPerSecond = timing.binsPerSecond;
+    plan->sampleRate = sample_rate;
+    plan->fftSize = timing.fftSize;
+    plan->paddedFftSize = fft_padded_size(timing.fftSize, 0);
+    plan->hopSize = (int)(sample_rate / timing.binsPerSecond);
+    if (plan->hopSize < 1) {
+        plan->hopSize = 1;
+    }
+    plan->windowsPerPage = spectral_page_windows(cfg, timing.binsPerSecond);
+    int single_page = plan->windowsPerPage > 0 && cfg->paginate != 1;
+
+    // Windows available in the requested duration, capped by the recording
+    double seconds = cfg->duration;
+    if (seconds <= 0.0 || (audioSeconds > 0.0 && audioSeconds < seconds)) {
+        seconds = audioSeconds;
+    }
+    if (seconds > 0.0) {
+        int available = (int)(seconds * sample_rate);
+        plan->windows = available >= plan->fftSize ? (available - plan->fftSize) / plan->hopSize + 1 : 0;
+    } else if (single_page) {
+        // Unknown length: assume the recording fills the page
+        plan->windows = plan->windowsPerPage;
+    }
+
+    // Only the first page is drawn unless the output is paginated
+    if (single_page && plan->windows > plan->windowsPerPage) {
+        plan->windows = plan->windowsPerPage;
+    }
+    if (plan->windows <= 0) {
+        return EXIT_FAILURE;
+    }
+
+    // The constant-Q engine keeps one bin per pixel row instead
+    double min_freq = DEFAULT_DBL(cfg->minFreq, DEFAULT_MIN_FREQ);
+    double max_freq = DEFAULT_DBL(cfg->maxFreq, DEFAULT_MAX_FREQ);
+    CqtLayout cqt;
+    int constant_q = cfg->analysisEngine == SPECTRAL_ENGINE_CONSTANT_Q &&
+                     cqt_layout(sample_rate, plan->fftSize, min_freq, max_freq, cqt_rows(cfg), &cqt) == 0;
+    if (constant_q) {
+        plan->paddedFftSize = cqt.transform_size;
+        plan->binMin = 0;
+        plan->binMax = cqt.bins - 1;
+        plan->contextSamples = cqt_context_samples(&cqt, plan->fftSize);
+    } else {
+        fft_bin_range(sample_rate, plan->paddedFftSize, min_freq, max_freq, &plan->binMin, &plan->binMax);
+        plan->contextSamples = fft_context_samples(sample_rate, plan->fftSize, 0, min_freq);
+    }
+    plan->sampleCount = (plan->windows - 1) * plan->hopSize + plan->fftSize + plan->contextSamples;
+    plan->bins = plan->binMax + 1;
+
+    // Page surface of the PNG render; a paginated render keeps the page being
+    // drawn and the page being encoded
+    double page_width = (cfg->pageFormat == 1) ? A3_WIDTH : A4_WIDTH;
+    double page_height = (cfg->pageFormat == 1) ? A3_HEIGHT : A4_HEIGHT;
+    plan->canvasWidth = (int)page_width;
+    plan->canvasHeight = (int)page_height;
+    plan->pages = 1;
+    if (cfg->paginate == 1 && plan->windowsPerPage > 0) {
+        plan->pages = (plan->windows + plan->windowsPerPage - 1) / plan->windowsPerPage;
+    }
+
+    long long canvas_pixels = (long long)plan->canvasWidth * plan->canvasHeight;
+    int paginated = cfg->paginate == 1 && plan->windowsPerPage > 0;
+    int matrix_windows = paginated && plan->windows > plan->windowsPerPage ? plan->windowsPerPage : plan->windows;
+    plan->signalBytes = (long long)plan->sampleCount * (long long)sizeof(double);
+    plan->matrixBytes = (long long)matrix_windows * plan->bins * (long long)sizeof(double);
+    plan->canvasBytes = canvas_pixels * 4 * (plan->pages > 1 ? 2 : 1);
+    plan->kernelBytes = constant_q ? cqt_kernel_bytes(&cqt, sample_rate, min_freq) : 0;
+    long long analysis_bytes = plan->signalBytes + plan->kernelBytes;
+    if (paginated) {
+        // The next page is analyzed while the previous one waits to be encoded
+        long long page_bytes = plan->kernelBytes + canvas_pixels * 4;
+        plan->peakBytes = plan->signalBytes + plan->matrixBytes +
+                          (page_bytes > plan->canvasBytes ? page_bytes : plan->canvasBytes);
+    } else {
+        plan->peakBytes = plan->matrixBytes +
+                          (analysis_bytes > plan->canvasBytes ? analysis_bytes : plan->canvasBytes);
+    }
+
+    plan->stageWork[SPECTRAL_STAGE_DECODE] = plan->sampleCount;
+    plan->stageWork[SPECTRAL_STAGE_FILTER] = plan->sampleCount;
+    plan->stageWork[SPECTRAL_STAGE_FFT] = (double)plan->windows *
+        (constant_q ? cqt_window_work(&cqt, sample_rate, min_freq)
+                    : fft_window_work(sample_rate, plan->fftSize, 0, min_freq, plan->hopSize));
+    if (!constant_q && plan->contextSamples > 0) {
+        // The low band also decimates the context (the work of a "hop" over it, without its transforms)
+        plan->stageWork[SPECTRAL_STAGE_FFT] += fft_window_work(sample_rate, plan->fftSize, 0, min_freq, plan->contextSamples) -
+                                               fft_window_work(sample_rate, plan->fftSize, 0, min_freq, 0);
+    }
+    if (paginated) {
+        // Global maximum first, then each page again
+        plan->stageWork[SPECTRAL_STAGE_FFT] *= 2.0;
+    }
+    plan->stageWork[SPECTRAL_STAGE_TONE_MAP] = (double)plan->windows * (plan->binMax - plan->binMin + 1);
+    plan->stageWork[SPECTRAL_STAGE_RASTER] = (double)canvas_pixels * plan->pages;
+    plan->stageWork[SPECTRAL_STAGE_ENCODE] = (double)canvas_pixels * plan->pages;
+
+    if (model != NULL) {
+        for (int i = 0; i < SPECTRAL_STAGE_COUNT; i++) {
+            plan->stageSeconds[i] = plan->stageWork[i] * model->secondsPerUnit[i];
+            plan->estimatedSeconds += plan->stageSeconds[i];
+        }
+    }
+    return EXIT_SUCCESS;
+}
+
+/*---------------------------------------------------------------------
+ * spectral_plan_file()
+ *
+ * Plans the generation of an audio file, whose sample rate and length are
+ * read from its header.
+ *
+ * Returns:
+ *  - EXIT_SUCCESS on success, EXIT_FAILURE if the file cannot be opened
+ *    or is shorter than one window.
+ *---------------------------------------------------------------------*/
+int spectral_plan_file(const SpectrogramSettings *cfg, const char *inputFile,
+                       const SpectralCostModel *model, SpectralPlan *plan)
+{
+    int sample_rate = 0;
+    double seconds = 0.0;
+    if (wav_file_info(DEFAULT_STR(inputFile, DEFAULT_INPUT_FILENAME), &sample_rate, &seconds) != 0) {
+        memset(plan, 0, sizeof(*plan));
+        return EXIT_FAILURE;
+    }
+    return spectral_plan(cfg, seconds, sample_rate, model, plan);
+}
+
+int spectral_plan_within_budget(const SpectralPlan *plan, long long memoryBudget, double timeBudget)
+{
+    return (memoryBudget <= 0 || plan->peakBytes <= memoryBudget) &&
+           (timeBudget <= 0.0 || plan->estimatedSeconds <= timeBudget);
+}
+
+/*---------------------------------------------------------------------
+ * spectral_job_set_budget()
+ *
+ * Sets the budgets checked by spectral_load_source() before decoding,
+ * with a copy of the cost model (NULL = defaults).
+ *---------------------------------------------------------------------*/
+void spectral_job_set_budget(SpectralJob *job, long long memoryBudget, double timeBudget,
+                             const SpectralCostModel *model)
+{
+    job->memoryBudget = memoryBudget > 0 ? memoryBudget : 0;
+    job->timeBudget = timeBudget > 0.0 ? timeBudget : 0.0;
+    if (model != NULL) {
+        job->costModel = *model;
+    } else {
+        spectral_cost_model_init(&job->costModel);
+    }
+}
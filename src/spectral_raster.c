@@ -1,6 +1,8 @@
+#define SPECTRAL_LOG_CATEGORY "raster"
 #include "spectral_common.h"
 #include "spectral_wav_processing.h"
 #include "spectral_fft.h"
+#include "spectral_analyze.h"
 
 /*---------------------------------------------------------------------
  * draw_vertical_scale()
@@ -182,10 +184,12 @@ void draw_reference_lines(cairo_t *cr, double spectro_left, double spectro_width
  *  - audioFile: Path to audio file
  *  - startTime: Start time in seconds
  *  - segmentDuration: Duration of the segment in seconds
+ *  - stats: Counters of the finished job, shown on a third line (may be NULL)
  *---------------------------------------------------------------------*/
 void draw_parameters_text(cairo_t *cr, double page_width __attribute__((unused)), double page_height,
                           const SpectrogramSettings *s, const char *audioFile, 
-                          double startTime, double segmentDuration __attribute__((unused)))
+                          double startTime, double segmentDuration __attribute__((unused)),
+                          const SpectralJobStats *stats)
 {
     // Extract filename from path (if provided)
     const char *filename = audioFile;
@@ -213,11 +217,13 @@ void draw_parameters_text(cairo_t *cr, double page_width __attribute__((unused))
     // Text origin and margin
     double margin = 50.0;
     double text_x = margin;
-    double text_y = page_height - (line_height * 2.5);  // Space for 2 lines + padding
+    int line_count = stats != NULL ? 3 : 2;
+    double text_y = page_height - (line_height * (line_count + 0.5));  // Space for the lines + padding
     
-    // Prepare the text for the two lines
+    // Prepare the text for the lines
     char line1[1024];
     char line2[1024];
+    char line3[1024] = "";
     
     // Line 1: file info, start time, duration, bins/s, and overlap preset
     const char* overlapText;
@@ -252,16 +258,22 @@ void draw_parameters_text(cairo_t *cr, double page_width __attribute__((unused))
              s->dynamicRangeDB, s->gammaCorrection, s->contrastFactor,
              s->enableHighBoost ? "On" : "Off", s->highBoostAlpha, s->writingSpeed);
     
+    // Line 3: performance counters of the job
+    if (stats != NULL) {
+        spectral_job_stats_format(stats, line3, sizeof(line3));
+    }
+    
     // Calculate text dimensions for background
-    cairo_text_extents_t extents1, extents2;
+    cairo_text_extents_t extents1, extents2, extents3;
     cairo_set_font_size(cr, fontSize);
     cairo_text_extents(cr, line1, &extents1);
     cairo_text_extents(cr, line2, &extents2);
+    cairo_text_extents(cr, line3, &extents3);
     
     // Calculate background dimensions
-    double max_width = fmax(extents1.width, extents2.width);
+    double max_width = fmax(fmax(extents1.width, extents2.width), extents3.width);
     double bg_width = max_width + margin * 2;
-    double bg_height = line_height * 2 + margin;
+    double bg_height = line_height * line_count + margin;
     double bg_x = margin;  // Aligned to left margin
     double bg_y = text_y - line_height - margin/2;
     
@@ -274,7 +286,7 @@ void draw_parameters_text(cairo_t *cr, double page_width __attribute__((unused))
     text_x = bg_x + margin;
     text_y = bg_y + line_height;
     
-    // Draw the two lines of text
+    // Draw the lines of text
     cairo_set_source_rgb(cr, 0.0, 0.0, 0.0);  // Black text
     
     // First line
@@ -285,273 +297,63 @@ void draw_parameters_text(cairo_t *cr, double page_width __attribute__((unused))
     text_y += line_height;
     cairo_move_to(cr, text_x, text_y);
     cairo_show_text(cr, line2);
+    
+    // Third line
+    if (stats != NULL) {
+        text_y += line_height;
+        cairo_move_to(cr, text_x, text_y);
+        cairo_show_text(cr, line3);
+    }
 }
 
+// Page geometry in pixels at PRINTER_DPI, shared by both renders
+typedef struct RasterLayout {
+    double  page_width;
+    double  page_height;
+    double  spectro_left;
+    double  spectro_width;
+    double  spectro_top;
+    double  spectro_bottom;
+    double  spectro_height_px;
+    double  octaves;            // Octaves of the log frequency scale
+    int     visible_windows;    // Windows that fit on the page
+    double  window_width;       // Width of one window
+} RasterLayout;
+
 /*---------------------------------------------------------------------
- * spectral_generator_impl()
+ * raster_layout()
  *
- * Generates a spectrogram PNG image.
- * Uses exact parameters specified by the user without automatic adjustments.
- * Optimized for 800 DPI output with correct logarithmic frequency scaling.
- *
- * Returns:
- *  - EXIT_SUCCESS on success, EXIT_FAILURE on error.
+ * Computes the page geometry and the number of visible windows.
  *---------------------------------------------------------------------*/
-int spectral_generator_impl(const SpectrogramSettings *cfg,
-                           const char *inputFile,
-                           const char *outputFile)
+static void raster_layout(const SpectralSource *src, int num_windows,
+                          RasterLayout *layout, SpectralJob *job)
 {
-    /* Copy configuration and fallback to defaults if necessary */
-    SpectrogramSettings s = *cfg;
-    double  minFreq         = DEFAULT_DBL(s.minFreq,        DEFAULT_MIN_FREQ);
-    double  maxFreq         = DEFAULT_DBL(s.maxFreq,        DEFAULT_MAX_FREQ);
-    double  writingSpeed    = DEFAULT_DBL(s.writingSpeed,   0.0);
-    double  duration        = DEFAULT_DBL(s.duration,       DEFAULT_DURATION);
-    int     sample_rate     = DEFAULT_INT(s.sampleRate,     DEFAULT_SAMPLE_RATE);
-    double  dynamicRangeDB  = DEFAULT_DBL(s.dynamicRangeDB, DYNAMIC_RANGE_DB);
-    double  gammaCorr       = DEFAULT_DBL(s.gammaCorrection, GAMMA_CORRECTION);
-    int     enableDither    = DEFAULT_BOOL(s.enableDithering, ENABLE_DITHERING);
-    double  contrastFactor  = DEFAULT_DBL(s.contrastFactor, CONTRAST_FACTOR);
-    int     enableHighBoost = DEFAULT_BOOL(s.enableHighBoost, ENABLE_HIGH_BOOST);
-    double  highBoostAlpha  = DEFAULT_DBL(s.highBoostAlpha, HIGH_BOOST_ALPHA);
-    double  binsPerSecond;
-    
-    // Calcul du bins/s optimal basé sur la résolution d'impression
-    if (writingSpeed > 0.0) {
-        // Formula: bins_per_second = (800 dpi / 2.54 cm/inch) * writeSpeed
-        double optimalBps = (PRINTER_DPI / INCH_TO_CM) * writingSpeed;
-        
-        // Arrondir à l'entier inférieur pour s'assurer qu'on ne dépasse jamais la résolution physique
-        optimalBps = floor(optimalBps);
-        
-        // Appliquer les limites (clamp)
-        if (optimalBps < MIN_BINS_PER_SECOND) {
-            optimalBps = MIN_BINS_PER_SECOND;
-        } else if (optimalBps > MAX_BINS_PER_SECOND) {
-            optimalBps = MAX_BINS_PER_SECOND;
-        }
-        
-        // Utiliser la valeur calculée
-        binsPerSecond = optimalBps;
-        printf(" - Calculated optimal bins/s: %.1f based on writing speed: %.2f cm/s\n", binsPerSecond, writingSpeed);
-    } else {
-        // Si pas de vitesse d'écriture spécifiée, utiliser la valeur de la structure ou la valeur par défaut
-        binsPerSecond = DEFAULT_DBL(s.binsPerSecond, DEFAULT_BINS_PER_SECOND);
-        printf(" - Using provided bins/s: %.1f (no writing speed specified)\n", binsPerSecond);
-    }
-    
-    int overlapPreset = DEFAULT_INT(s.overlapPreset, DEFAULT_OVERLAP_PRESET);  // Préréglage d'overlap (Medium par défaut)
-    
-    // Détermination de la valeur d'overlap en fonction du préréglage
-    double overlapValue;
-    switch(overlapPreset) {
-        case 0: // Low
-            overlapValue = OVERLAP_PRESET_LOW;
-            printf(" - Using low overlap preset (%.2f)\n", overlapValue);
-            break;
-        case 2: // High
-            overlapValue = OVERLAP_PRESET_HIGH;
-            printf(" - Using high overlap preset (%.2f)\n", overlapValue);
-            break;
-        default: // Medium (default)
-            overlapValue = OVERLAP_PRESET_MEDIUM;
-            printf(" - Using medium overlap preset (%.2f)\n", overlapValue);
-            break;
-    }
-    
-    // Calcul de la taille FFT en fonction du bins/s et du préréglage d'overlap
-    double hopSize = sample_rate / binsPerSecond;
-    double diviseur = 1.0 - overlapValue;
-    double calculatedFftSize = hopSize / diviseur;
-    
-    // Arrondir à la puissance de 2 supérieure
-    int fft_size = 1;
-    while (fft_size < calculatedFftSize) {
-        fft_size *= 2;
-    }
-    
-    // Stockage de la taille FFT pour l'affichage dans les journaux
-    // (Note: s.fftSize a été supprimé de la structure)
-    
-    // Vérification: si un fft_size est calculé à partir du modèle de résolution adaptative,
-    // nous utilisons cette valeur directement plutôt que de recalculer
-    // Note: Cette logique préserve la valeur calculée par SpectrogramParametersModel
-    if (cfg->fftSize > 0) {
-        // Si fftSize est spécifié, nous utilisons directement cette valeur
-        fft_size = cfg->fftSize;
-        printf(" - Using precalculated FFT size: %d (from resolution slider)\n", fft_size);
-    } else {
-        // Sinon, nous utilisons la méthode de calcul traditionnelle
-        printf(" - Calculated FFT size: %d (from bins/s=%.1f, overlap=%.2f)\n",
-               fft_size, binsPerSecond, overlapValue);
-    }
-    
-    /* Use default paths if input/output files are not specified */
-    const char* inputFilePath = DEFAULT_STR(inputFile, DEFAULT_INPUT_FILENAME);
-    const char* outputFilePath = DEFAULT_STR(outputFile, DEFAULT_OUTPUT_FILENAME);
-
-    // Si une vitesse d'écriture est spécifiée, calculer la durée en fonction de la vitesse
-    // Mais on ne modifie pas la durée si l'utilisateur a explicitement fourni une valeur
-    double original_duration = duration;
-    
-    if (writingSpeed > 0.0 && s.duration <= 0.0) {
-        // Sélection du format de page pour calculer la largeur
-        double pageWidth = (s.pageFormat == 1) ? A3_WIDTH : A4_WIDTH;
-        
-        // Convertir la largeur de pixels à cm - en utilisant la valeur exacte
-        double pageWidthCM = pageWidth / (PRINTER_DPI / 2.54); // 800 pixels par pouce, 2.54 cm par pouce
-        
-        // Calculer la durée: durée (s) = largeur (cm) / vitesse (cm/s)
-        duration = pageWidthCM / writingSpeed;
-        
-        // Mettre à jour la durée dans la structure s
-        s.duration = duration;
-        
-        printf("Writing speed: %.2f cm/s, page width: %.2f cm\n", writingSpeed, pageWidthCM);
-        printf("Calculated duration based on writing speed: %.2f seconds\n", duration);
-    }
-
-    printf("Spectrogram generation parameters:\n");
-    printf(" - FFT size: %d\n", fft_size);
-    printf(" - Overlap preset: %d (%s - %.2f)\n", overlapPreset,
-           overlapPreset == 0 ? "Low" :
-           overlapPreset == 2 ? "High" : "Medium",
-           overlapValue);
-    printf(" - Bins per second: %.1f\n", binsPerSecond);
-    printf(" - Min frequency: %f\n", minFreq);
-    printf(" - Max frequency: %f\n", maxFreq);
-    printf(" - Writing speed: %f cm/s\n", writingSpeed);
-    printf(" - Duration: %f\n", duration);
-    printf(" - Sample rate: %d\n", sample_rate);
-    printf(" - Dynamic range (dB): %f\n", dynamicRangeDB);
-    printf(" - Gamma correction: %f\n", gammaCorr);
-    printf(" - Dithering: %d\n", enableDither);
-    printf(" - Contrast factor: %f\n", contrastFactor);
-    printf(" - High boost: %d (alpha = %f)\n", enableHighBoost, highBoostAlpha);
-    printf(" - Input file: %s\n", inputFilePath);
-    printf(" - Output file: %s\n", outputFilePath);
-    printf(" - Log frequency scale: %s\n", USE_LOG_FREQUENCY ? "enabled" : "disabled");
-
-    /* ------------------------------ */
-    /* 1. Load audio signal from WAV  */
-    /* ------------------------------ */
-    int total_samples = 0;
-    double *signal = NULL;
-    
-    // Récupérer le paramètre de normalisation
-    int enableNormalization = DEFAULT_BOOL(s.enableNormalization, 1);
-    
-    printf(" - Loading WAV file with duration: %.2f seconds\n", s.duration);
-    printf(" - Normalization: %s\n", enableNormalization ? "enabled" : "disabled");
-    
-    if (load_wav_file(inputFilePath, &signal, &total_samples, &sample_rate, s.duration, enableNormalization) != 0) {
-        fprintf(stderr, "Error: Unable to load WAV file.\n");
-        return EXIT_FAILURE;
-    }
-
-    /* Apply high-pass filter if enabled */
-    int enableHighPass = DEFAULT_BOOL(s.enableHighPassFilter, 0);
-    
-    // DÉBOGAGE CRITIQUE - Afficher la structure entière des paramètres pour le filtre
-    printf(" === DÉTAIL COMPLET DES PARAMÈTRES DU FILTRE PASSE-HAUT ===\n");
-    printf(" - Filtre activé: %s\n", enableHighPass ? "OUI" : "NON");
-    printf(" - Valeur brute de s.highPassCutoffFreq = %.2f Hz\n", s.highPassCutoffFreq);
-    printf(" - Ordre du filtre: %d\n", s.highPassFilterOrder);
-    
-    // Utiliser DIRECTEMENT la valeur brute sans DEFAULT_DBL
-    double highPassCutoff = s.highPassCutoffFreq;
-    int highPassOrder = s.highPassFilterOrder;
-    
-    printf(" - Valeur finale utilisée pour highPassCutoff = %.2f Hz\n", highPassCutoff);
-    
-    if (enableHighPass && highPassCutoff > 0.0) {
-        printf(" - High-pass filter: enabled (cutoff = %.2f Hz, order = %d)\n",
-               highPassCutoff, highPassOrder);
-        
-        // Limit order to valid range (1-12)
-        if (highPassOrder < 1) highPassOrder = 1;
-        if (highPassOrder > 12) highPassOrder = 12;
-        
-        // Allocate coefficient arrays
-        double a[13] = {0}; // Max order 12 + 1
-        double b[13] = {0};
-        
-        // Design the filter
-        design_highpass_filter(highPassCutoff, highPassOrder, sample_rate, a, b);
-        
-        // Apply the filter
-        apply_highpass_filter(signal, total_samples, a, b, highPassOrder);
-    } else {
-        printf(" - High-pass filter: disabled\n");
-    }
-    
-    /* Apply high frequency boost if enabled */
-    if (enableHighBoost) {
-        apply_high_freq_boost_filter(signal, total_samples, highBoostAlpha);
-    }
-
-    /* ------------------------------ */
-    /* 2. Compute the Spectrogram     */
-    /* ------------------------------ */
-    // Create spectrogram data structure
-    SpectrogramData spectro_data = {0};
-    
-    // Compute spectrogram with bins per second and overlap preset
-    if (compute_spectrogram(signal, total_samples, sample_rate, fft_size, overlapPreset, binsPerSecond,
-                          minFreq, maxFreq, &spectro_data) != 0) {
-        fprintf(stderr, "Error: Failed to compute spectrogram.\n");
-        free(signal);
-        return EXIT_FAILURE;
-    }
+    const SpectrogramSettings s = src->s;
+    double minFreq = src->minFreq;
+    double maxFreq = src->maxFreq;
+    double writingSpeed = src->writingSpeed;
+    double binsPerSecond = src->binsPerSecond;
     
-    // Free the signal as we've extracted the spectrogram data
-    free(signal);
-    signal = NULL;
-    
-    // Apply image processing
-    apply_image_processing(&spectro_data, dynamicRangeDB, gammaCorr, enableDither, contrastFactor);
-    
-    /* ------------------------------ */
-    /* 3. Generate the PNG Spectrogram*/
-    /* ------------------------------ */
     // Determine page dimensions based on format for 800 DPI
     double page_width, page_height;
     if (s.pageFormat == 1) { // A3 landscape
         page_width = A3_WIDTH;
         page_height = A3_HEIGHT;
-        printf(" - Page format: A3 landscape (%.2f x %.2f mm)\n", A3_WIDTH_MM, A3_HEIGHT_MM);
+        spectral_log(job, SPECTRAL_LOG_INFO, " - Page format: A3 landscape (%.2f x %.2f mm)\n", A3_WIDTH_MM, A3_HEIGHT_MM);
     } else { // A4 portrait (default)
         page_width = A4_WIDTH;
         page_height = A4_HEIGHT;
-        printf(" - Page format: A4 portrait (%.2f x %.2f mm)\n", A4_WIDTH_MM, A4_HEIGHT_MM);
+        spectral_log(job, SPECTRAL_LOG_INFO, " - Page format: A4 portrait (%.2f x %.2f mm)\n", A4_WIDTH_MM, A4_HEIGHT_MM);
     }
     
     // Réduit la taille de la marge pour le texte (étiquettes de fréquence)
-    double label_margin = 150.0; // Espace pour les étiquettes
+    double label_margin = LABEL_MARGIN; // Espace pour les étiquettes
     double bottom_margin_px = DEFAULT_DBL(s.bottomMarginMM * MM_TO_PIXELS, DEFAULT_BOTTOM_MARGIN);
     double spectro_height_px = DEFAULT_DBL(s.spectroHeightMM * MM_TO_PIXELS, DEFAULT_SPECTRO_HEIGHT);
     
-    printf(" - Label margin: %.2f pixels at %.0f DPI\n", label_margin, PRINTER_DPI);
-    printf(" - Bottom margin: %.2f mm (%.2f pixels at %.0f DPI)\n", s.bottomMarginMM, bottom_margin_px, PRINTER_DPI);
-    printf(" - Spectrogram height: %.2f mm (%.2f pixels at %.0f DPI)\n", s.spectroHeightMM, spectro_height_px, PRINTER_DPI);
-    
-    // Create surface and context for 800 DPI
-    int image_width = (int)(page_width);
-    int image_height = (int)(page_height);
-    
-    printf(" - Creating canvas: %d x %d pixels at %.0f DPI\n", image_width, image_height, PRINTER_DPI);
-    
-    cairo_surface_t *surface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, image_width, image_height);
-    cairo_t *cr = cairo_create(surface);
-    if (cr == NULL) {
-        fprintf(stderr, "Error: Unable to create Cairo context.\n");
-        free(spectro_data.data);
-        return EXIT_FAILURE;
-    }
-    
-    // Fill background with white
-    cairo_set_source_rgb(cr, 1.0, 1.0, 1.0);
-    cairo_paint(cr);
+    spectral_log(job, SPECTRAL_LOG_INFO, " - Label margin: %.2f pixels at %.0f DPI\n", label_margin, PRINTER_DPI);
+    spectral_log(job, SPECTRAL_LOG_INFO, " - Bottom margin: %.2f mm (%.2f pixels at %.0f DPI)\n", s.bottomMarginMM, bottom_margin_px, PRINTER_DPI);
+    spectral_log(job, SPECTRAL_LOG_INFO, " - Spectrogram height: %.2f mm (%.2f pixels at %.0f DPI)\n", s.spectroHeightMM, spectro_height_px, PRINTER_DPI);
     
     // Calculate spectrogram layout - optimisé pour utiliser toute la largeur
     // Spectrogramme commence après la marge pour les étiquettes et s'étend jusqu'au bord droit
@@ -562,85 +364,25 @@ int spectral_generator_impl(const SpectrogramSettings *cfg,
     double spectro_bottom = page_height - bottom_margin_px;
     double spectro_top = spectro_bottom - spectro_height_px;
     
-    printf(" - Spectrogram position: left=%.1f, top=%.1f, width=%.1f, height=%.1f\n",
+    spectral_log(job, SPECTRAL_LOG_INFO, " - Spectrogram position: left=%.1f, top=%.1f, width=%.1f, height=%.1f\n",
            spectro_left, spectro_top, spectro_width, spectro_height_px);
     
     // Paramètres pour l'échelle logarithmique (si activée)
     double octaves = 0.0;
     if (USE_LOG_FREQUENCY) {
         octaves = log2(maxFreq / minFreq);
-        printf(" - Octaves: %.2f (from %.1f Hz to %.1f Hz)\n", octaves, minFreq, maxFreq);
+        spectral_log(job, SPECTRAL_LOG_INFO, " - Octaves: %.2f (from %.1f Hz to %.1f Hz)\n", octaves, minFreq, maxFreq);
     }
     
-    // Get spectrogram dimensions
-    int num_windows = spectro_data.num_windows;
-    int num_bins = spectro_data.num_bins;
-    int index_min = spectro_data.index_min;
-    int index_max = spectro_data.index_max;
-    double *spectrogram = spectro_data.data;
-    double freq_range = maxFreq - minFreq;
-    
-    // Calculate frequency resolution in the FFT
-    int fft_effective_size = (USE_ZERO_PADDING) ? ZERO_PAD_SIZE : fft_size;
-    double freq_resolution = sample_rate / (double)fft_effective_size;
-    
-    printf(" - Frequency resolution: %.2f Hz per bin\n", freq_resolution);
-    printf(" - Frequency bins range: %d to %d\n", index_min, index_max);
-    
-    // Calculate visible windows based on writing speed and desired pixel scale
+    // Visible windows: those of the first page at the writing speed. The
+    // analysis was planned from the same layout (spectral_page_windows()),
+    // so it holds no window beyond the page unless it is paginated.
     int visible_windows = num_windows;
-    
-    // Si une vitesse d'écriture est spécifiée, calculer correctement le nombre de fenêtres visibles
-    if (writingSpeed > 0.0) {
-        // Calculer d'abord la durée réelle du signal audio
-        double real_audio_duration = (double)total_samples / (double)sample_rate;
-        
-        // Calculer la durée des données FFT traitées
-        double fft_duration;
-        if (original_duration > 0.0) {
-            // Si l'utilisateur a spécifié une durée, utiliser cette valeur
-            fft_duration = original_duration;
-        } else {
-            // Sinon utiliser la durée du signal
-            fft_duration = real_audio_duration;
-        }
-        
-        // Convertir la page en cm
-        /* La variable page_width_cm n'est pas utilisée dans cette fonction */
-        double spectro_width_cm = spectro_width / (PRINTER_DPI / 2.54);
-        
-        // Calculer la largeur du spectrogramme en cm pour la durée spécifiée
-        double required_width_cm = fft_duration * writingSpeed;
-        
-        printf(" - Real audio duration: %.2f seconds\n", real_audio_duration);
-        printf(" - Processed FFT duration: %.2f seconds\n", fft_duration);
-        printf(" - Required width: %.2f cm (available: %.2f cm)\n", 
-               required_width_cm, spectro_width_cm);
-        
-        // Si le spectrogramme est plus large que la page, ajuster le nombre de fenêtres
-        if (required_width_cm > spectro_width_cm) {
-            // Calculer le ratio d'échelle
-            double scale_ratio = spectro_width_cm / required_width_cm;
-            visible_windows = (int)(num_windows * scale_ratio);
-            
-            // S'assurer qu'on a au moins une fenêtre
-            if (visible_windows < 1) visible_windows = 1;
-            
-            double visible_duration = (double)visible_windows * fft_duration / (double)num_windows;
-            
-            printf(" - Spectrogram exceeds available width, scaling down\n");
-            printf(" - Showing %.2f seconds out of %.2f (%.1f%%)\n",
-                  visible_duration, fft_duration, 
-                  visible_duration * 100.0 / fft_duration);
-        } else {
-            // Si le spectrogramme est plus petit, il faut l'élargir pour maintenir l'échelle
-            double pixel_cm_ratio = writingSpeed * fft_duration / spectro_width;
-            printf(" - Spectrogram smaller than available width, maintaining scale\n");
-            printf(" - Using %.2f%% of available width\n", 
-                   pixel_cm_ratio * 100.0);
-            
-            // Dans ce cas, visible_windows reste égal à num_windows
-        }
+    int page_windows = spectral_page_windows(&s, binsPerSecond);
+    if (page_windows > 0 && visible_windows > page_windows) {
+        visible_windows = page_windows;
+        spectral_log(job, SPECTRAL_LOG_INFO, " - Showing %d of %d windows (%.2f seconds per page)\n",
+                     visible_windows, num_windows, visible_windows / binsPerSecond);
     }
     
     // Calculate pixel dimensions - directement en 800 DPI
@@ -653,27 +395,107 @@ int spectral_generator_impl(const SpectrogramSettings *cfg,
     double pixels_per_window = cm_per_window / PIXELS_TO_CM;
     double window_width = pixels_per_window;
     
-    printf(" - Window width: %.3f pixels at %.0f DPI\n", window_width, PRINTER_DPI);
-    printf(" - Adaptive spacing: %.3f pixels per bin (%.3f cm per bin)\n", 
+    spectral_log(job, SPECTRAL_LOG_INFO, " - Window width: %.3f pixels at %.0f DPI\n", window_width, PRINTER_DPI);
+    spectral_log(job, SPECTRAL_LOG_INFO, " - Adaptive spacing: %.3f pixels per bin (%.3f cm per bin)\n", 
            window_width, cm_per_window);
     
-    // Pré-calcul des fréquences réelles pour chaque bin FFT
-    double *bin_frequencies = (double *)malloc(num_bins * sizeof(double));
-    if (bin_frequencies == NULL) {
-        fprintf(stderr, "Error: Unable to allocate memory for frequency bins.\n");
-        cairo_destroy(cr);
-        cairo_surface_destroy(surface);
-        free(spectro_data.data);
+    layout->page_width = page_width;
+    layout->page_height = page_height;
+    layout->spectro_left = spectro_left;
+    layout->spectro_width = spectro_width;
+    layout->spectro_top = spectro_top;
+    layout->spectro_bottom = spectro_bottom;
+    layout->spectro_height_px = spectro_height_px;
+    layout->octaves = octaves;
+    layout->visible_windows = visible_windows;
+    layout->window_width = window_width;
+}
+
+// Size of the pixels of an image surface (trace events)
+static long long raster_surface_bytes(cairo_surface_t *surface)
+{
+    return (long long)cairo_image_surface_get_stride(surface) * cairo_image_surface_get_height(surface);
+}
+
+/*---------------------------------------------------------------------
+ * raster_draw_page()
+ *
+ * Draws the windows [first_window, first_window + num_windows) of an
+ * analyzed source on a new page surface at print resolution, with the
+ * scale, reference lines and parameters text. The windows are those of
+ * the recording: spectro may hold a page of it only (its first_window).
+ * The spectrogram is only read, so several pages or renders may share
+ * it. The job is polled every band of rendered columns; the RASTER
+ * progress goes from
+ * progress_base to progress_base + progress_span.
+ *
+ * Returns:
+ *  - EXIT_SUCCESS on success (*surface_out is set), EXIT_FAILURE on
+ *    error, SPECTRAL_CANCELLED if the job was cancelled.
+ *---------------------------------------------------------------------*/
+static int raster_draw_page(const SpectralSource *src, const SpectrogramData *spectro,
+                            const RasterLayout *layout, const double *bin_frequencies,
+                            int first_window, int num_windows,
+                            double progress_base, double progress_span,
+                            cairo_surface_t **surface_out, SpectralJob *job)
+{
+    double trace = spectral_trace_begin();
+    SpectrogramSettings s = src->s;
+    double minFreq = src->minFreq;
+    double maxFreq = src->maxFreq;
+    const SpectrogramData spectro_data = *spectro;
+    
+    double page_width = layout->page_width;
+    double page_height = layout->page_height;
+    double spectro_left = layout->spectro_left;
+    double spectro_width = layout->spectro_width;
+    double spectro_top = layout->spectro_top;
+    double spectro_bottom = layout->spectro_bottom;
+    double spectro_height_px = layout->spectro_height_px;
+    double octaves = layout->octaves;
+    double window_width = layout->window_width;
+    
+    *surface_out = NULL;
+    
+    // Create surface and context for 800 DPI
+    int image_width = (int)(page_width);
+    int image_height = (int)(page_height);
+    
+    spectral_log(job, SPECTRAL_LOG_INFO, " - Creating canvas: %d x %d pixels at %.0f DPI\n", image_width, image_height, PRINTER_DPI);
+    
+    cairo_surface_t *surface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, image_width, image_height);
+    cairo_t *cr = cairo_create(surface);
+    if (cr == NULL) {
+        spectral_log(job, SPECTRAL_LOG_ERROR, "Error: Unable to create Cairo context.\n");
         return EXIT_FAILURE;
     }
     
-    // Calculer les fréquences exactes correspondant à chaque bin
-    for (int b = 0; b < num_bins; b++) {
-        bin_frequencies[b] = b * freq_resolution;
-    }
+    // Fill background with white
+    cairo_set_source_rgb(cr, 1.0, 1.0, 1.0);
+    cairo_paint(cr);
+    
+    // Get spectrogram dimensions
+    int num_bins = spectro_data.num_bins;
+    int index_min = spectro_data.index_min;
+    int index_max = spectro_data.index_max;
+    double *spectrogram = spectro_data.data + (size_t)(first_window - spectro_data.first_window) * num_bins;
+    double freq_range = maxFreq - minFreq;
     
     // Dessiner le spectrogramme
-    for (int w = 0; w < visible_windows; w++) {
+    for (int w = 0; w < num_windows; w++) {
+        // Vérifier l'annulation et signaler la progression à chaque bande de colonnes
+        if (w % SPECTRAL_JOB_POLL_INTERVAL == 0) {
+            if (spectral_job_should_stop(job)) {
+                spectral_log(job, SPECTRAL_LOG_INFO, " - Rendering cancelled at column %d/%d\n",
+                             first_window + w, first_window + num_windows);
+                cairo_destroy(cr);
+                cairo_surface_destroy(surface);
+                return SPECTRAL_CANCELLED;
+            }
+            spectral_job_report(job, SPECTRAL_STAGE_RASTER,
+                                progress_base + progress_span * w / num_windows);
+        }
+        
         double x = spectro_left + w * window_width;
         
         for (int b = index_min; b <= index_max; b++) {
@@ -705,7 +527,7 @@ int spectral_generator_impl(const SpectrogramSettings *cfg,
             }
             
             // Calculer la hauteur réelle du pixel (distance à la position Y suivante)
-            double next_bin_freq = (b < num_bins - 1) ? bin_frequencies[b + 1] : bin_freq + freq_resolution;
+            double next_bin_freq = bin_frequencies[b + 1];
             double next_y_pos;
             
             if (USE_LOG_FREQUENCY) {
@@ -749,40 +571,450 @@ int spectral_generator_impl(const SpectrogramSettings *cfg,
     
     // Display parameters if enabled
     if (s.displayParameters) {
-        // Use empty string for audio file, 0.0 for start time, and s.duration for segment duration as defaults
-        // These will be updated by the caller if needed
-        draw_parameters_text(cr, page_width, page_height, &s, "", 0.0, s.duration);
+        // Empty string for the audio file (updated by the caller if needed), start time of the page
+        double start_time = first_window / src->binsPerSecond;
+        double page_duration = num_windows / src->binsPerSecond;
+        draw_parameters_text(cr, page_width, page_height, &s, "", start_time, page_duration, NULL);
     }
     
     // Apply optional blur
     #if ENABLE_BLUR
         if (BLUR_RADIUS > 0) {
             // Le rayon de flou est déjà en 800 DPI
-            apply_separable_box_blur(surface, BLUR_RADIUS);
+            apply_separable_box_blur(surface, BLUR_RADIUS, job);
         }
     #endif
     
+    cairo_destroy(cr);
+    *surface_out = surface;
+    spectral_trace_end(job, "raster_page", trace, raster_surface_bytes(surface), num_windows);
+    return EXIT_SUCCESS;
+}
+
+/*---------------------------------------------------------------------
+ * raster_bin_frequencies()
+ *
+ * Allocates the frequency of every bin, FFT or constant-Q, plus that of
+ * the bin after the last one, which closes its row (spectral_free() to
+ * release).
+ *---------------------------------------------------------------------*/
+static double *raster_bin_frequencies(const SpectrogramData *spectro, SpectralJob *job)
+{
+    if (spectro->bins_per_octave > 0.0) {
+        spectral_log(job, SPECTRAL_LOG_INFO, " - Constant-Q bins: %.2f per octave from %.2f Hz\n",
+                     spectro->bins_per_octave, spectro->base_freq);
+    } else {
+        spectral_log(job, SPECTRAL_LOG_INFO, " - Frequency resolution: %.2f Hz per bin\n", spectro->freq_resolution);
+    }
+    spectral_log(job, SPECTRAL_LOG_INFO, " - Frequency bins range: %d to %d\n", spectro->index_min, spectro->index_max);
+    
+    // Pré-calcul des fréquences réelles pour chaque bin
+    double *bin_frequencies = (double *)spectral_alloc(job, (spectro->num_bins + 1) * sizeof(double));
+    if (bin_frequencies == NULL) {
+        spectral_log(job, SPECTRAL_LOG_ERROR, "Error: Unable to allocate memory for frequency bins.\n");
+        return NULL;
+    }
+    
+    // Calculer les fréquences exactes correspondant à chaque bin
+    for (int b = 0; b <= spectro->num_bins; b++) {
+        bin_frequencies[b] = spectrogram_bin_frequency(spectro, b);
+    }
+    return bin_frequencies;
+}
+
+// Pages of a paginated render: page k+1 is drawn while page k is encoded
+typedef struct RasterPagePipeline {
+    const SpectralSource   *src;
+    const SpectrogramData  *spectro;    // Whole analysis, or its shape when paginated
+    const RasterLayout     *layout;
+    const double           *bin_frequencies;
+    const char             *outputFile;
+    int     windows_per_page;
+    int     page_count;
+    int     encode_page;            // Page written by stage 0
+    cairo_surface_t *encode_surface;
+    int     encode_status;
+    int     draw_page;              // Page drawn by stage 1
+    SpectrogramData draw_matrix;    // Its windows (spectral_page_matrix())
+    cairo_surface_t *draw_surface;
+    int     draw_status;
+    SpectralJob *job;
+} RasterPagePipeline;
+
+/*---------------------------------------------------------------------
+ * raster_pipeline_analyze()
+ *
+ * Gets the windows of page pipeline->draw_page into
+ * pipeline->draw_matrix. It runs on the calling thread between two
+ * pipeline steps: the analysis of a paginated render uses the job's
+ * parallel loop itself.
+ *
+ * Returns:
+ *  - EXIT_SUCCESS on success, EXIT_FAILURE on error,
+ *    SPECTRAL_CANCELLED if the job was cancelled.
+ *---------------------------------------------------------------------*/
+static int raster_pipeline_analyze(RasterPagePipeline *pipeline)
+{
+    int first = pipeline->draw_page * pipeline->windows_per_page;
+    int count = pipeline->spectro->num_windows - first;
+    if (count > pipeline->windows_per_page) count = pipeline->windows_per_page;
+    
+    return spectral_page_matrix(pipeline->src, pipeline->spectro, first, count,
+                                &pipeline->draw_matrix, pipeline->job);
+}
+
+/*---------------------------------------------------------------------
+ * raster_pipeline_draw()
+ *
+ * Draws page pipeline->draw_page into pipeline->draw_surface from
+ * pipeline->draw_matrix.
+ *---------------------------------------------------------------------*/
+static void raster_pipeline_draw(RasterPagePipeline *pipeline)
+{
+    int page = pipeline->draw_page;
+    
+    SpectralStageTimer timer;
+    spectral_stage_begin(pipeline->job, SPECTRAL_STAGE_RASTER, &timer);
+    pipeline->draw_status = raster_draw_page(pipeline->src, &pipeline->draw_matrix, pipeline->layout,
+                                             pipeline->bin_frequencies,
+                                             pipeline->draw_matrix.first_window,
+                                             pipeline->draw_matrix.num_windows,
+                                             (double)page / pipeline->page_count,
+                                             1.0 / pipeline->page_count,
+                                             &pipeline->draw_surface, pipeline->job);
+    spectral_stage_end(pipeline->job, SPECTRAL_STAGE_RASTER, &timer);
+}
+
+/*---------------------------------------------------------------------
+ * raster_pipeline_stage()
+ *
+ * Stage of the page pipeline run by spectral_parallel_for(): 0 writes
+ * the PNG of encode_page, 1 draws draw_page.
+ *---------------------------------------------------------------------*/
+static void raster_pipeline_stage(void *arg, int stage)
+{
+    RasterPagePipeline *pipeline = (RasterPagePipeline *)arg;
+    if (stage == 1) {
+        raster_pipeline_draw(pipeline);
+        return;
+    }
+    
+    char pagePath[SPECTRAL_PATH_MAX];
+    if (spectral_page_file_name(pipeline->outputFile, pipeline->encode_page + 1,
+                                pagePath, sizeof(pagePath)) != 0) {
+        spectral_log(pipeline->job, SPECTRAL_LOG_ERROR, "Error: Page file name too long: %s\n", pipeline->outputFile);
+        pipeline->encode_status = EXIT_FAILURE;
+        return;
+    }
+    SpectralStageTimer timer;
+    spectral_stage_begin(pipeline->job, SPECTRAL_STAGE_ENCODE, &timer);
+    double trace = spectral_trace_begin();
+    cairo_status_t written = cairo_surface_write_to_png(pipeline->encode_surface, pagePath);
+    spectral_stage_end(pipeline->job, SPECTRAL_STAGE_ENCODE, &timer);
+    if (written != CAIRO_STATUS_SUCCESS) {
+        spectral_log(pipeline->job, SPECTRAL_LOG_ERROR, "Error: Failed to write PNG file: %s\n", pagePath);
+        pipeline->encode_status = EXIT_FAILURE;
+        return;
+    }
+    spectral_trace_end(pipeline->job, "png_encode", trace, raster_surface_bytes(pipeline->encode_surface), 1);
+    spectral_log(pipeline->job, SPECTRAL_LOG_INFO, " - Page %d/%d written: %s\n",
+                 pipeline->encode_page + 1, pipeline->page_count, pagePath);
+    pipeline->encode_status = EXIT_SUCCESS;
+}
+
+/*---------------------------------------------------------------------
+ * raster_render_png_pages()
+ *
+ * Lays the whole analysis out on consecutive pages at the writing speed
+ * and writes one numbered PNG per page (see spectral_page_file_name()).
+ * Every page holds the same whole number of windows, so the columns
+ * continue from one page to the next. The windows of page k+1 are
+ * analyzed (paginated analysis) once page k is drawn, then its drawing
+ * runs while page k is encoded, through the job's parallel loop: the
+ * memory holds one page of the matrix and two page surfaces. The pages
+ * already written are removed if the job stops or a page fails.
+ *
+ * Returns:
+ *  - EXIT_SUCCESS on success, EXIT_FAILURE on error,
+ *    SPECTRAL_CANCELLED if the job was cancelled.
+ *---------------------------------------------------------------------*/
+static int raster_render_png_pages(const SpectralSource *src, const SpectrogramData *spectro,
+                                   const RasterLayout *layout, const char *outputFile,
+                                   SpectralJob *job)
+{
+    int windows_per_page = (int)floor(layout->spectro_width / layout->window_width);
+    if (windows_per_page < 1) windows_per_page = 1;
+    int page_count = (spectro->num_windows + windows_per_page - 1) / windows_per_page;
+    if (page_count < 1) page_count = 1;
+    
+    spectral_log(job, SPECTRAL_LOG_INFO, " - Pagination: %d windows on %d pages of %d windows (%.2f s per page)\n",
+                 spectro->num_windows, page_count, windows_per_page, windows_per_page / src->binsPerSecond);
+    
+    double *bin_frequencies = raster_bin_frequencies(spectro, job);
+    if (bin_frequencies == NULL) {
+        return EXIT_FAILURE;
+    }
+    
+    RasterPagePipeline pipeline;
+    memset(&pipeline, 0, sizeof(pipeline));
+    pipeline.src = src;
+    pipeline.spectro = spectro;
+    pipeline.layout = layout;
+    pipeline.bin_frequencies = bin_frequencies;
+    pipeline.outputFile = outputFile;
+    pipeline.windows_per_page = windows_per_page;
+    pipeline.page_count = page_count;
+    pipeline.job = job;
+    
+    // Première page seule, puis chaque page est dessinée pendant l'encodage de la précédente
+    pipeline.draw_page = 0;
+    int status = raster_pipeline_analyze(&pipeline);
+    if (status == EXIT_SUCCESS) {
+        raster_pipeline_draw(&pipeline);
+        spectral_page_matrix_release(spectro, &pipeline.draw_matrix, job);
+        status = pipeline.draw_status;
+    }
+    int written = 0;
+    
+    for (int page = 0; page < page_count && status == EXIT_SUCCESS; page++) {
+        if (spectral_job_should_stop(job)) {
+            status = SPECTRAL_CANCELLED;
+            break;
+        }
+        
+        pipeline.encode_page = page;
+        pipeline.encode_surface = pipeline.draw_surface;
+        pipeline.draw_surface = NULL;
+        pipeline.draw_page = page + 1;
+        pipeline.draw_status = EXIT_SUCCESS;
+        
+        int stages = 1;
+        if (page + 1 < page_count) {
+            status = raster_pipeline_analyze(&pipeline);
+            if (status != EXIT_SUCCESS) {
+                cairo_surface_destroy(pipeline.encode_surface);
+                pipeline.encode_surface = NULL;
+                break;
+            }
+            stages = 2;
+        }
+        spectral_parallel_for(job, stages, raster_pipeline_stage, &pipeline);
+        if (stages == 2) {
+            spectral_page_matrix_release(spectro, &pipeline.draw_matrix, job);
+        }
+        
+        cairo_surface_destroy(pipeline.encode_surface);
+        pipeline.encode_surface = NULL;
+        if (pipeline.encode_status == EXIT_SUCCESS) {
+            written++;
+        }
+        status = pipeline.encode_status != EXIT_SUCCESS ? pipeline.encode_status : pipeline.draw_status;
+    }
+    
+    if (pipeline.draw_surface != NULL) {
+        cairo_surface_destroy(pipeline.draw_surface);
+    }
+    spectral_free(job, bin_frequencies);
+    
+    if (status != EXIT_SUCCESS) {
+        // Ne pas laisser une partie des pages
+        char pagePath[SPECTRAL_PATH_MAX];
+        for (int page = 1; page <= written; page++) {
+            if (spectral_page_file_name(outputFile, page, pagePath, sizeof(pagePath)) == 0) {
+                remove(pagePath);
+            }
+        }
+        return status;
+    }
+    
+    spectral_job_report(job, SPECTRAL_STAGE_RASTER, 1.0);
+    spectral_job_report(job, SPECTRAL_STAGE_ENCODE, 1.0);
+    
+    spectral_log(job, SPECTRAL_LOG_INFO, "Spectrogram generated successfully at %.0f DPI: %d pages\n", PRINTER_DPI, page_count);
+    
+    return EXIT_SUCCESS;
+}
+
+/*---------------------------------------------------------------------
+ * raster_render_png()
+ *
+ * Renders an analyzed source at print resolution and writes the PNG
+ * file, or one numbered PNG per page when s.paginate is set. The
+ * spectrogram is only read, so several renders may share it. The job
+ * is polled every band of rendered columns; nothing is written if it
+ * stops.
+ *
+ * Returns:
+ *  - EXIT_SUCCESS on success, EXIT_FAILURE on error,
+ *    SPECTRAL_CANCELLED if the job was cancelled.
+ *---------------------------------------------------------------------*/
+static int raster_render_png(const SpectralSource *src, const SpectrogramData *spectro,
+                             const char *outputFile, SpectralJob *job)
+{
+    const char* outputFilePath = DEFAULT_STR(outputFile, DEFAULT_OUTPUT_FILENAME);
+    
+    /* ------------------------------ */
+    /* 3. Generate the PNG Spectrogram*/
+    /* ------------------------------ */
+    RasterLayout layout;
+    raster_layout(src, spectro->num_windows, &layout, job);
+    
+    if (src->s.paginate == 1 && src->writingSpeed > 0.0) {
+        return raster_render_png_pages(src, spectro, &layout, outputFilePath, job);
+    }
+    
+    double *bin_frequencies = raster_bin_frequencies(spectro, job);
+    if (bin_frequencies == NULL) {
+        return EXIT_FAILURE;
+    }
+    
+    cairo_surface_t *surface = NULL;
+    SpectralStageTimer timer;
+    spectral_stage_begin(job, SPECTRAL_STAGE_RASTER, &timer);
+    int status = raster_draw_page(src, spectro, &layout, bin_frequencies, 0, layout.visible_windows,
+                                  0.0, 1.0, &surface, job);
+    spectral_stage_end(job, SPECTRAL_STAGE_RASTER, &timer);
+    spectral_free(job, bin_frequencies);
+    if (status != EXIT_SUCCESS) {
+        return status;
+    }
+    
+    // Last chance to stop before the (uninterruptible) PNG encoding
+    if (spectral_job_should_stop(job)) {
+        cairo_surface_destroy(surface);
+        return SPECTRAL_CANCELLED;
+    }
+    
+    spectral_job_report(job, SPECTRAL_STAGE_RASTER, 1.0);
+    spectral_job_report(job, SPECTRAL_STAGE_ENCODE, 0.0);
+    
     // Save the image
-    if (cairo_surface_write_to_png(surface, outputFilePath) != CAIRO_STATUS_SUCCESS) {
-        fprintf(stderr, "Error: Failed to write PNG file: %s\n", outputFilePath);
-        cairo_destroy(cr);
+    spectral_stage_begin(job, SPECTRAL_STAGE_ENCODE, &timer);
+    double trace = spectral_trace_begin();
+    cairo_status_t written = cairo_surface_write_to_png(surface, outputFilePath);
+    spectral_stage_end(job, SPECTRAL_STAGE_ENCODE, &timer);
+    if (written != CAIRO_STATUS_SUCCESS) {
+        spectral_log(job, SPECTRAL_LOG_ERROR, "Error: Failed to write PNG file: %s\n", outputFilePath);
         cairo_surface_destroy(surface);
-        free(spectro_data.data);
-        free(bin_frequencies);
         return EXIT_FAILURE;
     }
+    spectral_trace_end(job, "png_encode", trace, raster_surface_bytes(surface), 1);
     
     // Clean up resources
-    cairo_destroy(cr);
     cairo_surface_destroy(surface);
-    free(spectro_data.data);
-    free(bin_frequencies);
     
-    printf("Spectrogram generated successfully at %.0f DPI: %s\n", PRINTER_DPI, outputFilePath);
+    spectral_job_report(job, SPECTRAL_STAGE_ENCODE, 1.0);
+    
+    spectral_log(job, SPECTRAL_LOG_INFO, "Spectrogram generated successfully at %.0f DPI: %s\n", PRINTER_DPI, outputFilePath);
     
     return EXIT_SUCCESS;
 }
 
+/*---------------------------------------------------------------------
+ * spectral_generator_impl()
+ *
+ * Generates a spectrogram PNG image.
+ * Uses exact parameters specified by the user without automatic adjustments.
+ * Optimized for 800 DPI output with correct logarithmic frequency scaling.
+ * The job is polled between stages, every block of FFT windows and every
+ * band of rendered columns; nothing is written if it stops.
+ *
+ * Returns:
+ *  - EXIT_SUCCESS on success, EXIT_FAILURE on error,
+ *    SPECTRAL_CANCELLED if the job was cancelled.
+ *---------------------------------------------------------------------*/
+int spectral_generator_impl(const SpectrogramSettings *cfg,
+                           const char *inputFile,
+                           const char *outputFile,
+                           SpectralJob *job)
+{
+    SpectralAnalysis *analysis = NULL;
+    int status = spectral_analyze(cfg, inputFile, &analysis, job);
+    if (status != EXIT_SUCCESS) {
+        return status;
+    }
+    
+    status = spectral_render_png(analysis, NULL, outputFile, job);
+    spectral_analysis_free(analysis);
+    return status;
+}
+
+/*---------------------------------------------------------------------
+ * spectral_render_png()
+ *
+ * Renders an analysis as a PNG at print resolution, in the page layout
+ * of the analysis, with the overlay settings of cfg (NULL = those of
+ * the analysis).
+ *
+ * Returns:
+ *  - EXIT_SUCCESS on success, EXIT_FAILURE on error,
+ *    SPECTRAL_CANCELLED if the job was cancelled.
+ *---------------------------------------------------------------------*/
+int spectral_render_png(const SpectralAnalysis *analysis,
+                        const SpectrogramSettings *cfg,
+                        const char *outputFile,
+                        SpectralJob *job)
+{
+    if (analysis == NULL) {
+        return EXIT_FAILURE;
+    }
+    
+    SpectralSource view;
+    spectral_source_with_layout(&analysis->src, cfg, &view, job);
+    return raster_render_png(&view, &analysis->data, outputFile, job);
+}
+
+/*---------------------------------------------------------------------
+ * raster_overlay_metadata()
+ *
+ * Redraws the parameters text of a written PNG with the audio file name
+ * and start time, which spectral_generator_impl() does not know, and the
+ * counters of the finished job.
+ *---------------------------------------------------------------------*/
+static void raster_overlay_metadata(const SpectrogramSettings *settings,
+                                    const char *outputFile,
+                                    const char *audioFileName,
+                                    double startTime,
+                                    const SpectralJob *job)
+{
+    // Load the generated image
+    cairo_surface_t *surface = cairo_image_surface_create_from_png(outputFile);
+    if (cairo_surface_status(surface) == CAIRO_STATUS_SUCCESS) {
+        // Create a context for drawing
+        cairo_t *cr = cairo_create(surface);
+        
+        // Get page dimensions
+        int width = cairo_image_surface_get_width(surface);
+        int height = cairo_image_surface_get_height(surface);
+        
+        // Calculate the height needed for parameters text (4 lines with spacing)
+        double fontSize = 48.0 * settings->textScaleFactor;
+        cairo_set_font_size(cr, fontSize);
+        
+        // Get font extents for dynamic line height
+        cairo_font_extents_t font_extents;
+        cairo_font_extents(cr, &font_extents);
+        double line_height = font_extents.height * 1.5; // Add 50% extra spacing between lines
+        double text_area_height = line_height * 5; // 3 lines plus some padding
+        
+        // Draw a white rectangle over the existing parameters text area
+        cairo_set_source_rgb(cr, 1.0, 1.0, 1.0);
+        cairo_rectangle(cr, 0, height - text_area_height, width, text_area_height);
+        cairo_fill(cr);
+        
+        // Draw the parameters text with metadata
+        draw_parameters_text(cr, width, height, settings, audioFileName, startTime, settings->duration,
+                             job != NULL ? &job->stats : NULL);
+        
+        // Save the updated image
+        cairo_surface_write_to_png(surface, outputFile);
+        
+        // Clean up
+        cairo_destroy(cr);
+    }
+    cairo_surface_destroy(surface);
+}
+
 /*---------------------------------------------------------------------
  * spectral_generator_with_metadata()
  *
@@ -795,64 +1027,374 @@ int spectral_generator_impl(const SpectrogramSettings *cfg,
  *  - outputFile: Path to output PNG file
  *  - audioFileName: Name of the audio file to display in parameters
  *  - startTime: Start time in seconds to display in parameters
+ *  - job: Cancellation context (may be NULL)
  *
  * Returns:
- *  - EXIT_SUCCESS on success, EXIT_FAILURE on error.
+ *  - EXIT_SUCCESS on success, EXIT_FAILURE on error,
+ *    SPECTRAL_CANCELLED if the job was cancelled.
  *---------------------------------------------------------------------*/
 int spectral_generator_with_metadata(const SpectrogramSettings *cfg,
                                     const char *inputFile,
                                     const char *outputFile,
                                     const char *audioFileName,
                                     double startTime,
-                                     double segmentDuration __attribute__((unused)))
+                                     double segmentDuration __attribute__((unused)),
+                                     SpectralJob *job)
 {
-    // Create a copy of the settings
+    // Create a copy of the settings; the metadata belongs to a single page
     SpectrogramSettings settings = *cfg;
-    
-    // Store the metadata for later use in draw_parameters_text
-    // This is a workaround since we can't modify the existing API
+    settings.paginate = 0;
     
     // Call the implementation function
-    int result = spectral_generator_impl(&settings, inputFile, outputFile);
+    int result = spectral_generator_impl(&settings, inputFile, outputFile, job);
     
     // If successful, update the parameters text with metadata
     if (result == EXIT_SUCCESS && settings.displayParameters) {
-        // Load the generated image
-        cairo_surface_t *surface = cairo_image_surface_create_from_png(outputFile);
-        if (cairo_surface_status(surface) == CAIRO_STATUS_SUCCESS) {
-            // Create a context for drawing
-            cairo_t *cr = cairo_create(surface);
-            
-            // Get page dimensions
-            int width = cairo_image_surface_get_width(surface);
-            int height = cairo_image_surface_get_height(surface);
-            
-            // Calculate the height needed for parameters text (4 lines with spacing)
-            double fontSize = 48.0 * settings.textScaleFactor;
-            cairo_set_font_size(cr, fontSize);
-            
-            // Get font extents for dynamic line height
-            cairo_font_extents_t font_extents;
-            cairo_font_extents(cr, &font_extents);
-            double line_height = font_extents.height * 1.5; // Add 50% extra spacing between lines
-            double text_area_height = line_height * 5; // 4 lines plus some padding
-            
-            // Draw a white rectangle over the existing parameters text area
-            cairo_set_source_rgb(cr, 1.0, 1.0, 1.0);
-            cairo_rectangle(cr, 0, height - text_area_height, width, text_area_height);
-            cairo_fill(cr);
-            
-            // Draw the parameters text with metadata
-            draw_parameters_text(cr, width, height, &settings, audioFileName, startTime, settings.duration);
-            
-            // Save the updated image
-            cairo_surface_write_to_png(surface, outputFile);
-            
-            // Clean up
-            cairo_destroy(cr);
-            cairo_surface_destroy(surface);
-        }
+        raster_overlay_metadata(&settings, outputFile, audioFileName, startTime, job);
     }
     
     return result;
 }
+
+// Shared state of the parallel column bands of a draft
+typedef struct DraftBandContext {
+    const SpectrogramData *spectro;
+    unsigned char *pixels;      // ARGB32 surface data
+    int     stride;
+    int     x0;                 // First pixel column of the spectrogram
+    int     columns;
+    int     y0;                 // First pixel row of the spectrogram
+    int     rows;
+    const int *first_window;    // Windows of column c: [first_window[c], last_window[c])
+    const int *last_window;
+    const int *first_bin;       // Bins of row r: [first_bin[r], last_bin[r]], empty if first > last
+    const int *last_bin;
+    int     num_blocks;
+    volatile int blocks_done;
+    volatile int failed;
+    SpectralJob *job;
+} DraftBandContext;
+
+/*---------------------------------------------------------------------
+ * draft_band()
+ *
+ * Renders one band of pixel columns of a draft. Each pixel keeps the
+ * darkest intensity of the windows and bins it covers, so narrow events
+ * survive the pooling.
+ *---------------------------------------------------------------------*/
+static void draft_band(void *arg, int block)
+{
+    DraftBandContext *ctx = (DraftBandContext *)arg;
+    int first = block * SPECTRAL_JOB_POLL_INTERVAL;
+    int last = first + SPECTRAL_JOB_POLL_INTERVAL;
+    if (last > ctx->columns) last = ctx->columns;
+    
+    if (spectral_job_should_stop(ctx->job)) {
+        return;
+    }
+    
+    double *column = (double *)malloc((size_t)ctx->rows * sizeof(double));
+    if (column == NULL) {
+        SPECTRAL_ATOMIC_STORE(&ctx->failed, 1);
+        return;
+    }
+    
+    const double *spectrogram = ctx->spectro->data;
+    int num_bins = ctx->spectro->num_bins;
+    
+    for (int c = first; c < last; c++) {
+        for (int r = 0; r < ctx->rows; r++) {
+            column[r] = 1.0;
+        }
+        
+        // Pool the windows of the column, one contiguous spectrum at a time
+        for (int w = ctx->first_window[c]; w < ctx->last_window[c]; w++) {
+            const double *spectrum = spectrogram + (size_t)w * num_bins;
+            for (int r = 0; r < ctx->rows; r++) {
+                for (int b = ctx->first_bin[r]; b <= ctx->last_bin[r]; b++) {
+                    if (spectrum[b] < column[r]) {
+                        column[r] = spectrum[b];
+                    }
+                }
+            }
+        }
+        
+        for (int r = 0; r < ctx->rows; r++) {
+            if (ctx->first_bin[r] > ctx->last_bin[r] || ctx->first_window[c] >= ctx->last_window[c]) {
+                continue;
+            }
+            unsigned int gray = (unsigned int)(column[r] * 255.0 + 0.5);
+            unsigned int *pixel = (unsigned int *)(ctx->pixels + (size_t)(ctx->y0 + r) * ctx->stride) + ctx->x0 + c;
+            *pixel = 0xFF000000u | (gray << 16) | (gray << 8) | gray;
+        }
+    }
+    
+    free(column);
+    
+    int done = SPECTRAL_ATOMIC_INCREMENT(&ctx->blocks_done);
+    spectral_job_report(ctx->job, SPECTRAL_STAGE_RASTER, (double)done / ctx->num_blocks);
+}
+
+/*---------------------------------------------------------------------
+ * raster_render_draft()
+ *
+ * Renders a source directly at screen size: the page is scaled to fit
+ * in max_width x max_height, the FFT uses a shorter zero padding and the
+ * windows are pooled into pixel columns instead of being drawn one
+ * rectangle per bin. Scale, reference lines and parameters are drawn
+ * in page units through a scaled Cairo context.
+ *
+ * Returns:
+ *  - EXIT_SUCCESS on success, EXIT_FAILURE on error,
+ *    SPECTRAL_CANCELLED if the job was cancelled.
+ *---------------------------------------------------------------------*/
+static int raster_render_draft(const SpectralSource *src,
+                               const SpectrogramSettings *display,
+                               const char *audioFileName,
+                               double startTime,
+                               int max_width,
+                               int max_height,
+                               SpectralDraftCallback callback,
+                               void *userData,
+                               SpectralJob *job)
+{
+    // Shorter padding: the draft has far fewer pixel rows than the print
+    int pad_size = 0;
+    #if USE_ZERO_PADDING
+        pad_size = src->fftSize * SPECTRAL_DRAFT_PAD_FACTOR;
+        if (pad_size > ZERO_PAD_SIZE) pad_size = ZERO_PAD_SIZE;
+    #endif
+    
+    SpectrogramData spectro_data = {0};
+    int status = spectral_compute_analysis(src, pad_size, &spectro_data, job);
+    if (status != EXIT_SUCCESS) {
+        return status;
+    }
+    
+    RasterLayout layout;
+    raster_layout(src, spectro_data.num_windows, &layout, job);
+    
+    double scale = fmin(max_width / layout.page_width, max_height / layout.page_height);
+    int width = (int)(layout.page_width * scale);
+    int height = (int)(layout.page_height * scale);
+    if (width < 1) width = 1;
+    if (height < 1) height = 1;
+    
+    spectral_log(job, SPECTRAL_LOG_INFO, " - Draft: %d x %d pixels (%.1f DPI), FFT padded to %d\n",
+                 width, height, PRINTER_DPI * scale, pad_size);
+    
+    cairo_surface_t *surface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, width, height);
+    cairo_t *cr = cairo_create(surface);
+    if (cairo_status(cr) != CAIRO_STATUS_SUCCESS) {
+        spectral_log(job, SPECTRAL_LOG_ERROR, "Error: Unable to create Cairo context.\n");
+        cairo_destroy(cr);
+        cairo_surface_destroy(surface);
+        spectral_free(job, spectro_data.data);
+        return EXIT_FAILURE;
+    }
+    
+    cairo_set_source_rgb(cr, 1.0, 1.0, 1.0);
+    cairo_paint(cr);
+    cairo_surface_flush(surface);
+    
+    // Pixel extent of the spectrogram
+    double spectro_right = layout.spectro_left + layout.visible_windows * layout.window_width;
+    int x0 = (int)floor(layout.spectro_left * scale);
+    int x1 = (int)ceil(spectro_right * scale);
+    int y0 = (int)floor(layout.spectro_top * scale);
+    int y1 = (int)ceil(layout.spectro_bottom * scale);
+    if (x0 < 0) x0 = 0;
+    if (y0 < 0) y0 = 0;
+    if (x1 > width) x1 = width;
+    if (y1 > height) y1 = height;
+    int columns = x1 > x0 ? x1 - x0 : 0;
+    int rows = y1 > y0 ? y1 - y0 : 0;
+    
+    int *first_window = (int *)malloc((size_t)(2 * columns + 2 * rows + 1) * sizeof(int));
+    if (first_window == NULL) {
+        spectral_log(job, SPECTRAL_LOG_ERROR, "Error: Unable to allocate memory for the draft.\n");
+        cairo_destroy(cr);
+        cairo_surface_destroy(surface);
+        spectral_free(job, spectro_data.data);
+        return EXIT_FAILURE;
+    }
+    int *last_window = first_window + columns;
+    int *first_bin = last_window + columns;
+    int *last_bin = first_bin + rows;
+    
+    // Windows covered by each pixel column (at least the one under its center)
+    for (int c = 0; c < columns; c++) {
+        double left = ((x0 + c) / scale - layout.spectro_left) / layout.window_width;
+        double right = ((x0 + c + 1) / scale - layout.spectro_left) / layout.window_width;
+        int w0 = (int)floor(left);
+        int w1 = (int)ceil(right);
+        if (w0 < 0) w0 = 0;
+        if (w1 > layout.visible_windows) w1 = layout.visible_windows;
+        if (w1 <= w0 && w0 < layout.visible_windows) w1 = w0 + 1;
+        first_window[c] = w0;
+        last_window[c] = w1;
+    }
+    
+    // Bins covered by each pixel row, on the same frequency scale as the print
+    for (int r = 0; r < rows; r++) {
+        double ratio_top = (layout.spectro_bottom - (y0 + r) / scale) / layout.spectro_height_px;
+        double ratio_bottom = (layout.spectro_bottom - (y0 + r + 1) / scale) / layout.spectro_height_px;
+        first_bin[r] = 1;
+        last_bin[r] = 0;
+        if (ratio_top <= 0.0 || ratio_bottom >= 1.0) {
+            continue;
+        }
+        if (ratio_top > 1.0) ratio_top = 1.0;
+        if (ratio_bottom < 0.0) ratio_bottom = 0.0;
+        
+        double freq_low, freq_high;
+        if (USE_LOG_FREQUENCY) {
+            freq_low = src->minFreq * pow(2.0, ratio_bottom * layout.octaves);
+            freq_high = src->minFreq * pow(2.0, ratio_top * layout.octaves);
+        } else {
+            freq_low = src->minFreq + ratio_bottom * (src->maxFreq - src->minFreq);
+            freq_high = src->minFreq + ratio_top * (src->maxFreq - src->minFreq);
+        }
+        
+        int b0 = (int)floor(spectrogram_bin_position(&spectro_data, freq_low));
+        int b1 = (int)ceil(spectrogram_bin_position(&spectro_data, freq_high)) - 1;
+        if (b1 < b0) b1 = b0;
+        if (b0 < spectro_data.index_min) b0 = spectro_data.index_min;
+        if (b1 > spectro_data.index_max) b1 = spectro_data.index_max;
+        first_bin[r] = b0;
+        last_bin[r] = b1;
+    }
+    
+    DraftBandContext ctx;
+    ctx.spectro = &spectro_data;
+    ctx.pixels = cairo_image_surface_get_data(surface);
+    ctx.stride = cairo_image_surface_get_stride(surface);
+    ctx.x0 = x0;
+    ctx.columns = columns;
+    ctx.y0 = y0;
+    ctx.rows = rows;
+    ctx.first_window = first_window;
+    ctx.last_window = last_window;
+    ctx.first_bin = first_bin;
+    ctx.last_bin = last_bin;
+    ctx.num_blocks = (columns + SPECTRAL_JOB_POLL_INTERVAL - 1) / SPECTRAL_JOB_POLL_INTERVAL;
+    ctx.blocks_done = 0;
+    ctx.failed = 0;
+    ctx.job = job;
+    
+    spectral_job_report(job, SPECTRAL_STAGE_RASTER, 0.0);
+    SpectralStageTimer timer;
+    spectral_stage_begin(job, SPECTRAL_STAGE_RASTER, &timer);
+    spectral_parallel_for(job, ctx.num_blocks, draft_band, &ctx);
+    spectral_stage_end(job, SPECTRAL_STAGE_RASTER, &timer);
+    
+    free(first_window);
+    spectral_free(job, spectro_data.data);
+    
+    if (ctx.failed || spectral_job_should_stop(job)) {
+        cairo_destroy(cr);
+        cairo_surface_destroy(surface);
+        if (ctx.failed) {
+            spectral_log(job, SPECTRAL_LOG_ERROR, "Error: Unable to allocate memory for the draft.\n");
+            return EXIT_FAILURE;
+        }
+        return SPECTRAL_CANCELLED;
+    }
+    cairo_surface_mark_dirty(surface);
+    
+    // Overlays are drawn in page units, like on the print
+    cairo_scale(cr, scale, scale);
+    const SpectrogramSettings *s = &src->s;
+    if (s->enableVerticalScale) {
+        draw_vertical_scale(cr, layout.spectro_left, layout.spectro_top, layout.spectro_height_px,
+                            src->minFreq, src->maxFreq, layout.octaves,
+                            s->textScaleFactor, s->lineThicknessFactor);
+    }
+    if (s->enableBottomReferenceLine || s->enableTopReferenceLine) {
+        draw_reference_lines(cr, layout.spectro_left, layout.spectro_width,
+                             layout.spectro_bottom, layout.spectro_top,
+                             s->enableBottomReferenceLine, s->bottomReferenceLineOffset,
+                             s->enableTopReferenceLine, s->topReferenceLineOffset,
+                             s->lineThicknessFactor);
+    }
+    if (s->displayParameters) {
+        draw_parameters_text(cr, layout.page_width, layout.page_height, display,
+                             audioFileName, startTime, display->duration, NULL);
+    }
+    cairo_surface_flush(surface);
+    
+    spectral_job_report(job, SPECTRAL_STAGE_RASTER, 1.0);
+    
+    if (callback) {
+        callback(userData, cairo_image_surface_get_data(surface), width, height,
+                 cairo_image_surface_get_stride(surface), PRINTER_DPI * scale);
+    }
+    
+    cairo_destroy(cr);
+    cairo_surface_destroy(surface);
+    return EXIT_SUCCESS;
+}
+
+/*---------------------------------------------------------------------
+ * spectral_generator_progressive()
+ *
+ * Progressive preview: the audio is decoded and filtered once, a draft
+ * that fits in draftWidth x draftHeight is handed to the callback, then
+ * the same signal is rendered at print resolution into outputFile, with
+ * the metadata of spectral_generator_with_metadata().
+ *
+ * Returns:
+ *  - EXIT_SUCCESS on success, EXIT_FAILURE on error,
+ *    SPECTRAL_CANCELLED if the job was cancelled (during the draft or
+ *    the refinement).
+ *---------------------------------------------------------------------*/
+int spectral_generator_progressive(const SpectrogramSettings *cfg,
+                                   const char *inputFile,
+                                   const char *outputFile,
+                                   const char *audioFileName,
+                                   double startTime,
+                                   int draftWidth,
+                                   int draftHeight,
+                                   SpectralDraftCallback draftCallback,
+                                   void *draftUserData,
+                                   SpectralJob *job)
+{
+    SpectrogramSettings settings = *cfg;
+    settings.paginate = 0; // A preview is a single page
+    
+    SpectralSource src;
+    int status = spectral_load_source(&settings, inputFile, outputFile, &src, job);
+    if (status != EXIT_SUCCESS) {
+        return status;
+    }
+    
+    if (draftWidth > 0 && draftHeight > 0) {
+        // The draft analysis has its own share of the progress, so that the
+        // refinement does not move the bar back
+        spectral_job_progress_range(job, SPECTRAL_STAGE_FFT, SPECTRAL_STAGE_TONE_MAP, SPECTRAL_DRAFT_PROGRESS);
+        status = raster_render_draft(&src, &settings, audioFileName, startTime,
+                                     draftWidth, draftHeight, draftCallback, draftUserData, job);
+        if (status != EXIT_SUCCESS) {
+            spectral_free_source(&src);
+            return status;
+        }
+        spectral_job_progress_range(job, SPECTRAL_STAGE_FFT, SPECTRAL_STAGE_ENCODE, 1.0);
+    }
+    
+    // Refinement from the same signal; the signal is no longer needed once analyzed
+    SpectrogramData spectro_data = {0};
+    status = spectral_compute_analysis(&src, 0, &spectro_data, job);
+    if (status != EXIT_SUCCESS) {
+        spectral_free_source(&src);
+        return status;
+    }
+    spectral_free_source(&src);
+    
+    status = raster_render_png(&src, &spectro_data, outputFile, job);
+    spectral_free(job, spectro_data.data);
+    
+    if (status == EXIT_SUCCESS && settings.displayParameters) {
+        raster_overlay_metadata(&settings, outputFile, audioFileName, startTime, job);
+    }
+    return status;
+}
@@ -0,0 +1,314 @@
+/*
+ * Copyright (C) 2025 - present Ondulab
+ * All rights reserved.
+ *
+ * This software is licensed under terms that can be found in the LICENSE file
+ * in the root directory of this software component.
+ */
+
+#include "spectral_reference.h"
+#include <cairo/cairo-pdf.h>
+
+/*---------------------------------------------------------------------
+ * reference_compute_spectrogram()
+ *
+ * Serial short-time Fourier transform: Hann window over fft_size
+ * samples, zero padding to fft_padded_size(fft_size, pad_size), one
+ * window every sample_rate / bins_per_second samples. Stores the
+ * magnitudes of the bins up to max_freq; the global maximum is that of
+ * the [min_freq, max_freq] bins. The matrix is released with free().
+ *
+ * Returns:
+ *  - 0 on success, non-zero on error.
+ *---------------------------------------------------------------------*/
+int reference_compute_spectrogram(const double *signal, int total_samples, int sample_rate,
+                                  int fft_size, int pad_size, double bins_per_second,
+                                  double min_freq, double max_freq,
+                                  SpectrogramData *spectro_data)
+{
+    int padded = fft_padded_size(fft_size, pad_size);
+    int transform_bins = padded / 2 + 1;
+    int step = (int)(sample_rate / bins_per_second);
+    if (step < 1) step = 1;
+
+    int num_windows = (total_samples - fft_size) / step + 1;
+    if (num_windows <= 0) {
+        return 2;
+    }
+
+    double freq_resolution = sample_rate / (double)padded;
+    int index_min = (int)ceil(min_freq / freq_resolution);
+    int index_max = (int)floor(max_freq / freq_resolution);
+    if (index_min < 0) index_min = 0;
+    if (index_max > transform_bins - 1) index_max = transform_bins - 1;
+    if (index_min >= index_max) {
+        index_min = 0;
+        index_max = transform_bins - 1;
+    }
+    int num_bins = index_max + 1;
+
+    double *in = (double *)fftw_malloc(sizeof(double) * padded);
+    fftw_complex *out = (fftw_complex *)fftw_malloc(sizeof(fftw_complex) * transform_bins);
+    double *spectrogram = (double *)malloc((size_t)num_windows * num_bins * sizeof(double));
+    if (in == NULL || out == NULL || spectrogram == NULL) {
+        if (in) fftw_free(in);
+        if (out) fftw_free(out);
+        free(spectrogram);
+        return 3;
+    }
+    fftw_plan plan = fftw_plan_dft_r2c_1d(padded, in, out, FFTW_ESTIMATE);
+
+    double global_max = 0.0;
+    for (int w = 0; w < num_windows; w++) {
+        int start = w * step;
+        for (int i = 0; i < padded; i++) {
+            in[i] = (i < fft_size && start + i < total_samples) ? signal[start + i] : 0.0;
+        }
+        for (int i = 0; i < fft_size; i++) {
+            in[i] *= 0.5 * (1.0 - cos(2.0 * M_PI * i / (fft_size - 1)));
+        }
+
+        fftw_execute(plan);
+
+        double *row = spectrogram + (size_t)w * num_bins;
+        for (int b = 0; b < num_bins; b++) {
+            double magnitude = sqrt(out[b][0] * out[b][0] + out[b][1] * out[b][1]);
+            row[b] = magnitude;
+            if (b >= index_min && magnitude > global_max) {
+                global_max = magnitude;
+            }
+        }
+    }
+
+    fftw_destroy_plan(plan);
+    fftw_free(in);
+    fftw_free(out);
+
+    spectro_data->data = spectrogram;
+    spectro_data->first_window = 0;
+    spectro_data->num_windows = num_windows;
+    spectro_data->num_bins = num_bins;
+    spectro_data->index_min = index_min;
+    spectro_data->index_max = index_max;
+    spectro_data->global_max = global_max;
+    spectro_data->freq_resolution = freq_resolution;
+    spectro_data->bins_per_octave = 0.0;
+    spectro_data->base_freq = 0.0;
+    return 0;
+}
+
+/*---------------------------------------------------------------------
+ * reference_tone_map()
+ *
+ * Serial tone mapping of the [index_min, index_max] bins: dB scale over
+ * the dynamic range, gamma, inversion, 8-bit quantization with optional
+ * dithering, contrast. The dithering noise restarts from the seed and
+ * the block index every SPECTRAL_JOB_POLL_INTERVAL windows, as in the
+ * application.
+ *---------------------------------------------------------------------*/
+void reference_tone_map(SpectrogramData *spectro_data, double dynamic_range_db,
+                        double gamma_correction, int enable_dither, double contrast_factor,
+                        unsigned long long seed)
+{
+    if (dynamic_range_db <= 0.0) dynamic_range_db = DYNAMIC_RANGE_DB;
+    if (gamma_correction <= 0.0) gamma_correction = GAMMA_CORRECTION;
+    if (contrast_factor <= 0.0) contrast_factor = CONTRAST_FACTOR;
+
+    double epsilon = 1e-10;
+    double max_dB = 20.0 * log10(spectro_data->global_max + epsilon);
+    double min_dB = max_dB - dynamic_range_db;
+    unsigned long long rng_state = seed;
+
+    for (int w = 0; w < spectro_data->num_windows; w++) {
+        if (w % SPECTRAL_JOB_POLL_INTERVAL == 0) {
+            unsigned long long block = (unsigned long long)(w / SPECTRAL_JOB_POLL_INTERVAL);
+            rng_state = seed ^ (block * 0xD1B54A32D192ED03ULL);
+        }
+
+        double *row = spectro_data->data + (size_t)w * spectro_data->num_bins;
+        for (int b = spectro_data->index_min; b <= spectro_data->index_max; b++) {
+            double intensity;
+            if (USE_LOG_AMPLITUDE) {
+                double dB = 20.0 * log10(row[b] + epsilon);
+                intensity = (dB - min_dB) / (max_dB - min_dB);
+                if (intensity < 0.0) intensity = 0.0;
+                if (intensity > 1.0) intensity = 1.0;
+            } else {
+                intensity = row[b] / spectro_data->global_max;
+            }
+            if (gamma_correction != 1.0) {
+                intensity = pow(intensity, 1.0 / gamma_correction);
+            }
+
+            double quantized = (1.0 - intensity) * 255.0;
+            if (enable_dither) {
+                quantized += spectral_random_uniform(&rng_state) - 0.5;
+            }
+            if (quantized < 0.0) quantized = 0.0;
+            if (quantized > 255.0) quantized = 255.0;
+
+            double value = (quantized / 255.0 - 0.5) * contrast_factor + 0.5;
+            if (value < 0.0) value = 0.0;
+            if (value > 1.0) value = 1.0;
+            row[b] = value;
+        }
+    }
+}
+
+/*---------------------------------------------------------------------
+ * reference_raster_page()
+ *
+ * Draws the first page of a tone-mapped spectrogram the way the raster
+ * render does: page of the format at PRINTER_DPI, spectrogram right of
+ * the label margin and above the bottom margin, one gray rectangle per
+ * bin and window on a log frequency scale, the windows of one page at
+ * the writing speed. Scale, reference lines and parameters text are not
+ * drawn; the harness disables them.
+ *
+ * Returns:
+ *  - the ARGB32 surface, or NULL on error.
+ *---------------------------------------------------------------------*/
+cairo_surface_t *reference_raster_page(const SpectralSource *src, const SpectrogramData *spectro_data)
+{
+    const SpectrogramSettings *s = &src->s;
+    double page_width = (s->pageFormat == 1) ? A3_WIDTH : A4_WIDTH;
+    double page_height = (s->pageFormat == 1) ? A3_HEIGHT : A4_HEIGHT;
+    double bottom_margin = DEFAULT_DBL(s->bottomMarginMM * MM_TO_PIXELS, DEFAULT_BOTTOM_MARGIN);
+    double spectro_height = DEFAULT_DBL(s->spectroHeightMM * MM_TO_PIXELS, DEFAULT_SPECTRO_HEIGHT);
+    double spectro_left = LABEL_MARGIN;
+    double spectro_width = page_width - LABEL_MARGIN;
+    double spectro_bottom = page_height - bottom_margin;
+    double min_freq = src->minFreq;
+    double octaves = log2(src->maxFreq / min_freq);
+    double window_width = (src->writingSpeed / src->binsPerSecond) / PIXELS_TO_CM;
+
+    int visible_windows = spectro_data->num_windows;
+    if (src->writingSpeed > 0.0) {
+        int page_windows = (int)floor(spectro_width / window_width);
+        if (page_windows < 1) page_windows = 1;
+        if (visible_windows > page_windows) visible_windows = page_windows;
+    }
+
+    cairo_surface_t *surface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, (int)page_width, (int)page_height);
+    cairo_t *cr = cairo_create(surface);
+    if (cairo_status(cr) != CAIRO_STATUS_SUCCESS) {
+        cairo_destroy(cr);
+        cairo_surface_destroy(surface);
+        return NULL;
+    }
+    cairo_set_source_rgb(cr, 1.0, 1.0, 1.0);
+    cairo_paint(cr);
+
+    int num_bins = spectro_data->num_bins;
+    double freq_resolution = spectro_data->freq_resolution;
+    for (int w = 0; w < visible_windows; w++) {
+        double x = spectro_left + w * window_width;
+        for (int b = spectro_data->index_min; b <= spectro_data->index_max; b++) {
+            double intensity = spectro_data->data[(size_t)w * num_bins + b];
+            double bin_freq = b * freq_resolution;
+            double next_bin_freq = (b < num_bins - 1) ? (b + 1) * freq_resolution : bin_freq + freq_resolution;
+            double ratio = log2(bin_freq / min_freq) / octaves;
+            double next_ratio = log2(next_bin_freq / min_freq) / octaves;
+            if (ratio < 0.0) ratio = 0.0;
+            if (ratio > 1.0) ratio = 1.0;
+            if (next_ratio < 0.0) next_ratio = 0.0;
+            if (next_ratio > 1.0) next_ratio = 1.0;
+
+            double y = spectro_bottom - ratio * spectro_height;
+            double next_y = spectro_bottom - next_ratio * spectro_height;
+            double height = fabs(y - next_y);
+            if (height < 1.0) height = 1.0;
+
+            cairo_set_source_rgb(cr, intensity, intensity, intensity);
+            cairo_rectangle(cr, x, next_y, window_width, height);
+            cairo_fill(cr);
+        }
+    }
+
+    #if ENABLE_BLUR
+        if (BLUR_RADIUS > 0) {
+            apply_separable_box_blur(surface, BLUR_RADIUS, NULL);
+        }
+    #endif
+
+    cairo_destroy(cr);
+    cairo_surface_flush(surface);
+    return surface;
+}
+
+/*---------------------------------------------------------------------
+ * reference_vector_cells()
+ *
+ * Writes the first page of a tone-mapped spectrogram as the vector
+ * render drew it before its cells were merged: a PDF page of the format,
+ * the spectrogram between 20 mm margins, one color, rectangle and fill
+ * per bin and window. Only the cells are drawn; the size of the file is
+ * the baseline of the merged render.
+ *
+ * Returns:
+ *  - 0 on success (*cells is the number of cells drawn), non-zero on error.
+ *---------------------------------------------------------------------*/
+int reference_vector_cells(const SpectralSource *src, const SpectrogramData *spectro_data,
+                           const char *output_file, long long *cells)
+{
+    const SpectrogramSettings *s = &src->s;
+    double page_width_pt = ((s->pageFormat == 1) ? A3_WIDTH_MM : A4_WIDTH_MM) * MM_TO_POINTS;
+    double page_height_pt = ((s->pageFormat == 1) ? A3_HEIGHT_MM : A4_HEIGHT_MM) * MM_TO_POINTS;
+    double margin_pt = 20.0 * MM_TO_POINTS;
+    double spectro_width_pt = page_width_pt - 2 * margin_pt;
+    double spectro_height_pt;
+    if (s->spectroHeightMM > 0) {
+        spectro_height_pt = s->spectroHeightMM * MM_TO_POINTS;
+    } else {
+        double freq_range_ratio = (src->maxFreq - src->minFreq) / (src->sampleRate / 2.0);
+        spectro_height_pt = spectro_width_pt * freq_range_ratio * 0.75;
+        if (spectro_height_pt > page_height_pt - 2 * margin_pt) {
+            spectro_height_pt = page_height_pt - 2 * margin_pt;
+        }
+    }
+    double spectro_x = margin_pt;
+    double spectro_y = (page_height_pt - spectro_height_pt) / 2;
+
+    int num_bins = spectro_data->num_bins;
+    int index_min = spectro_data->index_min;
+    int index_max = spectro_data->index_max;
+    double window_width = src->writingSpeed / src->binsPerSecond * (POINTS_PER_INCH / 2.54);
+    double bin_height = spectro_height_pt / (index_max - index_min + 1);
+
+    int visible_windows = spectro_data->num_windows;
+    if (src->writingSpeed > 0.0) {
+        int page_windows = (int)floor(spectro_width_pt / window_width);
+        if (page_windows < 1) page_windows = 1;
+        if (visible_windows > page_windows) visible_windows = page_windows;
+    }
+
+    cairo_surface_t *surface = cairo_pdf_surface_create(output_file, page_width_pt, page_height_pt);
+    cairo_t *cr = cairo_create(surface);
+    if (cairo_status(cr) != CAIRO_STATUS_SUCCESS) {
+        cairo_destroy(cr);
+        cairo_surface_destroy(surface);
+        return 1;
+    }
+    cairo_set_source_rgb(cr, 1.0, 1.0, 1.0);
+    cairo_paint(cr);
+
+    for (int w = 0; w < visible_windows; w++) {
+        double x = spectro_x + w * window_width;
+        for (int b = index_min; b <= index_max; b++) {
+            double intensity = spectro_data->data[(size_t)w * num_bins + b];
+            double y = spectro_y + spectro_height_pt - (b - index_min + 1) * bin_height;
+            cairo_set_source_rgb(cr, intensity, intensity, intensity);
+            cairo_rectangle(cr, x, y, window_width, bin_height);
+            cairo_fill(cr);
+        }
+    }
+
+    cairo_show_page(cr);
+    cairo_destroy(cr);
+    cairo_surface_finish(surface);
+    int status = cairo_surface_status(surface) != CAIRO_STATUS_SUCCESS;
+    cairo_surface_destroy(surface);
+
+    *cells = (long long)visible_windows * (index_max - index_min + 1);
+    return status;
+}
@@ -0,0 +1,37 @@
+/*
+ * Copyright (C) 2025 - present Ondulab
+ * All rights reserved.
+ *
+ * This software is licensed under terms that can be found in the LICENSE file
+ * in the root directory of this software component.
+ */
+
+#ifndef SPECTRAL_REFERENCE_H
+#define SPECTRAL_REFERENCE_H
+
+#include "spectral_common.h"
+#include "spectral_analyze.h"
+
+/*
+ * Frozen reference of the analysis and raster stages, used by the
+ * equivalence harness (spectral_verify.c). These are serial copies of
+ * the uniform transform of compute_spectrogram(), apply_image_processing()
+ * and the cell loop of the raster render as they stood when the harness
+ * was written, and of the vector cell loop before its cells were merged. They must not follow later optimizations: an optimized
+ * path is correct when it reproduces them within the tolerances of its
+ * stage. Change them only with a deliberate change of the printed output.
+ */
+
+// Function prototypes
+int reference_compute_spectrogram(const double *signal, int total_samples, int sample_rate,
+                                  int fft_size, int pad_size, double bins_per_second,
+                                  double min_freq, double max_freq,
+                                  SpectrogramData *spectro_data);
+void reference_tone_map(SpectrogramData *spectro_data, double dynamic_range_db,
+                        double gamma_correction, int enable_dither, double contrast_factor,
+                        unsigned long long seed);
+cairo_surface_t *reference_raster_page(const SpectralSource *src, const SpectrogramData *spectro_data);
+int reference_vector_cells(const SpectralSource *src, const SpectrogramData *spectro_data,
+                           const char *output_file, long long *cells);
+
+#endif /* SPECTRAL_REFERENCE_H */
@@ -0,0 +1,147 @@
+/*
+ * Copyright (C) 2025 - present Ondulab
+ * All rights reserved.
+ *
+ * This software is licensed under terms that can be found in the LICENSE file
+ * in the root directory of this software component.
+ */
+
+#include "spectral_synth.h"
+#include <stdint.h>
+
+#define SYNTH_CHUNK_FRAMES  65536       /* Frames synthesized per write */
+#define SYNTH_SEED          0x5eed5eedULL
+
+const char *synth_signal_names[SYNTH_SIGNAL_COUNT] = {"sine", "chirp", "pink", "impulses"};
+
+/* xorshift64*: the same recording on every machine and every run */
+static double synth_random(uint64_t *state)
+{
+    *state ^= *state >> 12;
+    *state ^= *state << 25;
+    *state ^= *state >> 27;
+    return (double)((*state * 0x2545F4914F6CDD1DULL) >> 11) * (2.0 / 9007199254740992.0) - 1.0;
+}
+
+/*---------------------------------------------------------------------
+ * synth_parse_signals()
+ *
+ * Parses a comma-separated list of signal names.
+ *
+ * Returns:
+ *  - the number of signals, -1 if a name is unknown.
+ *---------------------------------------------------------------------*/
+int synth_parse_signals(const char *text, int *signals, int max_signals)
+{
+    int count = 0;
+    char *copy = strdup(text);
+    for (char *item = strtok(copy, ","); item != NULL && count < max_signals; item = strtok(NULL, ",")) {
+        int found = -1;
+        for (int i = 0; i < SYNTH_SIGNAL_COUNT; i++) {
+            if (strcmp(item, synth_signal_names[i]) == 0) {
+                found = i;
+            }
+        }
+        if (found < 0) {
+            fprintf(stderr, "unknown signal '%s'\n", item);
+            free(copy);
+            return -1;
+        }
+        signals[count++] = found;
+    }
+    free(copy);
+    return count;
+}
+
+/*---------------------------------------------------------------------
+ * synth_write_source()
+ *
+ * Writes a synthetic recording as 24-bit PCM (RF64 above the 4 GB
+ * limit of WAV). Every channel carries the same signal at a slightly
+ * lower level than the previous one.
+ *
+ * Returns:
+ *  - 0 on success, non-zero on error.
+ *---------------------------------------------------------------------*/
+int synth_write_source(const char *path, SynthSignal signal, double duration,
+                       int sample_rate, int channels)
+{
+    sf_count_t total_frames = (sf_count_t)(duration * sample_rate);
+    double bytes = (double)total_frames * channels * 3.0;
+
+    SF_INFO info;
+    memset(&info, 0, sizeof(info));
+    info.samplerate = sample_rate;
+    info.channels = channels;
+    info.format = (bytes < 4.0e9 ? SF_FORMAT_WAV : SF_FORMAT_RF64) | SF_FORMAT_PCM_24;
+
+    SNDFILE *sf = sf_open(path, SFM_WRITE, &info);
+    if (sf == NULL) {
+        fprintf(stderr, "cannot create %s: %s\n", path, sf_strerror(NULL));
+        return 1;
+    }
+
+    float *buffer = (float *)malloc((size_t)SYNTH_CHUNK_FRAMES * channels * sizeof(float));
+    if (buffer == NULL) {
+        sf_close(sf);
+        return 2;
+    }
+
+    uint64_t state = SYNTH_SEED;
+    double pink[3] = {0.0, 0.0, 0.0};
+    double f0 = 20.0;
+    double f1 = fmin(20000.0, 0.45 * sample_rate);
+    double sweep_rate = log(f1 / f0) / duration;
+    sf_count_t impulse_period = sample_rate / 2;
+
+    for (sf_count_t start = 0; start < total_frames; start += SYNTH_CHUNK_FRAMES) {
+        sf_count_t count = total_frames - start;
+        if (count > SYNTH_CHUNK_FRAMES) {
+            count = SYNTH_CHUNK_FRAMES;
+        }
+
+        for (sf_count_t i = 0; i < count; i++) {
+            sf_count_t n = start + i;
+            double t = (double)n / sample_rate;
+            double value;
+
+            switch (signal) {
+                case SYNTH_SINE:
+                    value = 0.5 * sin(2.0 * M_PI * 440.0 * t) + 0.25 * sin(2.0 * M_PI * 3000.0 * t);
+                    break;
+                case SYNTH_CHIRP:
+                    value = 0.8 * sin(2.0 * M_PI * f0 * (exp(sweep_rate * t) - 1.0) / sweep_rate);
+                    break;
+                case SYNTH_PINK: {
+                    double white = synth_random(&state);
+                    pink[0] = 0.99765 * pink[0] + white * 0.0990460;
+                    pink[1] = 0.96300 * pink[1] + white * 0.2965164;
+                    pink[2] = 0.57000 * pink[2] + white * 1.0526913;
+                    value = 0.2 * (pink[0] + pink[1] + pink[2] + white * 0.1848);
+                    break;
+                }
+                case SYNTH_IMPULSES:
+                default:
+                    value = (n % impulse_period == 0) ? 0.9 : 0.001 * synth_random(&state);
+                    break;
+            }
+
+            if (value > 1.0) value = 1.0;
+            if (value < -1.0) value = -1.0;
+            for (int c = 0; c < channels; c++) {
+                buffer[i * channels + c] = (float)(value * (1.0 - 0.1 * (c % 8)));
+            }
+        }
+
+        if (sf_writef_float(sf, buffer, count) != count) {
+            fprintf(stderr, "write error on %s: %s\n", path, sf_strerror(sf));
+            free(buffer);
+            sf_close(sf);
+            return 3;
+        }
+    }
+
+    free(buffer);
+    sf_close(sf);
+    return 0;
+}
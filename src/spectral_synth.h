@@ -0,0 +1,30 @@
+/*
+ * Copyright (C) 2025 - present Ondulab
+ * All rights reserved.
+ *
+ * This software is licensed under terms that can be found in the LICENSE file
+ * in the root directory of this software component.
+ */
+
+#ifndef SPECTRAL_SYNTH_H
+#define SPECTRAL_SYNTH_H
+
+#include "spectral_common.h"
+
+// Synthetic recordings of the benchmark and of the equivalence harness
+typedef enum SynthSignal {
+    SYNTH_SINE = 0,                     // 440 Hz + 3 kHz tones
+    SYNTH_CHIRP,                        // Exponential sweep over the whole duration
+    SYNTH_PINK,                         // Pink noise (Paul Kellet's filter)
+    SYNTH_IMPULSES,                     // One click every 0.5 s on a noise floor
+    SYNTH_SIGNAL_COUNT
+} SynthSignal;
+
+extern const char *synth_signal_names[SYNTH_SIGNAL_COUNT];
+
+// Function prototypes
+int synth_parse_signals(const char *text, int *signals, int max_signals);
+int synth_write_source(const char *path, SynthSignal signal, double duration,
+                       int sample_rate, int channels);
+
+#endif /* SPECTRAL_SYNTH_H */
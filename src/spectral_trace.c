@@ -0,0 +1,215 @@
+/*
+ * Copyright (C) 2025 - present Ondulab
+ * All rights reserved.
+ *
+ * This software is licensed under terms that can be found in the LICENSE file
+ * in the root directory of this software component.
+ */
+
+#define SPECTRAL_LOG_CATEGORY "trace"
+#include "spectral_common.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
+#define TRACE_BUFFER_EVENTS 4096    /* Events per buffer; a full buffer is chained */
+
+// One complete ("X") event of the timeline
+typedef struct TraceEvent {
+    const char *name;               // Static string
+    double      begin;              // Microseconds since the start of the trace
+    double      duration;           // Microseconds
+    const void *job;                // Job the work belongs to (may be NULL)
+    long long   bytes;              // Bytes processed, 0 if not relevant
+    long long   count;              // Items processed (FFTs, pages...), 0 if not relevant
+} TraceEvent;
+
+// Events of one thread; only the owning thread appends to it
+typedef struct TraceBuffer {
+    struct TraceBuffer *next;       // Next buffer of the global list
+    int         tid;                // Trace thread id of the owner
+    int         count;              // Events written, read and written atomically
+    TraceEvent  events[TRACE_BUFFER_EVENTS];
+} TraceBuffer;
+
+static TraceBuffer *volatile trace_buffers = NULL;     // Every buffer ever created
+static int trace_active = 0;                            // Read and written atomically
+static volatile int trace_next_tid = 0;
+static double trace_origin = 0.0;                       // Time of spectral_trace_start()
+static SPECTRAL_THREAD_LOCAL TraceBuffer *trace_current = NULL;
+static SPECTRAL_THREAD_LOCAL int trace_tid = -1;
+
+/*---------------------------------------------------------------------
+ * trace_now()
+ *
+ * Returns the monotonic time in microseconds.
+ *---------------------------------------------------------------------*/
+static double trace_now(void)
+{
+#ifdef _WIN32
+    return (double)GetTickCount64() * 1000.0;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e6 + (double)ts.tv_nsec / 1e3;
+#endif
+}
+
+/*---------------------------------------------------------------------
+ * trace_new_buffer()
+ *
+ * Allocates a buffer for the calling thread and pushes it on the global
+ * list without locking.
+ *---------------------------------------------------------------------*/
+static TraceBuffer *trace_new_buffer(void)
+{
+    TraceBuffer *buffer = (TraceBuffer *)malloc(sizeof(TraceBuffer));
+    if (buffer == NULL) {
+        return NULL;
+    }
+
+    if (trace_tid < 0) {
+        trace_tid = SPECTRAL_ATOMIC_INCREMENT(&trace_next_tid);
+    }
+    buffer->tid = trace_tid;
+    buffer->count = 0;
+
+#if defined(__GNUC__) || defined(__clang__)
+    TraceBuffer *head = __atomic_load_n(&trace_buffers, __ATOMIC_ACQUIRE);
+    do {
+        buffer->next = head;
+    } while (!__atomic_compare_exchange_n(&trace_buffers, &head, buffer, 1,
+                                          __ATOMIC_RELEASE, __ATOMIC_ACQUIRE));
+#else
+    buffer->next = trace_buffers;
+    trace_buffers = buffer;
+#endif
+    return buffer;
+}
+
+/*---------------------------------------------------------------------
+ * spectral_trace_start()
+ *
+ * Clears the recorded events and starts recording. The buffers of the
+ * threads are kept and reused.
+ *---------------------------------------------------------------------*/
+void spectral_trace_start(void)
+{
+    for (TraceBuffer *buffer = trace_buffers; buffer != NULL; buffer = buffer->next) {
+        SPECTRAL_ATOMIC_STORE(&buffer->count, 0);
+    }
+    trace_origin = trace_now();
+    // Publishes trace_origin to the threads that see the trace active
+    SPECTRAL_ATOMIC_STORE_RELEASE(&trace_active, 1);
+}
+
+/*---------------------------------------------------------------------
+ * spectral_trace_begin()
+ *
+ * Returns the timestamp to pass to spectral_trace_end(), or 0 when no
+ * trace is being recorded.
+ *---------------------------------------------------------------------*/
+double spectral_trace_begin(void)
+{
+    if (!SPECTRAL_ATOMIC_LOAD_ACQUIRE(&trace_active)) {
+        return 0.0;
+    }
+    double now = trace_now() - trace_origin;
+    return now > 0.0 ? now : 1e-3;
+}
+
+/*---------------------------------------------------------------------
+ * spectral_trace_end()
+ *
+ * Records the event started at begin in the calling thread's buffer.
+ * name must be a string with static lifetime.
+ *---------------------------------------------------------------------*/
+void spectral_trace_end(const SpectralJob *job, const char *name, double begin,
+                        long long bytes, long long count)
+{
+    if (!SPECTRAL_ATOMIC_LOAD_ACQUIRE(&trace_active) || begin <= 0.0) {
+        return;
+    }
+
+    TraceBuffer *buffer = trace_current;
+    if (buffer == NULL || SPECTRAL_ATOMIC_LOAD(&buffer->count) >= TRACE_BUFFER_EVENTS) {
+        buffer = trace_new_buffer();
+        if (buffer == NULL) {
+            return;
+        }
+        trace_current = buffer;
+    }
+
+    int index = SPECTRAL_ATOMIC_LOAD(&buffer->count);
+    TraceEvent *event = &buffer->events[index];
+    event->name = name;
+    event->begin = begin;
+    event->duration = trace_now() - trace_origin - begin;
+    event->job = job;
+    event->bytes = bytes;
+    event->count = count;
+
+    // Publish the event after its fields
+    SPECTRAL_ATOMIC_STORE_RELEASE(&buffer->count, index + 1);
+}
+
+/*---------------------------------------------------------------------
+ * spectral_trace_stop()
+ *
+ * Stops recording and writes the events as a Chrome trace (JSON Trace
+ * Event Format, readable by chrome://tracing and Perfetto). The events
+ * of generations still running when tracing stops may be missing.
+ *
+ * Returns:
+ *  - 0 on success, -1 if the file cannot be written.
+ *---------------------------------------------------------------------*/
+int spectral_trace_stop(const char *path)
+{
+    SPECTRAL_ATOMIC_STORE(&trace_active, 0);
+    if (path == NULL || path[0] == '\0') {
+        return 0;
+    }
+
+    FILE *out = fopen(path, "w");
+    if (out == NULL) {
+        spectral_log(NULL, SPECTRAL_LOG_ERROR, "Error: Could not write trace file %s\n", path);
+        return -1;
+    }
+
+    fputs("{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n", out);
+    int first = 1;
+    int named[1024] = {0};
+    for (TraceBuffer *buffer = trace_buffers; buffer != NULL; buffer = buffer->next) {
+        // Thread names, once per thread
+        if (buffer->tid < 1024 && !named[buffer->tid]) {
+            named[buffer->tid] = 1;
+            fprintf(out, "%s{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": %d, "
+                         "\"args\": {\"name\": \"thread %d\"}}",
+                    first ? "" : ",\n", buffer->tid, buffer->tid);
+            first = 0;
+        }
+
+        int count = SPECTRAL_ATOMIC_LOAD_ACQUIRE(&buffer->count);
+        for (int i = 0; i < count; i++) {
+            const TraceEvent *event = &buffer->events[i];
+            fprintf(out, "%s{\"name\": \"%s\", \"cat\": \"spectral\", \"ph\": \"X\", \"pid\": 1, \"tid\": %d, "
+                         "\"ts\": %.3f, \"dur\": %.3f, \"args\": {\"job\": \"%p\"",
+                    first ? "" : ",\n", event->name, buffer->tid,
+                    event->begin, event->duration, event->job);
+            if (event->bytes > 0) {
+                fprintf(out, ", \"bytes\": %lld", event->bytes);
+            }
+            if (event->count > 0) {
+                fprintf(out, ", \"count\": %lld", event->count);
+            }
+            fputs("}}", out);
+            first = 0;
+        }
+    }
+    fputs("\n]}\n", out);
+
+    int status = ferror(out) ? -1 : 0;
+    fclose(out);
+    return status;
+}
@@ -1,6 +1,9 @@
+#define SPECTRAL_LOG_CATEGORY "vector"
 #include "spectral_common.h"
 #include "spectral_wav_processing.h"
 #include "spectral_fft.h"
+#include "spectral_analyze.h"
+#include <stdint.h>
 #include <cairo/cairo-pdf.h>  // Ajout de l'en-tête spécifique pour les fonctions PDF
 
 /*---------------------------------------------------------------------
@@ -109,9 +112,10 @@ void draw_reference_lines_vector(cairo_t *cr, double spectro_x, double spectro_w
  *  - page_width_pt: Width of the page in points
  *  - page_height_pt: Height of the page in points
  *  - s: Spectrogram settings
+ *  - stats: Counters of the job so far, shown on a third line (may be NULL)
  *---------------------------------------------------------------------*/
 void draw_parameters_text_vector(cairo_t *cr, double page_width_pt, double page_height_pt,
-                                const SpectrogramSettings *s) {
+                                const SpectrogramSettings *s, const SpectralJobStats *stats) {
     // Formater la chaîne de paramètres sur deux lignes pour plus de lisibilité
     char line1[1024];
     char line2[1024];
@@ -172,76 +176,381 @@ void draw_parameters_text_vector(cairo_t *cr, double page_width_pt, double page_
     double text_y2 = page_height_pt - 15.0;
     cairo_move_to(cr, text_x2, text_y2);
     cairo_show_text(cr, line2);
+    
+    // Troisième ligne: compteurs de performance du job
+    if (stats != NULL) {
+        char line3[1024];
+        cairo_text_extents_t extents3;
+        spectral_job_stats_format(stats, line3, sizeof(line3));
+        cairo_text_extents(cr, line3, &extents3);
+        cairo_move_to(cr, (page_width_pt - extents3.width) / 2, page_height_pt - 5.0);
+        cairo_show_text(cr, line3);
+    }
+}
+
+/* Rectangle of merged spectrogram cells sharing one gray level:
+   windows [w0, w1) and rows [r0, r1) counted from index_min upwards */
+typedef struct {
+    int w0, w1;
+    int r0, r1;
+    int level;
+} GrayRect;
+
+/* Horizontal run of one row and the rectangle it belongs to */
+typedef struct {
+    int w0, w1;
+    int level;
+    int rect;
+} GrayRun;
+
+/* Gray level of an intensity (0-1) */
+static inline int gray_level(double intensity)
+{
+    int level = (int)(intensity * (SPECTRAL_PDF_GRAY_LEVELS - 1) + 0.5);
+    if (level < 0) return 0;
+    if (level > SPECTRAL_PDF_GRAY_LEVELS - 1) return SPECTRAL_PDF_GRAY_LEVELS - 1;
+    return level;
+}
+
+/* 8-bit gray of an intensity (0-1), for the embedded image */
+static inline uint32_t gray_byte(double intensity)
+{
+    int gray = (int)(intensity * 255.0 + 0.5);
+    if (gray < 0) return 0;
+    if (gray > 255) return 255;
+    return (uint32_t)gray;
 }
 
 /*---------------------------------------------------------------------
- * spectral_generator_vector_pdf_impl()
+ * draw_spectrogram_merged()
+ *
+ * Draws the spectrogram cells as filled rectangles. Intensities are
+ * quantized to SPECTRAL_PDF_GRAY_LEVELS gray levels, adjacent cells of
+ * the same level are merged into rectangles (runs along each row, then
+ * identical runs of consecutive rows), and every level is emitted as a
+ * single path with one fill, instead of one fill per cell. The counts
+ * go to the vectorRects and vectorFills counters of the job.
  *
- * Generates a vector PDF spectrogram with precise physical dimensions.
- * Uses Cairo PDF surface for high-quality vector output.
- * Uses exact parameters specified by the user without automatic adjustments.
- * 
  * Parameters:
- *  - cfg: Spectrogram settings structure
- *  - inputFile: Path to input WAV file
- *  - outputFile: Path to output PDF file
- *  - dpi: Requested DPI for the vector output (e.g. 800)
+ *  - cr: Cairo context
+ *  - spectrogram: Tone-mapped intensities (0-1), num_bins per window
+ *  - num_bins: Number of bins per window
+ *  - index_min, index_max: Drawn bins (lowest at the bottom)
+ *  - num_windows: Number of drawn windows
+ *  - spectro_x: Left position of the spectrogram
+ *  - spectro_bottom: Bottom position of the spectrogram
+ *  - window_width, bin_height: Size of a cell in points
+ *  - progress_base, progress_span: RASTER progress range of this call
+ *  - job: Cancellation context (may be NULL)
  *
  * Returns:
- *  - EXIT_SUCCESS on success, EXIT_FAILURE on error.
+ *  - EXIT_SUCCESS on success, EXIT_FAILURE on allocation error,
+ *    SPECTRAL_CANCELLED if the job was cancelled.
  *---------------------------------------------------------------------*/
-int spectral_generator_vector_pdf_impl(const SpectrogramSettings *cfg,
-                                      const char *inputFile,
-                                      const char *outputFile,
-                                      int dpi)
+static int draw_spectrogram_merged(cairo_t *cr, const double *spectrogram, int num_bins,
+                                   int index_min, int index_max, int num_windows,
+                                   double spectro_x, double spectro_bottom,
+                                   double window_width, double bin_height,
+                                   double progress_base, double progress_span,
+                                   SpectralJob *job)
 {
-    /* Copy configuration and fallback to defaults if necessary */
-    SpectrogramSettings s = *cfg;
-    double  minFreq       = DEFAULT_DBL(s.minFreq,        DEFAULT_MIN_FREQ);
-    double  maxFreq       = DEFAULT_DBL(s.maxFreq,        DEFAULT_MAX_FREQ);
-    double  writingSpeed  = DEFAULT_DBL(s.writingSpeed,   0.0);
-    double  duration      = DEFAULT_DBL(s.duration,       DEFAULT_DURATION);
-    int     sample_rate   = DEFAULT_INT(s.sampleRate,     DEFAULT_SAMPLE_RATE);
-    double  dynamicRangeDB = DEFAULT_DBL(s.dynamicRangeDB, DYNAMIC_RANGE_DB);
-    double  gammaCorr     = DEFAULT_DBL(s.gammaCorrection, GAMMA_CORRECTION);
-    int     enableDither  = DEFAULT_BOOL(s.enableDithering, ENABLE_DITHERING);
-    double  contrastFactor = DEFAULT_DBL(s.contrastFactor, CONTRAST_FACTOR);
-    double  binsPerSecond = DEFAULT_DBL(s.binsPerSecond,  DEFAULT_BINS_PER_SECOND);
-    int     overlapPreset = DEFAULT_INT(s.overlapPreset,  DEFAULT_OVERLAP_PRESET);
-    
-    // Détermination de la valeur d'overlap en fonction du préréglage
-    double overlap;
-    switch(overlapPreset) {
-        case 0: // Low
-            overlap = OVERLAP_PRESET_LOW;
-            printf(" - Using low overlap preset (%.2f)\n", overlap);
-            break;
-        case 2: // High
-            overlap = OVERLAP_PRESET_HIGH;
-            printf(" - Using high overlap preset (%.2f)\n", overlap);
-            break;
-        default: // Medium (default)
-            overlap = OVERLAP_PRESET_MEDIUM;
-            printf(" - Using medium overlap preset (%.2f)\n", overlap);
+    int num_rows = index_max - index_min + 1;
+    if (num_windows <= 0 || num_rows <= 0) {
+        return EXIT_SUCCESS;
+    }
+
+    GrayRun *prev_runs = (GrayRun *)malloc(num_windows * sizeof(GrayRun));
+    GrayRun *cur_runs  = (GrayRun *)malloc(num_windows * sizeof(GrayRun));
+    int rect_capacity = num_windows;
+    int rect_count = 0;
+    GrayRect *rects = (GrayRect *)malloc(rect_capacity * sizeof(GrayRect));
+    if (!prev_runs || !cur_runs || !rects) {
+        spectral_log(job, SPECTRAL_LOG_ERROR, "Error: Memory allocation failed for vector cells\n");
+        free(prev_runs);
+        free(cur_runs);
+        free(rects);
+        return EXIT_FAILURE;
+    }
+
+    int status = EXIT_SUCCESS;
+    int prev_count = 0;
+
+    /* 1. Fusionner les cellules, ligne par ligne depuis les basses fréquences */
+    for (int r = 0; r < num_rows && status == EXIT_SUCCESS; r++) {
+        if (r % SPECTRAL_JOB_POLL_INTERVAL == 0) {
+            if (spectral_job_should_stop(job)) {
+                status = SPECTRAL_CANCELLED;
+                break;
+            }
+            spectral_job_report(job, SPECTRAL_STAGE_RASTER,
+                                progress_base + progress_span * 0.5 * r / num_rows);
+        }
+
+        int b = index_min + r;
+        int cur_count = 0;
+        int p = 0;
+
+        for (int w = 0; w < num_windows; ) {
+            // Quantifier l'intensité, puis étendre la suite de même niveau
+            int level = gray_level(spectrogram[(size_t)w * num_bins + b]);
+            int w0 = w++;
+            while (w < num_windows && gray_level(spectrogram[(size_t)w * num_bins + b]) == level) {
+                w++;
+            }
+
+            // Les suites des deux lignes sont triées : la suite identique de la ligne
+            // précédente, s'il y en a une, commence au même endroit
+            while (p < prev_count && prev_runs[p].w0 < w0) {
+                p++;
+            }
+
+            GrayRun *run = &cur_runs[cur_count++];
+            run->w0 = w0;
+            run->w1 = w;
+            run->level = level;
+
+            if (p < prev_count && prev_runs[p].w0 == w0 && prev_runs[p].w1 == w &&
+                prev_runs[p].level == level) {
+                run->rect = prev_runs[p].rect;
+                rects[run->rect].r1 = r + 1;
+                continue;
+            }
+
+            if (rect_count == rect_capacity) {
+                int new_capacity = rect_capacity * 2;
+                GrayRect *grown = (GrayRect *)realloc(rects, new_capacity * sizeof(GrayRect));
+                if (!grown) {
+                    spectral_log(job, SPECTRAL_LOG_ERROR, "Error: Memory allocation failed for vector cells\n");
+                    status = EXIT_FAILURE;
+                    break;
+                }
+                rects = grown;
+                rect_capacity = new_capacity;
+            }
+            run->rect = rect_count;
+            rects[rect_count].w0 = w0;
+            rects[rect_count].w1 = w;
+            rects[rect_count].r0 = r;
+            rects[rect_count].r1 = r + 1;
+            rects[rect_count].level = level;
+            rect_count++;
+        }
+
+        GrayRun *swap = prev_runs;
+        prev_runs = cur_runs;
+        cur_runs = swap;
+        prev_count = cur_count;
+    }
+
+    free(prev_runs);
+    free(cur_runs);
+    if (status != EXIT_SUCCESS) {
+        free(rects);
+        return status;
+    }
+
+    /* 2. Trier les rectangles par niveau (tri par dénombrement) */
+    int *order = (int *)malloc(rect_count * sizeof(int));
+    int level_start[SPECTRAL_PDF_GRAY_LEVELS + 1] = {0};
+    if (!order) {
+        spectral_log(job, SPECTRAL_LOG_ERROR, "Error: Memory allocation failed for vector cells\n");
+        free(rects);
+        return EXIT_FAILURE;
+    }
+    for (int i = 0; i < rect_count; i++) {
+        level_start[rects[i].level + 1]++;
+    }
+    for (int l = 0; l < SPECTRAL_PDF_GRAY_LEVELS; l++) {
+        level_start[l + 1] += level_start[l];
+    }
+    {
+        int fill_pos[SPECTRAL_PDF_GRAY_LEVELS];
+        memcpy(fill_pos, level_start, sizeof(fill_pos));
+        for (int i = 0; i < rect_count; i++) {
+            order[fill_pos[rects[i].level]++] = i;
+        }
+    }
+
+    /* 3. Un chemin et un remplissage par niveau de gris */
+    int fills = 0;
+    for (int l = 0; l < SPECTRAL_PDF_GRAY_LEVELS; l++) {
+        if (spectral_job_should_stop(job)) {
+            status = SPECTRAL_CANCELLED;
             break;
+        }
+        if (level_start[l] == level_start[l + 1]) {
+            continue;
+        }
+
+        for (int i = level_start[l]; i < level_start[l + 1]; i++) {
+            const GrayRect *rect = &rects[order[i]];
+            cairo_rectangle(cr,
+                            spectro_x + rect->w0 * window_width,
+                            spectro_bottom - rect->r1 * bin_height,
+                            (rect->w1 - rect->w0) * window_width,
+                            (rect->r1 - rect->r0) * bin_height);
+        }
+
+        double gray = (double)l / (SPECTRAL_PDF_GRAY_LEVELS - 1);
+        cairo_set_source_rgb(cr, gray, gray, gray);
+        cairo_fill(cr);
+        fills++;
+
+        spectral_job_report(job, SPECTRAL_STAGE_RASTER,
+                            progress_base + progress_span * (0.5 + 0.5 * level_start[l + 1] / rect_count));
     }
-    
-    // Calcul de la taille FFT en fonction du bins/s et du préréglage d'overlap
-    double hopSize = sample_rate / binsPerSecond;
-    double diviseur = 1.0 - overlap;
-    double calculatedFftSize = hopSize / diviseur;
-    
-    // Arrondir à la puissance de 2 supérieure
-    int fft_size = 1;
-    while (fft_size < calculatedFftSize) {
-        fft_size *= 2;
+
+    if (status == EXIT_SUCCESS) {
+        spectral_log(job, SPECTRAL_LOG_INFO, " - Vector cells: %d merged into %d rectangles, %d fills\n",
+                     num_windows * num_rows, rect_count, fills);
+        SPECTRAL_JOB_COUNT(job, vectorRects, rect_count);
+        SPECTRAL_JOB_COUNT(job, vectorFills, fills);
     }
+
+    free(order);
+    free(rects);
+    return status;
+}
+
+/*---------------------------------------------------------------------
+ * draw_spectrogram_image()
+ *
+ * Draws the spectrogram area as a single 8-bit grayscale image with
+ * exactly dpi pixels per inch. Cairo embeds a gray-only image as a
+ * DeviceGray XObject with Flate compression, so the size of the file
+ * depends on the page and the DPI, not on the number of bins. Pixels
+ * are sampled from the nearest cell and drawn without interpolation.
+ *
+ * Parameters:
+ *  - cr: Cairo context
+ *  - spectrogram: Tone-mapped intensities (0-1), num_bins per window
+ *  - num_bins: Number of bins per window
+ *  - index_min, index_max: Drawn bins (lowest at the bottom)
+ *  - num_windows: Number of drawn windows
+ *  - x, y: Top left corner of the image in points
+ *  - width, height: Size of the image in points
+ *  - dpi: Resolution of the image
+ *  - progress_base, progress_span: RASTER progress range of this call
+ *  - job: Cancellation context (may be NULL)
+ *
+ * Returns:
+ *  - EXIT_SUCCESS on success, EXIT_FAILURE on allocation error,
+ *    SPECTRAL_CANCELLED if the job was cancelled.
+ *---------------------------------------------------------------------*/
+static int draw_spectrogram_image(cairo_t *cr, const double *spectrogram, int num_bins,
+                                  int index_min, int index_max, int num_windows,
+                                  double x, double y, double width, double height,
+                                  int dpi, double progress_base, double progress_span,
+                                  SpectralJob *job)
+{
+    int num_rows = index_max - index_min + 1;
+    int width_px = (int)ceil(width * dpi / POINTS_PER_INCH - 1e-6);
+    int height_px = (int)ceil(height * dpi / POINTS_PER_INCH - 1e-6);
+    if (num_windows <= 0 || num_rows <= 0 || width_px <= 0 || height_px <= 0) {
+        return EXIT_SUCCESS;
+    }
+
+    cairo_surface_t *image = cairo_image_surface_create(CAIRO_FORMAT_RGB24, width_px, height_px);
+    int *column_window = (int *)malloc(width_px * sizeof(int));
+    if (cairo_surface_status(image) != CAIRO_STATUS_SUCCESS || !column_window) {
+        spectral_log(job, SPECTRAL_LOG_ERROR, "Error: Unable to allocate a %dx%d spectrogram image\n",
+                     width_px, height_px);
+        cairo_surface_destroy(image);
+        free(column_window);
+        return EXIT_FAILURE;
+    }
+
+    spectral_log(job, SPECTRAL_LOG_INFO, " - Spectrogram image: %dx%d pixels at %d DPI\n",
+                 width_px, height_px, dpi);
+
+    // Fenêtre la plus proche du centre de chaque colonne de pixels
+    for (int px = 0; px < width_px; px++) {
+        int w = (int)((px + 0.5) * num_windows / width_px);
+        column_window[px] = w < num_windows ? w : num_windows - 1;
+    }
+
+    unsigned char *pixels = cairo_image_surface_get_data(image);
+    int stride = cairo_image_surface_get_stride(image);
+    int status = EXIT_SUCCESS;
+
+    cairo_surface_flush(image);
+    for (int py = 0; py < height_px; py++) {
+        if (py % SPECTRAL_JOB_POLL_INTERVAL == 0) {
+            if (spectral_job_should_stop(job)) {
+                status = SPECTRAL_CANCELLED;
+                break;
+            }
+            spectral_job_report(job, SPECTRAL_STAGE_RASTER,
+                                progress_base + progress_span * py / height_px);
+        }
+
+        // Les basses fréquences sont en bas de l'image
+        int r = num_rows - 1 - (int)((py + 0.5) * num_rows / height_px);
+        int b = index_min + (r < 0 ? 0 : r);
+        uint32_t *row = (uint32_t *)(pixels + (size_t)py * stride);
+
+        for (int px = 0; px < width_px; px++) {
+            row[px] = gray_byte(spectrogram[(size_t)column_window[px] * num_bins + b]) * 0x010101u;
+        }
+    }
+    cairo_surface_mark_dirty(image);
+    free(column_window);
+
+    if (status == EXIT_SUCCESS) {
+        cairo_save(cr);
+        cairo_translate(cr, x, y);
+        cairo_scale(cr, width / width_px, height / height_px);
+        cairo_set_source_surface(cr, image, 0, 0);
+        // Pas d'interpolation : chaque pixel reste net à l'impression
+        cairo_pattern_set_filter(cairo_get_source(cr), CAIRO_FILTER_NEAREST);
+        cairo_rectangle(cr, 0, 0, width_px, height_px);
+        cairo_fill(cr);
+        cairo_restore(cr);
+    }
+
+    cairo_surface_destroy(image);
+    return status;
+}
+
+/*---------------------------------------------------------------------
+ * vector_render_pdf()
+ *
+ * Draws an analyzed source into a vector PDF with precise physical
+ * dimensions. With s.paginate (and a writing speed) the whole recording
+ * is laid out on consecutive pages of the same document; the windows of
+ * each page are analyzed when it is drawn (spectral_page_matrix()), so
+ * the memory holds one page of the matrix. The spectrogram is only
+ * read, so several renders may share it.
+ *
+ * Parameters:
+ *  - src: Resolved settings of the analysis
+ *  - spectro: Tone-mapped spectrogram, or its shape when paginated
+ *  - inputFilePath: Path of the analyzed file, shown in the title
+ *  - outputFile: Path to output PDF file
+ *  - dpi: Requested DPI (e.g. 800), resolution of the spectrogram image
+ *         when s.pdfEmbedImage is set
+ *  - job: Cancellation context (may be NULL), polled every band of
+ *         drawn columns
+ *
+ * Returns:
+ *  - EXIT_SUCCESS on success, EXIT_FAILURE on error,
+ *    SPECTRAL_CANCELLED if the job was cancelled (the partial PDF is removed).
+ *---------------------------------------------------------------------*/
+static int vector_render_pdf(const SpectralSource *src,
+                             const SpectrogramData *spectro,
+                             const char *inputFilePath,
+                             const char *outputFile,
+                             int dpi,
+                             SpectralJob *job)
+{
+    SpectrogramSettings s = src->s;
+    double  minFreq       = src->minFreq;
+    double  maxFreq       = src->maxFreq;
+    double  writingSpeed  = src->writingSpeed;
+    int     sample_rate   = src->sampleRate;
+    double  binsPerSecond = src->binsPerSecond;
+    int     overlapPreset = src->overlapPreset;
     
-    printf(" - Calculated FFT size: %d (from bins/s=%.1f, overlap=%.2f)\n",
-           fft_size, binsPerSecond, overlap);
-    
-    /* Use default paths if input/output files are not specified */
-    const char* inputFilePath = DEFAULT_STR(inputFile, DEFAULT_INPUT_FILENAME);
     const char* outputFilePath = DEFAULT_STR(outputFile, DEFAULT_PDF_FILENAME);
     
     /* Validate DPI */
@@ -249,19 +558,9 @@ int spectral_generator_vector_pdf_impl(const SpectrogramSettings *cfg,
         dpi = 300; // Fallback to standard 300 DPI
     }
     
-    printf("Vector PDF generation parameters:\n");
-    printf(" - Resolution: %d DPI\n", dpi);
-    printf(" - FFT size: %d\n", fft_size);
-    printf(" - Overlap preset: %d (%s - %.2f)\n", overlapPreset,
-           overlapPreset == 0 ? "Low" :
-           overlapPreset == 2 ? "High" : "Medium",
-           overlap);
-    printf(" - Bins per second: %.1f\n", binsPerSecond);
-    printf(" - Min frequency: %f\n", minFreq);
-    printf(" - Max frequency: %f\n", maxFreq);
-    printf(" - Writing speed: %f cm/s\n", writingSpeed);
-    printf(" - Input file: %s\n", inputFilePath);
-    printf(" - Output file: %s\n", outputFilePath);
+    spectral_log(job, SPECTRAL_LOG_INFO, "Vector PDF generation parameters:\n");
+    spectral_log(job, SPECTRAL_LOG_INFO, " - Resolution: %d DPI\n", dpi);
+    spectral_log(job, SPECTRAL_LOG_INFO, " - Output file: %s\n", outputFilePath);
     
     /* ------------------------------ */
     /* 1. Calculate physical dimensions */
@@ -271,86 +570,19 @@ int spectral_generator_vector_pdf_impl(const SpectrogramSettings *cfg,
     if (s.pageFormat == 1) { // A3 paysage
         page_width_mm = A3_WIDTH_MM;
         page_height_mm = A3_HEIGHT_MM;
-        printf(" - Page format: A3 landscape (%.1f x %.1f mm)\n", page_width_mm, page_height_mm);
+        spectral_log(job, SPECTRAL_LOG_INFO, " - Page format: A3 landscape (%.1f x %.1f mm)\n", page_width_mm, page_height_mm);
     } else { // A4 portrait (par défaut)
         page_width_mm = A4_WIDTH_MM;
         page_height_mm = A4_HEIGHT_MM;
-        printf(" - Page format: A4 portrait (%.1f x %.1f mm)\n", page_width_mm, page_height_mm);
+        spectral_log(job, SPECTRAL_LOG_INFO, " - Page format: A4 portrait (%.1f x %.1f mm)\n", page_width_mm, page_height_mm);
     }
     
     // Conversion en points (unité PDF)
     double page_width_pt = page_width_mm * MM_TO_POINTS;
     double page_height_pt = page_height_mm * MM_TO_POINTS;
-    printf(" - Page dimensions: %.2f x %.2f points\n", page_width_pt, page_height_pt);
-    
-    /* ------------------------------ */
-    /* 2. Load audio signal from WAV  */
-    /* ------------------------------ */
-    int total_samples = 0;
-    double *signal = NULL;
-    
-    // Si une vitesse d'écriture est spécifiée, calculer la durée
-    if (writingSpeed > 0.0) {
-        // Calculer la durée: durée (s) = largeur (cm) / vitesse (cm/s)
-        double page_width_cm = page_width_mm / 10.0; // mm to cm
-        duration = page_width_cm / writingSpeed;
-        
-        // Mettre à jour la durée dans la structure s
-        s.duration = duration;
-        
-        printf(" - Calculated duration based on writing speed: %.2f seconds\n", duration);
-    }
-    
-    // Récupérer le paramètre de normalisation
-    int enableNormalization = DEFAULT_BOOL(s.enableNormalization, 1);
-    
-    printf(" - Loading WAV file with duration: %.2f seconds\n", s.duration);
-    printf(" - Normalization: %s\n", enableNormalization ? "enabled" : "disabled");
+    spectral_log(job, SPECTRAL_LOG_INFO, " - Page dimensions: %.2f x %.2f points\n", page_width_pt, page_height_pt);
     
-    if (load_wav_file(inputFilePath, &signal, &total_samples, &sample_rate, s.duration, enableNormalization) != 0) {
-        fprintf(stderr, "Error: Unable to load WAV file.\n");
-        return EXIT_FAILURE;
-    }
-    
-    // Apply audio processing if enabled (high-pass filter, etc.)
-    int enableHighPass = DEFAULT_BOOL(s.enableHighPassFilter, 0);
-    double highPassCutoff = DEFAULT_DBL(s.highPassCutoffFreq, 0.0);
-    int highPassOrder = DEFAULT_INT(s.highPassFilterOrder, 2);
-    int enableHighBoost = DEFAULT_BOOL(s.enableHighBoost, ENABLE_HIGH_BOOST);
-    double highBoostAlpha = DEFAULT_DBL(s.highBoostAlpha, HIGH_BOOST_ALPHA);
-    
-    if (enableHighPass && highPassCutoff > 0.0) {
-        printf(" - High-pass filter: enabled (cutoff = %.2f Hz, order = %d)\n", 
-               highPassCutoff, highPassOrder);
-        
-        double a[13] = {0};
-        double b[13] = {0};
-        design_highpass_filter(highPassCutoff, highPassOrder, sample_rate, a, b);
-        apply_highpass_filter(signal, total_samples, a, b, highPassOrder);
-    }
-    
-    if (enableHighBoost) {
-        apply_high_freq_boost_filter(signal, total_samples, highBoostAlpha);
-    }
-    
-    /* ------------------------------ */
-    /* 3. Compute spectrogram data    */
-    /* ------------------------------ */
-    SpectrogramData spectro_data = {0};
-    
-    if (compute_spectrogram(signal, total_samples, sample_rate, fft_size, overlapPreset, binsPerSecond,
-                           minFreq, maxFreq, &spectro_data) != 0) {
-        fprintf(stderr, "Error: Failed to compute spectrogram.\n");
-        free(signal);
-        return EXIT_FAILURE;
-    }
-    
-    // We no longer need the audio signal
-    free(signal);
-    signal = NULL;
-    
-    // Apply image processing
-    apply_image_processing(&spectro_data, dynamicRangeDB, gammaCorr, enableDither, contrastFactor);
+    const SpectrogramData spectro_data = *spectro;
     
     /* ------------------------------ */
     /* 4. Create PDF surface          */
@@ -358,31 +590,21 @@ int spectral_generator_vector_pdf_impl(const SpectrogramSettings *cfg,
     // Définir la surface PDF en utilisant les dimensions physiques
     cairo_surface_t *surface = cairo_pdf_surface_create(outputFilePath, page_width_pt, page_height_pt);
     if (cairo_surface_status(surface) != CAIRO_STATUS_SUCCESS) {
-        fprintf(stderr, "Error: Unable to create PDF surface.\n");
-        free(spectro_data.data);
+        spectral_log(job, SPECTRAL_LOG_ERROR, "Error: Unable to create PDF surface.\n");
         return EXIT_FAILURE;
     }
     
-    // Calculer le facteur d'échelle pour la résolution demandée
-    double scale_factor = dpi / POINTS_PER_INCH; // PDF utilise 72 points par pouce
-    (void)scale_factor; // Pour éviter le warning de variable non utilisée
-    
     // Créer le contexte Cairo
     cairo_t *cr = cairo_create(surface);
     if (cr == NULL) {
-        fprintf(stderr, "Error: Unable to create Cairo context.\n");
+        spectral_log(job, SPECTRAL_LOG_ERROR, "Error: Unable to create Cairo context.\n");
         cairo_surface_destroy(surface);
-        free(spectro_data.data);
         return EXIT_FAILURE;
     }
     
     // Appliquer la résolution au document PDF
     cairo_pdf_surface_set_size(surface, page_width_pt, page_height_pt);
     
-    // Fond blanc
-    cairo_set_source_rgb(cr, 1.0, 1.0, 1.0);
-    cairo_paint(cr);
-    
     /* ------------------------------ */
     /* 5. Définir les marges          */
     /* ------------------------------ */
@@ -413,114 +635,16 @@ int spectral_generator_vector_pdf_impl(const SpectrogramSettings *cfg,
     double spectro_x = margin_pt;
     double spectro_y = (page_height_pt - spectro_height_pt) / 2; // Centré verticalement
     
-    /* ------------------------------ */
-    /* 6. Dessiner le cadre et les axes */
-    /* ------------------------------ */
-    // Style des traits pour les vecteurs
-    cairo_set_line_width(cr, 0.5);
-    cairo_set_source_rgb(cr, 0.0, 0.0, 0.0);
-    
-    // Cadre du spectrogramme
-    cairo_rectangle(cr, spectro_x, spectro_y, spectro_width_pt, spectro_height_pt);
-    cairo_stroke(cr);
-    
     // Extraire les données du spectrogramme
     int num_windows = spectro_data.num_windows;
     int num_bins = spectro_data.num_bins;
     int index_min = spectro_data.index_min;
     int index_max = spectro_data.index_max;
-    double *spectrogram = spectro_data.data;
     double freq_range = maxFreq - minFreq;
     
-    // Draw vertical scale if enabled
-    if (s.enableVerticalScale) {
-        draw_vertical_scale_vector(cr, spectro_x, spectro_y, spectro_height_pt, minFreq, maxFreq);
-    } else {
-        // Grille fréquentielle (tous les 1kHz ou octaves selon l'échelle)
-        cairo_set_line_width(cr, 0.2);
-        cairo_set_source_rgba(cr, 0.5, 0.5, 0.5, 0.5);
-        
-        // Dessiner des lignes horizontales pour les fréquences (toutes les octaves)
-        cairo_select_font_face(cr, "Arial", CAIRO_FONT_SLANT_NORMAL, CAIRO_FONT_WEIGHT_NORMAL);
-        cairo_set_font_size(cr, 8);
-        
-        if (USE_LOG_FREQUENCY) {
-            // Échelle logarithmique par octaves
-            double octave_min = log2(minFreq);
-            double octave_max = log2(maxFreq);
-            
-            for (double octave = ceil(octave_min); octave <= floor(octave_max); octave += 1.0) {
-                double freq = pow(2.0, octave);
-                double y_pos = spectro_y + spectro_height_pt * (1.0 - (log2(freq) - octave_min) / (octave_max - octave_min));
-                
-                // Ligne horizontale
-                cairo_move_to(cr, spectro_x, y_pos);
-                cairo_line_to(cr, spectro_x + spectro_width_pt, y_pos);
-                cairo_stroke(cr);
-                
-                // Libellé de fréquence
-                char label[32];
-                if (freq >= 1000) {
-                    snprintf(label, sizeof(label), "%.1f kHz", freq / 1000.0);
-                } else {
-                    snprintf(label, sizeof(label), "%.0f Hz", freq);
-                }
-                
-                cairo_move_to(cr, spectro_x - 30, y_pos + 3);
-                cairo_show_text(cr, label);
-            }
-        } else {
-            // Échelle linéaire par paliers de 1 kHz
-            int step = 1000; // 1 kHz par ligne
-            if (freq_range > 10000) step = 2000; // Adapter pour les grandes plages
-            
-            for (int freq = ((int)minFreq / step) * step; freq <= maxFreq; freq += step) {
-                if (freq < minFreq) continue;
-                
-                double y_pos = spectro_y + spectro_height_pt * (1.0 - (freq - minFreq) / freq_range);
-                
-                // Ligne horizontale
-                cairo_move_to(cr, spectro_x, y_pos);
-                cairo_line_to(cr, spectro_x + spectro_width_pt, y_pos);
-                cairo_stroke(cr);
-                
-                // Libellé de fréquence
-                char label[32];
-                if (freq >= 1000) {
-                    snprintf(label, sizeof(label), "%d kHz", freq / 1000);
-                } else {
-                    snprintf(label, sizeof(label), "%d Hz", freq);
-                }
-                
-                cairo_move_to(cr, spectro_x - 30, y_pos + 3);
-                cairo_show_text(cr, label);
-            }
-        }
-    }
-    
     /* ------------------------------ */
     /* 7. Dessiner le spectrogramme   */
     /* ------------------------------ */
-    // Calculate visible windows based on physical dimensions and writing speed
-    int visible_windows = num_windows;
-    // Réutiliser le hopSize déjà calculé précédemment
-    double audio_duration = (double)spectro_data.num_windows * hopSize / sample_rate;
-    
-    if (writingSpeed > 0.0) {
-        double page_width_cm = page_width_mm / 10.0;
-        double spectrogram_width_cm = audio_duration * writingSpeed;
-        
-        if (spectrogram_width_cm > page_width_cm) {
-            // Truncate to what fits on the page, but keep the scale exact
-            double visible_duration = page_width_cm / writingSpeed;
-            visible_windows = (int)(num_windows * (visible_duration / audio_duration));
-            
-            printf(" - Spectrogram exceeds page width, truncating to %d windows\n", visible_windows);
-            printf(" - Shows first %.2f seconds (%.2f%% of total %.2f seconds)\n",
-                  visible_duration, (visible_duration * 100.0 / audio_duration), audio_duration);
-        }
-    }
-    
     // Calculer la taille d'un pixel du spectrogramme
     
     // Modification pour adaptation dynamique de l'espacement entre bins
@@ -534,91 +658,303 @@ int spectral_generator_vector_pdf_impl(const SpectrogramSettings *cfg,
     
     double bin_height = spectro_height_pt / (index_max - index_min + 1);
     
-    printf(" - Vector window width: %.3f points\n", window_width);
-    printf(" - Adaptive spacing: %.3f points per bin (%.3f cm per bin)\n", 
+    spectral_log(job, SPECTRAL_LOG_INFO, " - Vector window width: %.3f points\n", window_width);
+    spectral_log(job, SPECTRAL_LOG_INFO, " - Adaptive spacing: %.3f points per bin (%.3f cm per bin)\n", 
            window_width, cm_per_window);
     
-    // Dessiner chaque "pixel" du spectrogramme avec des rectangles vectoriels
-    for (int w = 0; w < visible_windows; w++) {
-        // Position X du "pixel"
-        double x = spectro_x + w * window_width;
+    // Chaque page contient le même nombre entier de fenêtres, celles qui tiennent
+    // entre les marges ; les colonnes se suivent donc sans rupture d'une page à
+    // l'autre. L'analyse a été planifiée sur la mise en page PNG, plus large :
+    // sans pagination, seule la première page est dessinée.
+    int windows_per_page = num_windows;
+    int page_count = 1;
+    if (writingSpeed > 0.0) {
+        int fitting_windows = (int)floor(spectro_width_pt / window_width);
+        if (fitting_windows < 1) fitting_windows = 1;
+        if (fitting_windows < windows_per_page) {
+            windows_per_page = fitting_windows;
+        }
+    }
+    if (s.paginate == 1 && writingSpeed > 0.0) {
+        page_count = (num_windows + windows_per_page - 1) / windows_per_page;
+        if (page_count < 1) page_count = 1;
+        spectral_log(job, SPECTRAL_LOG_INFO, " - Pagination: %d windows on %d pages of %d windows (%.2f s per page)\n",
+                     num_windows, page_count, windows_per_page, windows_per_page / binsPerSecond);
+    }
+    
+    for (int page = 0; page < page_count; page++) {
+        int first_window = page * windows_per_page;
+        int page_windows = num_windows - first_window;
+        if (page_windows > windows_per_page) page_windows = windows_per_page;
+        SpectrogramData page_matrix;
+        int page_status = spectral_page_matrix(src, spectro, first_window, page_windows, &page_matrix, job);
+        if (page_status != EXIT_SUCCESS) {
+            cairo_destroy(cr);
+            cairo_surface_destroy(surface);
+            remove(outputFilePath);
+            return page_status;
+        }
+        SpectralStageTimer timer;
+        spectral_stage_begin(job, SPECTRAL_STAGE_RASTER, &timer);
+        double trace = spectral_trace_begin();
+        const double *page_spectrogram = page_matrix.data;
+        double progress_base = (double)page / page_count;
+        double progress_span = 1.0 / page_count;
         
-        for (int b = index_min; b <= index_max; b++) {
-            // Intensité du "pixel" (0-1)
-            double intensity = spectrogram[w * num_bins + b];
-            
-            // Calculer la position Y (inversée pour mettre les basses fréquences en bas)
-            double y = spectro_y + spectro_height_pt - (b - index_min + 1) * bin_height;
+        // Fond blanc
+        cairo_set_source_rgb(cr, 1.0, 1.0, 1.0);
+        cairo_paint(cr);
+        
+        /* ------------------------------ */
+        /* 6. Dessiner le cadre et les axes */
+        /* ------------------------------ */
+        // Style des traits pour les vecteurs
+        cairo_set_line_width(cr, 0.5);
+        cairo_set_source_rgb(cr, 0.0, 0.0, 0.0);
+        
+        // Cadre du spectrogramme
+        cairo_rectangle(cr, spectro_x, spectro_y, spectro_width_pt, spectro_height_pt);
+        cairo_stroke(cr);
+        
+        // Draw vertical scale if enabled
+        if (s.enableVerticalScale) {
+            draw_vertical_scale_vector(cr, spectro_x, spectro_y, spectro_height_pt, minFreq, maxFreq);
+        } else {
+            // Grille fréquentielle (tous les 1kHz ou octaves selon l'échelle)
+            cairo_set_line_width(cr, 0.2);
+            cairo_set_source_rgba(cr, 0.5, 0.5, 0.5, 0.5);
+        
+            // Dessiner des lignes horizontales pour les fréquences (toutes les octaves)
+            cairo_select_font_face(cr, "Arial", CAIRO_FONT_SLANT_NORMAL, CAIRO_FONT_WEIGHT_NORMAL);
+            cairo_set_font_size(cr, 8);
+        
+            if (USE_LOG_FREQUENCY) {
+                // Échelle logarithmique par octaves
+                double octave_min = log2(minFreq);
+                double octave_max = log2(maxFreq);
             
-            // Définir la couleur en niveaux de gris
-            cairo_set_source_rgb(cr, intensity, intensity, intensity);
+                for (double octave = ceil(octave_min); octave <= floor(octave_max); octave += 1.0) {
+                    double freq = pow(2.0, octave);
+                    double y_pos = spectro_y + spectro_height_pt * (1.0 - (log2(freq) - octave_min) / (octave_max - octave_min));
+                
+                    // Ligne horizontale
+                    cairo_move_to(cr, spectro_x, y_pos);
+                    cairo_line_to(cr, spectro_x + spectro_width_pt, y_pos);
+                    cairo_stroke(cr);
+                
+                    // Libellé de fréquence
+                    char label[32];
+                    if (freq >= 1000) {
+                        snprintf(label, sizeof(label), "%.1f kHz", freq / 1000.0);
+                    } else {
+                        snprintf(label, sizeof(label), "%.0f Hz", freq);
+                    }
+                
+                    cairo_move_to(cr, spectro_x - 30, y_pos + 3);
+                    cairo_show_text(cr, label);
+                }
+            } else {
+                // Échelle linéaire par paliers de 1 kHz
+                int step = 1000; // 1 kHz par ligne
+                if (freq_range > 10000) step = 2000; // Adapter pour les grandes plages
             
-            // Dessiner le rectangle
-            cairo_rectangle(cr, x, y, window_width, bin_height);
-            cairo_fill(cr);
+                for (int freq = ((int)minFreq / step) * step; freq <= maxFreq; freq += step) {
+                    if (freq < minFreq) continue;
+                
+                    double y_pos = spectro_y + spectro_height_pt * (1.0 - (freq - minFreq) / freq_range);
+                
+                    // Ligne horizontale
+                    cairo_move_to(cr, spectro_x, y_pos);
+                    cairo_line_to(cr, spectro_x + spectro_width_pt, y_pos);
+                    cairo_stroke(cr);
+                
+                    // Libellé de fréquence
+                    char label[32];
+                    if (freq >= 1000) {
+                        snprintf(label, sizeof(label), "%d kHz", freq / 1000);
+                    } else {
+                        snprintf(label, sizeof(label), "%d Hz", freq);
+                    }
+                
+                    cairo_move_to(cr, spectro_x - 30, y_pos + 3);
+                    cairo_show_text(cr, label);
+                }
+            }
         }
-    }
-    
-    // Draw reference lines if enabled
-    if (s.enableBottomReferenceLine || s.enableTopReferenceLine) {
-        draw_reference_lines_vector(cr, spectro_x, spectro_width_pt, spectro_y, spectro_height_pt,
-                                   s.enableBottomReferenceLine, s.bottomReferenceLineOffset,
-                                   s.enableTopReferenceLine, s.topReferenceLineOffset);
+        
+        // Dessiner le spectrogramme : image à la résolution demandée (mode hybride)
+        // ou cellules vectorielles fusionnées par niveau de gris
+        int draw_status;
+        if (s.pdfEmbedImage == 1) {
+            draw_status = draw_spectrogram_image(cr, page_spectrogram, num_bins, index_min, index_max,
+                                                 page_windows, spectro_x, spectro_y,
+                                                 page_windows * window_width, spectro_height_pt,
+                                                 dpi, progress_base, progress_span, job);
+        } else {
+            draw_status = draw_spectrogram_merged(cr, page_spectrogram, num_bins, index_min, index_max,
+                                                  page_windows, spectro_x, spectro_y + spectro_height_pt,
+                                                  window_width, bin_height, progress_base, progress_span, job);
+        }
+        spectral_page_matrix_release(spectro, &page_matrix, job);
+        if (draw_status != EXIT_SUCCESS) {
+            spectral_stage_end(job, SPECTRAL_STAGE_RASTER, &timer);
+            if (draw_status == SPECTRAL_CANCELLED) {
+                spectral_log(job, SPECTRAL_LOG_INFO, " - Vector rendering cancelled\n");
+            }
+            cairo_destroy(cr);
+            cairo_surface_destroy(surface);
+            // Cairo a déjà commencé à écrire le fichier : ne pas laisser un PDF partiel
+            remove(outputFilePath);
+            return draw_status;
+        }
+        
+        // Draw reference lines if enabled
+        if (s.enableBottomReferenceLine || s.enableTopReferenceLine) {
+            draw_reference_lines_vector(cr, spectro_x, spectro_width_pt, spectro_y, spectro_height_pt,
+                                       s.enableBottomReferenceLine, s.bottomReferenceLineOffset,
+                                       s.enableTopReferenceLine, s.topReferenceLineOffset);
+        }
+        
+        /* ------------------------------ */
+        /* 8. Ajouter les méta-informations */
+        /* ------------------------------ */
+        // Titre du document
+        cairo_select_font_face(cr, "Arial", CAIRO_FONT_SLANT_NORMAL, CAIRO_FONT_WEIGHT_BOLD);
+        cairo_set_font_size(cr, 14);
+        cairo_set_source_rgb(cr, 0.0, 0.0, 0.0);
+        
+        char title[256];
+        if (page_count > 1) {
+            snprintf(title, sizeof(title), "Spectrogram: %s (%d/%d)", inputFilePath, page + 1, page_count);
+        } else {
+            snprintf(title, sizeof(title), "Spectrogram: %s", inputFilePath);
+        }
+        
+        cairo_text_extents_t extents;
+        cairo_text_extents(cr, title, &extents);
+        cairo_move_to(cr, (page_width_pt - extents.width) / 2, margin_pt / 2);
+        cairo_show_text(cr, title);
+        
+        // Informations sur les paramètres
+        cairo_select_font_face(cr, "Arial", CAIRO_FONT_SLANT_NORMAL, CAIRO_FONT_WEIGHT_NORMAL);
+        cairo_set_font_size(cr, 8);
+        
+        char info[256];
+        const char* overlapText;
+        switch(overlapPreset) {
+            case 0: overlapText = "Low"; break;
+            case 2: overlapText = "High"; break;
+            default: overlapText = "Medium"; break;
+        }
+        
+        snprintf(info, sizeof(info),
+                 "Bins/s: %.1f, Overlap: %s, Freq: %.0f-%.0f Hz, Resolution: %d DPI",
+                 binsPerSecond, overlapText, minFreq, maxFreq, dpi);
+        
+        cairo_text_extents(cr, info, &extents);
+        cairo_move_to(cr, (page_width_pt - extents.width) / 2, page_height_pt - margin_pt / 2);
+        cairo_show_text(cr, info);
+        
+        // Display parameters if enabled
+        if (s.displayParameters) {
+            draw_parameters_text_vector(cr, page_width_pt, page_height_pt, &s, job != NULL ? &job->stats : NULL);
+        }
+        
+        // Terminer la page (Cairo écrit son contenu dans le PDF)
+        cairo_show_page(cr);
+        spectral_trace_end(job, "pdf_page", trace, 0, page_windows);
+        spectral_stage_end(job, SPECTRAL_STAGE_RASTER, &timer);
     }
     
     /* ------------------------------ */
-    /* 8. Ajouter les méta-informations */
+    /* 9. Finaliser et sauvegarder    */
     /* ------------------------------ */
-    // Titre du document
-    cairo_select_font_face(cr, "Arial", CAIRO_FONT_SLANT_NORMAL, CAIRO_FONT_WEIGHT_BOLD);
-    cairo_set_font_size(cr, 14);
-    cairo_set_source_rgb(cr, 0.0, 0.0, 0.0);
+    spectral_job_report(job, SPECTRAL_STAGE_RASTER, 1.0);
+    spectral_job_report(job, SPECTRAL_STAGE_ENCODE, 0.0);
     
-    char title[256];
-    snprintf(title, sizeof(title), "Spectrogram: %s", inputFilePath);
+    // Nettoyer (Cairo termine le PDF à la destruction de la surface)
+    SpectralStageTimer timer;
+    spectral_stage_begin(job, SPECTRAL_STAGE_ENCODE, &timer);
+    double trace = spectral_trace_begin();
+    cairo_destroy(cr);
+    cairo_surface_destroy(surface);
+    spectral_trace_end(job, "pdf_encode", trace, 0, page_count);
+    spectral_stage_end(job, SPECTRAL_STAGE_ENCODE, &timer);
     
-    cairo_text_extents_t extents;
-    cairo_text_extents(cr, title, &extents);
-    cairo_move_to(cr, (page_width_pt - extents.width) / 2, margin_pt / 2);
-    cairo_show_text(cr, title);
+    spectral_job_report(job, SPECTRAL_STAGE_ENCODE, 1.0);
     
-    // Informations sur les paramètres
-    cairo_select_font_face(cr, "Arial", CAIRO_FONT_SLANT_NORMAL, CAIRO_FONT_WEIGHT_NORMAL);
-    cairo_set_font_size(cr, 8);
+    spectral_log(job, SPECTRAL_LOG_INFO, "Vector PDF spectrogram generated successfully at %d DPI: %s\n", dpi, outputFilePath);
     
-    char info[256];
-    const char* overlapText;
-    switch(overlapPreset) {
-        case 0: overlapText = "Low"; break;
-        case 2: overlapText = "High"; break;
-        default: overlapText = "Medium"; break;
+    return EXIT_SUCCESS;
+}
+
+/*---------------------------------------------------------------------
+ * spectral_render_vector_pdf()
+ *
+ * Renders an analysis as a vector PDF, in the page layout of the
+ * analysis, with the overlay settings of cfg (NULL = those of the
+ * analysis).
+ *
+ * Returns:
+ *  - EXIT_SUCCESS on success, EXIT_FAILURE on error,
+ *    SPECTRAL_CANCELLED if the job was cancelled.
+ *---------------------------------------------------------------------*/
+int spectral_render_vector_pdf(const SpectralAnalysis *analysis,
+                               const SpectrogramSettings *cfg,
+                               const char *outputFile,
+                               int dpi,
+                               SpectralJob *job)
+{
+    if (analysis == NULL) {
+        return EXIT_FAILURE;
     }
     
-    snprintf(info, sizeof(info),
-             "Bins/s: %.1f, Overlap: %s, Freq: %.0f-%.0f Hz, Resolution: %d DPI",
-             binsPerSecond, overlapText, minFreq, maxFreq, dpi);
-    
-    cairo_text_extents(cr, info, &extents);
-    cairo_move_to(cr, (page_width_pt - extents.width) / 2, page_height_pt - margin_pt / 2);
-    cairo_show_text(cr, info);
-    
-    // Display parameters if enabled
-    if (s.displayParameters) {
-        draw_parameters_text_vector(cr, page_width_pt, page_height_pt, &s);
+    SpectralSource view;
+    spectral_source_with_layout(&analysis->src, cfg, &view, job);
+    return vector_render_pdf(&view, &analysis->data, analysis->inputFile, outputFile, dpi, job);
+}
+
+/*---------------------------------------------------------------------
+ * spectral_generator_vector_pdf_impl()
+ *
+ * Generates a vector PDF spectrogram with precise physical dimensions.
+ * Uses Cairo PDF surface for high-quality vector output.
+ * The settings are resolved as for the PNG (bins/s from the writing
+ * speed, precalculated FFT size), so both formats can share one analysis;
+ * dithering is left out, since the PDF cells are quantized to
+ * SPECTRAL_PDF_GRAY_LEVELS levels.
+ * 
+ * Parameters:
+ *  - cfg: Spectrogram settings structure
+ *  - inputFile: Path to input WAV file
+ *  - outputFile: Path to output PDF file
+ *  - dpi: Requested DPI (e.g. 800), resolution of the spectrogram image
+ *         when s.pdfEmbedImage is set
+ *  - job: Cancellation context (may be NULL), polled every block of FFT
+ *         windows and every band of drawn columns
+ *
+ * Returns:
+ *  - EXIT_SUCCESS on success, EXIT_FAILURE on error,
+ *    SPECTRAL_CANCELLED if the job was cancelled (the partial PDF is removed).
+ *---------------------------------------------------------------------*/
+int spectral_generator_vector_pdf_impl(const SpectrogramSettings *cfg,
+                                      const char *inputFile,
+                                      const char *outputFile,
+                                      int dpi,
+                                      SpectralJob *job)
+{
+    // Pas de dithering : son bruit sépare les cellules voisines d'un même
+    // niveau de gris, qui ne fusionnent plus
+    SpectrogramSettings settings = *cfg;
+    settings.enableDithering = 0;
+    
+    SpectralAnalysis *analysis = NULL;
+    int status = spectral_analyze(&settings, inputFile, &analysis, job);
+    if (status != EXIT_SUCCESS) {
+        return status;
     }
     
-    /* ------------------------------ */
-    /* 9. Finaliser et sauvegarder    */
-    /* ------------------------------ */
-    // Afficher la page et nettoyer
-    cairo_show_page(cr);
-    cairo_destroy(cr);
-    cairo_surface_destroy(surface);
-    
-    // Libérer la mémoire
-    free(spectro_data.data);
-    
-    printf("Vector PDF spectrogram generated successfully at %d DPI: %s\n", dpi, outputFilePath);
-    
-    return EXIT_SUCCESS;
+    status = spectral_render_vector_pdf(analysis, NULL, outputFile, dpi, job);
+    spectral_analysis_free(analysis);
+    return status;
 }
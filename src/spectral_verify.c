@@ -0,0 +1,1180 @@
+/*
+ * Copyright (C) 2025 - present Ondulab
+ * All rights reserved.
+ *
+ * This software is licensed under terms that can be found in the LICENSE file
+ * in the root directory of this software component.
+ */
+
+/*
+ * Equivalence harness of the analysis and raster kernels.
+ *
+ * Every optimized variant of a stage (FFT, tone mapping, raster page)
+ * is compared with the frozen reference of spectral_reference.c on a
+ * corpus of synthetic recordings. Each stage is isolated: it receives
+ * the reference output of the previous stage, so a difference is always
+ * attributed to the stage that produced it. The FFT is compared with a
+ * relative tolerance, the tone mapping with an absolute one and the
+ * page pixel by pixel; the level differences are printed as histograms.
+ * The multi-resolution FFT is only expected to match above its
+ * crossover, within the interpolation error of its short transform;
+ * its low band is checked on synthetic tones instead: the level of a
+ * tone below the crossover, and the alias of a tone above it. The
+ * constant-Q engine has no reference either: a sine at the center of a
+ * bin, one per octave, must peak on that row at half its amplitude.
+ * The parallel decoder of the compressed formats is compared with its
+ * serial decoding, on the recording re-encoded as FLAC and Ogg Vorbis.
+ * The merged cells of the vector PDF are measured against the per-cell
+ * drawing they replaced: fewer rectangles, one fill per gray level at
+ * most, and a file that is a fraction of the per-cell one.
+ * A variant outside its tolerance fails the run (exit status 1).
+ *
+ * With --concurrent N, the variants are replaced by a stress test of the
+ * whole generation: N jobs render every recording at the same time, with
+ * VERIFY_CONCURRENT_SEEDS seeds, a shared plan cache and parallel loops.
+ * Each page must be identical, pixel for pixel, to the serial render of
+ * its seed. Built with CONFIG+=tsan (verify/Sp3ctraGenVerify.pro), the
+ * run also checks the concurrent jobs under ThreadSanitizer.
+ *
+ * Une nouvelle variante (SIMD, GPU, autre bibliothèque FFT) s'ajoute à
+ * la table verify_variants avec l'étape qu'elle remplace.
+ */
+
+#include "spectral_common.h"
+#include "spectral_analyze.h"
+#include "spectral_cqt.h"
+#include "spectral_decoder.h"
+#include "spectral_reference.h"
+#include "spectral_synth.h"
+#include <pthread.h>
+#include <stdint.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define VERIFY_MAX_VALUES   16          /* Values per corpus dimension */
+#define VERIFY_MAX_THREADS  8           /* Threads of the parallel variants */
+#define VERIFY_BUCKETS      10          /* Buckets of the level histograms */
+#define VERIFY_SEED         0x5eed0fULL /* Dithering seed of every job */
+#define VERIFY_MAX_CONCURRENT   64      /* Jobs of --concurrent */
+#define VERIFY_CONCURRENT_SEEDS 4       /* Seeds shared by the concurrent jobs */
+#define VERIFY_DECODE_RANGES    4       /* Ranges of the parallel decoding variants */
+
+typedef enum VerifyStage {
+    VERIFY_STAGE_FFT = 0,
+    VERIFY_STAGE_TONE_MAP,
+    VERIFY_STAGE_RASTER,
+    VERIFY_STAGE_FFT_HYBRID,        // Multi-resolution FFT, above the crossover
+    VERIFY_STAGE_LOW_LEVEL,         // Its low band: level of a tone, relative
+    VERIFY_STAGE_LOW_ALIAS,         // Its low band: alias of a higher tone, relative to it
+    VERIFY_STAGE_CQT,               // Constant-Q engine: level of a tone per octave, relative
+    VERIFY_STAGE_DECODE,            // Parallel decoding: samples against the serial decoding
+    VERIFY_STAGE_VECTOR,            // Merged PDF cells: file size relative to the per-cell drawing
+    VERIFY_STAGE_COUNT
+} VerifyStage;
+
+/* Upper bound of every histogram bucket, in 8-bit levels */
+static const int verify_bucket_limits[VERIFY_BUCKETS] = {0, 1, 2, 4, 8, 16, 32, 64, 128, 255};
+
+/* One recording of the corpus and the reference output of every stage */
+typedef struct VerifyPoint {
+    SpectralSource  src;
+    SpectrogramData fft;            // reference_compute_spectrogram()
+    SpectrogramData tone;           // reference_tone_map() of fft
+    const char     *source;         // Path of the recording
+    const char     *workdir;
+} VerifyPoint;
+
+typedef struct VerifyResult {
+    double      max_error;          // Relative (FFT), absolute (tone map) or levels (raster)
+    long long   histogram[VERIFY_BUCKETS];
+    long long   compared;           // Values or pixel channels compared
+    char        detail[160];        // Structural mismatch, empty if none
+    char        note[160];          // Information that does not fail the variant
+} VerifyResult;
+
+typedef int (*VerifyFunction)(const VerifyPoint *point, SpectralJob *job, VerifyResult *result);
+
+typedef struct VerifyVariant {
+    const char     *name;
+    VerifyStage     stage;
+    int             parallel;       // Runs with verify_parallel_for() installed
+    VerifyFunction  run;
+} VerifyVariant;
+
+typedef struct VerifyOptions {
+    double  tolerance[VERIFY_STAGE_COUNT];
+    int     threads;
+    const char *variant_filter;     // Substring of the variant names, NULL = all
+    int     concurrent;             // Jobs of the stress test, 0 = run the variants
+} VerifyOptions;
+
+/*---------------------------------------------------------------------
+ * Parallel loop of the parallel variants: a fixed number of threads,
+ * thread t running the indices t, t + n, t + 2n... The result must not
+ * depend on that split.
+ *---------------------------------------------------------------------*/
+typedef struct VerifyWorker {
+    int     first;
+    int     stride;
+    int     count;
+    void  (*body)(void *arg, int index);
+    void   *arg;
+} VerifyWorker;
+
+static void *verify_worker(void *arg)
+{
+    VerifyWorker *worker = (VerifyWorker *)arg;
+    for (int i = worker->first; i < worker->count; i += worker->stride) {
+        worker->body(worker->arg, i);
+    }
+    return NULL;
+}
+
+static void verify_parallel_for(void *userData, int count,
+                                void (*body)(void *arg, int index), void *arg)
+{
+    int threads = *(const int *)userData;
+    if (threads > count) threads = count;
+    if (threads < 1) threads = 1;
+
+    pthread_t ids[VERIFY_MAX_THREADS];
+    VerifyWorker workers[VERIFY_MAX_THREADS];
+    int started = 0;
+    for (int t = 0; t < threads; t++) {
+        workers[t].first = t;
+        workers[t].stride = threads;
+        workers[t].count = count;
+        workers[t].body = body;
+        workers[t].arg = arg;
+        if (t > 0 && pthread_create(&ids[t], NULL, verify_worker, &workers[t]) == 0) {
+            started |= 1 << t;
+        } else if (t > 0) {
+            verify_worker(&workers[t]);
+        }
+    }
+    verify_worker(&workers[0]);
+    for (int t = 1; t < threads; t++) {
+        if (started & (1 << t)) {
+            pthread_join(ids[t], NULL);
+        }
+    }
+}
+
+/* Adds a difference in 8-bit levels to the histogram */
+static void verify_count_levels(VerifyResult *result, int levels)
+{
+    int bucket = 0;
+    while (bucket < VERIFY_BUCKETS - 1 && levels > verify_bucket_limits[bucket]) {
+        bucket++;
+    }
+    result->histogram[bucket]++;
+    result->compared++;
+}
+
+/* Copies a spectrogram (released with free()) */
+static int verify_copy_spectrogram(const SpectrogramData *from, SpectrogramData *to)
+{
+    *to = *from;
+    size_t bytes = (size_t)from->num_windows * from->num_bins * sizeof(double);
+    to->data = (double *)malloc(bytes);
+    if (to->data == NULL) {
+        return 1;
+    }
+    memcpy(to->data, from->data, bytes);
+    return 0;
+}
+
+/* Compares the shapes of two spectrograms; a mismatch is written to the result */
+static int verify_same_shape(const SpectrogramData *a, const SpectrogramData *b, VerifyResult *result)
+{
+    if (a->num_windows == b->num_windows && a->num_bins == b->num_bins &&
+        a->index_min == b->index_min && a->index_max == b->index_max) {
+        return 1;
+    }
+    snprintf(result->detail, sizeof(result->detail),
+             "shape %d x %d, bins %d-%d (reference %d x %d, bins %d-%d)",
+             a->num_windows, a->num_bins, a->index_min, a->index_max,
+             b->num_windows, b->num_bins, b->index_min, b->index_max);
+    return 0;
+}
+
+/*---------------------------------------------------------------------
+ * verify_compare_fft()
+ *
+ * compute_spectrogram() on the decoded signal with the given padding,
+ * against the reference transform, over the drawn bins from first_bin.
+ * The error is relative to the reference global maximum.
+ *
+ * Returns:
+ *  - EXIT_SUCCESS on success, EXIT_FAILURE if the transform failed.
+ *---------------------------------------------------------------------*/
+static int verify_compare_fft(const VerifyPoint *point, SpectralJob *job, int pad_size,
+                              int first_bin, VerifyResult *result)
+{
+    const SpectralSource *src = &point->src;
+    SpectrogramData data;
+    memset(&data, 0, sizeof(data));
+    if (compute_spectrogram(src->signal, src->totalSamples, 0, point->fft.num_windows, src->sampleRate, src->fftSize, pad_size,
+                            src->overlapPreset, src->binsPerSecond, src->minFreq, src->maxFreq,
+                            &data, job) != 0) {
+        return EXIT_FAILURE;
+    }
+
+    const SpectrogramData *ref = &point->fft;
+    if (verify_same_shape(&data, ref, result)) {
+        double scale = ref->global_max > 0.0 ? ref->global_max : 1.0;
+        if (first_bin < ref->index_min) first_bin = ref->index_min;
+        for (int w = 0; w < ref->num_windows; w++) {
+            for (int b = first_bin; b <= ref->index_max; b++) {
+                size_t i = (size_t)w * ref->num_bins + b;
+                double error = fabs(data.data[i] - ref->data[i]) / scale;
+                if (error > result->max_error) result->max_error = error;
+                verify_count_levels(result, (int)lround(error * 255.0));
+            }
+        }
+        if (first_bin == ref->index_min) {
+            double max_error = fabs(data.global_max - ref->global_max) / scale;
+            if (max_error > result->max_error) result->max_error = max_error;
+        }
+    }
+
+    spectral_free(job, data.data);
+    return EXIT_SUCCESS;
+}
+
+/*---------------------------------------------------------------------
+ * verify_fft()
+ *
+ * The uniform transform (explicit padding to the reference size),
+ * over every drawn bin.
+ *---------------------------------------------------------------------*/
+static int verify_fft(const VerifyPoint *point, SpectralJob *job, VerifyResult *result)
+{
+    int pad_size = fft_padded_size(point->src.fftSize, 0);
+    return verify_compare_fft(point, job, pad_size, 0, result);
+}
+
+/*---------------------------------------------------------------------
+ * verify_fft_hybrid()
+ *
+ * The default analysis (multi-resolution with USE_HYBRID_FFT), from
+ * the crossover up. Below it, the long window resolves finer than the
+ * reference by design and is not compared.
+ *---------------------------------------------------------------------*/
+static int verify_fft_hybrid(const VerifyPoint *point, SpectralJob *job, VerifyResult *result)
+{
+    const SpectralSource *src = &point->src;
+    HybridFftLayout layout;
+    if (!fft_hybrid_layout(src->sampleRate, src->fftSize, fft_padded_size(src->fftSize, 0),
+                           src->minFreq, &layout)) {
+        snprintf(result->note, sizeof(result->note), "uniform transform at this size");
+    } else if (layout.decimation > 1) {
+        snprintf(result->note, sizeof(result->note),
+                 "short transform %d; bins below %d from a %d-sample window decimated by %d",
+                 layout.short_size, layout.crossover_bin, layout.long_window, layout.decimation);
+    } else {
+        snprintf(result->note, sizeof(result->note), "short transform %d, no low band", layout.short_size);
+    }
+    return verify_compare_fft(point, job, 0, layout.crossover_bin, result);
+}
+
+/*---------------------------------------------------------------------
+ * verify_low_band_tone()
+ *
+ * Analyzes a sine of the given frequency (amplitude 0.5) with the
+ * windows and range of the recording, and returns the largest
+ * magnitudes of its middle window below bin limit and from bin limit
+ * up. pad_size 0 runs the multi-resolution analysis, the reference
+ * padding the uniform one.
+ *
+ * Returns:
+ *  - EXIT_SUCCESS on success, EXIT_FAILURE if the analysis failed.
+ *---------------------------------------------------------------------*/
+static int verify_low_band_tone(const SpectralSource *src, SpectralJob *job, double freq, int pad_size,
+                                int limit, double *below, double *above)
+{
+    double *tone = (double *)malloc((size_t)src->totalSamples * sizeof(double));
+    if (tone == NULL) {
+        return EXIT_FAILURE;
+    }
+    for (int i = 0; i < src->totalSamples; i++) {
+        tone[i] = 0.5 * sin(2.0 * M_PI * freq * i / src->sampleRate);
+    }
+
+    SpectrogramData data;
+    memset(&data, 0, sizeof(data));
+    int status = compute_spectrogram(tone, src->totalSamples, 0, 0, src->sampleRate, src->fftSize, pad_size,
+                                     src->overlapPreset, src->binsPerSecond, src->minFreq, src->maxFreq,
+                                     &data, job);
+    free(tone);
+    if (status != 0) {
+        return EXIT_FAILURE;
+    }
+
+    const double *row = data.data + (size_t)(data.num_windows / 2) * data.num_bins;
+    *below = 0.0;
+    *above = 0.0;
+    for (int b = data.index_min; b <= data.index_max; b++) {
+        double *peak = b < limit ? below : above;
+        if (row[b] > *peak) *peak = row[b];
+    }
+    spectral_free(job, data.data);
+    return EXIT_SUCCESS;
+}
+
+/* Multi-resolution layout of a recording; 0 (with a note) if it has no low band */
+static int verify_low_band_layout(const SpectralSource *src, HybridFftLayout *layout, VerifyResult *result)
+{
+    if (!fft_hybrid_layout(src->sampleRate, src->fftSize, fft_padded_size(src->fftSize, 0),
+                           src->minFreq, layout) || layout->decimation <= 1) {
+        snprintf(result->note, sizeof(result->note), "no low band at this size");
+        return 0;
+    }
+    return 1;
+}
+
+/*---------------------------------------------------------------------
+ * verify_low_level()
+ *
+ * Level of a tone below the crossover (half its
+ * frequency, at least the bottom of the drawn range) in the long
+ * window, against the uniform transform. The error is relative to the
+ * uniform peak.
+ *---------------------------------------------------------------------*/
+static int verify_low_level(const VerifyPoint *point, SpectralJob *job, VerifyResult *result)
+{
+    const SpectralSource *src = &point->src;
+    HybridFftLayout layout;
+    if (!verify_low_band_layout(src, &layout, result)) {
+        return EXIT_SUCCESS;
+    }
+
+    double freq = fmax(0.5 * HYBRID_LOW_FREQ_THRESHOLD, 1.5 * src->minFreq);
+    double hybrid, expected, unused;
+    if (verify_low_band_tone(src, job, freq, 0, layout.crossover_bin, &hybrid, &unused) != EXIT_SUCCESS ||
+        verify_low_band_tone(src, job, freq, fft_padded_size(src->fftSize, 0), layout.crossover_bin,
+                             &expected, &unused) != EXIT_SUCCESS) {
+        return EXIT_FAILURE;
+    }
+
+    result->max_error = expected > 0.0 ? fabs(hybrid - expected) / expected : 1.0;
+    verify_count_levels(result, (int)lround(result->max_error * 255.0));
+    snprintf(result->note, sizeof(result->note), "%.1f Hz tone: %.4g in the long window, %.4g uniform",
+             freq, hybrid, expected);
+    return EXIT_SUCCESS;
+}
+
+/*---------------------------------------------------------------------
+ * verify_low_alias()
+ *
+ * Alias of a tone above the crossover that decimation without the
+ * anti-aliasing filter would fold to half the crossover frequency: the
+ * largest magnitude of the bins below the cross-fade (long window
+ * alone), relative to the tone peak.
+ *---------------------------------------------------------------------*/
+static int verify_low_alias(const VerifyPoint *point, SpectralJob *job, VerifyResult *result)
+{
+    const SpectralSource *src = &point->src;
+    HybridFftLayout layout;
+    if (!verify_low_band_layout(src, &layout, result)) {
+        return EXIT_SUCCESS;
+    }
+
+    double freq = (double)src->sampleRate / layout.decimation - 0.5 * HYBRID_LOW_FREQ_THRESHOLD;
+    double alias, peak;
+    if (verify_low_band_tone(src, job, freq, 0, layout.blend_bin, &alias, &peak) != EXIT_SUCCESS) {
+        return EXIT_FAILURE;
+    }
+
+    result->max_error = peak > 0.0 ? alias / peak : 1.0;
+    verify_count_levels(result, (int)lround(result->max_error * 255.0));
+    snprintf(result->note, sizeof(result->note), "%.1f Hz tone: %.1f dB below the crossover",
+             freq, 20.0 * log10(fmax(result->max_error, 1e-12)));
+    return EXIT_SUCCESS;
+}
+
+/*---------------------------------------------------------------------
+ * verify_constant_q()
+ *
+ * compute_constant_q() with the rows of the page, on a sine at the
+ * center of one bin per octave (amplitude 0.5, below 0.45 of the sample
+ * rate). The signal is two of the longest windows around the analyzed
+ * one. The tone must peak on its own row, at 0.25 (the positive
+ * frequency half); the error is relative to that level.
+ *---------------------------------------------------------------------*/
+static int verify_constant_q(const VerifyPoint *point, SpectralJob *job, VerifyResult *result)
+{
+    const SpectralSource *src = &point->src;
+    int rows = cqt_rows(&src->s);
+    CqtLayout layout;
+    if (cqt_layout(src->sampleRate, src->fftSize, src->minFreq, src->maxFreq, rows, &layout) != 0) {
+        snprintf(result->detail, sizeof(result->detail), "no constant-Q layout for %d rows over %.2f-%.2f Hz",
+                 rows, src->minFreq, src->maxFreq);
+        return EXIT_SUCCESS;
+    }
+
+    int total = 2 * layout.longest_window + src->fftSize;
+    double *tone = (double *)malloc((size_t)total * sizeof(double));
+    if (tone == NULL) {
+        return EXIT_FAILURE;
+    }
+
+    int status = EXIT_SUCCESS;
+    int octaves = 0;
+    for (int octave = 0; result->detail[0] == '\0'; octave++) {
+        int row = (int)lround((octave + 0.5) * layout.bins_per_octave);
+        double freq = src->minFreq * pow(2.0, row / layout.bins_per_octave);
+        if (row >= layout.bins || freq >= 0.45 * src->sampleRate) {
+            break;
+        }
+        for (int i = 0; i < total; i++) {
+            tone[i] = 0.5 * sin(2.0 * M_PI * freq * i / src->sampleRate);
+        }
+
+        SpectrogramData data;
+        memset(&data, 0, sizeof(data));
+        if (compute_constant_q(tone, total, 0, 0, src->sampleRate, src->fftSize, src->binsPerSecond,
+                               src->minFreq, src->maxFreq, rows, &data, job) != 0) {
+            status = EXIT_FAILURE;
+            break;
+        }
+
+        const double *levels = data.data + (size_t)(data.num_windows / 2) * data.num_bins;
+        int peak = 0;
+        for (int k = 1; k < data.num_bins; k++) {
+            if (levels[k] > levels[peak]) peak = k;
+        }
+        double error = fabs(levels[row] - 0.25) / 0.25;
+        if (error > result->max_error) result->max_error = error;
+        verify_count_levels(result, (int)lround(error * 255.0));
+        if (peak != row) {
+            snprintf(result->detail, sizeof(result->detail), "%.1f Hz tone peaks on row %d instead of %d",
+                     freq, peak, row);
+        }
+        spectral_free(job, data.data);
+        octaves++;
+    }
+    free(tone);
+
+    snprintf(result->note, sizeof(result->note), "%d rows (%.1f per octave), Q = %.1f, %d octaves",
+             layout.bins, layout.bins_per_octave, layout.q, octaves);
+    return status;
+}
+
+/*---------------------------------------------------------------------
+ * verify_tone_map()
+ *
+ * apply_image_processing() on a copy of the reference transform,
+ * against reference_tone_map() with the same seed.
+ *---------------------------------------------------------------------*/
+static int verify_tone_map(const VerifyPoint *point, SpectralJob *job, VerifyResult *result)
+{
+    const SpectralSource *src = &point->src;
+    SpectrogramData data;
+    if (verify_copy_spectrogram(&point->fft, &data) != 0) {
+        return EXIT_FAILURE;
+    }
+    apply_image_processing(&data, src->dynamicRangeDB, src->gammaCorr, src->enableDither,
+                           src->contrastFactor, job);
+
+    const SpectrogramData *ref = &point->tone;
+    for (int w = 0; w < ref->num_windows; w++) {
+        for (int b = ref->index_min; b <= ref->index_max; b++) {
+            size_t i = (size_t)w * ref->num_bins + b;
+            double error = fabs(data.data[i] - ref->data[i]);
+            if (error > result->max_error) result->max_error = error;
+            verify_count_levels(result, abs((int)lround(data.data[i] * 255.0) -
+                                            (int)lround(ref->data[i] * 255.0)));
+        }
+    }
+
+    free(data.data);
+    return EXIT_SUCCESS;
+}
+
+/*---------------------------------------------------------------------
+ * verify_raster()
+ *
+ * spectral_render_png() of the reference tone-mapped spectrogram, read
+ * back from the PNG, against reference_raster_page(), channel by
+ * channel. The error is the largest difference in 8-bit levels.
+ *---------------------------------------------------------------------*/
+static int verify_raster(const VerifyPoint *point, SpectralJob *job, VerifyResult *result)
+{
+    SpectralAnalysis analysis;
+    memset(&analysis, 0, sizeof(analysis));
+    analysis.src = point->src;
+    analysis.src.signal = NULL;
+    analysis.data = point->tone;
+    analysis.inputFile = (char *)point->source;
+
+    char png[SPECTRAL_PATH_MAX];
+    snprintf(png, sizeof(png), "%s/verify_page.png", point->workdir);
+    if (spectral_render_png(&analysis, NULL, png, job) != EXIT_SUCCESS) {
+        return EXIT_FAILURE;
+    }
+
+    cairo_surface_t *rendered = cairo_image_surface_create_from_png(png);
+    unlink(png);
+    cairo_surface_t *expected = reference_raster_page(&point->src, &point->tone);
+    int status = EXIT_SUCCESS;
+
+    if (cairo_surface_status(rendered) != CAIRO_STATUS_SUCCESS || expected == NULL) {
+        status = EXIT_FAILURE;
+    } else if (cairo_image_surface_get_width(rendered) != cairo_image_surface_get_width(expected) ||
+               cairo_image_surface_get_height(rendered) != cairo_image_surface_get_height(expected)) {
+        snprintf(result->detail, sizeof(result->detail), "page %d x %d (reference %d x %d)",
+                 cairo_image_surface_get_width(rendered), cairo_image_surface_get_height(rendered),
+                 cairo_image_surface_get_width(expected), cairo_image_surface_get_height(expected));
+    } else {
+        int width = cairo_image_surface_get_width(expected);
+        int height = cairo_image_surface_get_height(expected);
+        const unsigned char *a = cairo_image_surface_get_data(rendered);
+        const unsigned char *b = cairo_image_surface_get_data(expected);
+        int stride_a = cairo_image_surface_get_stride(rendered);
+        int stride_b = cairo_image_surface_get_stride(expected);
+
+        // Both surfaces are opaque: compare the red, green and blue channels
+        for (int y = 0; y < height; y++) {
+            const uint32_t *row_a = (const uint32_t *)(a + (size_t)y * stride_a);
+            const uint32_t *row_b = (const uint32_t *)(b + (size_t)y * stride_b);
+            for (int x = 0; x < width; x++) {
+                for (int shift = 0; shift < 24; shift += 8) {
+                    int levels = abs((int)((row_a[x] >> shift) & 0xFF) - (int)((row_b[x] >> shift) & 0xFF));
+                    if (levels > result->max_error) result->max_error = levels;
+                    verify_count_levels(result, levels);
+                }
+            }
+        }
+    }
+
+    cairo_surface_destroy(rendered);
+    if (expected != NULL) {
+        cairo_surface_destroy(expected);
+    }
+    return status;
+}
+
+/*---------------------------------------------------------------------
+ * verify_vector()
+ *
+ * spectral_render_vector_pdf() of the reference transform, tone-mapped
+ * without dithering as the PDF generation does, against
+ * reference_vector_cells() of the same page. The rectangles may not
+ * outnumber the cells, nor the fills the gray levels; the error is the
+ * size of the PDF relative to the per-cell baseline, which draws the
+ * cells only.
+ *---------------------------------------------------------------------*/
+static int verify_vector(const VerifyPoint *point, SpectralJob *job, VerifyResult *result)
+{
+    const SpectralSource *src = &point->src;
+    SpectrogramData data;
+    if (verify_copy_spectrogram(&point->fft, &data) != 0) {
+        return EXIT_FAILURE;
+    }
+    reference_tone_map(&data, src->dynamicRangeDB, src->gammaCorr, 0, src->contrastFactor, VERIFY_SEED);
+
+    SpectralAnalysis analysis;
+    memset(&analysis, 0, sizeof(analysis));
+    analysis.src = *src;
+    analysis.src.signal = NULL;
+    analysis.src.s.pdfEmbedImage = 0;
+    analysis.data = data;
+    analysis.inputFile = (char *)point->source;
+
+    char pdf[SPECTRAL_PATH_MAX];
+    char baseline[SPECTRAL_PATH_MAX];
+    snprintf(pdf, sizeof(pdf), "%s/verify_page.pdf", point->workdir);
+    snprintf(baseline, sizeof(baseline), "%s/verify_cells.pdf", point->workdir);
+    long long cells = 0;
+    struct stat merged_stat;
+    struct stat baseline_stat;
+    int status = EXIT_SUCCESS;
+
+    if (spectral_render_vector_pdf(&analysis, NULL, pdf, 0, job) != EXIT_SUCCESS ||
+        reference_vector_cells(&analysis.src, &data, baseline, &cells) != 0 ||
+        stat(pdf, &merged_stat) != 0 || stat(baseline, &baseline_stat) != 0 || baseline_stat.st_size <= 0) {
+        status = EXIT_FAILURE;
+    } else {
+        long long rects = job->stats.vectorRects;
+        long long fills = job->stats.vectorFills;
+        result->compared = cells;
+        result->max_error = (double)merged_stat.st_size / baseline_stat.st_size;
+        if (rects <= 0 || rects > cells || fills > SPECTRAL_PDF_GRAY_LEVELS) {
+            snprintf(result->detail, sizeof(result->detail),
+                     "%lld cells drawn as %lld rectangles and %lld fills (%d gray levels)",
+                     cells, rects, fills, SPECTRAL_PDF_GRAY_LEVELS);
+        }
+        snprintf(result->note, sizeof(result->note),
+                 "%lld cells merged into %lld rectangles, %lld fills; %lld bytes (per-cell baseline %lld)",
+                 cells, rects, fills, (long long)merged_stat.st_size, (long long)baseline_stat.st_size);
+    }
+
+    unlink(pdf);
+    unlink(baseline);
+    free(data.data);
+    return status;
+}
+
+/*---------------------------------------------------------------------
+ * verify_decode()
+ *
+ * The recording re-encoded in the given format on two channels (the
+ * second at 0.9 of the first), decoded from a seventh of its length by
+ * decode_range_mono() and decode_range_float() with
+ * VERIFY_DECODE_RANGES ranges, against the serial decoding of the same
+ * frames. The error is absolute, in full scale; a range decoded short
+ * or misaligned shows up as a frame count or a large error.
+ *---------------------------------------------------------------------*/
+static int verify_decode(const VerifyPoint *point, SpectralJob *job, int format, const char *extension,
+                         VerifyResult *result)
+{
+    SF_INFO info;
+    memset(&info, 0, sizeof(info));
+    SNDFILE *in = sf_open(point->source, SFM_READ, &info);
+    if (in == NULL) {
+        return EXIT_FAILURE;
+    }
+    sf_count_t frames = info.frames;
+    float *samples = (float *)malloc((size_t)frames * info.channels * sizeof(float));
+    float *stereo = (float *)malloc((size_t)frames * 2 * sizeof(float));
+    if (samples == NULL || stereo == NULL || sf_readf_float(in, samples, frames) != frames) {
+        sf_close(in);
+        free(samples);
+        free(stereo);
+        return EXIT_FAILURE;
+    }
+    sf_close(in);
+    for (sf_count_t i = 0; i < frames; i++) {
+        stereo[2 * i] = samples[i * info.channels];
+        stereo[2 * i + 1] = 0.9f * samples[i * info.channels];
+    }
+    free(samples);
+
+    char path[SPECTRAL_PATH_MAX];
+    snprintf(path, sizeof(path), "%s/verify_decode%s", point->workdir, extension);
+    SF_INFO out_info;
+    memset(&out_info, 0, sizeof(out_info));
+    out_info.samplerate = info.samplerate;
+    out_info.channels = 2;
+    out_info.format = format;
+    if (!sf_format_check(&out_info)) {
+        snprintf(result->note, sizeof(result->note), "%s not supported by this libsndfile, skipped", extension);
+        free(stereo);
+        return EXIT_SUCCESS;
+    }
+    SNDFILE *out = sf_open(path, SFM_WRITE, &out_info);
+    int written = out != NULL && sf_writef_float(out, stereo, frames) == frames;
+    if (out != NULL) {
+        sf_close(out);
+    }
+    free(stereo);
+    if (!written) {
+        unlink(path);
+        return EXIT_FAILURE;
+    }
+
+    sf_count_t start = frames / 7;
+    sf_count_t count = frames - start;
+    double *serial_mono = (double *)malloc((size_t)count * sizeof(double));
+    double *parallel_mono = (double *)malloc((size_t)count * sizeof(double));
+    float *serial_float = (float *)malloc((size_t)count * 2 * sizeof(float));
+    float *parallel_float = (float *)malloc((size_t)count * 2 * sizeof(float));
+    int status = EXIT_SUCCESS;
+
+    if (serial_mono == NULL || parallel_mono == NULL || serial_float == NULL || parallel_float == NULL) {
+        status = EXIT_FAILURE;
+    } else {
+        sf_count_t decoded[4] = {
+            decode_range_mono(path, start, count, serial_mono, 1, job),
+            decode_range_mono(path, start, count, parallel_mono, VERIFY_DECODE_RANGES, job),
+            decode_range_float(path, start, count, serial_float, 1, job),
+            decode_range_float(path, start, count, parallel_float, VERIFY_DECODE_RANGES, job),
+        };
+        if (decoded[0] != count || decoded[1] != count || decoded[2] != count || decoded[3] != count) {
+            snprintf(result->detail, sizeof(result->detail),
+                     "decoded %lld / %lld mono and %lld / %lld interleaved frames (serial / parallel), %lld expected",
+                     (long long)decoded[0], (long long)decoded[1], (long long)decoded[2],
+                     (long long)decoded[3], (long long)count);
+        } else {
+            for (sf_count_t i = 0; i < count; i++) {
+                double error = fabs(parallel_mono[i] - serial_mono[i]);
+                if (error > result->max_error) result->max_error = error;
+                verify_count_levels(result, (int)lround(error * 255.0));
+            }
+            for (sf_count_t i = 0; i < 2 * count; i++) {
+                double error = fabs((double)parallel_float[i] - (double)serial_float[i]);
+                if (error > result->max_error) result->max_error = error;
+                verify_count_levels(result, (int)lround(error * 255.0));
+            }
+            snprintf(result->note, sizeof(result->note), "frames %lld-%lld in %d ranges",
+                     (long long)start, (long long)frames, VERIFY_DECODE_RANGES);
+        }
+    }
+
+    free(serial_mono);
+    free(parallel_mono);
+    free(serial_float);
+    free(parallel_float);
+    unlink(path);
+    return status;
+}
+
+static int verify_decode_flac(const VerifyPoint *point, SpectralJob *job, VerifyResult *result)
+{
+    return verify_decode(point, job, SF_FORMAT_FLAC | SF_FORMAT_PCM_24, ".flac", result);
+}
+
+static int verify_decode_ogg(const VerifyPoint *point, SpectralJob *job, VerifyResult *result)
+{
+    return verify_decode(point, job, SF_FORMAT_OGG | SF_FORMAT_VORBIS, ".ogg", result);
+}
+
+/* Variants under test; the reference of each stage is implicit */
+static const VerifyVariant verify_variants[] = {
+    {"compute_spectrogram",             VERIFY_STAGE_FFT,           0, verify_fft},
+    {"compute_spectrogram/parallel",    VERIFY_STAGE_FFT,           1, verify_fft},
+    {"compute_spectrogram/hybrid",      VERIFY_STAGE_FFT_HYBRID,    1, verify_fft_hybrid},
+    {"compute_spectrogram/hybrid-level", VERIFY_STAGE_LOW_LEVEL,    1, verify_low_level},
+    {"compute_spectrogram/hybrid-alias", VERIFY_STAGE_LOW_ALIAS,    1, verify_low_alias},
+    {"compute_constant_q",              VERIFY_STAGE_CQT,           1, verify_constant_q},
+    {"apply_image_processing",          VERIFY_STAGE_TONE_MAP,      0, verify_tone_map},
+    {"apply_image_processing/parallel", VERIFY_STAGE_TONE_MAP,      1, verify_tone_map},
+    {"spectral_render_png",             VERIFY_STAGE_RASTER,        0, verify_raster},
+    {"spectral_render_vector_pdf",      VERIFY_STAGE_VECTOR,        0, verify_vector},
+    {"decode_range/flac",               VERIFY_STAGE_DECODE,        0, verify_decode_flac},
+    {"decode_range/ogg",                VERIFY_STAGE_DECODE,        0, verify_decode_ogg},
+};
+
+static const char *verify_stage_names[VERIFY_STAGE_COUNT] = {"fft", "tone_map", "raster", "fft", "level", "alias", "cqt", "decode", "vector"};
+
+/* Prints the non-empty buckets of a histogram */
+static void verify_print_histogram(const VerifyResult *result)
+{
+    int lower = 0;
+    fputs("      levels:", stdout);
+    for (int i = 0; i < VERIFY_BUCKETS; i++) {
+        if (result->histogram[i] > 0) {
+            if (lower == verify_bucket_limits[i]) {
+                printf(" [%d] %lld", lower, result->histogram[i]);
+            } else {
+                printf(" [%d-%d] %lld", lower, verify_bucket_limits[i], result->histogram[i]);
+            }
+        }
+        lower = verify_bucket_limits[i] + 1;
+    }
+    putchar('\n');
+}
+
+/*---------------------------------------------------------------------
+ * verify_point()
+ *
+ * Runs every selected variant on one recording.
+ *
+ * Returns:
+ *  - the number of failed variants, -1 if the recording could not be
+ *    analyzed.
+ *---------------------------------------------------------------------*/
+static int verify_point(const char *source, const char *workdir, const SpectrogramSettings *settings,
+                        const VerifyOptions *options)
+{
+    VerifyPoint point;
+    memset(&point, 0, sizeof(point));
+    point.source = source;
+    point.workdir = workdir;
+
+    // Production decode and filters: every stage starts from the same signal
+    if (spectral_load_source(settings, source, NULL, &point.src, NULL) != EXIT_SUCCESS) {
+        fprintf(stderr, "verify: cannot load %s\n", source);
+        return -1;
+    }
+    const SpectralSource *src = &point.src;
+    if (reference_compute_spectrogram(src->signal, src->totalSamples, src->sampleRate, src->fftSize, 0,
+                                      src->binsPerSecond, src->minFreq, src->maxFreq, &point.fft) != 0 ||
+        verify_copy_spectrogram(&point.fft, &point.tone) != 0) {
+        fprintf(stderr, "verify: reference analysis failed on %s\n", source);
+        free(point.fft.data);
+        spectral_free_source(&point.src);
+        return -1;
+    }
+    reference_tone_map(&point.tone, src->dynamicRangeDB, src->gammaCorr, src->enableDither,
+                       src->contrastFactor, VERIFY_SEED);
+
+    printf("%s: %d Hz, FFT %d, %d windows, bins %d-%d\n", source, src->sampleRate, src->fftSize,
+           point.fft.num_windows, point.fft.index_min, point.fft.index_max);
+
+    int failures = 0;
+    int count = (int)(sizeof(verify_variants) / sizeof(verify_variants[0]));
+    for (int v = 0; v < count; v++) {
+        const VerifyVariant *variant = &verify_variants[v];
+        if (options->variant_filter != NULL && strstr(variant->name, options->variant_filter) == NULL) {
+            continue;
+        }
+
+        SpectralJob job;
+        spectral_job_init(&job, 0.0);
+        spectral_job_set_seed(&job, VERIFY_SEED);
+        if (variant->parallel) {
+            spectral_job_set_parallel_for(&job, verify_parallel_for, (void *)&options->threads);
+        }
+
+        VerifyResult result;
+        memset(&result, 0, sizeof(result));
+        int status = variant->run(&point, &job, &result);
+        double tolerance = options->tolerance[variant->stage];
+        int passed = status == EXIT_SUCCESS && result.detail[0] == '\0' && result.max_error <= tolerance;
+
+        printf("  %s %-32s %-8s max error %.3g (tolerance %.3g), %lld values\n",
+               passed ? "PASS" : "FAIL", variant->name, verify_stage_names[variant->stage],
+               result.max_error, tolerance, result.compared);
+        if (status != EXIT_SUCCESS) {
+            printf("      the variant failed to run\n");
+        } else if (result.detail[0] != '\0') {
+            printf("      %s\n", result.detail);
+        } else {
+            verify_print_histogram(&result);
+        }
+        if (result.note[0] != '\0') {
+            printf("      %s\n", result.note);
+        }
+        failures += !passed;
+    }
+
+    free(point.fft.data);
+    free(point.tone.data);
+    spectral_free_source(&point.src);
+    return failures;
+}
+
+/* One generation of the concurrent stress test */
+typedef struct VerifyConcurrentJob {
+    const char *source;
+    const SpectrogramSettings *settings;
+    char        output[SPECTRAL_PATH_MAX];
+    unsigned long long seed;
+    SpectralPlanCache *cache;       // Shared by the jobs, NULL = none
+    const int  *threads;            // Threads of the parallel loops, NULL = serial
+    int         status;
+    uint64_t    hash;               // Of the page pixels
+} VerifyConcurrentJob;
+
+/*---------------------------------------------------------------------
+ * verify_png_hash()
+ *
+ * FNV-1a hash of the pixels of a PNG, row by row (the stride padding is
+ * left out).
+ *
+ * Returns:
+ *  - 0 on success, 1 if the file cannot be read.
+ *---------------------------------------------------------------------*/
+static int verify_png_hash(const char *path, uint64_t *hash)
+{
+    cairo_surface_t *surface = cairo_image_surface_create_from_png(path);
+    if (cairo_surface_status(surface) != CAIRO_STATUS_SUCCESS) {
+        cairo_surface_destroy(surface);
+        return 1;
+    }
+
+    int width = cairo_image_surface_get_width(surface);
+    int height = cairo_image_surface_get_height(surface);
+    int stride = cairo_image_surface_get_stride(surface);
+    const unsigned char *data = cairo_image_surface_get_data(surface);
+    uint64_t h = 0xcbf29ce484222325ULL;
+    for (int y = 0; y < height; y++) {
+        const unsigned char *row = data + (size_t)y * stride;
+        for (int i = 0; i < width * 4; i++) {
+            h = (h ^ row[i]) * 0x100000001b3ULL;
+        }
+    }
+    cairo_surface_destroy(surface);
+    *hash = h;
+    return 0;
+}
+
+/* Runs one generation of the stress test and hashes its page */
+static void *verify_concurrent_worker(void *arg)
+{
+    VerifyConcurrentJob *run = (VerifyConcurrentJob *)arg;
+
+    SpectralJob job;
+    spectral_job_init(&job, 0.0);
+    spectral_job_set_seed(&job, run->seed);
+    if (run->cache != NULL) {
+        spectral_job_set_plan_cache(&job, run->cache);
+    }
+    if (run->threads != NULL) {
+        spectral_job_set_parallel_for(&job, verify_parallel_for, (void *)run->threads);
+    }
+
+    run->status = spectral_generator(run->settings, run->source, run->output, &job);
+    if (run->status == EXIT_SUCCESS && verify_png_hash(run->output, &run->hash) != 0) {
+        run->status = EXIT_FAILURE;
+    }
+    unlink(run->output);
+    return NULL;
+}
+
+/*---------------------------------------------------------------------
+ * verify_concurrent()
+ *
+ * Renders one recording serially once per seed, then with
+ * options->concurrent jobs at the same time (job i uses seed
+ * i % VERIFY_CONCURRENT_SEEDS), and compares every page with the serial
+ * one of its seed.
+ *
+ * Returns:
+ *  - the number of jobs that failed or differ, -1 if the serial renders
+ *    failed.
+ *---------------------------------------------------------------------*/
+static int verify_concurrent(const char *source, const char *workdir, const SpectrogramSettings *settings,
+                             const VerifyOptions *options)
+{
+    VerifyConcurrentJob serial[VERIFY_CONCURRENT_SEEDS];
+    for (int s = 0; s < VERIFY_CONCURRENT_SEEDS; s++) {
+        memset(&serial[s], 0, sizeof(serial[s]));
+        serial[s].source = source;
+        serial[s].settings = settings;
+        serial[s].seed = VERIFY_SEED + (unsigned long long)s;
+        snprintf(serial[s].output, sizeof(serial[s].output), "%s/verify_serial_%d.png", workdir, s);
+        verify_concurrent_worker(&serial[s]);
+        if (serial[s].status != EXIT_SUCCESS) {
+            fprintf(stderr, "verify: serial render of %s failed\n", source);
+            return -1;
+        }
+    }
+
+    SpectralPlanCache *cache = spectral_plan_cache_create();
+    VerifyConcurrentJob *runs = (VerifyConcurrentJob *)calloc((size_t)options->concurrent, sizeof(VerifyConcurrentJob));
+    pthread_t *ids = (pthread_t *)calloc((size_t)options->concurrent, sizeof(pthread_t));
+    int *started = (int *)calloc((size_t)options->concurrent, sizeof(int));
+    if (cache == NULL || runs == NULL || ids == NULL || started == NULL) {
+        fprintf(stderr, "verify: out of memory\n");
+        spectral_plan_cache_destroy(cache);
+        free(runs);
+        free(ids);
+        free(started);
+        return -1;
+    }
+
+    for (int i = 0; i < options->concurrent; i++) {
+        runs[i].source = source;
+        runs[i].settings = settings;
+        runs[i].seed = VERIFY_SEED + (unsigned long long)(i % VERIFY_CONCURRENT_SEEDS);
+        runs[i].cache = cache;
+        runs[i].threads = &options->threads;
+        snprintf(runs[i].output, sizeof(runs[i].output), "%s/verify_concurrent_%02d.png", workdir, i);
+        started[i] = pthread_create(&ids[i], NULL, verify_concurrent_worker, &runs[i]) == 0;
+        if (!started[i]) {
+            verify_concurrent_worker(&runs[i]);
+        }
+    }
+
+    int failures = 0;
+    for (int i = 0; i < options->concurrent; i++) {
+        if (started[i]) {
+            pthread_join(ids[i], NULL);
+        }
+        const VerifyConcurrentJob *expected = &serial[i % VERIFY_CONCURRENT_SEEDS];
+        if (runs[i].status != EXIT_SUCCESS) {
+            printf("  FAIL job %02d (seed %#llx) failed to render\n", i, runs[i].seed);
+            failures++;
+        } else if (runs[i].hash != expected->hash) {
+            printf("  FAIL job %02d (seed %#llx) page %016llx, serial %016llx\n", i, runs[i].seed,
+                   (unsigned long long)runs[i].hash, (unsigned long long)expected->hash);
+            failures++;
+        }
+    }
+    printf("  %s %d concurrent jobs, %d seeds, %d threads each\n", failures == 0 ? "PASS" : "FAIL",
+           options->concurrent, VERIFY_CONCURRENT_SEEDS, options->threads);
+    if (serial[0].hash == serial[1].hash) {
+        printf("      seeds %#llx and %#llx give the same page (no dithering?)\n", serial[0].seed, serial[1].seed);
+    }
+
+    spectral_plan_cache_destroy(cache);
+    free(runs);
+    free(ids);
+    free(started);
+    return failures;
+}
+
+/* Parses a comma-separated list of numbers */
+static int verify_parse_list(const char *text, double *values, int max_values)
+{
+    int count = 0;
+    char *copy = strdup(text);
+    for (char *item = strtok(copy, ","); item != NULL && count < max_values; item = strtok(NULL, ",")) {
+        values[count++] = atof(item);
+    }
+    free(copy);
+    return count;
+}
+
+static void verify_usage(const char *program)
+{
+    fprintf(stderr,
+            "Usage: %s [options]\n"
+            "  --signals LIST          sine,chirp,pink,impulses (default: all)\n"
+            "  --durations LIST        Seconds (default: 3)\n"
+            "  --rates LIST            Sample rates in Hz (default: 44100,96000,192000)\n"
+            "  --variant TEXT          Only the variants whose name contains TEXT\n"
+            "  --threads N             Threads of the parallel variants (default: 4)\n"
+            "  --fft-tolerance X       Relative magnitude error (default: 1e-9)\n"
+            "  --tone-tolerance X      Absolute intensity error (default: 1e-9)\n"
+            "  --pixel-tolerance N     8-bit pixel difference (default: 0)\n"
+            "  --hybrid-tolerance X    Relative error above the crossover (default: 0.02)\n"
+            "  --level-tolerance X     Relative level error of a low tone (default: 0.05)\n"
+            "  --alias-tolerance X     Alias below the crossover, relative (default: 0.001)\n"
+            "  --cqt-tolerance X       Relative level error of the constant-Q tones (default: 0.05)\n"
+            "  --decode-tolerance X    Parallel against serial decoding, full scale (default: 0)\n"
+            "  --vector-tolerance X    PDF size relative to the per-cell drawing (default: 0.5)\n"
+            "  --concurrent N          Stress test: N jobs at once instead of the variants\n"
+            "  --workdir DIR           Directory of the synthetic recordings (default: .)\n"
+            "  --keep                  Keep the synthetic recordings\n",
+            program);
+}
+
+int main(int argc, char *argv[])
+{
+    int signals[VERIFY_MAX_VALUES];
+    int num_signals = 0;
+    for (int i = 0; i < SYNTH_SIGNAL_COUNT; i++) {
+        signals[num_signals++] = i;
+    }
+    double durations[VERIFY_MAX_VALUES];
+    int num_durations = verify_parse_list("3", durations, VERIFY_MAX_VALUES);
+    double rates[VERIFY_MAX_VALUES];
+    int num_rates = verify_parse_list("44100,96000,192000", rates, VERIFY_MAX_VALUES);
+
+    VerifyOptions options;
+    memset(&options, 0, sizeof(options));
+    options.tolerance[VERIFY_STAGE_FFT] = 1e-9;
+    options.tolerance[VERIFY_STAGE_TONE_MAP] = 1e-9;
+    options.tolerance[VERIFY_STAGE_RASTER] = 0.0;
+    options.tolerance[VERIFY_STAGE_FFT_HYBRID] = 0.02;
+    options.tolerance[VERIFY_STAGE_LOW_LEVEL] = 0.05;
+    options.tolerance[VERIFY_STAGE_LOW_ALIAS] = 0.001;
+    options.tolerance[VERIFY_STAGE_CQT] = 0.05;
+    options.tolerance[VERIFY_STAGE_DECODE] = 0.0;
+    options.tolerance[VERIFY_STAGE_VECTOR] = 0.5;
+    options.threads = 4;
+
+    const char *workdir = ".";
+    int keep = 0;
+
+    for (int i = 1; i < argc; i++) {
+        const char *arg = argv[i];
+        const char *value = (i + 1 < argc) ? argv[i + 1] : NULL;
+        int takes_value = 1;
+
+        if (strcmp(arg, "--keep") == 0) {
+            keep = 1;
+            takes_value = 0;
+        } else if (value == NULL) {
+            verify_usage(argv[0]);
+            return EXIT_FAILURE;
+        } else if (strcmp(arg, "--signals") == 0) {
+            num_signals = synth_parse_signals(value, signals, VERIFY_MAX_VALUES);
+        } else if (strcmp(arg, "--durations") == 0) {
+            num_durations = verify_parse_list(value, durations, VERIFY_MAX_VALUES);
+        } else if (strcmp(arg, "--rates") == 0) {
+            num_rates = verify_parse_list(value, rates, VERIFY_MAX_VALUES);
+        } else if (strcmp(arg, "--variant") == 0) {
+            options.variant_filter = value;
+        } else if (strcmp(arg, "--threads") == 0) {
+            options.threads = atoi(value);
+        } else if (strcmp(arg, "--fft-tolerance") == 0) {
+            options.tolerance[VERIFY_STAGE_FFT] = atof(value);
+        } else if (strcmp(arg, "--tone-tolerance") == 0) {
+            options.tolerance[VERIFY_STAGE_TONE_MAP] = atof(value);
+        } else if (strcmp(arg, "--pixel-tolerance") == 0) {
+            options.tolerance[VERIFY_STAGE_RASTER] = atof(value);
+        } else if (strcmp(arg, "--hybrid-tolerance") == 0) {
+            options.tolerance[VERIFY_STAGE_FFT_HYBRID] = atof(value);
+        } else if (strcmp(arg, "--level-tolerance") == 0) {
+            options.tolerance[VERIFY_STAGE_LOW_LEVEL] = atof(value);
+        } else if (strcmp(arg, "--alias-tolerance") == 0) {
+            options.tolerance[VERIFY_STAGE_LOW_ALIAS] = atof(value);
+        } else if (strcmp(arg, "--cqt-tolerance") == 0) {
+            options.tolerance[VERIFY_STAGE_CQT] = atof(value);
+        } else if (strcmp(arg, "--decode-tolerance") == 0) {
+            options.tolerance[VERIFY_STAGE_DECODE] = atof(value);
+        } else if (strcmp(arg, "--vector-tolerance") == 0) {
+            options.tolerance[VERIFY_STAGE_VECTOR] = atof(value);
+        } else if (strcmp(arg, "--concurrent") == 0) {
+            options.concurrent = atoi(value);
+        } else if (strcmp(arg, "--workdir") == 0) {
+            workdir = value;
+        } else {
+            verify_usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+        i += takes_value;
+    }
+
+    if (num_signals <= 0 || num_durations <= 0 || num_rates <= 0 ||
+        options.threads < 1 || options.threads > VERIFY_MAX_THREADS ||
+        options.concurrent < 0 || options.concurrent > VERIFY_MAX_CONCURRENT) {
+        verify_usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    // The generator messages would drown the report
+    spectral_log_set_level(SPECTRAL_LOG_ERROR);
+
+    char source[SPECTRAL_PATH_MAX];
+    int points = 0;
+    int failures = 0;
+    int status = EXIT_SUCCESS;
+
+    for (int si = 0; si < num_signals && status == EXIT_SUCCESS; si++)
+    for (int di = 0; di < num_durations && status == EXIT_SUCCESS; di++)
+    for (int ri = 0; ri < num_rates && status == EXIT_SUCCESS; ri++) {
+        SynthSignal signal = (SynthSignal)signals[si];
+        double duration = durations[di];
+        int sample_rate = (int)rates[ri];
+
+        snprintf(source, sizeof(source), "%s/verify_%s_%.0fs_%dHz.wav",
+                 workdir, synth_signal_names[signal], duration, sample_rate);
+        if (access(source, R_OK) != 0 &&
+            synth_write_source(source, signal, duration, sample_rate, 1) != 0) {
+            status = EXIT_FAILURE;
+            break;
+        }
+
+        // First page only, no overlay: the reference page draws the cells alone
+        SpectrogramSettings settings;
+        memset(&settings, 0, sizeof(settings));
+        settings.duration = duration;
+        settings.sampleRate = sample_rate;
+        settings.writingSpeed = 2.5;
+        settings.enableDithering = 1;
+        settings.enableNormalization = 1;
+        settings.enableHighPassFilter = 1;
+        settings.highPassCutoffFreq = 100.0;
+        settings.highPassFilterOrder = 2;
+
+        int failed;
+        if (options.concurrent > 0) {
+            printf("%s: %d Hz\n", source, sample_rate);
+            failed = verify_concurrent(source, workdir, &settings, &options);
+        } else {
+            failed = verify_point(source, workdir, &settings, &options);
+        }
+        if (failed < 0) {
+            status = EXIT_FAILURE;
+        } else {
+            failures += failed;
+            points++;
+        }
+
+        if (!keep) {
+            unlink(source);
+        }
+    }
+
+    if (status == EXIT_SUCCESS && failures > 0) {
+        status = EXIT_FAILURE;
+    }
+    printf("verify: %d recordings, %d failures\n", points, failures);
+    return status;
+}
@@ -6,6 +6,7 @@
  * in the root directory of this software component.
  */
 
+#define SPECTRAL_LOG_CATEGORY "audio"
 #include "spectral_wav_processing.h"
 
 /*---------------------------------------------------------------------
@@ -19,6 +20,52 @@
  *  - 0 on success, non-zero on error.
  *---------------------------------------------------------------------*/
 int load_wav_file(const char *filename, double **signal, int *num_samples, int *sample_rate, double duration, int normalize)
+{
+    return load_wav_file_scaled(filename, signal, num_samples, sample_rate, duration, 0, normalize, 1.0, NULL);
+}
+
+/*---------------------------------------------------------------------
+ * wav_file_info()
+ *
+ * Reads the sample rate and duration of an audio file from its header,
+ * without decoding it.
+ *
+ * Returns:
+ *  - 0 on success, 1 if the file cannot be opened.
+ *---------------------------------------------------------------------*/
+int wav_file_info(const char *filename, int *sample_rate, double *seconds)
+{
+    SF_INFO info;
+    memset(&info, 0, sizeof(info));
+    
+    SNDFILE *sf = sf_open(filename, SFM_READ, &info);
+    if (sf == NULL) {
+        return 1;
+    }
+    sf_close(sf);
+    
+    *sample_rate = info.samplerate;
+    *seconds = info.samplerate > 0 ? (double)info.frames / info.samplerate : 0.0;
+    return 0;
+}
+
+/*---------------------------------------------------------------------
+ * load_wav_file_scaled()
+ *
+ * Same as load_wav_file(), with a virtual gain applied to every sample
+ * while the file is read. The gain replaces a pre-normalized copy of
+ * the file; it is ignored when normalize is set, since normalization
+ * rescales the signal to a peak of 1.0 anyway. The peak is tracked
+ * during the read/mix-down loop, so no extra pass over the signal is
+ * made unless normalization is requested. max_frames, when positive,
+ * caps the frames read (the sample range planned by the layout).
+ * Messages go to the job's logger (NULL = stdout/stderr).
+ *
+ * Returns:
+ *  - 0 on success, non-zero on error.
+ *---------------------------------------------------------------------*/
+int load_wav_file_scaled(const char *filename, double **signal, int *num_samples, int *sample_rate,
+                         double duration, int max_frames, int normalize, double gain, SpectralJob *job)
 {
     SNDFILE *sf;
     SF_INFO info;
@@ -29,16 +76,16 @@ int load_wav_file(const char *filename, double **signal, int *num_samples, int *
     // Open sound file for reading
     sf = sf_open(filename, SFM_READ, &info);
     if (sf == NULL) {
-        fprintf(stderr, "Error: Could not open file %s: %s\n", filename, sf_strerror(NULL));
+        spectral_log(job, SPECTRAL_LOG_ERROR, "Error: Could not open file %s: %s\n", filename, sf_strerror(NULL));
         return 1;
     }
     
-    printf("File Info:\n");
-    printf(" - Sample rate: %d Hz\n", info.samplerate);
-    printf(" - Channels: %d\n", info.channels);
-    printf(" - Format: %d\n", info.format);
-    printf(" - Total frames: %lld\n", (long long)info.frames);
-    printf(" - Duration: %.2f seconds\n", (double)info.frames / info.samplerate);
+    spectral_log(job, SPECTRAL_LOG_INFO, "File Info:\n");
+    spectral_log(job, SPECTRAL_LOG_INFO, " - Sample rate: %d Hz\n", info.samplerate);
+    spectral_log(job, SPECTRAL_LOG_INFO, " - Channels: %d\n", info.channels);
+    spectral_log(job, SPECTRAL_LOG_INFO, " - Format: %d\n", info.format);
+    spectral_log(job, SPECTRAL_LOG_INFO, " - Total frames: %lld\n", (long long)info.frames);
+    spectral_log(job, SPECTRAL_LOG_INFO, " - Duration: %.2f seconds\n", (double)info.frames / info.samplerate);
     
     // Determine frames to read based on requested duration
     int frames_to_read = 0;
@@ -46,52 +93,115 @@ int load_wav_file(const char *filename, double **signal, int *num_samples, int *
         frames_to_read = (int)(duration * info.samplerate);
         if (frames_to_read > info.frames) {
             frames_to_read = info.frames;
-            printf(" - Requested duration exceeds file duration, reading entire file.\n");
+            spectral_log(job, SPECTRAL_LOG_INFO, " - Requested duration exceeds file duration, reading entire file.\n");
         } else {
-            printf(" - Loading %.2f seconds from WAV file.\n", duration);
+            spectral_log(job, SPECTRAL_LOG_INFO, " - Loading %.2f seconds from WAV file.\n", duration);
         }
     } else {
         frames_to_read = info.frames;
-        printf(" - No duration specified, reading entire file.\n");
+        spectral_log(job, SPECTRAL_LOG_INFO, " - No duration specified, reading entire file.\n");
+    }
+    if (max_frames > 0 && frames_to_read > max_frames) {
+        frames_to_read = max_frames;
+        spectral_log(job, SPECTRAL_LOG_INFO, " - Reading the %d frames of the planned range.\n", frames_to_read);
     }
     
     // Allocate memory for the signal
     *signal = (double *)malloc(frames_to_read * sizeof(double));
     if (*signal == NULL) {
         sf_close(sf);
-        fprintf(stderr, "Error: Memory allocation failed for audio signal.\n");
+        spectral_log(job, SPECTRAL_LOG_ERROR, "Error: Memory allocation failed for audio signal.\n");
         return 2;
     }
     
-    // If the file has multiple channels, we'll need a buffer for reading
-    double *buffer = NULL;
-    if (info.channels > 1) {
-        buffer = (double *)malloc(frames_to_read * info.channels * sizeof(double));
+    // A gain of 1.0 (or an unset gain) leaves samples untouched
+    int apply_gain = !normalize && gain > 0.0 && gain != 1.0;
+    double max_abs = 0.0;
+    
+    int decode_threads = decoder_recommended_threads(&info, frames_to_read);
+    
+    if (decode_threads > 1) {
+        // Long compressed files: decode disjoint ranges in parallel, mixed down to mono
+        spectral_log(job, SPECTRAL_LOG_DEBUG, " - Decoding %d frames with %d parallel ranges\n", frames_to_read, decode_threads);
+        sf_count_t decoded = decode_range_mono(filename, 0, frames_to_read, *signal, decode_threads, job);
+        if (decoded < 0) {
+            free(*signal);
+            *signal = NULL;
+            sf_close(sf);
+            spectral_log(job, SPECTRAL_LOG_ERROR, "Error: Parallel decoding failed for %s.\n", filename);
+            return 4;
+        }
+        *num_samples = (int)decoded;
+        
+        if (apply_gain || normalize) {
+            for (int i = 0; i < *num_samples; i++) {
+                if (apply_gain) {
+                    (*signal)[i] *= gain;
+                }
+                if (normalize && fabs((*signal)[i]) > max_abs) {
+                    max_abs = fabs((*signal)[i]);
+                }
+            }
+        }
+    } else if (info.channels > 1) {
+        // Read multi-channel files in bounded chunks rather than one whole-file buffer
+        const int chunk_frames = 4096;
+        double *buffer = (double *)malloc((size_t)chunk_frames * info.channels * sizeof(double));
         if (buffer == NULL) {
             free(*signal);
+            *signal = NULL;
             sf_close(sf);
-            fprintf(stderr, "Error: Memory allocation failed for channel buffer.\n");
+            spectral_log(job, SPECTRAL_LOG_ERROR, "Error: Memory allocation failed for channel buffer.\n");
             return 3;
         }
         
-        // Read frames into buffer
-        sf_count_t frames_read = sf_readf_double(sf, buffer, frames_to_read);
-        
         // Mix down to mono by averaging channels
-        printf(" - Mixing down %d channels to mono\n", info.channels);
-        for (int i = 0; i < frames_read; i++) {
-            double sum = 0;
-            for (int j = 0; j < info.channels; j++) {
-                sum += buffer[i * info.channels + j];
+        spectral_log(job, SPECTRAL_LOG_DEBUG, " - Mixing down %d channels to mono\n", info.channels);
+        int total_read = 0;
+        while (total_read < frames_to_read) {
+            int wanted = frames_to_read - total_read;
+            if (wanted > chunk_frames) {
+                wanted = chunk_frames;
             }
-            (*signal)[i] = sum / info.channels;
+            sf_count_t frames_read = sf_readf_double(sf, buffer, wanted);
+            if (frames_read <= 0) {
+                break;
+            }
+            
+            double *dst = *signal + total_read;
+            for (int i = 0; i < frames_read; i++) {
+                double sum = 0;
+                for (int j = 0; j < info.channels; j++) {
+                    sum += buffer[i * info.channels + j];
+                }
+                double value = sum / info.channels;
+                if (apply_gain) {
+                    value *= gain;
+                }
+                if (normalize && fabs(value) > max_abs) {
+                    max_abs = fabs(value);
+                }
+                dst[i] = value;
+            }
+            total_read += (int)frames_read;
         }
         
         free(buffer);
-        *num_samples = frames_read;
+        *num_samples = total_read;
     } else {
         // Mono file, read directly
         *num_samples = sf_readf_double(sf, *signal, frames_to_read);
+        
+        if (apply_gain || normalize) {
+            for (int i = 0; i < *num_samples; i++) {
+                if (apply_gain) {
+                    (*signal)[i] *= gain;
+                }
+                if (normalize && fabs((*signal)[i]) > max_abs) {
+                    max_abs = fabs((*signal)[i]);
+                }
+            }
+        }
     }
     
     // Set the sample rate
@@ -102,33 +212,20 @@ int load_wav_file(const char *filename, double **signal, int *num_samples, int *
     
     // Normalize the audio if requested
     if (normalize) {
-        printf(" - Normalizing audio to maximum amplitude of 1.0\n");
-        double max_abs = 0.0;
-        for (int i = 0; i < *num_samples; i++) {
-            if (fabs((*signal)[i]) > max_abs) {
-                max_abs = fabs((*signal)[i]);
-            }
-        }
+        spectral_log(job, SPECTRAL_LOG_INFO, " - Normalizing audio to maximum amplitude of 1.0\n");
         if (max_abs > 0.0) {
-            printf(" - Maximum amplitude before normalization: %.6f\n", max_abs);
+            spectral_log(job, SPECTRAL_LOG_INFO, " - Maximum amplitude before normalization: %.6f\n", max_abs);
             for (int i = 0; i < *num_samples; i++) {
                 (*signal)[i] /= max_abs;
             }
         }
+    } else if (apply_gain) {
+        spectral_log(job, SPECTRAL_LOG_INFO, " - Skipping normalization, applied input gain of %.6f\n", gain);
     } else {
-        printf(" - Skipping normalization (preserving original amplitude)\n");
-        
-        // Optionally, we could print the maximum amplitude for information
-        double max_abs = 0.0;
-        for (int i = 0; i < *num_samples; i++) {
-            if (fabs((*signal)[i]) > max_abs) {
-                max_abs = fabs((*signal)[i]);
-            }
-        }
-        printf(" - Maximum amplitude: %.6f\n", max_abs);
+        spectral_log(job, SPECTRAL_LOG_INFO, " - Skipping normalization (preserving original amplitude)\n");
     }
     
-    printf(" - Loaded %d samples at %d Hz (%.2f seconds)\n", 
+    spectral_log(job, SPECTRAL_LOG_INFO, " - Loaded %d samples at %d Hz (%.2f seconds)\n", 
            *num_samples, *sample_rate, (double)*num_samples / *sample_rate);
     
     return 0;
@@ -175,9 +272,9 @@ void apply_hann_window(double *buffer, int size)
  * Applies a simple high-frequency boost filter to the signal.
  * The filter is a first-order high-shelf filter with parameter alpha.
  *---------------------------------------------------------------------*/
-void apply_high_freq_boost_filter(double *signal, int num_samples, double alpha)
+void apply_high_freq_boost_filter(double *signal, int num_samples, double alpha, SpectralJob *job)
 {
-    printf(" - Applying high frequency boost (alpha = %.2f)\n", alpha);
+    spectral_log(job, SPECTRAL_LOG_INFO, " - Applying high frequency boost (alpha = %.2f)\n", alpha);
     
     if (num_samples < 2) return;
     
@@ -195,21 +292,20 @@ void apply_high_freq_boost_filter(double *signal, int num_samples, double alpha)
  * Designs a digital high-pass filter with specified parameters.
  * Implements a simple high-pass filter based on standard difference equation.
  *---------------------------------------------------------------------*/
-void design_highpass_filter(double cutoff_freq, int order, double sample_rate, double *a, double *b)
+void design_highpass_filter(double cutoff_freq, int order, double sample_rate, double *a, double *b,
+                            SpectralJob *job)
 {
-    // Validation et logs détaillés pour le débogage
-    printf("=== FILTRE PASSE-HAUT DEBUG ===\n");
-    printf("design_highpass_filter - cutoff_freq reçue: %.2f Hz\n", cutoff_freq);
-    printf("design_highpass_filter - order reçu: %d\n", order);
-    printf("design_highpass_filter - sample_rate reçu: %.2f Hz\n", sample_rate);
+    // Validation des paramètres reçus
+    spectral_log(job, SPECTRAL_LOG_DEBUG, "design_highpass_filter - cutoff: %.2f Hz, order: %d, sample rate: %.2f Hz\n",
+                 cutoff_freq, order, sample_rate);
     
     if (cutoff_freq <= 0.0) {
-        printf("Warning: Invalid cutoff frequency (%.2f Hz), using default of 100 Hz\n", cutoff_freq);
+        spectral_log(job, SPECTRAL_LOG_WARNING, "Warning: Invalid cutoff frequency (%.2f Hz), using default of 100 Hz\n", cutoff_freq);
         cutoff_freq = 100.0;
     }
     
     if (order < 1 || order > 8) {
-        printf("Warning: Invalid filter order (%d), using order = 2\n", order);
+        spectral_log(job, SPECTRAL_LOG_WARNING, "Warning: Invalid filter order (%d), using order = 2\n", order);
         order = 2;
     }
     
@@ -234,9 +330,9 @@ void design_highpass_filter(double cutoff_freq, int order, double sample_rate, d
     a[2] = 0.0;  // Non utilisé pour un filtre du premier ordre
     b[2] = 0.0;  // Non utilisé pour un filtre du premier ordre
     
-    printf(" - Designed simple high-pass filter: cutoff = %.2f Hz, alpha = %.4f\n",
+    spectral_log(job, SPECTRAL_LOG_DEBUG, " - Designed simple high-pass filter: cutoff = %.2f Hz, alpha = %.4f\n",
            cutoff_freq, alpha);
-    printf(" - Filter coefficients: a=[%.4f, %.4f], b=[%.4f, %.4f]\n",
+    spectral_log(job, SPECTRAL_LOG_DEBUG, " - Filter coefficients: a=[%.4f, %.4f], b=[%.4f, %.4f]\n",
            a[0], a[1], b[0], b[1]);
 }
 
@@ -247,18 +343,19 @@ void design_highpass_filter(double cutoff_freq, int order, double sample_rate, d
  * Implements the formula: y[n] = alpha * (y[n-1] + x[n] - x[n-1])
  * where alpha is a coefficient related to the cutoff frequency.
  *---------------------------------------------------------------------*/
-void apply_highpass_filter(double *signal, int num_samples, double *a, double *b, int filter_order)
+void apply_highpass_filter(double *signal, int num_samples, double *a, double *b, int filter_order,
+                           SpectralJob *job)
 {
     // Validate order
     if (filter_order < 1 || filter_order > 8) {
-        fprintf(stderr, "Warning: Invalid filter order (%d), using order = 2\n", filter_order);
+        spectral_log(job, SPECTRAL_LOG_WARNING, "Warning: Invalid filter order (%d), using order = 2\n", filter_order);
         filter_order = 2;
     }
     
     // Extraire le coefficient alpha du filtre
     double alpha = b[0];  // b[0] contient alpha selon notre design du filtre
     
-    printf(" - Applying simplified high-pass filter (alpha = %.4f)\n", alpha);
+    spectral_log(job, SPECTRAL_LOG_DEBUG, " - Applying simplified high-pass filter (alpha = %.4f)\n", alpha);
     
     // Mesurer l'amplitude maximale du signal avant filtrage
     double max_amplitude = 0.0;
@@ -268,12 +365,12 @@ void apply_highpass_filter(double *signal, int num_samples, double *a, double *b
             max_amplitude = abs_val;
         }
     }
-    printf(" - Original signal max amplitude: %.6f\n", max_amplitude);
+    spectral_log(job, SPECTRAL_LOG_DEBUG, " - Original signal max amplitude: %.6f\n", max_amplitude);
     
     // Créer une copie de travail du signal
     double *filtered = (double *)malloc(num_samples * sizeof(double));
     if (filtered == NULL) {
-        fprintf(stderr, "Error: Memory allocation failed for filtered signal.\n");
+        spectral_log(job, SPECTRAL_LOG_ERROR, "Error: Memory allocation failed for filtered signal.\n");
         return;
     }
     
@@ -282,7 +379,7 @@ void apply_highpass_filter(double *signal, int num_samples, double *a, double *b
     
     // Nombre de passes pour simuler un ordre plus élevé
     int passes = filter_order;
-    printf(" - Applying filter with %d passes for order %d\n", passes, filter_order);
+    spectral_log(job, SPECTRAL_LOG_DEBUG, " - Applying filter with %d passes for order %d\n", passes, filter_order);
     
     // Appliquer le filtre plusieurs fois pour simuler un ordre plus élevé
     for (int pass = 0; pass < passes; pass++) {
@@ -315,7 +412,7 @@ void apply_highpass_filter(double *signal, int num_samples, double *a, double *b
             filtered[i] = y;
         }
         
-        printf(" - Pass %d completed\n", pass + 1);
+        spectral_log(job, SPECTRAL_LOG_DEBUG, " - Pass %d completed\n", pass + 1);
     }
     
     // Vérifier l'amplitude après filtrage
@@ -326,13 +423,13 @@ void apply_highpass_filter(double *signal, int num_samples, double *a, double *b
             max_filtered = abs_val;
         }
     }
-    printf(" - Filtered signal max amplitude: %.6f\n", max_filtered);
+    spectral_log(job, SPECTRAL_LOG_DEBUG, " - Filtered signal max amplitude: %.6f\n", max_filtered);
     
     // Normaliser le signal si nécessaire
     if (max_filtered > 0.0 &&
         (max_filtered < 0.01 * max_amplitude || max_filtered > 2.0 * max_amplitude)) {
         double normalize_factor = max_amplitude / max_filtered;
-        printf(" - Normalizing output (factor = %.4f)\n", normalize_factor);
+        spectral_log(job, SPECTRAL_LOG_DEBUG, " - Normalizing output (factor = %.4f)\n", normalize_factor);
         
         for (int i = 0; i < num_samples; i++) {
             filtered[i] *= normalize_factor;
@@ -345,7 +442,7 @@ void apply_highpass_filter(double *signal, int num_samples, double *a, double *b
     // Libérer la mémoire
     free(filtered);
     
-    printf(" - Successfully applied high-pass filter to signal\n");
+    spectral_log(job, SPECTRAL_LOG_DEBUG, " - Successfully applied high-pass filter to signal\n");
 }
 
 /*---------------------------------------------------------------------
@@ -353,7 +450,7 @@ void apply_highpass_filter(double *signal, int num_samples, double *a, double *b
  *
  * Applies a separable box blur to the image.
  *---------------------------------------------------------------------*/
-void apply_separable_box_blur(cairo_surface_t *surface, int radius)
+void apply_separable_box_blur(cairo_surface_t *surface, int radius, SpectralJob *job)
 {
     if (radius <= 0) return;
     
@@ -365,7 +462,7 @@ void apply_separable_box_blur(cairo_surface_t *surface, int radius)
     
     unsigned char *temp = (unsigned char *)malloc(height * stride);
     if (temp == NULL) {
-        fprintf(stderr, "Error: Memory allocation failed for blur buffer.\n");
+        spectral_log(job, SPECTRAL_LOG_ERROR, "Error: Memory allocation failed for blur buffer.\n");
         return;
     }
     
@@ -441,11 +538,11 @@ int normalize_wav_file(const char *input_path, const char *output_path, double f
     
     // Load the input file without normalizing it (normalize=0)
     if (load_wav_file(input_path, &signal, &num_samples, &sample_rate, 0, 0) != 0) {
-        fprintf(stderr, "Error: Failed to load input audio file for normalization\n");
+        spectral_log(NULL, SPECTRAL_LOG_ERROR, "Error: Failed to load input audio file for normalization\n");
         return 1;
     }
     
-    printf("Normalizing audio file with factor: %.6f\n", factor);
+    spectral_log(NULL, SPECTRAL_LOG_INFO, "Normalizing audio file with factor: %.6f\n", factor);
     
     // Apply the normalization factor
     for (int i = 0; i < num_samples; i++) {
@@ -465,7 +562,7 @@ int normalize_wav_file(const char *input_path, const char *output_path, double f
     // Open output file
     sf = sf_open(output_path, SFM_WRITE, &info);
     if (sf == NULL) {
-        fprintf(stderr, "Error: Could not open output file %s: %s\n",
+        spectral_log(NULL, SPECTRAL_LOG_ERROR, "Error: Could not open output file %s: %s\n",
                 output_path, sf_strerror(NULL));
         free(signal);
         return 2;
@@ -474,7 +571,7 @@ int normalize_wav_file(const char *input_path, const char *output_path, double f
     // Write normalized data
     sf_count_t frames_written = sf_write_double(sf, signal, num_samples);
     if (frames_written != num_samples) {
-        fprintf(stderr, "Error: Could only write %lld of %d frames\n",
+        spectral_log(NULL, SPECTRAL_LOG_ERROR, "Error: Could only write %lld of %d frames\n",
                 (long long)frames_written, num_samples);
         sf_close(sf);
         free(signal);
@@ -485,6 +582,6 @@ int normalize_wav_file(const char *input_path, const char *output_path, double f
     sf_close(sf);
     free(signal);
     
-    printf("Successfully created normalized audio file: %s\n", output_path);
+    spectral_log(NULL, SPECTRAL_LOG_INFO, "Successfully created normalized audio file: %s\n", output_path);
     return 0;
 }
@@ -16,6 +16,7 @@
 #include <sndfile.h>
 #include <cairo/cairo.h>
 #include "spectral_common.h"
+#include "spectral_decoder.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -23,12 +24,17 @@ extern "C" {
 
 // Function prototypes
 int load_wav_file(const char *filename, double **signal, int *num_samples, int *sample_rate, double duration, int normalize);
+int wav_file_info(const char *filename, int *sample_rate, double *seconds);
+int load_wav_file_scaled(const char *filename, double **signal, int *num_samples, int *sample_rate,
+                         double duration, int max_frames, int normalize, double gain, SpectralJob *job);
 void generate_sine_wave(double *signal, int total_samples, double sample_rate, double frequency, double amplitude);
 void apply_hann_window(double *buffer, int size);
-void apply_high_freq_boost_filter(double *signal, int num_samples, double alpha);
-void design_highpass_filter(double cutoff_freq, int order, double sample_rate, double *a, double *b);
-void apply_highpass_filter(double *signal, int num_samples, double *a, double *b, int filter_order);
-void apply_separable_box_blur(cairo_surface_t *surface, int radius);
+void apply_high_freq_boost_filter(double *signal, int num_samples, double alpha, SpectralJob *job);
+void design_highpass_filter(double cutoff_freq, int order, double sample_rate, double *a, double *b,
+                            SpectralJob *job);
+void apply_highpass_filter(double *signal, int num_samples, double *a, double *b, int filter_order,
+                           SpectralJob *job);
+void apply_separable_box_blur(cairo_surface_t *surface, int radius, SpectralJob *job);
 int normalize_wav_file(const char *input_path, const char *output_path, double factor);
 
 #ifdef __cplusplus
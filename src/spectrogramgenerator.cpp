@@ -4,6 +4,7 @@
 #include "../include/VisualizationFactory.h"
 #include "../include/TaskManager.h"
 #include "../include/Constants.h"
+#include "../include/AudioAnalysisCache.h"
 #include "../src/spectral_wav_processing.h"
 #include <QDir>
 #include <QFileInfo>
@@ -13,6 +14,7 @@
 #include <QBuffer>
 #include <QDateTime>
 #include <sndfile.h>
+#include <memory>
 
 // Initialisation de la variable statique
 PreviewImageProvider* SpectrogramGenerator::s_previewProvider = nullptr;
@@ -20,10 +22,19 @@ PreviewImageProvider* SpectrogramGenerator::s_previewProvider = nullptr;
 SpectrogramGenerator::SpectrogramGenerator(QObject *parent)
     : QObject(parent)
     , m_settings() // Initialisation de la structure des paramètres
+    , m_inputGain(1.0)
+    , m_previewController(new PreviewController(this))
 {
     // Connecter les signaux du TaskManager pour relayer les mises à jour de progression
     connect(TaskManager::getInstance(), &TaskManager::taskProgressUpdated,
             this, &SpectrogramGenerator::taskProgressUpdated);
+    
+    // Les facteurs de normalisation demandés avant la fin de l'analyse arrivent ici
+    connect(AudioAnalysisCache::getInstance(), &AudioAnalysisCache::analysisReady,
+            this, [this](const QString &audioPath, bool success) {
+        double factor = success ? AudioAnalysisCache::getInstance()->cachedNormalizationFactor(audioPath) : 1.0;
+        emit normalizationFactorReady(audioPath, factor > 0.0 ? factor : 1.0);
+    });
 }
 
 void SpectrogramGenerator::setPreviewImageProvider(PreviewImageProvider *provider)
@@ -94,6 +105,15 @@ void SpectrogramGenerator::generateSpectrogram(
         return;
     }
     
+    // Refuser les générations dont le plan dépasse les budgets, avant tout décodage
+    SpectralPlan plan;
+    QString refusal;
+    if (TaskManager::getInstance()->planGeneration(settings.toCStruct(), inputFile, &plan) &&
+        !TaskManager::getInstance()->withinBudget(plan, &refusal)) {
+        emit spectrogramGenerated(false, "", refusal);
+        return;
+    }
+    
     // Obtenir la stratégie de visualisation
     VisualizationStrategy* strategy = VisualizationFactory::getInstance()->getStrategy(visualizationType);
     if (!strategy) {
@@ -179,86 +199,91 @@ void SpectrogramGenerator::generatePreview(
     // Convertir en structure C
     SpectrogramSettings settings = settingsCpp.toCStruct();
     
-    // Exécuter la génération de prévisualisation dans un thread séparé via TaskManager
-    QUuid taskId = TaskManager::getInstance()->runTask(
-        [this, settings, inputFile](TaskManager::ProgressCallback progressCallback) {
-            // Créer un fichier temporaire pour la prévisualisation
-            QTemporaryFile tempFile;
-            tempFile.setAutoRemove(false); // Ne pas supprimer automatiquement pour pouvoir le charger
-            
-            progressCallback(10, "Création du fichier temporaire...");
-            
-            if (!tempFile.open()) {
-                emit previewGenerated(false, QImage(), "Impossible de créer le fichier temporaire");
-                return;
-            }
-            
-            QString tempFilePath = tempFile.fileName();
-            tempFile.close();
-            
-            progressCallback(20, "Génération du spectrogramme...");
-            
-            // Convertir les QString en const char* pour l'API C
-            QByteArray inputFileBytes = inputFile.toLocal8Bit();
-            QByteArray tempFileBytes = tempFilePath.toLocal8Bit();
-            
-            const char *inputFileCStr = inputFileBytes.constData();
-            const char *tempFileCStr = tempFileBytes.constData();
-            
-            // Extract filename from path for parameters display
-            QString audioFileName = inputFile.isEmpty() ? "Default" : QFileInfo(inputFile).fileName();
-            
-            // Call the C function to generate the spectrogram in the temporary file
-            // Pass the audio filename, start time (0.0 for preview) and duration for parameters display
-            int result = spectral_generator_with_metadata(&settings, inputFileCStr, tempFileCStr,
-                                                         audioFileName.toUtf8().constData(), 0.0, settings.duration);
-            
-            progressCallback(80, "Traitement de l'image...");
-            
-            if (result == EXIT_SUCCESS) {
-                // Charger l'image générée
-                QImageReader reader(tempFilePath);
-                QImage previewImage = reader.read();
+    // Les rafales de requêtes (curseurs) sont regroupées : seule la dernière est lancée
+    m_previewController->request([this, settings, inputFile](quint64 serial) {
+        // La nouvelle prévisualisation rend obsolètes celles en cours
+        cancelPreviews();
+        
+        // Taille de l'ébauche à la résolution de l'écran, fixée au lancement
+        QSize draftSize = m_previewController->draftSize();
+        
+        QUuid taskId = TaskManager::getInstance()->runCancellableTask(
+            [this, settings, inputFile, serial, draftSize](SpectralJob* job, TaskManager::ProgressCallback progressCallback) {
+                // Refuser les prévisualisations dont le plan dépasse les budgets ; la lecture
+                // de l'en-tête et le plan restent hors du thread de l'interface
+                SpectralPlan plan;
+                QString refusal;
+                if (TaskManager::getInstance()->planGeneration(settings, inputFile, &plan) &&
+                    !TaskManager::getInstance()->withinBudget(plan, &refusal)) {
+                    publishPreview(serial, false, false, QImage(), refusal);
+                    return;
+                }
+                
+                // Créer un fichier temporaire pour la prévisualisation
+                QTemporaryFile tempFile;
+                tempFile.setAutoRemove(false); // Ne pas supprimer automatiquement pour pouvoir le charger
+                
+                progressCallback(0, "Création du fichier temporaire...");
+                
+                if (!tempFile.open()) {
+                    publishPreview(serial, false, false, QImage(), "Impossible de créer le fichier temporaire");
+                    return;
+                }
+                
+                QString tempFilePath = tempFile.fileName();
+                tempFile.close();
+                
+                // Convertir les QString en const char* pour l'API C
+                QByteArray inputFileBytes = inputFile.toLocal8Bit();
+                QByteArray tempFileBytes = tempFilePath.toLocal8Bit();
+                
+                const char *inputFileCStr = inputFileBytes.constData();
+                const char *tempFileCStr = tempFileBytes.constData();
+                
+                // Extract filename from path for parameters display
+                QString audioFileName = inputFile.isEmpty() ? "Default" : QFileInfo(inputFile).fileName();
                 
-                if (!previewImage.isNull()) {
-                    // Stocker l'image et émettre le signal
-                    m_previewImage = previewImage;
+                // Generate the spectrogram in the temporary file, after a draft if the viewport is known
+                // Pass the audio filename and start time (0.0 for preview) for parameters display
+                int result = renderPreview(settings, inputFileCStr, tempFileCStr, audioFileName, 0.0,
+                                           serial, false, draftSize, job);
+                
+                if (result == SPECTRAL_CANCELLED) {
+                    // L'annulation a déjà été signalée par TaskManager::cancelTask
+                    qDebug() << "Génération de la prévisualisation annulée";
+                    QFile::remove(tempFilePath);
+                    return;
+                }
+                
+                if (result == EXIT_SUCCESS) {
+                    // Charger l'image générée
+                    QImageReader reader(tempFilePath);
+                    QImage previewImage = reader.read();
                     
-                    // Mettre à jour l'image dans le fournisseur d'images si disponible
-                    if (s_previewProvider) {
-                        qDebug() << "Mise à jour de l'image dans le fournisseur d'images";
-                        qDebug() << "Dimensions de l'image: " << previewImage.width() << "x" << previewImage.height();
-                        qDebug() << "Format de l'image: " << previewImage.format();
-                        s_previewProvider->updateImage(previewImage);
-                        
-                        // Vérifier l'état de l'image après la mise à jour
-                        s_previewProvider->debugImageState();
+                    if (!previewImage.isNull()) {
+                        progressCallback(100, "Prévisualisation générée avec succès");
+                        publishPreview(serial, false, true, previewImage);
                     } else {
-                        qDebug() << "Fournisseur d'images non disponible!";
+                        publishPreview(serial, false, false, QImage(), "Erreur lors du chargement de l'image de prévisualisation");
                     }
-                    
-                    progressCallback(100, "Prévisualisation générée avec succès");
-                    emit previewGenerated(true, previewImage);
                 } else {
-                    emit previewGenerated(false, QImage(), "Erreur lors du chargement de l'image de prévisualisation");
+                    publishPreview(serial, false, false, QImage(), "Erreur lors de la génération de la prévisualisation");
+                }
+                
+                // Supprimer le fichier temporaire
+                QFile::remove(tempFilePath);
+            },
+            [this, serial](bool success, const QString& message) {
+                // Cette fonction est appelée lorsque la tâche est terminée
+                if (!success) {
+                    publishPreview(serial, false, false, QImage(), message);
                 }
-            } else {
-                emit previewGenerated(false, QImage(), "Erreur lors de la génération de la prévisualisation");
-            }
-            
-            // Supprimer le fichier temporaire
-            QFile::remove(tempFilePath);
-        },
-        [this](bool success, const QString& message) {
-            // Cette fonction est appelée lorsque la tâche est terminée
-            if (!success) {
-                emit previewGenerated(false, QImage(), message);
             }
-        }
-    );
-    
-    // Stocker l'ID de la tâche
-    m_runningTasks[taskId] = "preview";
+        );
+        
+        // Stocker l'ID de la tâche
+        m_runningTasks[taskId] = "preview";
+    });
 }
 
 void SpectrogramGenerator::generateSpectrogramFromSegment(
@@ -325,6 +350,9 @@ void SpectrogramGenerator::generateSpectrogramFromSegment(
         overlapPreset
     );
     
+    // Les échantillons du segment portent déjà le gain appliqué par le WaveformProvider
+    settingsCpp.setInputGain(1.0);
+    
     // Log après createSettings
     qDebug() << "DEBUG - Après createSettings:";
     qDebug() << "DEBUG -   settingsCpp.m_minFreq = " << settingsCpp.getMinFreq();
@@ -338,27 +366,35 @@ void SpectrogramGenerator::generateSpectrogramFromSegment(
     qDebug() << "DEBUG -   settings.minFreq = " << settings.minFreq;
     qDebug() << "DEBUG -   settings.maxFreq = " << settings.maxFreq;
     
-    // Exécuter la génération de prévisualisation dans un thread séparé via TaskManager
-    QUuid taskId = TaskManager::getInstance()->runTask(
-        [this, settings, audioSegment, originalAudioFileName, startTime](TaskManager::ProgressCallback progressCallback) {
-            // Indiquer le début du traitement
-            progressCallback(10, "Préparation du segment audio...");
-            
-            this->runSegmentPreviewGeneration(settings, audioSegment, originalAudioFileName, startTime);
-            
-            // Indiquer la fin du traitement
-            progressCallback(100, "Traitement du segment terminé");
-        },
-        [this](bool success, const QString& message) {
-            // Cette fonction est appelée lorsque la tâche est terminée
-            if (!success) {
-                emit segmentPreviewGenerated(false, QImage(), message);
+    // Les rafales de requêtes (curseurs) sont regroupées : seule la dernière est lancée
+    m_previewController->request([this, settings, audioSegment, originalAudioFileName, startTime](quint64 serial) {
+        // La nouvelle prévisualisation rend obsolètes celles en cours
+        cancelPreviews();
+        
+        // Taille de l'ébauche à la résolution de l'écran, fixée au lancement
+        QSize draftSize = m_previewController->draftSize();
+        
+        QUuid taskId = TaskManager::getInstance()->runCancellableTask(
+            [this, settings, audioSegment, originalAudioFileName, startTime, serial, draftSize](SpectralJob* job, TaskManager::ProgressCallback progressCallback) {
+                // Indiquer le début du traitement (les étapes suivantes sont signalées par le job)
+                progressCallback(0, "Préparation du segment audio...");
+                
+                this->runSegmentPreviewGeneration(settings, audioSegment, serial, draftSize, originalAudioFileName, startTime, job);
+                
+                // Indiquer la fin du traitement
+                progressCallback(100, "Traitement du segment terminé");
+            },
+            [this, serial](bool success, const QString& message) {
+                // Cette fonction est appelée lorsque la tâche est terminée
+                if (!success) {
+                    publishPreview(serial, true, false, QImage(), message);
+                }
             }
-        }
-    );
-    
-    // Stocker l'ID de la tâche
-    m_runningTasks[taskId] = "segment";
+        );
+        
+        // Stocker l'ID de la tâche
+        m_runningTasks[taskId] = "segment";
+    });
 }
 
 void SpectrogramGenerator::saveCurrentPreview(const QString &outputFilePath, const QString &format)
@@ -652,6 +688,9 @@ SpectrogramSettingsCpp SpectrogramGenerator::createSettings(
     // Stocker la valeur calculée pour qu'elle soit transmise au moteur de génération
     settings.setFftSize(calculatedFftSize);
     
+    // Gain virtuel appliqué par le pipeline au chargement du fichier
+    settings.setInputGain(m_inputGain);
+    
     // IMPORTANT: Stocker les paramètres mis à jour dans l'instance m_settings pour pouvoir y accéder plus tard
     m_settings = settings;
     
@@ -669,8 +708,11 @@ SpectrogramSettingsCpp SpectrogramGenerator::createSettings(
 void SpectrogramGenerator::runSegmentPreviewGeneration(
     const SpectrogramSettings &settings,
     const QByteArray &audioSegment,
+    quint64 serial,
+    const QSize &draftSize,
     const QString &originalAudioFileName,
-    double startTime)
+    double startTime,
+    SpectralJob *job)
 {
     // Log debug information
     qDebug() << "Generating segment preview";
@@ -683,7 +725,7 @@ void SpectrogramGenerator::runSegmentPreviewGeneration(
     audioTempFile.setAutoRemove(false); // Don't auto-remove to allow processing
     
     if (!audioTempFile.open()) {
-        emit segmentPreviewGenerated(false, QImage(), "Impossible de créer le fichier temporaire pour les données audio");
+        publishPreview(serial, true, false, QImage(), "Impossible de créer le fichier temporaire pour les données audio");
         return;
     }
     
@@ -712,7 +754,7 @@ void SpectrogramGenerator::runSegmentPreviewGeneration(
     if (!outfile) {
         qWarning() << "Failed to create WAV file:" << sf_strerror(nullptr);
         QFile::remove(audioTempFilePath);
-        emit segmentPreviewGenerated(false, QImage(), "Failed to create WAV file: " + QString(sf_strerror(nullptr)));
+        publishPreview(serial, true, false, QImage(), "Failed to create WAV file: " + QString(sf_strerror(nullptr)));
         return;
     }
     
@@ -727,7 +769,7 @@ void SpectrogramGenerator::runSegmentPreviewGeneration(
     if (written != numSamples / sfInfo.channels) {
         qWarning() << "Failed to write all samples. Expected:" << numSamples / sfInfo.channels << "Written:" << written;
         QFile::remove(audioTempFilePath);
-        emit segmentPreviewGenerated(false, QImage(), "Failed to write all audio samples");
+        publishPreview(serial, true, false, QImage(), "Failed to write all audio samples");
         return;
     }
     
@@ -737,7 +779,7 @@ void SpectrogramGenerator::runSegmentPreviewGeneration(
     
     if (!imageTempFile.open()) {
         QFile::remove(audioTempFilePath);
-        emit segmentPreviewGenerated(false, QImage(), "Unable to create temporary file for the image");
+        publishPreview(serial, true, false, QImage(), "Unable to create temporary file for the image");
         return;
     }
     
@@ -764,14 +806,17 @@ void SpectrogramGenerator::runSegmentPreviewGeneration(
                             originalAudioFileName : 
                             QFileInfo(audioTempFilePath).fileName();
     
-    // Call the C function to generate the spectrogram in the temporary file
-    // Pass the original audio filename, start time and segment duration for parameters display
-    int result = spectral_generator_with_metadata(&settings, audioFileCStr, imageFileCStr,
-                                                 audioFileName.toUtf8().constData(), startTime, settings.duration);
+    // Generate the spectrogram in the temporary file, after a draft if the viewport is known
+    // Pass the original audio filename and start time for parameters display
+    int result = renderPreview(settings, audioFileCStr, imageFileCStr, audioFileName, startTime,
+                               serial, true, draftSize, job);
     
     qDebug() << "spectral_generator returned: " << result << (result == EXIT_SUCCESS ? " (SUCCESS)" : " (FAILURE)");
     
-    if (result == EXIT_SUCCESS) {
+    if (result == SPECTRAL_CANCELLED) {
+        // The cancellation has already been reported by TaskManager::cancelTask
+        qDebug() << "Segment preview generation cancelled";
+    } else if (result == EXIT_SUCCESS) {
         qDebug() << "Loading generated image from: " << imageTempFilePath;
         // Charger l'image générée
         QImageReader reader(imageTempFilePath);
@@ -779,32 +824,14 @@ void SpectrogramGenerator::runSegmentPreviewGeneration(
         
         if (!previewImage.isNull()) {
             qDebug() << "Image loaded successfully: " << previewImage.width() << "x" << previewImage.height();
-            // Stocker l'image et émettre le signal
-            m_previewImage = previewImage;
-            
-            // Mettre à jour l'image dans le fournisseur d'images si disponible
-            if (s_previewProvider) {
-                qDebug() << "Updating image in preview provider";
-                qDebug() << "Updating image in image provider (segment)";
-                qDebug() << "Image dimensions: " << previewImage.width() << "x" << previewImage.height();
-                qDebug() << "Image format: " << previewImage.format();
-                s_previewProvider->updateImage(previewImage);
-                
-                // Vérifier l'état de l'image après la mise à jour
-                s_previewProvider->debugImageState();
-            } else {
-                qDebug() << "Image provider not available!";
-            }
-            
-            qDebug() << "Emitting segmentPreviewGenerated signal with success=true";
-            emit segmentPreviewGenerated(true, previewImage);
+            publishPreview(serial, true, true, previewImage);
         } else {
             qWarning() << "Failed to load image from: " << imageTempFilePath;
-            emit segmentPreviewGenerated(false, QImage(), "Error loading segment preview image");
+            publishPreview(serial, true, false, QImage(), "Error loading segment preview image");
         }
     } else {
         qWarning() << "spectral_generator failed with code: " << result;
-        emit segmentPreviewGenerated(false, QImage(), "Error generating segment preview (code: " + QString::number(result) + ")");
+        publishPreview(serial, true, false, QImage(), "Error generating segment preview (code: " + QString::number(result) + ")");
     }
     
     // Supprimer les fichiers temporaires
@@ -814,6 +841,104 @@ void SpectrogramGenerator::runSegmentPreviewGeneration(
     qDebug() << "Segment preview generation completed with result:" << (result == EXIT_SUCCESS ? "SUCCESS" : "FAILURE");
 }
 
+int SpectrogramGenerator::renderPreview(const SpectrogramSettings &settings,
+                                        const char *audioFile,
+                                        const char *imageFile,
+                                        const QString &audioFileName,
+                                        double startTime,
+                                        quint64 serial,
+                                        bool segment,
+                                        const QSize &draftSize,
+                                        SpectralJob *job)
+{
+    QByteArray audioFileNameBytes = audioFileName.toUtf8();
+    int result;
+    
+    if (!draftSize.isValid() || draftSize.isEmpty()) {
+        result = spectral_generator_with_metadata(&settings, audioFile, imageFile,
+                                                  audioFileNameBytes.constData(), startTime, settings.duration,
+                                                  job);
+    } else {
+        // L'ébauche est publiée pendant l'appel, avant l'affinage à la résolution d'impression
+        DraftTarget target = { this, serial, segment };
+        result = spectral_generator_progressive(&settings, audioFile, imageFile,
+                                                audioFileNameBytes.constData(), startTime,
+                                                draftSize.width(), draftSize.height(),
+                                                &SpectrogramGenerator::forwardDraft, &target,
+                                                job);
+    }
+    
+    // Compteurs de la génération pour le panneau de diagnostic et le modèle de coût
+    if (result == EXIT_SUCCESS) {
+        TaskManager::getInstance()->publishJobStats(job);
+        TaskManager::getInstance()->calibrateCostModel(settings, QString::fromLocal8Bit(audioFile), job->stats);
+    }
+    return result;
+}
+
+void SpectrogramGenerator::forwardDraft(void *userData, const unsigned char *pixels,
+                                        int width, int height, int stride, double dpi)
+{
+    DraftTarget *target = static_cast<DraftTarget*>(userData);
+    
+    // Les pixels ne sont valides que pendant l'appel : copie profonde
+    QImage draft = QImage(pixels, width, height, stride, QImage::Format_ARGB32_Premultiplied).copy();
+    int dotsPerMeter = qRound(dpi / 0.0254);
+    draft.setDotsPerMeterX(dotsPerMeter);
+    draft.setDotsPerMeterY(dotsPerMeter);
+    
+    target->generator->publishPreview(target->serial, target->segment, true, draft, QString(), true);
+}
+
+void SpectrogramGenerator::publishPreview(quint64 serial, bool segment, bool success,
+                                          const QImage &previewImage, const QString &errorMessage,
+                                          bool draft)
+{
+    // Les workers rendent la main au thread de l'interface : m_previewImage et le
+    // fournisseur d'images ne sont modifiés que là, dans l'ordre des résultats
+    QMetaObject::invokeMethod(this, [this, serial, segment, success, previewImage, errorMessage, draft]() {
+        if (success) {
+            // Un résultat plus récent (ou plus fin) est déjà affiché
+            if (!m_previewController->accept(serial, draft)) {
+                return;
+            }
+            
+            // L'ébauche n'est qu'affichée : enregistrement et impression attendent l'affinage
+            if (draft) {
+                if (s_previewProvider) {
+                    s_previewProvider->updateDraftImage(previewImage);
+                }
+                emit previewDraftGenerated(segment);
+                return;
+            }
+            
+            m_previewImage = previewImage;
+            
+            // Mettre à jour l'image dans le fournisseur d'images si disponible
+            if (s_previewProvider) {
+                qDebug() << "Mise à jour de l'image dans le fournisseur d'images" << (segment ? "(segment)" : "");
+                qDebug() << "Dimensions de l'image: " << previewImage.width() << "x" << previewImage.height();
+                qDebug() << "Format de l'image: " << previewImage.format();
+                s_previewProvider->updateImage(previewImage);
+                
+                // Vérifier l'état de l'image après la mise à jour
+                s_previewProvider->debugImageState();
+            } else {
+                qDebug() << "Fournisseur d'images non disponible!";
+            }
+        } else if (m_previewController->isObsolete(serial)) {
+            // Échec ou annulation d'une prévisualisation remplacée : rien à signaler
+            return;
+        }
+        
+        if (segment) {
+            emit segmentPreviewGenerated(success, previewImage, errorMessage);
+        } else {
+            emit previewGenerated(success, previewImage, errorMessage);
+        }
+    }, Qt::QueuedConnection);
+}
+
 bool SpectrogramGenerator::printPreview()
 {
     qDebug() << "SpectrogramGenerator::printPreview - Impression de la prévisualisation actuelle";
@@ -878,48 +1003,51 @@ double SpectrogramGenerator::calculateNormalizationFactor(const QString &audioPa
         return 1.0; // Valeur par défaut (pas de changement)
     }
     
-    // Ouvrir le fichier audio avec libsndfile
-    SF_INFO info;
-    memset(&info, 0, sizeof(info));
-    
-    SNDFILE *sf = sf_open(audioPath.toUtf8().constData(), SFM_READ, &info);
-    if (!sf) {
-        qWarning() << "Impossible d'ouvrir le fichier audio:" << sf_strerror(NULL);
-        return 1.0;
-    }
-    
-    // Lire les échantillons et trouver la valeur maximale d'amplitude
-    double max_amplitude = 0.0;
-    const int BUFFER_SIZE = 4096;
-    double buffer[BUFFER_SIZE];
-    
-    sf_count_t read_count;
-    while ((read_count = sf_read_double(sf, buffer, BUFFER_SIZE)) > 0) {
-        for (sf_count_t i = 0; i < read_count; i++) {
-            double abs_value = fabs(buffer[i]);
-            if (abs_value > max_amplitude) {
-                max_amplitude = abs_value;
-            }
-        }
-    }
+    // L'analyse crête/RMS est calculée une seule fois par fichier (en arrière-plan
+    // dès le chargement) puis conservée en mémoire et dans un fichier annexe ;
+    // tant qu'elle n'est pas prête, normalizationFactorReady() suivra
+    double factor = AudioAnalysisCache::getInstance()->cachedNormalizationFactor(audioPath);
     
-    sf_close(sf);
-    
-    // Calculer le facteur de normalisation
-    // Limiter le facteur à une valeur raisonnable pour éviter une amplification excessive
-    // des fichiers avec de très faibles amplitudes
-    double factor = 1.0;
-    if (max_amplitude > 0.001) {
-        factor = 0.95 / max_amplitude; // 95% du maximum pour éviter l'écrêtage
-    } else {
-        factor = 10.0; // Limite pour les fichiers avec amplitude très faible
-    }
-    
-    qDebug() << "Amplitude maximale:" << max_amplitude << "- Facteur de normalisation calculé:" << factor;
+    qDebug() << "Facteur de normalisation calculé:" << factor << (factor > 0.0 ? "" : "(analyse en cours)");
     
     return factor;
 }
 
+void SpectrogramGenerator::requestNormalizedAudio(const QString &inputPath, double factor)
+{
+    // Le nom est choisi ici pour que cleanup() (thread de l'interface) supprime la copie
+    QFileInfo fileInfo(inputPath);
+    QString outputPath = QDir(QDir::tempPath()).filePath(
+        fileInfo.baseName() + "_normalized_" + QString::number(QDateTime::currentMSecsSinceEpoch()) + ".wav");
+    m_tempFiles.append(outputPath);
+    
+    auto written = std::make_shared<bool>(false);
+    TaskManager::getInstance()->runTask(
+        [inputPath, outputPath, factor, written](TaskManager::ProgressCallback progressCallback) {
+            progressCallback(0, "Copie normalisée pour la lecture...");
+            *written = QFileInfo::exists(inputPath) &&
+                       normalize_wav_file(inputPath.toUtf8().constData(), outputPath.toUtf8().constData(), factor) == 0;
+            progressCallback(100, "Copie normalisée pour la lecture terminée");
+        },
+        [this, inputPath, outputPath, factor, written](bool, const QString&) {
+            QString result = *written ? outputPath : QString();
+            QMetaObject::invokeMethod(this, [this, inputPath, factor, result]() {
+                emit normalizedAudioReady(inputPath, factor, result);
+            }, Qt::QueuedConnection);
+        }
+    );
+}
+
+void SpectrogramGenerator::setInputGain(double gain)
+{
+    m_inputGain = gain > 0.0 ? gain : 1.0;
+}
+
+double SpectrogramGenerator::getInputGain() const
+{
+    return m_inputGain;
+}
+
 void SpectrogramGenerator::cleanup()
 {
     qDebug() << "SpectrogramGenerator::cleanup - Nettoyage de" << m_tempFiles.size() << "fichiers temporaires";
@@ -940,6 +1068,20 @@ void SpectrogramGenerator::cleanup()
     m_tempFiles.clear();
 }
 
+void SpectrogramGenerator::cancelPreviews()
+{
+    TaskManager* taskManager = TaskManager::getInstance();
+    
+    for (auto it = m_runningTasks.begin(); it != m_runningTasks.end(); ) {
+        // Les tâches terminées sont simplement oubliées
+        if (taskManager->isTaskRunning(it.key())) {
+            qDebug() << "Annulation de la tâche" << it.value() << it.key();
+            taskManager->cancelTask(it.key());
+        }
+        it = m_runningTasks.erase(it);
+    }
+}
+
 int SpectrogramGenerator::getPreviewImageWidth() const
 {
     if (!s_previewProvider) {
@@ -1,10 +1,10 @@
 #include "../include/vectorprintprovider.h"
+#include "../include/TaskManager.h"
 #include <QDir>
 #include <QFileInfo>
 #include <QDebug>
 #include <QThread>
 #include <QFuture>
-#include <QtConcurrent/QtConcurrent>
 #include <cairo/cairo.h>
 #include <cairo/cairo-pdf.h>
 
@@ -13,7 +13,8 @@ extern "C" {
     int spectral_generator_vector_pdf(const SpectrogramSettings *cfg,
                                      const char *inputFile,
                                      const char *outputFile,
-                                     int dpi);
+                                     int dpi,
+                                     SpectralJob *job);
 }
 
 VectorPrintProvider::VectorPrintProvider(QObject *parent)
@@ -23,6 +24,16 @@ VectorPrintProvider::VectorPrintProvider(QObject *parent)
 
 VectorPrintProvider::~VectorPrintProvider()
 {
+    // The generation thread references this object
+    cancel();
+    m_future.waitForFinished();
+}
+
+void VectorPrintProvider::cancel()
+{
+    if (m_job) {
+        spectral_job_cancel(m_job.get());
+    }
 }
 
 void VectorPrintProvider::generateVectorPDF(
@@ -47,7 +58,9 @@ void VectorPrintProvider::generateVectorPDF(
     int overlapPreset,
     const QString &inputFile,
     const QString &outputFolder,
-    int dpi)
+    int dpi,
+    bool embedImage,
+    bool paginate)
 {
     // Vérifier que les fichiers existent
     if (inputFile.isEmpty()) {
@@ -87,13 +100,26 @@ void VectorPrintProvider::generateVectorPDF(
     settings.writingSpeed = writingSpeed;
     settings.binsPerSecond = binsPerSecond;
     settings.overlapPreset = overlapPreset;
+    settings.inputGain = 1.0;
+    settings.pdfEmbedImage = embedImage ? 1 : 0;
+    settings.paginate = paginate ? 1 : 0;
+    settings.analysisEngine = SPECTRAL_ENGINE_FFT;
 
     // Définir le chemin du fichier de sortie
     QString outputFile = QDir(outputFolder).filePath("spectrogram_vector.pdf");
 
-    // Exécuter la génération dans un thread séparé
-    QFuture<void> future = QtConcurrent::run([=]() {
-        this->runVectorGeneration(settings, inputFile, outputFile, dpi);
+    // Une nouvelle génération écrit le même fichier : annuler la précédente
+    // et attendre qu'elle ait libéré le fichier
+    cancel();
+    m_future.waitForFinished();
+
+    // Exécuter la génération sur le planificateur (classe export), en gardant son future et son job
+    std::shared_ptr<SpectralJob> job = std::make_shared<SpectralJob>();
+    spectral_job_init(job.get(), 0.0);
+    TaskManager::getInstance()->prepareJob(job.get());
+    m_job = job;
+    m_future = JobScheduler::getInstance()->schedule(JobScheduler::Export, [=]() {
+        this->runVectorGeneration(settings, inputFile, outputFile, dpi, job.get());
     });
 }
 
@@ -101,13 +127,16 @@ void VectorPrintProvider::runVectorGeneration(
     const SpectrogramSettings &settings,
     const QString &inputFile,
     const QString &outputFile,
-    int dpi)
+    int dpi,
+    SpectralJob *job)
 {
     // Ajouter des logs détaillés
     qDebug() << "Génération du PDF vectoriel";
     qDebug() << "Fichier d'entrée: " << inputFile;
     qDebug() << "Fichier de sortie: " << outputFile;
     qDebug() << "Résolution: " << dpi << " DPI";
+    qDebug() << "Spectrogramme: " << (settings.pdfEmbedImage ? "image en niveaux de gris" : "cellules vectorielles");
+    qDebug() << "Pagination: " << (settings.paginate ? "enregistrement entier" : "première page");
     qDebug() << "Bins par seconde: " << settings.binsPerSecond;
     qDebug() << "Préréglage d'overlap: " << (settings.overlapPreset == 0 ? "Low" :
                                            settings.overlapPreset == 2 ? "High" : "Medium");
@@ -122,9 +151,15 @@ void VectorPrintProvider::runVectorGeneration(
 
     // Appeler la fonction C
     qDebug() << "Appel de spectral_generator_vector_pdf pour la génération du PDF vectoriel";
-    int result = spectral_generator_vector_pdf(&settings, inputFileCStr, outputFileCStr, dpi);
+    int result = spectral_generator_vector_pdf(&settings, inputFileCStr, outputFileCStr, dpi, job);
     qDebug() << "spectral_generator_vector_pdf a retourné: " << result << (result == EXIT_SUCCESS ? " (SUCCÈS)" : " (ÉCHEC)");
 
+    if (result == SPECTRAL_CANCELLED) {
+        qDebug() << "Génération du PDF vectoriel annulée";
+        emit vectorPDFGenerated(false, "", "Génération annulée");
+        return;
+    }
+
     // Émettre le signal avec le résultat
     if (result == EXIT_SUCCESS) {
         qDebug() << "PDF vectoriel généré avec succès à: " << outputFile;
@@ -7,9 +7,14 @@
  */
 
 #include "waveformprovider.h"
+#include "AudioAnalysisCache.h"
+#include "PathManager.h"
+#include "../src/spectral_decoder.h"
 #include <QDebug>
 #include <QFile>
 #include <QFileInfo>
+#include <QMutexLocker>
+#include <QtConcurrent/QtConcurrent>
 #include <cmath>
 #include <algorithm>
 
@@ -17,6 +22,10 @@ WaveformProvider::WaveformProvider(QObject *parent)
     : QObject(parent)
     , m_file(nullptr)
     , m_fileLoaded(false)
+    , m_gain(1.0)
+    , m_cancelLoad(false)
+    , m_loadProgress(0.0)
+    , m_loadSerial(0)
 {
     // Initialize the SF_INFO structure
     memset(&m_fileInfo, 0, sizeof(SF_INFO));
@@ -38,6 +47,7 @@ bool WaveformProvider::loadFile(const QString &filePath)
     QFile file(filePath);
     if (!file.exists()) {
         qWarning() << "File does not exist:" << filePath;
+        emit waveformChanged();
         emit fileLoaded(false, 0, 0);
         return false;
     }
@@ -46,43 +56,151 @@ bool WaveformProvider::loadFile(const QString &filePath)
     m_file = sf_open(filePath.toUtf8().constData(), SFM_READ, &m_fileInfo);
     if (!m_file) {
         qWarning() << "Failed to open audio file:" << filePath << "Error:" << sf_strerror(nullptr);
+        emit waveformChanged();
         emit fileLoaded(false, 0, 0);
         return false;
     }
     
-    // Analyze the audio file
-    analyzeAudio();
-    
     // Calculate the duration in seconds
     double durationSeconds = static_cast<double>(m_fileInfo.frames) / m_fileInfo.samplerate;
     
+    {
+        QMutexLocker locker(&m_pyramidMutex);
+        m_pyramid.reset(m_fileInfo.channels);
+    }
+    m_loadProgress = 0.0;
+    m_cancelLoad = false;
+    quint64 serial = ++m_loadSerial;
+    
+    // Decode the waveform in background; the partial pyramid is usable meanwhile
+    m_loadFuture = QtConcurrent::run([this, filePath, info = m_fileInfo, serial]() {
+        analyzeAudio(filePath, info, serial);
+    });
+    
+    // Compute the peak/RMS summaries in background so normalization is immediate
+    AudioAnalysisCache::getInstance()->requestAnalysis(filePath);
+    
+    // Segment extraction reads from the file and works before decoding completes
     m_fileLoaded = true;
+    emit waveformChanged();
     emit fileLoaded(true, durationSeconds, m_fileInfo.samplerate);
     
     return true;
 }
 
-void WaveformProvider::analyzeAudio()
+void WaveformProvider::analyzeAudio(const QString &filePath, SF_INFO fileInfo, quint64 serial)
 {
-    // Allocate memory for audio data
-    m_audioData.resize(m_fileInfo.frames * m_fileInfo.channels);
+    // A pyramid saved by a previous session avoids decoding the file at all
+    QString sidecar = PathManager::getCacheFilePath(filePath, "waveform", "s3wp");
+    if (!sidecar.isEmpty()) {
+        WaveformPyramid cached;
+        if (cached.load(sidecar)) {
+            qDebug() << "Waveform pyramid loaded from cache:" << sidecar;
+            {
+                QMutexLocker locker(&m_pyramidMutex);
+                m_pyramid = std::move(cached);
+            }
+            reportProgress(1.0, serial);
+            return;
+        }
+    }
     
-    // Read all audio data
-    sf_count_t readCount = sf_readf_float(m_file, m_audioData.data(), m_fileInfo.frames);
+    // This thread uses its own handle: m_file stays available for extraction
+    SF_INFO info;
+    memset(&info, 0, sizeof(info));
+    QByteArray pathBytes = filePath.toUtf8();
+    SNDFILE *file = sf_open(pathBytes.constData(), SFM_READ, &info);
+    if (!file) {
+        qWarning() << "Failed to open audio file for decoding:" << filePath;
+        reportProgress(1.0, serial);
+        return;
+    }
     
-    if (readCount != m_fileInfo.frames) {
-        qWarning() << "Failed to read all audio frames. Expected:" << m_fileInfo.frames << "Read:" << readCount;
+    // Decode in bounded chunks (long compressed files as parallel ranges),
+    // publishing each chunk to the pyramid as it arrives
+    int decodeThreads = decoder_recommended_threads(&fileInfo, fileInfo.frames);
+    sf_count_t chunkFrames = std::max<sf_count_t>(
+        1 << 19, static_cast<sf_count_t>(decodeThreads * DECODER_MIN_RANGE_SECONDS * fileInfo.samplerate));
+    std::vector<float> buffer(static_cast<size_t>(std::min(chunkFrames, fileInfo.frames)) * fileInfo.channels);
+    
+    sf_count_t readCount = 0;
+    while (readCount < fileInfo.frames && !m_cancelLoad) {
+        sf_count_t wanted = std::min(chunkFrames, fileInfo.frames - readCount);
+        sf_count_t chunkRead;
+        if (decodeThreads > 1) {
+            chunkRead = decode_range_float(pathBytes.constData(), readCount, wanted, buffer.data(), decodeThreads, nullptr);
+        } else {
+            chunkRead = sf_readf_float(file, buffer.data(), wanted);
+        }
+        if (chunkRead <= 0) {
+            break;
+        }
+        
+        {
+            QMutexLocker locker(&m_pyramidMutex);
+            m_pyramid.appendFrames(buffer.data(), chunkRead);
+        }
+        readCount += chunkRead;
+        
+        reportProgress(static_cast<double>(readCount) / fileInfo.frames, serial);
+    }
+    
+    sf_close(file);
+    
+    if (m_cancelLoad) {
+        return;
+    }
+    
+    if (readCount != fileInfo.frames) {
+        qWarning() << "Failed to read all audio frames. Expected:" << fileInfo.frames << "Read:" << readCount;
+    }
+    
+    {
+        QMutexLocker locker(&m_pyramidMutex);
+        m_pyramid.finalize();
+        
+        if (!sidecar.isEmpty() && !m_pyramid.save(sidecar)) {
+            qWarning() << "Unable to write waveform pyramid cache:" << sidecar;
+        }
     }
     
-    // Return to the beginning of the file for future reads
-    sf_seek(m_file, 0, SEEK_SET);
+    reportProgress(1.0, serial);
+}
+
+void WaveformProvider::reportProgress(double progress, quint64 serial)
+{
+    if (serial != m_loadSerial) {
+        return;
+    }
+    m_loadProgress = progress;
+    
+    // Emit from the GUI thread, where QML connections live; a report
+    // queued before the file was closed or replaced is dropped there
+    QMetaObject::invokeMethod(this, [this, progress, serial]() {
+        if (serial != m_loadSerial) {
+            return;
+        }
+        emit waveformChanged();
+        emit loadProgress(progress);
+    }, Qt::QueuedConnection);
+}
+
+double WaveformProvider::getLoadProgress() const
+{
+    return m_loadProgress;
+}
+
+bool WaveformProvider::isFullyLoaded() const
+{
+    QMutexLocker locker(&m_pyramidMutex);
+    return m_fileLoaded && m_pyramid.isComplete();
 }
 
 QVariantList WaveformProvider::getWaveformData(int width)
 {
     QVariantList result;
     
-    if (!m_fileLoaded || m_audioData.empty()) {
+    if (!m_fileLoaded) {
         qWarning() << "No audio data loaded";
         return result;
     }
@@ -93,23 +211,101 @@ QVariantList WaveformProvider::getWaveformData(int width)
     return result;
 }
 
+QByteArray WaveformProvider::getWaveformDataPacked(int width, double startRatio, double endRatio)
+{
+    if (!m_fileLoaded || width <= 0) {
+        return QByteArray();
+    }
+    
+    QByteArray result(3 * width * static_cast<int>(sizeof(float)), Qt::Uninitialized);
+    float *data = reinterpret_cast<float *>(result.data());
+    if (!summarizeWindow(startRatio, endRatio, width, data, data + width, data + 2 * width)) {
+        return QByteArray();
+    }
+    
+    return result;
+}
+
+bool WaveformProvider::summarizeWindow(double startRatio, double endRatio, int width,
+                                       float *minOut, float *maxOut, float *rmsOut)
+{
+    if (!m_fileLoaded || width <= 0) {
+        return false;
+    }
+    
+    startRatio = std::clamp(startRatio, 0.0, 1.0);
+    endRatio = std::clamp(endRatio, startRatio, 1.0);
+    qint64 startFrame = static_cast<qint64>(startRatio * m_fileInfo.frames);
+    qint64 endFrame = static_cast<qint64>(endRatio * m_fileInfo.frames);
+    
+    return summarize(startFrame, endFrame, width, minOut, maxOut, rmsOut);
+}
+
 void WaveformProvider::resampleForDisplay(int targetWidth, QVariantList &result)
 {
-    // Number of samples per pixel
-    int samplesPerPixel = std::max(1, static_cast<int>(m_fileInfo.frames / targetWidth));
+    if (targetWidth <= 0) {
+        return;
+    }
     
-    // Number of channels
-    int channels = m_fileInfo.channels;
+    std::vector<float> minValues(targetWidth);
+    std::vector<float> maxValues(targetWidth);
+    std::vector<float> rmsValues(targetWidth);
+    if (!summarize(0, m_fileInfo.frames, targetWidth, minValues.data(), maxValues.data(), rmsValues.data())) {
+        return;
+    }
     
-    // For each pixel of the target width
+    result.reserve(targetWidth);
     for (int i = 0; i < targetWidth; ++i) {
-        // Calculate the start index for this pixel
-        int startIdx = i * samplesPerPixel * channels;
-        
-        // Make sure we don't exceed the limits
-        if (startIdx >= static_cast<int>(m_audioData.size())) {
-            break;
+        // Add values to the result list
+        QVariantMap point;
+        point["min"] = minValues[i];
+        point["max"] = maxValues[i];
+        point["rms"] = rmsValues[i];
+        result.append(point);
+    }
+}
+
+bool WaveformProvider::summarize(qint64 startFrame, qint64 endFrame, int width, float *minOut, float *maxOut, float *rmsOut)
+{
+    if (width <= 0 || endFrame <= startFrame) {
+        return false;
+    }
+    
+    // Columns narrower than a pyramid block are computed from the samples themselves
+    if ((endFrame - startFrame) / width < WaveformPyramid::BASE_BLOCK_SIZE) {
+        summarizeRaw(startFrame, endFrame, width, minOut, maxOut, rmsOut);
+    } else {
+        // Columns beyond the decoded prefix stay empty until their chunk arrives
+        QMutexLocker locker(&m_pyramidMutex);
+        m_pyramid.query(startFrame, endFrame, width, minOut, maxOut, rmsOut);
+    }
+    
+    // Apply the virtual gain
+    if (m_gain != 1.0) {
+        float gain = static_cast<float>(m_gain);
+        for (int i = 0; i < width; ++i) {
+            minOut[i] *= gain;
+            maxOut[i] *= gain;
+            rmsOut[i] *= gain;
         }
+    }
+    
+    return true;
+}
+
+void WaveformProvider::summarizeRaw(qint64 startFrame, qint64 endFrame, int width, float *minOut, float *maxOut, float *rmsOut)
+{
+    int channels = m_fileInfo.channels;
+    qint64 span = endFrame - startFrame;
+    
+    // The window is at most BASE_BLOCK_SIZE frames per column
+    std::vector<float> samples(static_cast<size_t>(span) * channels);
+    sf_seek(m_file, startFrame, SEEK_SET);
+    sf_count_t readCount = sf_readf_float(m_file, samples.data(), span);
+    
+    for (int i = 0; i < width; ++i) {
+        qint64 a = (span * i) / width;
+        qint64 b = std::min<qint64>((span * (i + 1)) / width, readCount);
         
         // Calculate min and max values for this segment
         float minValue = 0.0f;
@@ -117,38 +313,23 @@ void WaveformProvider::resampleForDisplay(int targetWidth, QVariantList &result)
         float rmsValue = 0.0f;
         int count = 0;
         
-        // Go through all samples for this pixel
-        for (int j = 0; j < samplesPerPixel && (startIdx + j * channels) < static_cast<int>(m_audioData.size()); ++j) {
+        for (qint64 j = a; j < b; ++j) {
             // Average of channels for each sample
             float sampleValue = 0.0f;
             for (int ch = 0; ch < channels; ++ch) {
-                int idx = startIdx + j * channels + ch;
-                if (idx < static_cast<int>(m_audioData.size())) {
-                    sampleValue += m_audioData[idx];
-                }
+                sampleValue += samples[j * channels + ch];
             }
             sampleValue /= channels;
             
-            // Update min/max
             minValue = std::min(minValue, sampleValue);
             maxValue = std::max(maxValue, sampleValue);
-            
-            // Calculate RMS
             rmsValue += sampleValue * sampleValue;
             count++;
         }
         
-        // Finalize RMS
-        if (count > 0) {
-            rmsValue = std::sqrt(rmsValue / count);
-        }
-        
-        // Add values to the result list
-        QVariantMap point;
-        point["min"] = minValue;
-        point["max"] = maxValue;
-        point["rms"] = rmsValue;
-        result.append(point);
+        minOut[i] = minValue;
+        maxOut[i] = maxValue;
+        rmsOut[i] = count > 0 ? std::sqrt(rmsValue / count) : 0.0f;
     }
 }
 
@@ -230,6 +411,13 @@ QByteArray WaveformProvider::extractSegment(double startPosition, double duratio
         qWarning() << "Failed to read all requested samples. Expected:" << sampleCount << "Read:" << readCount;
     }
     
+    // Apply the virtual gain in place of a normalized copy of the file
+    if (m_gain != 1.0) {
+        for (float &sample : buffer) {
+            sample *= static_cast<float>(m_gain);
+        }
+    }
+    
     // Convert to QByteArray
     QByteArray result;
     result.resize(buffer.size() * sizeof(float));
@@ -261,14 +449,37 @@ QString WaveformProvider::getFilePath() const
     return m_filePath;
 }
 
+void WaveformProvider::setGain(double gain)
+{
+    double newGain = gain > 0.0 ? gain : 1.0;
+    if (newGain != m_gain) {
+        m_gain = newGain;
+        emit waveformChanged();
+    }
+}
+
+double WaveformProvider::getGain() const
+{
+    return m_gain;
+}
+
 void WaveformProvider::closeFile()
 {
+    // Stop the background decoding of the previous file
+    m_cancelLoad = true;
+    m_loadFuture.waitForFinished();
+    ++m_loadSerial;
+    m_loadProgress = 0.0;
+    
     if (m_file) {
         sf_close(m_file);
         m_file = nullptr;
     }
     
-    m_audioData.clear();
+    {
+        QMutexLocker locker(&m_pyramidMutex);
+        m_pyramid = WaveformPyramid();
+    }
     m_fileLoaded = false;
     memset(&m_fileInfo, 0, sizeof(SF_INFO));
 }
@@ -0,0 +1,36 @@
+###############################################################################
+# sp3ctragen-verify - Équivalence des noyaux optimisés avec la référence figée
+#
+# Usage: sp3ctragen-verify --rates 44100,192000 --variant parallel
+#        sp3ctragen-verify --concurrent 32   (stress test, voir CONFIG+=tsan)
+###############################################################################
+
+TEMPLATE = app
+CONFIG -= qt app_bundle
+CONFIG += console release
+
+# Nom et cible du projet
+TARGET = sp3ctragen-verify
+
+# Répertoires pour les fichiers générés
+OBJECTS_DIR = build/obj
+
+# Noyau C de génération (sources, en-têtes et bibliothèques externes)
+include(../spectral_core.pri)
+
+# Fichiers source
+SOURCES += \
+    ../src/spectral_verify.c \
+    ../src/spectral_reference.c \
+    ../src/spectral_synth.c
+
+# Build ThreadSanitizer: qmake CONFIG+=tsan, puis
+#   sp3ctragen-verify --concurrent 32 --durations 1
+# Les jobs concurrents doivent finir sans rapport de TSan et rendre des
+# pages identiques au rendu série de leur graine.
+tsan {
+    CONFIG -= release
+    CONFIG += debug
+    QMAKE_CFLAGS += -fsanitize=thread -O1 -g
+    QMAKE_LFLAGS += -fsanitize=thread
+}